@@ -0,0 +1,276 @@
+#!/usr/bin/env python
+
+# Simulation speed benchmark for the TSAR platforms.
+#
+# For each (platform, number of clusters, workload) configuration, this
+# script builds the platform and the workload, runs the simulator for a
+# fixed number of cycles, and reports:
+# - the simulation speed (simulated kHz, the elaboration time excluded),
+# - the host memory footprint (max RSS),
+# - optionally (--profile), a per module breakdown of the host time,
+#   obtained by sampling the simulator with perf (memc / L1 / routers /
+#   crossbars / kernel / other).
+# The results are written as JSON (one document per benchmark run), so
+# that successive runs can be compared to track speed regressions.
+#
+# The platforms are built with their Makefile (soclib-cc must be in the
+# PATH). The paths to the external tools are defined in a bench_config.py file
+# in this directory (see the defaults below):
+# - giet_vm   : path to the GIET-VM repository (genmap, for the hard_config.h
+#               of the tsar_generic_iob and tsar_generic_leti platforms)
+# - almos     : True if the ALMOS binaries are installed in
+#               tsar_generic_xbar/almos (see tsar_generic_xbar/scripts/run_simus.py)
+# The GIET workloads are built in a scratch copy of their directory (with
+# the hard_config.h of the platform), removed at the end of the benchmark.
+#
+# Usage : sim_speed.py [--quick] [--profile] [--ncycles N] [--output file]
+#                      [--platforms p1,p2] [--clusters 1,4] [--workloads w1,w2]
+
+import json
+import optparse
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+bench_path = os.path.dirname(os.path.realpath(__file__))
+tsar_path  = os.path.join(bench_path, '..')
+
+# Default configuration (overridden by bench_config.py)
+giet_vm   = ''
+almos     = False
+procs     = 4           # processors per cluster
+ncycles   = 2000000     # simulated cycles per run
+
+config_name = os.path.join(bench_path, 'bench_config.py')
+if os.path.isfile(config_name):
+    exec(open(config_name).read())
+
+# cluster count -> mesh size
+meshes = { 1 : (1, 1), 4 : (2, 2), 16 : (4, 4), 64 : (8, 8) }
+
+# GIET workloads (softs/soft_<name>_giet, including the hard_config.h
+# generated for the platform)
+giet_workloads = [ 'hello', 'sort', 'transpose' ]
+
+# The tsar_generic_xbar platform is built for ALMOS (USE_ALMOS in top.cpp),
+# and has no GIET mapping: it runs the ALMOS boot for the cycle budget.
+platforms = {
+    'xbar' : dict(dir = 'tsar_generic_xbar', workloads = [ 'almos' ]),
+    'iob'  : dict(dir = 'tsar_generic_iob',  workloads = giet_workloads),
+    'leti' : dict(dir = 'tsar_generic_leti', workloads = giet_workloads),
+}
+
+# Classification of the profiled symbols (first match)
+modules = [
+    ('memc',      re.compile(r'VciMemCache|CacheDirectory|HeapDirectory|UpdateTab|TransactionTab|CacheData')),
+    ('l1',        re.compile(r'VciCcVCacheWrapper|GenericCache|GenericTlb|MultiWriteBuffer|Mips32|Iss')),
+    ('routers',   re.compile(r'DspinRouter|DspinMesh|VirtualDspinRouter')),
+    ('crossbars', re.compile(r'Crossbar|DspinTargetWrapper|DspinInitiatorWrapper')),
+    ('kernel',    re.compile(r'sc_core|sc_dt|systemcass|sc_signal|sc_module')),
+]
+
+XBAR_HARD_CONFIG = '''
+/* Generated from sim_speed.py */
+
+#ifndef _HD_CONFIG_H
+#define _HD_CONFIG_H
+
+#define X_SIZE              %(x)d
+#define Y_SIZE              %(y)d
+#define NB_CLUSTERS         %(clusters)d
+#define NB_PROCS_MAX        %(procs)d
+#define NB_TASKS_MAX        8
+
+#define NB_TIM_CHANNELS     32
+#define NB_DMA_CHANNELS     1
+
+#define NB_TTY_CHANNELS     4
+#define NB_IOC_CHANNELS     1
+#define NB_NIC_CHANNELS     0
+#define NB_CMA_CHANNELS     0
+
+#define USE_XICU            1
+#define IOMMU_ACTIVE        0
+
+#define IRQ_PER_PROCESSOR   1
+
+#endif //_HD_CONFIG_H
+'''
+
+
+def log(msg):
+    sys.stderr.write(msg + '\n')
+
+
+def run(cmd, cwd):
+    log('[%s] %s' % (os.path.relpath(cwd, tsar_path), ' '.join(cmd)))
+    with open(os.devnull, 'w') as null:
+        return subprocess.call(cmd, cwd = cwd, stdout = null)
+
+
+def build(name, clusters, workload, scratch):
+    platform = platforms[name]
+    pdir = os.path.join(tsar_path, 'platforms', platform['dir'])
+    x, y = meshes[clusters]
+    params = dict(x = x, y = y, clusters = clusters, procs = procs)
+
+    # hard_config.h of the platform (and of the GIET workload)
+    if name == 'xbar':
+        with open(os.path.join(pdir, 'almos', 'hard_config.h'), 'w') as f:
+            f.write(XBAR_HARD_CONFIG % params)
+    else:
+        if not giet_vm:
+            log('*** giet_vm not defined in bench_config.py')
+            return None
+        genmap = os.path.join(giet_vm, 'giet_python', 'genmap')
+        if run([ genmap, '--arch=%s' % pdir, '--x=%d' % x, '--y=%d' % y,
+                 '--p=%d' % procs, '--hard=%s' % pdir ], pdir) != 0:
+            return None
+
+    if run([ 'make', 'simul.x' ], pdir) != 0:
+        return None
+
+    args = [ os.path.join(pdir, 'simul.x') ]
+    if workload != 'almos':
+        # scratch copy of the workload (its Makefile uses ../giet_tsar)
+        giet = os.path.join(scratch, 'giet_tsar')
+        if not os.path.exists(giet):
+            os.symlink(os.path.join(tsar_path, 'softs', 'giet_tsar'), giet)
+        sdir = os.path.join(scratch, 'soft_%s_giet' % workload)
+        if os.path.exists(sdir):
+            shutil.rmtree(sdir)
+        shutil.copytree(os.path.join(tsar_path, 'softs', 'soft_%s_giet' % workload), sdir)
+        shutil.copy(os.path.join(pdir, 'hard_config.h'), sdir)
+        if run([ 'make', 'clean', 'bin.soft' ], sdir) != 0:
+            return None
+        args += [ '-SOFT', os.path.join(sdir, 'bin.soft') ]
+    elif not almos:
+        log('*** almos not set in bench_config.py')
+        return None
+
+    return pdir, args
+
+
+def measure(pdir, args, cycles, prefix = []):
+    cmd = prefix + args + [ '-NCYCLES', str(cycles), '-THREADS', '1' ]
+    log('[%s] %s' % (os.path.relpath(pdir, tsar_path), ' '.join(cmd)))
+    with open(os.devnull, 'w') as null:
+        start = time.time()
+        p = subprocess.Popen(cmd, cwd = pdir, stdout = null, stderr = null)
+        pid, status, usage = os.wait4(p.pid, 0)
+        wall = time.time() - start
+    return status, wall, usage.ru_maxrss
+
+
+def profile(pdir, args, cycles):
+    data = os.path.join(pdir, 'perf.data')
+    status, wall, rss = measure(pdir, args, cycles,
+                                [ 'perf', 'record', '-q', '-F', '499', '-o', data, '--' ])
+    if status != 0:
+        return None
+
+    report = subprocess.Popen([ 'perf', 'report', '--stdio', '--no-children',
+                                '--sort', 'symbol', '-i', data ],
+                              stdout = subprocess.PIPE).communicate()[0]
+    os.remove(data)
+
+    breakdown = dict((m, 0.0) for m, regex in modules)
+    breakdown['other'] = 0.0
+    for line in report.decode('latin-1').splitlines():
+        match = re.match(r'\s*([0-9.]+)%\s+\[\.\]\s+(.*)', line)
+        if not match:
+            continue
+        percent, symbol = float(match.group(1)), match.group(2)
+        for m, regex in modules:
+            if regex.search(symbol):
+                breakdown[m] += percent
+                break
+        else:
+            breakdown['other'] += percent
+
+    return dict((m, round(v, 2)) for m, v in breakdown.items())
+
+
+def revision():
+    try:
+        return subprocess.Popen([ 'git', 'rev-parse', 'HEAD' ], cwd = tsar_path,
+                                stdout = subprocess.PIPE).communicate()[0].decode().strip()
+    except OSError:
+        return ''
+
+
+def run_all(opts, wanted, results, scratch):
+    for name in opts.platforms.split(','):
+        for clusters in [ int(c) for c in opts.clusters.split(',') ]:
+            for workload in platforms[name]['workloads']:
+                if wanted and workload not in wanted:
+                    continue
+
+                result = dict(platform = name, clusters = clusters, workload = workload,
+                              ncycles = opts.ncycles)
+                results.append(result)
+
+                target = build(name, clusters, workload, scratch)
+                if target is None:
+                    result['error'] = 'build failed'
+                    continue
+                pdir, sim = target
+
+                # the elaboration time is measured with a one cycle run
+                status0, startup, rss0 = measure(pdir, sim, 1)
+                status, wall, rss = measure(pdir, sim, opts.ncycles)
+                if (status0 != 0) or (status != 0):
+                    result['error'] = 'simulation failed'
+                    continue
+
+                result['wall_s']     = round(wall, 3)
+                result['startup_s']  = round(startup, 3)
+                result['khz']        = round(opts.ncycles / max(wall - startup, 1e-3) / 1000, 2)
+                result['max_rss_kb'] = rss
+
+                if opts.profile:
+                    result['breakdown'] = profile(pdir, sim, opts.ncycles)
+
+                log('  => %s' % json.dumps(result, sort_keys = True))
+
+
+
+def main():
+    parser = optparse.OptionParser()
+    parser.add_option('--ncycles',   type = 'int', default = ncycles)
+    parser.add_option('--output',    default = '-')
+    parser.add_option('--platforms', default = ','.join(sorted(platforms)))
+    parser.add_option('--clusters',  default = ','.join(str(c) for c in sorted(meshes)))
+    parser.add_option('--workloads', default = '')
+    parser.add_option('--profile',   action = 'store_true', default = False)
+    parser.add_option('--quick',     action = 'store_true', default = False,
+                      help = '1 and 4 clusters, hello (GIET) and almos (xbar) workloads, 200000 cycles')
+    opts, args = parser.parse_args()
+
+    if opts.quick:
+        opts.clusters  = '1,4'
+        opts.workloads = 'hello,almos'
+        opts.ncycles   = 200000
+
+    wanted = opts.workloads.split(',') if opts.workloads else None
+    results = []
+    scratch = tempfile.mkdtemp(prefix = 'sim_speed_')
+
+    try:
+        run_all(opts, wanted, results, scratch)
+    finally:
+        shutil.rmtree(scratch)
+
+    document = dict(revision = revision(), date = time.strftime('%Y-%m-%dT%H:%M:%S'),
+                    host = os.uname()[1], results = results)
+    out = sys.stdout if opts.output == '-' else open(opts.output, 'w')
+    json.dump(document, out, indent = 1, sort_keys = True)
+    out.write('\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,279 @@
+/* -*- c++ -*-
+ *
+ * SOCLIB_LGPL_HEADER_BEGIN
+ *
+ * This file is part of SoCLib, GNU LGPLv2.1.
+ *
+ * SoCLib is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; version 2.1 of the License.
+ *
+ * SoCLib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with SoCLib; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * SOCLIB_LGPL_HEADER_END
+ */
+
+#ifndef SOCLIB_COUNTER_BLOCK_H
+#define SOCLIB_COUNTER_BLOCK_H
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "statistics_registry.h"
+
+namespace soclib
+{
+
+////////////////////////////////////////////////////////////////////////
+//                    The activity counter blocks
+// A component groups its activity counters (64 bits) in a structure
+// containing only uint64_t members, allocated in a CounterBlock:
+// the counters are contiguous, and are accessed with the -> operator.
+//
+// When a shared memory prefix has been defined (set_shm_prefix(),
+// before the construction of the components), each block is allocated
+// in a POSIX shared memory object named "/<prefix>.<path>" (the '/' of
+// the component path are replaced by '_'). An external monitor can
+// map this object (read only), and sample the counters while the
+// simulation is running: the counters are aligned, so that each value
+// is read atomically on a 64 bits host. Otherwise the block is
+// allocated in the heap.
+//
+// Segment layout (native byte order):
+// - header : "SOCCNTRS", uint32 version, uint32 number of counters,
+//   path of the component (null terminated, COUNTER_BLOCK_PATH_SIZE),
+// - one descriptor per counter : name and unit (null terminated,
+//   COUNTER_BLOCK_NAME_SIZE and COUNTER_BLOCK_UNIT_SIZE), empty for a
+//   counter not published by the add() function,
+// - one uint64 value per counter.
+// The shared memory object is removed by the block destructor.
+////////////////////////////////////////////////////////////////////////
+
+#define COUNTER_BLOCK_PATH_SIZE     64
+#define COUNTER_BLOCK_NAME_SIZE     32
+#define COUNTER_BLOCK_UNIT_SIZE     16
+
+class CounterBlockBase
+{
+    struct Header
+    {
+        char        magic[8];
+        uint32_t    version;
+        uint32_t    count;
+        char        path[COUNTER_BLOCK_PATH_SIZE];
+    };
+
+    struct Descriptor
+    {
+        char        name[COUNTER_BLOCK_NAME_SIZE];
+        char        unit[COUNTER_BLOCK_UNIT_SIZE];
+    };
+
+    std::string     m_path;
+    std::string     m_shm_name;     // empty for a heap block
+    size_t          m_count;
+    size_t          m_size;         // segment size (bytes)
+    char *          m_segment;
+    uint64_t *      m_values;
+
+    CounterBlockBase(const CounterBlockBase &);
+    CounterBlockBase & operator=(const CounterBlockBase &);
+
+    static std::string & shm_prefix()
+    {
+        static std::string prefix;
+        return prefix;
+    }
+
+    Descriptor * descriptors() const
+    {
+        return (Descriptor *)(m_segment + sizeof(Header));
+    }
+
+    void map_shm()
+    {
+        m_shm_name = "/" + shm_prefix() + "." + m_path;
+        for (size_t i = 1; i < m_shm_name.size(); i++)
+        {
+            if (m_shm_name[i] == '/') m_shm_name[i] = '_';
+        }
+
+        int fd = shm_open(m_shm_name.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+        if (fd < 0)
+        {
+            perror("COUNTER ERROR : cannot create the shared memory object");
+            exit(EXIT_FAILURE);
+        }
+
+        if (ftruncate(fd, m_size) != 0)
+        {
+            perror("COUNTER ERROR : cannot size the shared memory object");
+            exit(EXIT_FAILURE);
+        }
+
+        void * segment = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (segment == MAP_FAILED)
+        {
+            perror("COUNTER ERROR : cannot map the shared memory object");
+            exit(EXIT_FAILURE);
+        }
+        ::close(fd);
+
+        m_segment = (char *)segment;    // ftruncate() fills the object with 0
+    }
+
+    protected:
+
+    CounterBlockBase(const std::string &path, size_t count)
+        : m_path(path), m_count(count)
+    {
+        m_size = sizeof(Header) + count * (sizeof(Descriptor) + sizeof(uint64_t));
+
+        if (shm_prefix().empty()) m_segment = (char *)calloc(1, m_size);
+        else                      map_shm();
+
+        if (m_segment == NULL)
+        {
+            perror("COUNTER ERROR : cannot allocate the counter block");
+            exit(EXIT_FAILURE);
+        }
+
+        Header * header = (Header *)m_segment;
+        header->version = 1;
+        header->count   = count;
+        strncpy(header->path, path.c_str(), COUNTER_BLOCK_PATH_SIZE - 1);
+
+        m_values = (uint64_t *)(m_segment + sizeof(Header) + count * sizeof(Descriptor));
+
+        // the magic number is written last, for a monitor polling the object
+        __sync_synchronize();
+        memcpy(header->magic, "SOCCNTRS", 8);
+    }
+
+    ~CounterBlockBase()
+    {
+        if (m_shm_name.empty())
+        {
+            free(m_segment);
+        }
+        else
+        {
+            munmap(m_segment, m_size);
+            shm_unlink(m_shm_name.c_str());
+        }
+    }
+
+    uint64_t * values() const
+    {
+        return m_values;
+    }
+
+    public:
+
+    /////////////////////////////////////////////////////////////////////
+    // The set_shm_prefix() function selects the shared memory
+    // allocation for the blocks constructed after the call
+    // (an empty prefix selects the heap allocation).
+    /////////////////////////////////////////////////////////////////////
+    static void set_shm_prefix(const std::string &prefix)
+    {
+        shm_prefix() = prefix;
+    }
+
+    size_t size() const
+    {
+        return m_count;
+    }
+
+    bool is_shared() const
+    {
+        return not m_shm_name.empty();
+    }
+
+    const std::string & shm_name() const
+    {
+        return m_shm_name;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The add() function names a counter of the block in the segment
+    // descriptors, and publishes it in the statistics registry.
+    /////////////////////////////////////////////////////////////////////
+    void add(const char *name, const char *unit, const uint64_t *counter)
+    {
+        assert((counter >= m_values) and (counter < m_values + m_count) and
+               "COUNTER ERROR : counter not in the block");
+
+        Descriptor & d = descriptors()[counter - m_values];
+        strncpy(d.name, name, COUNTER_BLOCK_NAME_SIZE - 1);
+        strncpy(d.unit, unit, COUNTER_BLOCK_UNIT_SIZE - 1);
+
+        StatisticsRegistry::instance().add(m_path, name, unit, counter);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The clear() function resets all counters of the block.
+    /////////////////////////////////////////////////////////////////////
+    void clear()
+    {
+        for (size_t i = 0; i < m_count; i++) m_values[i] = 0;
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////
+// The counter structure T must only contain uint64_t members (arrays
+// of uint64_t are allowed).
+/////////////////////////////////////////////////////////////////////////
+template<typename T>
+class CounterBlock : public CounterBlockBase
+{
+    T * m_counters;
+
+    public:
+
+    CounterBlock(const std::string &path)
+        : CounterBlockBase(path, sizeof(T) / sizeof(uint64_t)),
+          m_counters((T *)values())
+    {
+        assert((sizeof(T) % sizeof(uint64_t) == 0) and
+               "COUNTER ERROR : the counter structure must contain only uint64_t");
+    }
+
+    T * operator->() const
+    {
+        return m_counters;
+    }
+
+    T & operator*() const
+    {
+        return *m_counters;
+    }
+};
+
+} // end namespace soclib
+
+#endif
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
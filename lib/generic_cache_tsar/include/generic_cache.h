@@ -41,8 +41,12 @@
 // But it can fail if all ways are in ZOMBI state.
 /////////////////////////////////////////////////////////////////////////////////
 // Implementation note
-// The DATA part is implemented as an uint32_t array[nways*nsets*nwords].
-// The DIRECTORY part is implemented as an uint32_t array[nways*nsets].
+// The DATA part is implemented as an uint32_t array[nsets*nways*nwords].
+// The DIRECTORY part is implemented as two arrays[nsets*nways] (tag, state).
+// The arrays are set-major : the ways of a set are contiguous, and the
+// associative search builds a bitmask of the matching ways with a branch
+// free loop on the ways, that can be vectorized by the compiler.
+// The LRU bits of a set are packed in an uint16_t (one bit per way).
 // All methods requiring a dual port RAM or cache modification using
 // an associative search have been deprecated.
 /////////////////////////////////////////////////////////////////////////////////
@@ -90,11 +94,12 @@ class GenericCache
     data_t              *r_data ;
     addr_t               *r_tag ;
     int                 *r_state;
-    bool                *r_lru ;
+    uint16_t            *r_lru ;    // one bit per way (set if new)
 
     size_t              m_ways;	
     size_t              m_sets;	
     size_t              m_words;
+    uint16_t            m_ways_mask;    // one bit per way
 
     const soclib::common::AddressMaskingTable<addr_t>  m_x ;
     const soclib::common::AddressMaskingTable<addr_t>  m_y ;
@@ -103,43 +108,96 @@ class GenericCache
     //////////////////////////////////////////////////////////////
     inline data_t &cache_data(size_t way, size_t set, size_t word)
     {
-        return r_data[(way*m_sets*m_words)+(set*m_words)+word];
+        return r_data[(((set*m_ways)+way)*m_words)+word];
     }
 
     //////////////////////////////////////////////
     inline addr_t &cache_tag(size_t way, size_t set)
     {
-        return r_tag[(way*m_sets)+set];
+        return r_tag[(set*m_ways)+way];
     }
 
     //////////////////////////////////////////////
-    inline bool &cache_lru(size_t way, size_t set)
+    inline int &cache_state(size_t way, size_t set)
     {
-        return r_lru[(way*m_sets)+set];
+        return r_state[(set*m_ways)+way];
     }
 
-    //////////////////////////////////////////////
-    inline int &cache_state(size_t way, size_t set)
+    /////////////////////////////////////////////////
+    inline void cache_set_lru(size_t way, size_t set)
     {
-        return r_state[(way*m_sets)+set];
+        r_lru[set] |= (uint16_t)(1 << way);
+
+ 	    // all lines are new -> they all become old 
+        if ( r_lru[set] == m_ways_mask ) r_lru[set] = 0;
     }
 
     /////////////////////////////////////////////////
-    inline void cache_set_lru(size_t way, size_t set)
+    inline void cache_clear_lru(size_t way, size_t set)
     {
-	    size_t way2;
+        r_lru[set] &= (uint16_t)~(1 << way);
+    }
 
-        cache_lru(way, set) = true;
+    //////////////////////////////////////////////////////////////
+    // Returns the bitmask of the ways of a set containing the tag
+    //////////////////////////////////////////////////////////////
+    inline uint32_t tag_match(addr_t tag, size_t set)
+    {
+        const addr_t *tags = &r_tag[set*m_ways];
+        uint32_t     match = 0;
 
-	    for (way2 = 0; way2 < m_ways; way2++ ) 
+        for ( size_t way = 0; way < m_ways; way++ ) 
         {
-	        if (cache_lru(way2, set) == false) return;
-	    }
- 	    // all lines are new -> they all become old 
-	    for (way2 = 0; way2 < m_ways; way2++ ) 
+            match |= (uint32_t)(tags[way] == tag) << way;
+        }
+        return match;
+    }
+
+    //////////////////////////////////////////////////////////////
+    // Returns the bitmask of the ways of a set in a given state
+    //////////////////////////////////////////////////////////////
+    inline uint32_t state_match(int state, size_t set)
+    {
+        const int    *states = &r_state[set*m_ways];
+        uint32_t     match   = 0;
+
+        for ( size_t way = 0; way < m_ways; way++ ) 
         {
-	        cache_lru(way2, set) = false;
-	    }
+            match |= (uint32_t)(states[way] == state) << way;
+        }
+        return match;
+    }
+
+    //////////////////////////////////////////////////////////////
+    // Returns the lowest way of a non zero bitmask
+    //////////////////////////////////////////////////////////////
+    inline size_t first_way(uint32_t mask)
+    {
+#ifdef __GNUC__
+        return __builtin_ctz(mask);
+#else
+        size_t way = 0;
+        while ( not (mask & 0x1) )
+        {
+            mask = mask >> 1;
+            way++;
+        }
+        return way;
+#endif
+    }
+
+    //////////////////////////////////////////////////////////////
+    // Returns the highest way of a non zero bitmask
+    //////////////////////////////////////////////////////////////
+    inline size_t last_way(uint32_t mask)
+    {
+#ifdef __GNUC__
+        return 31 - __builtin_clz(mask);
+#else
+        size_t way = 0;
+        while ( mask >>= 1 ) way++;
+        return way;
+#endif
     }
 
     ////////////////////////////////
@@ -163,6 +221,7 @@ public:
         : m_ways(nways),
           m_sets(nsets),
           m_words(nwords),
+          m_ways_mask((uint16_t)((1 << nways) - 1)),
 
 #define l2 soclib::common::uint32_log2
 
@@ -193,10 +252,10 @@ std::cout << "constructing " << name << std::endl
           << std::endl;
 #endif
 
-        r_data    = new data_t[nways*nsets*nwords];
-        r_tag     = new addr_t[nways*nsets];
-        r_state   = new int[nways*nsets];
-        r_lru     = new bool[nways*nsets];
+        r_data    = new data_t[nsets*nways*nwords];
+        r_tag     = new addr_t[nsets*nways];
+        r_state   = new int[nsets*nways];
+        r_lru     = new uint16_t[nsets];
     }
 
     ////////////////
@@ -214,7 +273,7 @@ std::cout << "constructing " << name << std::endl
         std::memset(r_data, 0, sizeof(*r_data)*m_ways*m_sets*m_words);
         std::memset(r_tag, 0, sizeof(*r_tag)*m_ways*m_sets);
         std::memset(r_state, CACHE_SLOT_STATE_EMPTY, sizeof(*r_state)*m_ways*m_sets);
-        std::memset(r_lru, 0, sizeof(*r_lru)*m_ways*m_sets);
+        std::memset(r_lru, 0, sizeof(*r_lru)*m_sets);
     }
 
     /////////////////////////////////////////////////////////////////////
@@ -229,15 +288,15 @@ std::cout << "constructing " << name << std::endl
         const size_t      set  = m_y[ad];
         const size_t      word = m_x[ad];
 
-        for ( size_t way = 0; way < m_ways; way++ ) 
+        const uint32_t    hit  = tag_match(tag, set) & 
+                                 state_match(CACHE_SLOT_STATE_VALID, set);
+
+        if ( hit ) 
         {
-            if ( (tag == cache_tag(way, set))  
-                   && (cache_state(way, set) == CACHE_SLOT_STATE_VALID) )
-            {
-                *dt = cache_data(way, set, word);
-                cache_set_lru(way, set);
-                return true;
-            }
+            const size_t way = first_way(hit);
+            *dt = cache_data(way, set, word);
+            cache_set_lru(way, set);
+            return true;
         }
         return false;
     }
@@ -258,18 +317,18 @@ std::cout << "constructing " << name << std::endl
         const size_t      set  = m_y[ad];
         const size_t      word = m_x[ad];
 
-        for ( size_t way = 0; way < m_ways; way++ ) 
+        const uint32_t    hit  = tag_match(tag, set) & 
+                                 state_match(CACHE_SLOT_STATE_VALID, set);
+
+        if ( hit ) 
         {
-            if ( (tag == cache_tag(way, set)) and
-                 (cache_state(way, set) == CACHE_SLOT_STATE_VALID) )
-            {
-                *selway  = way;
-                *selset  = set;
-                *selword = word;
-                *dt = cache_data(way, set, word);
-                cache_set_lru(way, set);
-                return true;
-            }
+            const size_t way = first_way(hit);
+            *selway  = way;
+            *selset  = set;
+            *selword = word;
+            *dt = cache_data(way, set, word);
+            cache_set_lru(way, set);
+            return true;
         }
         return false;
     }
@@ -302,27 +361,21 @@ std::cout << "constructing " << name << std::endl
         *selword = 0;
         *dt      = 0;
 
-        for ( size_t way = 0; way < m_ways; way++ ) 
+        // matching tag and not EMPTY (the last matching way is selected)
+        const uint32_t    hit  = tag_match(tag, set) & 
+                                 ~state_match(CACHE_SLOT_STATE_EMPTY, set);
+
+        if ( hit ) 
         {
-            if ( tag == cache_tag(way, set) )  // matching tag
+            const size_t way = last_way(hit);
+            *state   = cache_state(way, set);
+            *selway  = way;
+            *selset  = set;
+            *selword = word;
+            if ( *state == CACHE_SLOT_STATE_VALID )
             {
-
-                if ( cache_state(way, set) == CACHE_SLOT_STATE_VALID )
-                {
-                    *state   = CACHE_SLOT_STATE_VALID;
-                    *selway  = way;
-                    *selset  = set;
-                    *selword = word;
-                    *dt      = cache_data(way, set, word);
-                    cache_set_lru(way, set);
-                }
-                else if ( cache_state(way, set) == CACHE_SLOT_STATE_ZOMBI )
-                {
-                    *state   = CACHE_SLOT_STATE_ZOMBI;
-                    *selway  = way;
-                    *selset  = set;
-                    *selword = word;
-                }
+                *dt      = cache_data(way, set, word);
+                cache_set_lru(way, set);
             }
         }
     }
@@ -343,17 +396,17 @@ std::cout << "constructing " << name << std::endl
         const size_t      set  = m_y[ad];
         const size_t      word = m_x[ad];
 
-        for ( size_t way = 0; way < m_ways; way++ ) 
+        const uint32_t    hit  = tag_match(tag, set) & 
+                                 state_match(CACHE_SLOT_STATE_VALID, set);
+
+        if ( hit ) 
         {
-            if ( (tag == cache_tag(way, set))  
-                   && (cache_state(way, set) == CACHE_SLOT_STATE_VALID) )
-            {
-                *selway  = way;
-                *selset  = set;
-                *selword = word;
-                *dt = cache_data(way, set, word);
-                return true;
-            }
+            const size_t way = first_way(hit);
+            *selway  = way;
+            *selset  = set;
+            *selword = word;
+            *dt = cache_data(way, set, word);
+            return true;
         }
         return false;
     }
@@ -378,22 +431,22 @@ std::cout << "constructing " << name << std::endl
         const size_t      set  = m_y[ad];
         const size_t      word = m_x[ad];
 
-        for ( size_t way = 0; way < m_ways; way++ ) 
+        const uint32_t    hit  = tag_match(tag, set) & 
+                                 state_match(CACHE_SLOT_STATE_VALID, set);
+
+        if ( hit ) 
         {
-            if ( (tag == cache_tag(way, set))   
-                   && (cache_state(way, set) == CACHE_SLOT_STATE_VALID) ) 
+            const size_t way = first_way(hit);
+            *dt      = cache_data(way, set, word);
+            if ( word+1 < m_words) 
             {
-                *dt      = cache_data(way, set, word);
-                if ( word+1 < m_words) 
-                {
-                    *dt_next = cache_data(way, set, word+1);
-                }
-                *selway  = way;
-                *selset  = set;
-                *selword = word;
-                cache_set_lru(way, set);
-                return true;
+                *dt_next = cache_data(way, set, word+1);
             }
+            *selway  = way;
+            *selset  = set;
+            *selword = word;
+            cache_set_lru(way, set);
+            return true;
         }
         return false;
     }
@@ -427,33 +480,27 @@ std::cout << "constructing " << name << std::endl
         *selword = 0;
         *dt      = 0;
 
-        for ( size_t way = 0; way < m_ways; way++ ) 
+        // matching tag and not EMPTY (the last matching way is selected)
+        const uint32_t    hit  = tag_match(tag, set) & 
+                                 ~state_match(CACHE_SLOT_STATE_EMPTY, set);
+
+        if ( hit ) 
         {
-            if ( tag == cache_tag(way, set) )  // matching tag
+            const size_t way = last_way(hit);
+            *state   = cache_state(way, set);
+            *selway  = way;
+            *selset  = set;
+            *selword = word;
+            if ( *state == CACHE_SLOT_STATE_VALID )
             {
-
-                if ( cache_state(way, set) == CACHE_SLOT_STATE_VALID )
-                {
-                    *state   = CACHE_SLOT_STATE_VALID;
-                    *selway  = way;
-                    *selset  = set;
-                    *selword = word;
-                    *dt      = cache_data(way, set, word);
-                    if ( word+1 < m_words) 
-                    {
-                        *dt_next = cache_data(way, set, word+1);
-                    } else {
-			assert(false && "can't request 2 words at end of line");
-		    }
-                    cache_set_lru(way, set);
-                }
-                else if ( cache_state(way, set) == CACHE_SLOT_STATE_ZOMBI )
+                *dt      = cache_data(way, set, word);
+                if ( word+1 < m_words) 
                 {
-                    *state   = CACHE_SLOT_STATE_ZOMBI;
-                    *selway  = way;
-                    *selset  = set;
-                    *selword = word;
+                    *dt_next = cache_data(way, set, word+1);
+                } else {
+                    assert(false && "can't request 2 words at end of line");
                 }
+                cache_set_lru(way, set);
             }
         }
     }
@@ -475,17 +522,17 @@ std::cout << "constructing " << name << std::endl
         const size_t      set  = m_y[ad];
         const size_t      word = m_x[ad];
 
-        for ( size_t way = 0; way < m_ways; way++ ) 
+        const uint32_t    hit  = tag_match(tag, set) & 
+                                 state_match(CACHE_SLOT_STATE_VALID, set);
+
+        if ( hit ) 
         {
-            if ( (tag == cache_tag(way, set)) 
-                   && (cache_state(way, set) == CACHE_SLOT_STATE_VALID) ) 
-            {
-                *selway  = way;
-                *selset  = set;
-                *selword = word;
-                cache_set_lru(way, set);
-                return true;
-            }
+            const size_t way = first_way(hit);
+            *selway  = way;
+            *selset  = set;
+            *selword = word;
+            cache_set_lru(way, set);
+            return true;
         }
         return false;
     }
@@ -511,17 +558,17 @@ std::cout << "constructing " << name << std::endl
         const size_t      ad_set  = m_y[ad];
         const size_t      ad_word = m_x[ad];
 
-        for ( size_t _way = 0; _way < m_ways; _way++ ) 
+        const uint32_t    hit     = tag_match(ad_tag, ad_set) & 
+                                    ~state_match(CACHE_SLOT_STATE_EMPTY, ad_set);
+
+        if ( hit ) 
         {
-            if ( (ad_tag == cache_tag(_way, ad_set) ) and 
-                 (cache_state(_way, ad_set) != CACHE_SLOT_STATE_EMPTY) ) 
-            {
-                *state = cache_state(_way, ad_set);
-                *way   = _way;
-                *set   = ad_set;
-                *word  = ad_word;
-                return;
-            }
+            const size_t _way = first_way(hit);
+            *state = cache_state(_way, ad_set);
+            *way   = _way;
+            *set   = ad_set;
+            *word  = ad_word;
+            return;
         }
         
         // return value if not (VALID or ZOMBI)
@@ -542,6 +589,19 @@ std::cout << "constructing " << name << std::endl
         *tag   = cache_tag(way, set);
     }
 
+    ///////////////////////////////////////////////////////////////////
+    // Read a single 32 bits word in a selected slot, that must be
+    // VALID. The directory is not accessed, and the LRU is updated
+    // as for a read hit.
+    ///////////////////////////////////////////////////////////////////
+    inline data_t read_slot(size_t way,
+                            size_t set,
+                            size_t word)
+    {
+        cache_set_lru(way, set);
+        return cache_data(way, set, word);
+    }
+
     ////////////////////////////////////////////
     inline addr_t get_tag(size_t way, size_t set)
     {
@@ -614,27 +674,23 @@ std::cout << "constructing " << name << std::endl
         *way = 0;
 
         // Search first empty slot 
-        for ( size_t _way = 0 ; _way < m_ways && !found ; _way++ )
+        uint32_t empty = m_ways_mask & ~state_match(CACHE_SLOT_STATE_VALID, *set);
+        if ( empty )
         {
-            if ( cache_state(_way, *set) != CACHE_SLOT_STATE_VALID )  // empty
-            {
-                found   = true;
-                cleanup = false;
-                *way    = _way;
-            }
+            found   = true;
+            cleanup = false;
+            *way    = first_way(empty);
         }
 
         // If no empty slot, search first  old slot (lru == false) 
         if ( !found )
         { 
-            for ( size_t _way = 0 ; _way < m_ways && !found ; _way++ )
+            uint32_t old = m_ways_mask & ~r_lru[*set];
+            if ( old )
             {
-                if ( not cache_lru(_way, *set) )
-                {
-                    found   = true;
-                    cleanup = true;
-                    *way    = _way;
-                }
+                found   = true;
+                cleanup = true;
+                *way    = first_way(old);
             }
         }
 
@@ -664,43 +720,36 @@ std::cout << "constructing " << name << std::endl
         *found = false;
 
         // Search first empty slot 
-        for ( size_t _way = 0 ; _way < m_ways && !(*found) ; _way++ )
+        uint32_t empty = state_match(CACHE_SLOT_STATE_EMPTY, _set);
+        if ( empty )
         {
-            if ( cache_state(_way, _set) == CACHE_SLOT_STATE_EMPTY )
-            {
-                *found   = true;
-                *cleanup = false;
-                *way     = _way;
-                *set     = m_y[ad];
-                return;
-            }
+            *found   = true;
+            *cleanup = false;
+            *way     = first_way(empty);
+            *set     = m_y[ad];
+            return;
         }
         // Search first not zombi old slot 
-        for ( size_t _way = 0 ; _way < m_ways && !(*found) ; _way++ )
+        uint32_t not_zombi = m_ways_mask & ~state_match(CACHE_SLOT_STATE_ZOMBI, _set);
+        uint32_t old       = not_zombi & ~r_lru[_set];
+        if ( old )
         {
-            if ( not cache_lru(_way, _set) and 
-                 (cache_state(_way, _set) != CACHE_SLOT_STATE_ZOMBI) )
-            {
-                *found   = true;
-                *cleanup = true;
-                *way     = _way;
-                *set     = m_y[ad];
-                *victim  = cache_tag(*way,_set) * m_sets + _set;
-                return;
-            }
+            *found   = true;
+            *cleanup = true;
+            *way     = first_way(old);
+            *set     = m_y[ad];
+            *victim  = cache_tag(*way,_set) * m_sets + _set;
+            return;
         }
         // Search first not zombi slot
-        for ( size_t _way = 0 ; _way < m_ways && !(*found) ; _way++ )
+        if ( not_zombi )
         {
-            if ( cache_state(_way, _set) != CACHE_SLOT_STATE_ZOMBI) 
-            {
-                *found   = true;
-                *cleanup = true;
-                *way    = _way;
-                *set     = m_y[ad];
-                *victim  = cache_tag(*way,_set) * m_sets + _set;
-                return;
-            }
+            *found   = true;
+            *cleanup = true;
+            *way     = first_way(not_zombi);
+            *set     = m_y[ad];
+            *victim  = cache_tag(*way,_set) * m_sets + _set;
+            return;
         }
 
         // no slot found...
@@ -858,7 +907,7 @@ std::cout << "constructing " << name << std::endl
             {
                 hit                   = true;
                 cache_state(way, set) = CACHE_SLOT_STATE_EMPTY;
-                cache_lru(way, set)   = false;
+                cache_clear_lru(way, set);
             }
         }
         return hit;
@@ -883,7 +932,7 @@ std::cout << "constructing " << name << std::endl
             {
                 hit                   = true;
                 cache_state(way, set) = CACHE_SLOT_STATE_EMPTY;
-                cache_lru(way, set)   = false;
+                cache_clear_lru(way, set);
                 *selway             = way;
                 *selset             = set;
             }
@@ -65,9 +65,28 @@ class GenericLLSCGlobalTable
 
     const std::string           name              ; // component name
 
+    // The valid registrations are indexed by two open addressing hash tables
+    // (linear probing, at most half full) :
+    // - the slot index table gives the slot containing a given address,
+    // - the block map table gives, for a given block of 64 words,
+    //   a bit-vector of the words having a valid registration.
+    // The block map allows the sw() method to find all the registrations
+    // in a written range without looking up every word of the range.
+    enum
+    {
+        hash_size  = (nb_slots <= 16) ? 32 : (nb_slots <= 32) ? 64 : 128,
+        hash_mask  = hash_size - 1,
+        block_bits = 6, // log2 of the number of words in a block
+    };
+
     uint32_t                    r_key  [nb_slots] ; // array of key
     addr_t                      r_addr [nb_slots] ; // array of addresses
     bool                        r_val  [nb_slots] ; // array of valid bits
+    uint64_t                    r_val_mask        ; // valid bits as a bit-vector
+
+    int                         m_slot_index [hash_size] ; // slot index (-1 if empty)
+    uint64_t                    m_block_tag  [hash_size] ; // block number
+    uint64_t                    m_block_map  [hash_size] ; // word bit-vector (0 if empty)
 
     uint32_t                    r_next_key        ; // value of the next key
     uint64_t                    r_block_mask      ; // mask for the slots blocks
@@ -210,21 +229,130 @@ class GenericLLSCGlobalTable
         }
     }
 
+    ////////////////////////////////////////////////////////////////////////////
+    static inline size_t lowestBit(uint64_t v)
+    //  This function returns the position of the lowest bit set in v (v != 0)
+    {
+        size_t pos = 0;
+        if ((v & 0xFFFFFFFFULL) == 0) { v >>= 32; pos += 32; }
+        if ((v & 0xFFFFULL)     == 0) { v >>= 16; pos += 16; }
+        if ((v & 0xFFULL)       == 0) { v >>= 8;  pos += 8;  }
+        if ((v & 0xFULL)        == 0) { v >>= 4;  pos += 4;  }
+        if ((v & 0x3ULL)        == 0) { v >>= 2;  pos += 2;  }
+        if ((v & 0x1ULL)        == 0) {           pos += 1;  }
+        return pos;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    static inline size_t hash(const uint64_t v)
+    //  This function returns the home entry of a key in the hash tables
+    {
+        return (size_t)((v * 0x9E3779B97F4A7C15ULL) >> 40) & hash_mask;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    static inline bool inProbeRange(size_t home, size_t hole, size_t pos)
+    //  This function returns true if the entry at position pos, whose home
+    //  entry is home, cannot be moved to the hole at position hole
+    //  (that is when home is cyclically in the range ]hole, pos])
+    {
+        if (hole <= pos) return (hole < home) and (home <= pos);
+        else             return (hole < home) or  (home <= pos);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    inline void indexInsert(const size_t slot)
+    //  This function registers a valid slot in the hash tables
+    {
+        uint64_t ad    = (uint64_t)r_addr[slot];
+        uint64_t word  = ad >> 2;
+        uint64_t block = word >> block_bits;
+
+        // slot index table (the address is not already registered)
+        size_t i = hash(ad);
+        while (m_slot_index[i] >= 0) i = (i + 1) & hash_mask;
+        m_slot_index[i] = slot;
+
+        // block map table
+        i = hash(block);
+        while ((m_block_map[i] != 0) and (m_block_tag[i] != block))
+            i = (i + 1) & hash_mask;
+        m_block_tag[i]  = block;
+        m_block_map[i] |= (uint64_t)1 << (word & ((1 << block_bits) - 1));
+
+        r_val_mask |= (uint64_t)1 << slot;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    inline void indexRemove(const size_t slot)
+    //  This function removes a valid slot from the hash tables
+    //  The deleted entries are filled by shifting back the following
+    //  entries of the probe sequence (no tombstone).
+    {
+        uint64_t ad    = (uint64_t)r_addr[slot];
+        uint64_t word  = ad >> 2;
+        uint64_t block = word >> block_bits;
+
+        // slot index table
+        size_t i = hash(ad);
+        while (m_slot_index[i] != (int)slot) i = (i + 1) & hash_mask;
+        for (size_t j = (i + 1) & hash_mask;
+             m_slot_index[j] >= 0;
+             j = (j + 1) & hash_mask)
+        {
+            if (inProbeRange(hash(r_addr[m_slot_index[j]]), i, j)) continue;
+            m_slot_index[i] = m_slot_index[j];
+            i = j;
+        }
+        m_slot_index[i] = -1;
+
+        // block map table (the word bit is cleared only if no other slot
+        // contains an address in the same word)
+        i = hash(block);
+        while (m_block_tag[i] != block or m_block_map[i] == 0)
+            i = (i + 1) & hash_mask;
+
+        for (size_t k = 0; k < 4; k++)
+        {
+            uint64_t other = (word << 2) | k;
+            if ((other != ad) and (hitAddr((addr_t)other) >= 0)) return;
+        }
+
+        m_block_map[i] &= ~((uint64_t)1 << (word & ((1 << block_bits) - 1)));
+        if (m_block_map[i] != 0) return;
+
+        for (size_t j = (i + 1) & hash_mask;
+             m_block_map[j] != 0;
+             j = (j + 1) & hash_mask)
+        {
+            if (inProbeRange(hash(m_block_tag[j]), i, j)) continue;
+            m_block_tag[i] = m_block_tag[j];
+            m_block_map[i] = m_block_map[j];
+            i = j;
+        }
+        m_block_map[i] = 0;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    inline void invalSlot(const size_t slot)
+    //  This function invalidates a valid registration
+    {
+        r_val[slot] = false;
+        r_val_mask &= ~((uint64_t)1 << slot);
+        indexRemove(slot);
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     inline int nextEmptySlot() const
     //  This function returns :
-    //  - the position of the first next empty slot in the table
-    //    (starting from the last empty slot used)
-    //    and updates the r_last_empty_slot register
+    //  - the position of the first empty slot in the table
     //  - -1 if the table is full
     {
-        uint64_t i; 
-        for(i = 0; i < nb_slots; i++)
-        {
-            if (!r_val[i]) return i;
-        }
+        uint64_t empty = ~r_val_mask;
+        if (nb_slots < 64) empty &= ((uint64_t)1 << (nb_slots % 64)) - 1;
 
-        return -1;
+        if (empty == 0) return -1;
+        return lowestBit(empty);
     }
 
     ////////////////////////////////////////////////////////////////////////////
@@ -232,15 +360,17 @@ class GenericLLSCGlobalTable
     //  HIT on the address only
     //  This function takes an addr_t ad
     //  It returns :
-    //  - the position of the first HIT in the table
+    //  - the position of the HIT in the table
+    //    (there is at most one valid registration per address)
     //  - -1 in case of MISS
     //  NB : HIT = (slot addr == ad) AND (slot is valid)
     {
-        // checking all slots
-        for (size_t i = 0; i < nb_slots; i++)
+        for (size_t i = hash((uint64_t)ad);
+             m_slot_index[i] >= 0;
+             i = (i + 1) & hash_mask)
         {
             // if HIT, returning its position
-            if(ad == r_addr[i] && r_val[i]) return i;
+            if (r_addr[m_slot_index[i]] == ad) return m_slot_index[i];
         }
 
         // MISS
@@ -252,17 +382,14 @@ class GenericLLSCGlobalTable
     //  HIT on the address AND the on the signature
     //  This function takes an addr_t ad and a uint32_t key
     //  It returns :
-    //  - the position of the first HIT in the table
+    //  - the position of the HIT in the table
     //  - -1 in case of MISS
     //  NB : HIT = (slot addr == ad) AND (slot key == key)
     //                               AND (slot is valid)
     {
-        // checking all slots
-        for (size_t i = 0; i < nb_slots; i++)
-        {
-            // if HIT, returning its position
-            if(ad == r_addr[i] && key == r_key[i] && r_val[i]) return i;
-        }
+        int pos = hitAddr(ad);
+
+        if ((pos >= 0) and (r_key[pos] == key)) return pos;
 
         // MISS
         return -1;
@@ -292,6 +419,7 @@ class GenericLLSCGlobalTable
     :   name(n)
     {
         assert(nb_procs > 1); 
+        assert((nb_slots <= 64) && "nb_slots must be at most 64");
         init();
         init_block_mask();
     }
@@ -309,6 +437,12 @@ class GenericLLSCGlobalTable
         std::memset(r_val,  0, sizeof(*r_val) * nb_slots);
         std::memset(r_addr, 0, sizeof(*r_addr) * nb_slots);
         std::memset(r_key,  0, sizeof(*r_key) * nb_slots);
+        r_val_mask          = 0;
+
+        // making the hash tables empty
+        std::memset(m_slot_index, 0xFF, sizeof(m_slot_index));
+        std::memset(m_block_tag,  0,    sizeof(m_block_tag));
+        std::memset(m_block_map,  0,    sizeof(m_block_map));
 
         // init registers
         r_next_key          = 0;
@@ -381,6 +515,9 @@ class GenericLLSCGlobalTable
 
             // increment the eviction counter (for stats)
             m_cpt_evic++;
+
+            // remove the evicted registration from the index
+            invalSlot(pos);
         }
 
         // get the key for the new registration
@@ -389,6 +526,7 @@ class GenericLLSCGlobalTable
         r_key[pos]      = key   ;
         r_addr[pos]     = ad    ;
         r_val[pos]      = true  ;
+        indexInsert(pos);
         //  compute the next key
         upNextKey();
 
@@ -420,7 +558,7 @@ class GenericLLSCGlobalTable
             // increment the sc success counter (for stats)
             m_cpt_sc_success++;
             // invalidate the registration
-            r_val[pos] = false;
+            invalSlot(pos);
             // return the success of the sc operation
             return true;
         }
@@ -475,16 +613,43 @@ class GenericLLSCGlobalTable
         // NO
         //      nothing
 
-        // for every address in the given range ...
-        for (addr_t i = ad_min; i <= ad_max; i+=4)
-        {
-            //  Is there a registration for the given address ?
-            int pos = hitAddr(i);
+        // the range contains the addresses ad_min + 4*k <= ad_max
+        if (ad_max < ad_min) return;
 
-            //  If there is one, invalidate it
-            if (pos >= 0)
+        uint64_t offset   = (uint64_t)ad_min & 0x3;
+        uint64_t word_min = (uint64_t)ad_min >> 2;
+        uint64_t word_max = ((uint64_t)ad_max - offset) >> 2;
+
+        // for every block of words in the given range ...
+        for (uint64_t block  = word_min >> block_bits;
+                      block <= (word_max >> block_bits);
+                      block++)
+        {
+            //  Are there registrations in this block ?
+            size_t i = hash(block);
+            while ((m_block_map[i] != 0) and (m_block_tag[i] != block))
+                i = (i + 1) & hash_mask;
+
+            uint64_t map = m_block_map[i];
+            if (map == 0) continue;
+
+            //  keep only the words in the range
+            uint64_t first = block << block_bits;
+            uint64_t last  = first + (1 << block_bits) - 1;
+            if (word_min > first)
+                map &= ~(uint64_t)0 << (word_min - first);
+            if (word_max < last)
+                map &= ~(uint64_t)0 >> (last - word_max);
+
+            //  invalidate the registration of every remaining word
+            //  (the block map entry can be modified by invalSlot())
+            while (map != 0)
             {
-                r_val[pos] = false;
+                size_t bit = lowestBit(map);
+                map &= map - 1;
+
+                int pos = hitAddr((addr_t)(((first + bit) << 2) | offset));
+                if (pos >= 0) invalSlot(pos);
             }
         }
     }
@@ -0,0 +1,350 @@
+/* -*- c++ -*-
+ *
+ * SOCLIB_LGPL_HEADER_BEGIN
+ *
+ * This file is part of SoCLib, GNU LGPLv2.1.
+ *
+ * SoCLib is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; version 2.1 of the License.
+ *
+ * SoCLib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with SoCLib; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * SOCLIB_LGPL_HEADER_END
+ */
+
+#ifndef SOCLIB_STATISTICS_REGISTRY_H
+#define SOCLIB_STATISTICS_REGISTRY_H
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace soclib
+{
+
+////////////////////////////////////////////////////////////////////////
+//                    The statistics registry
+// Each component publishes its activity counters in the registry
+// (generally in its constructor), with:
+// - the path of the instance (the component name),
+// - the name of the counter,
+// - the unit of the counter.
+// The registry only keeps a pointer on each counter: the counters are
+// read when a snapshot is dumped, and the registry has no cost between
+// two snapshots.
+// The snapshots are written in a file, in one of the following formats:
+// - FORMAT_CSV    : one "cycle,path,name,unit,value" line per counter,
+// - FORMAT_JSON   : one JSON object per snapshot and per line,
+// - FORMAT_BINARY : a header describing the counters, followed by one
+//                   record per snapshot (see dump()).
+// In MODE_DELTA, the dumped values are the increments since the previous
+// snapshot. In MODE_CUMULATIVE, the dumped values are the counter values.
+////////////////////////////////////////////////////////////////////////
+class StatisticsRegistry
+{
+    public:
+
+    enum format_t
+    {
+        FORMAT_CSV,
+        FORMAT_JSON,
+        FORMAT_BINARY,
+    };
+
+    enum mode_t
+    {
+        MODE_CUMULATIVE,
+        MODE_DELTA,
+    };
+
+    private:
+
+    struct Counter
+    {
+        std::string         path;
+        std::string         name;
+        std::string         unit;
+        const uint32_t *    ptr32;      // 32 bits counter (or NULL)
+        const uint64_t *    ptr64;      // 64 bits counter (or NULL)
+        uint64_t            last;       // value at the previous snapshot
+
+        uint64_t value() const
+        {
+            return ptr64 ? *ptr64 : (uint64_t)*ptr32;
+        }
+    };
+
+    std::vector<Counter>    m_counters;
+    FILE *                  m_file;
+    format_t                m_format;
+    mode_t                  m_mode;
+    size_t                  m_header_size;  // counters described in the binary header
+
+    StatisticsRegistry()
+        : m_file(NULL), m_format(FORMAT_CSV), m_mode(MODE_CUMULATIVE), m_header_size(0)
+    {}
+
+    StatisticsRegistry(const StatisticsRegistry &);
+    StatisticsRegistry & operator=(const StatisticsRegistry &);
+
+    void add(const std::string &path,
+             const std::string &name,
+             const std::string &unit,
+             const uint32_t *   ptr32,
+             const uint64_t *   ptr64)
+    {
+        assert((m_header_size == 0) and
+               "STATISTICS ERROR : counter added after the first binary snapshot");
+
+        Counter c;
+        c.path  = path;
+        c.name  = name;
+        c.unit  = unit;
+        c.ptr32 = ptr32;
+        c.ptr64 = ptr64;
+        c.last  = 0;
+        m_counters.push_back(c);
+    }
+
+    static void write_string(FILE *file, const std::string &s)
+    {
+        fwrite(s.c_str(), 1, s.size() + 1, file);
+    }
+
+    static void write_json_string(FILE *file, const std::string &s)
+    {
+        fputc('"', file);
+        for (size_t i = 0; i < s.size(); i++)
+        {
+            if ((s[i] == '"') or (s[i] == '\\')) fputc('\\', file);
+            fputc(s[i], file);
+        }
+        fputc('"', file);
+    }
+
+    public:
+
+    ~StatisticsRegistry()
+    {
+        close();
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The instance() function returns the registry of the simulation
+    /////////////////////////////////////////////////////////////////////
+    static StatisticsRegistry & instance()
+    {
+        static StatisticsRegistry registry;
+        return registry;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The add() functions publish a counter in the registry.
+    /////////////////////////////////////////////////////////////////////
+    void add(const std::string &path,
+             const std::string &name,
+             const std::string &unit,
+             const uint32_t *   counter)
+    {
+        add(path, name, unit, counter, NULL);
+    }
+
+    void add(const std::string &path,
+             const std::string &name,
+             const std::string &unit,
+             const uint64_t *   counter)
+    {
+        add(path, name, unit, NULL, counter);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The remove() function removes all counters published by a
+    // component (it must be called by the component destructor).
+    /////////////////////////////////////////////////////////////////////
+    void remove(const std::string &path)
+    {
+        std::vector<Counter>::iterator it = m_counters.begin();
+        while (it != m_counters.end())
+        {
+            if (it->path == path) it = m_counters.erase(it);
+            else                  ++it;
+        }
+    }
+
+    size_t size() const
+    {
+        return m_counters.size();
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The open() function selects the snapshot file ("-" for stdout),
+    // format and mode. It returns false if the file cannot be created.
+    /////////////////////////////////////////////////////////////////////
+    bool open(const char *filename, format_t format, mode_t mode)
+    {
+        close();
+
+        if (strcmp(filename, "-") == 0)
+            m_file = stdout;
+        else
+            m_file = fopen(filename, (format == FORMAT_BINARY) ? "wb" : "w");
+
+        m_format      = format;
+        m_mode        = mode;
+        m_header_size = 0;
+        return (m_file != NULL);
+    }
+
+    void close()
+    {
+        if (m_file and (m_file != stdout)) fclose(m_file);
+        m_file = NULL;
+    }
+
+    bool is_open() const
+    {
+        return (m_file != NULL);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The parse_format() and parse_mode() functions decode the
+    // command line values ("csv", "json", "bin" / "delta", "cumulative").
+    /////////////////////////////////////////////////////////////////////
+    static bool parse_format(const char *s, format_t &format)
+    {
+        if      (strcmp(s, "csv")  == 0) format = FORMAT_CSV;
+        else if (strcmp(s, "json") == 0) format = FORMAT_JSON;
+        else if (strcmp(s, "bin")  == 0) format = FORMAT_BINARY;
+        else return false;
+        return true;
+    }
+
+    static bool parse_mode(const char *s, mode_t &mode)
+    {
+        if      (strcmp(s, "delta")      == 0) mode = MODE_DELTA;
+        else if (strcmp(s, "cumulative") == 0) mode = MODE_CUMULATIVE;
+        else return false;
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The rebase() function takes the current counter values as
+    // reference for the next delta snapshot. It must be called when
+    // the components reset their counters.
+    /////////////////////////////////////////////////////////////////////
+    void rebase()
+    {
+        for (size_t i = 0; i < m_counters.size(); i++)
+        {
+            m_counters[i].last = m_counters[i].value();
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The dump() function writes a snapshot of all counters.
+    // Binary format (native byte order) :
+    // - header (before the first snapshot) : "SOCSTATS", uint32 version,
+    //   uint32 mode, uint32 number of counters, and for each counter the
+    //   path, name and unit as null terminated strings,
+    // - snapshot : uint64 cycle, and one uint64 value per counter.
+    /////////////////////////////////////////////////////////////////////
+    void dump(uint64_t cycle)
+    {
+        if (m_file == NULL) return;
+
+        if ((m_format == FORMAT_BINARY) and (m_header_size == 0))
+        {
+            uint32_t header[3] = { 1, (uint32_t)m_mode, (uint32_t)m_counters.size() };
+            fwrite("SOCSTATS", 1, 8, m_file);
+            fwrite(header, sizeof(header), 1, m_file);
+            for (size_t i = 0; i < m_counters.size(); i++)
+            {
+                write_string(m_file, m_counters[i].path);
+                write_string(m_file, m_counters[i].name);
+                write_string(m_file, m_counters[i].unit);
+            }
+            m_header_size = m_counters.size();
+        }
+
+        if (m_format == FORMAT_BINARY)
+        {
+            assert((m_header_size == m_counters.size()) and
+                   "STATISTICS ERROR : counters removed after the first binary snapshot");
+            fwrite(&cycle, sizeof(cycle), 1, m_file);
+        }
+        else if (m_format == FORMAT_JSON)
+        {
+            fprintf(m_file, "{\"cycle\": %llu, \"mode\": \"%s\", \"counters\": [",
+                    (unsigned long long)cycle,
+                    (m_mode == MODE_DELTA) ? "delta" : "cumulative");
+        }
+        else if (m_header_size == 0)
+        {
+            fprintf(m_file, "cycle,path,name,unit,value\n");
+            m_header_size = m_counters.size();
+        }
+
+        for (size_t i = 0; i < m_counters.size(); i++)
+        {
+            Counter & c     = m_counters[i];
+            uint64_t  value = c.value();
+
+            if (m_mode == MODE_DELTA)
+            {
+                uint64_t delta = value - c.last;
+                c.last = value;
+                value  = delta;
+            }
+
+            if (m_format == FORMAT_BINARY)
+            {
+                fwrite(&value, sizeof(value), 1, m_file);
+            }
+            else if (m_format == FORMAT_JSON)
+            {
+                fprintf(m_file, "%s{\"path\": ", (i == 0) ? "" : ", ");
+                write_json_string(m_file, c.path);
+                fprintf(m_file, ", \"name\": ");
+                write_json_string(m_file, c.name);
+                fprintf(m_file, ", \"unit\": ");
+                write_json_string(m_file, c.unit);
+                fprintf(m_file, ", \"value\": %llu}", (unsigned long long)value);
+            }
+            else
+            {
+                fprintf(m_file, "%llu,%s,%s,%s,%llu\n",
+                        (unsigned long long)cycle,
+                        c.path.c_str(), c.name.c_str(), c.unit.c_str(),
+                        (unsigned long long)value);
+            }
+        }
+
+        if (m_format == FORMAT_JSON) fprintf(m_file, "]}\n");
+        fflush(m_file);
+    }
+};
+
+} // end namespace soclib
+
+#endif
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
@@ -0,0 +1,379 @@
+/* -*- c++ -*-
+ *
+ * SOCLIB_LGPL_HEADER_BEGIN
+ *
+ * This file is part of SoCLib, GNU LGPLv2.1.
+ *
+ * SoCLib is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; version 2.1 of the License.
+ *
+ * SoCLib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with SoCLib; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * SOCLIB_LGPL_HEADER_END
+ */
+
+#ifndef SOCLIB_TRACE_SINK_H
+#define SOCLIB_TRACE_SINK_H
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+
+namespace soclib
+{
+
+////////////////////////////////////////////////////////////////////////
+//                    The binary trace sink
+// It replaces the text traces (print_trace() functions) of the
+// components by binary samples, written in a file by a background
+// writer thread:
+// - A component describes its trace once, as a TraceSource object: a
+//   header line (such as "MEMC <name>"), and a list of fields. Each
+//   field is a 32 bits value, printed after a prefix string, either as
+//   a decimal number, or as an entry of a string table (FSM states).
+// - At each traced cycle, the component pushes the field values in the
+//   ring of its source (single producer / single consumer lock-free
+//   ring). The simulation thread only accesses memory, and waits only
+//   if the ring is full.
+// - The writer thread drains the rings in the trace file.
+// The trace file is decoded offline (trace_decode.py script of the
+// tsar_generic_xbar platform), to reproduce the text traces.
+//
+// File format (native byte order):
+// - header : "SOCTRACE", uint32 version,
+// - source record : uint32 TRACE_RECORD_SOURCE, uint32 source id,
+//   header string, uint32 number of fields, and for each field the
+//   prefix string, uint32 table size (0 for a decimal field), and the
+//   table strings (all strings are null terminated),
+// - sample record : uint32 TRACE_RECORD_SAMPLE, uint32 source id,
+//   uint64 sequence number, uint64 cycle, one uint32 value per field.
+// The sequence numbers define the order of the samples (the order of
+// the push() calls), as the samples of different sources are not
+// written in this order.
+////////////////////////////////////////////////////////////////////////
+
+#define TRACE_SINK_RING_SIZE    1024    // samples per source (power of 2)
+#define TRACE_SINK_MAX_FIELDS   32      // max number of fields per source
+#define TRACE_SINK_PERIOD_US    1000    // writer thread polling period
+
+class TraceSink;
+
+class TraceSource
+{
+    friend class TraceSink;
+
+    struct Field
+    {
+        std::string                 prefix;
+        std::vector<std::string>    table;      // empty for a decimal field
+    };
+
+    struct Sample
+    {
+        uint64_t    seq;
+        uint64_t    cycle;
+        uint32_t    values[TRACE_SINK_MAX_FIELDS];
+    };
+
+    std::string             m_header;
+    std::vector<Field>      m_fields;
+    TraceSink *             m_sink;         // NULL before attach()
+    uint32_t                m_id;
+
+    // lock-free ring : head is only written by the producer (push()),
+    // and tail is only written by the consumer (the writer thread).
+    Sample                  m_ring[TRACE_SINK_RING_SIZE];
+    volatile uint32_t       m_head;
+    volatile uint32_t       m_tail;
+
+    TraceSource(const TraceSource &);
+    TraceSource & operator=(const TraceSource &);
+
+    public:
+
+    TraceSource(const std::string &header)
+        : m_header(header), m_sink(NULL), m_id(0), m_head(0), m_tail(0)
+    {}
+
+    /////////////////////////////////////////////////////////////////////
+    // The field() functions add a field to the source description
+    // (before the source is attached to the sink):
+    // - a decimal field,
+    // - a field decoded by a string table.
+    /////////////////////////////////////////////////////////////////////
+    void field(const char *prefix)
+    {
+        assert((m_sink == NULL) and (m_fields.size() < TRACE_SINK_MAX_FIELDS) and
+               "TRACE ERROR : cannot add a field to this source");
+
+        Field f;
+        f.prefix = prefix;
+        m_fields.push_back(f);
+    }
+
+    void field(const char *prefix, const char * const *table, size_t size)
+    {
+        field(prefix);
+        for (size_t i = 0; i < size; i++) m_fields.back().table.push_back(table[i]);
+    }
+
+    template<size_t N>
+    void field(const char *prefix, const char * const (&table)[N])
+    {
+        field(prefix, table, N);
+    }
+
+    size_t fields() const
+    {
+        return m_fields.size();
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The push() function registers a sample (one value per field).
+    // It is defined after the TraceSink class.
+    /////////////////////////////////////////////////////////////////////
+    void push(uint64_t cycle, const uint32_t *values);
+};
+
+class TraceSink
+{
+    std::vector<TraceSource *>  m_sources;
+    FILE *                      m_file;
+    pthread_mutex_t             m_lock;         // file and sources list
+    pthread_t                   m_thread;
+    volatile bool               m_running;
+    volatile bool               m_stop;
+    volatile uint64_t           m_seq;          // next sequence number
+
+    enum
+    {
+        TRACE_RECORD_SOURCE = 1,
+        TRACE_RECORD_SAMPLE = 2,
+    };
+
+    TraceSink()
+        : m_file(NULL), m_running(false), m_stop(false), m_seq(0)
+    {
+        pthread_mutex_init(&m_lock, NULL);
+    }
+
+    TraceSink(const TraceSink &);
+    TraceSink & operator=(const TraceSink &);
+
+    void write_u32(uint32_t v)
+    {
+        fwrite(&v, sizeof(v), 1, m_file);
+    }
+
+    void write_string(const std::string &s)
+    {
+        fwrite(s.c_str(), 1, s.size() + 1, m_file);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The drain() function writes all the samples available in the
+    // rings. It returns the number of written samples.
+    /////////////////////////////////////////////////////////////////////
+    size_t drain()
+    {
+        size_t count = 0;
+
+        pthread_mutex_lock(&m_lock);
+        for (size_t i = 0; i < m_sources.size(); i++)
+        {
+            TraceSource * src = m_sources[i];
+            const uint32_t nfields = src->m_fields.size();
+
+            while (src->m_head != src->m_tail)
+            {
+                __sync_synchronize();
+                const TraceSource::Sample & s =
+                    src->m_ring[src->m_tail % TRACE_SINK_RING_SIZE];
+
+                write_u32(TRACE_RECORD_SAMPLE);
+                write_u32(src->m_id);
+                fwrite(&s.seq, sizeof(s.seq), 1, m_file);
+                fwrite(&s.cycle, sizeof(s.cycle), 1, m_file);
+                fwrite(s.values, sizeof(uint32_t), nfields, m_file);
+
+                __sync_synchronize();
+                src->m_tail = src->m_tail + 1;
+                count++;
+            }
+        }
+        pthread_mutex_unlock(&m_lock);
+        return count;
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            bool stop = m_stop;
+            __sync_synchronize();
+            if (drain() == 0)
+            {
+                if (stop) break;
+                usleep(TRACE_SINK_PERIOD_US);
+            }
+        }
+    }
+
+    static void * thread_entry(void *arg)
+    {
+        ((TraceSink *)arg)->run();
+        return NULL;
+    }
+
+    public:
+
+    ~TraceSink()
+    {
+        close();
+        for (size_t i = 0; i < m_sources.size(); i++) delete m_sources[i];
+        pthread_mutex_destroy(&m_lock);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The instance() function returns the trace sink of the simulation
+    /////////////////////////////////////////////////////////////////////
+    static TraceSink & instance()
+    {
+        static TraceSink sink;
+        return sink;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The open() function creates the trace file and starts the writer
+    // thread. It returns false in case of failure.
+    /////////////////////////////////////////////////////////////////////
+    bool open(const char *filename)
+    {
+        close();
+
+        m_file = fopen(filename, "wb");
+        if (m_file == NULL) return false;
+
+        uint32_t version = 1;
+        fwrite("SOCTRACE", 1, 8, m_file);
+        fwrite(&version, sizeof(version), 1, m_file);
+
+        m_stop = false;
+        if (pthread_create(&m_thread, NULL, thread_entry, this) != 0)
+        {
+            fclose(m_file);
+            m_file = NULL;
+            return false;
+        }
+        m_running = true;
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The close() function writes the pending samples, stops the
+    // writer thread and closes the trace file. The samples pushed
+    // after close() are discarded.
+    /////////////////////////////////////////////////////////////////////
+    void close()
+    {
+        if (not m_running) return;
+
+        m_stop = true;
+        pthread_join(m_thread, NULL);
+        m_running = false;
+
+        fclose(m_file);
+        m_file = NULL;
+    }
+
+    bool is_open() const
+    {
+        return m_running;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The attach() function writes the source description in the trace
+    // file. The sink takes the ownership of the source.
+    /////////////////////////////////////////////////////////////////////
+    void attach(TraceSource *src)
+    {
+        assert((src->m_sink == NULL) and
+               "TRACE ERROR : source already attached");
+
+        pthread_mutex_lock(&m_lock);
+        src->m_id   = m_sources.size();
+        src->m_sink = this;
+
+        if (m_file)
+        {
+            write_u32(TRACE_RECORD_SOURCE);
+            write_u32(src->m_id);
+            write_string(src->m_header);
+            write_u32(src->m_fields.size());
+            for (size_t i = 0; i < src->m_fields.size(); i++)
+            {
+                const TraceSource::Field & f = src->m_fields[i];
+                write_string(f.prefix);
+                write_u32(f.table.size());
+                for (size_t j = 0; j < f.table.size(); j++) write_string(f.table[j]);
+            }
+        }
+        m_sources.push_back(src);
+        pthread_mutex_unlock(&m_lock);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The next_seq() function returns a new sequence number
+    /////////////////////////////////////////////////////////////////////
+    uint64_t next_seq()
+    {
+        return __sync_fetch_and_add(&m_seq, 1);
+    }
+};
+
+inline void TraceSource::push(uint64_t cycle, const uint32_t *values)
+{
+    assert(m_sink and "TRACE ERROR : source not attached");
+
+    if (not m_sink->is_open()) return;
+
+    // wait a free slot
+    while (m_head - m_tail == TRACE_SINK_RING_SIZE) sched_yield();
+    __sync_synchronize();
+
+    Sample & s = m_ring[m_head % TRACE_SINK_RING_SIZE];
+    s.seq   = m_sink->next_seq();
+    s.cycle = cycle;
+    memcpy(s.values, values, m_fields.size() * sizeof(uint32_t));
+
+    __sync_synchronize();
+    m_head = m_head + 1;
+}
+
+} // end namespace soclib
+
+#endif
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
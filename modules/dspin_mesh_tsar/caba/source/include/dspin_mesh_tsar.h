@@ -0,0 +1,202 @@
+/* -*- c++ -*-
+  *
+  * File : dspin_mesh_tsar.h
+  * Copyright (c) UPMC, Lip6
+  *
+  * SOCLIB_LGPL_HEADER_BEGIN
+  *
+  * This file is part of SoCLib, GNU LGPLv2.1.
+  *
+  * SoCLib is free software; you can redistribute it and/or modify it
+  * under the terms of the GNU Lesser General Public License as published
+  * by the Free Software Foundation; version 2.1 of the License.
+  *
+  * SoCLib is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  * Lesser General Public License for more details.
+  *
+  * You should have received a copy of the GNU Lesser General Public
+  * License along with SoCLib; if not, write to the Free Software
+  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  * 02110-1301 USA
+  *
+  * SOCLIB_LGPL_HEADER_END
+  *
+  */
+
+////////////////////////////////////////////////////////////////////////////////
+// This component implements a complete 2D mesh of DSPIN routers, as one
+// single module: it replaces the X_SIZE * Y_SIZE unicast DSPIN routers
+// of one network, and is cycle-accurate with respect to them.
+// - Only the LOCAL ports of the routers are visible, as two arrays of
+//   DSPIN ports indexed by the cluster coordinates (p_local_in[x][y] and
+//   p_local_out[x][y]).
+// - The links between neighbour routers are not SystemC signals: the
+//   NORTH/SOUTH/EAST/WEST inputs of a router are directly computed from
+//   the output FIFO state of the neighbour router. The mesh boundaries
+//   behave as the network boundaries signals of the platforms
+//   (no incoming flit, and outgoing flits always consumed).
+// - The router state is stored in struct-of-arrays form: the FIFOs are
+//   ring buffers of uint64_t flits, and the output ports allocation
+//   state is a bit-vector per router.
+// - The whole mesh is evaluated in one transition() per cycle. A router
+//   that does not contain any flit, and does not receive any flit is
+//   skipped (its state does not change).
+// It replaces the soclib DspinRouter components of the CMD, RSP, P2M and
+// CLACK networks of the tsar_xbar_cluster (used without broadcast).
+// The transition() function follows the DspinRouterTsar component, which
+// is derived from the soclib DspinRouter component with a modified routing
+// function (IOB special cases, not modelled here): X-FIRST routing, and
+// round-robin allocation of the output ports. Broadcast is not supported.
+// The lock-step equivalence with both router components can be checked
+// with the platforms/dspin_mesh_check platform, which also lists the
+// behavioural differences not visible on the LOCAL ports.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DSPIN_MESH_TSAR_H_
+#define DSPIN_MESH_TSAR_H_
+
+#include <systemc>
+#include <stdint.h>
+#include "caba_base_module.h"
+#include "dspin_interface.h"
+#include "alloc_elems.h"
+#include "static_assert.h"
+
+namespace soclib { namespace caba {
+
+using namespace sc_core;
+
+template<int flit_width>
+class DspinMeshTsar
+: public soclib::caba::BaseModule
+{
+	// Port indexing
+	enum
+    {
+		DSPIN_NORTH	= 0,
+		DSPIN_SOUTH	= 1,
+		DSPIN_EAST	= 2,
+		DSPIN_WEST	= 3,
+		DSPIN_LOCAL	= 4,
+	};
+
+    // Input Port FSM
+    enum
+    {
+        INFSM_IDLE,
+        INFSM_REQ,
+        INFSM_ALLOC,
+    };
+
+    // no request / no grant
+    enum
+    {
+        NO_PORT = 0xFF,
+    };
+
+    protected:
+    SC_HAS_PROCESS(DspinMeshTsar);
+
+    public:
+
+	// ports
+	sc_in<bool>                 p_clk;
+	sc_in<bool>                 p_resetn;
+	DspinInput<flit_width>      **p_local_in;     // [x][y]
+	DspinOutput<flit_width>	    **p_local_out;    // [x][y]
+
+	// constructor / destructor
+	DspinMeshTsar(
+                sc_module_name name,
+                const size_t   x_size,         // number of clusters in a row
+                const size_t   y_size,         // number of clusters in a column
+                const size_t   x_width,        // x field width in first flit
+                const size_t   y_width,        // y field width in first flit
+                const size_t   in_fifo_depth,  // input fifo depth
+                const size_t   out_fifo_depth);// output fifo depth
+
+    ~DspinMeshTsar();
+
+    private:
+
+    // structural parameters
+    const size_t                m_x_size;
+    const size_t                m_y_size;
+    const size_t                m_routers;        // x_size * y_size
+	const size_t                m_x_shift;
+	const size_t                m_x_mask;
+	const size_t                m_y_shift;
+	const size_t                m_y_mask;
+    const size_t                m_in_depth;
+    const size_t                m_out_depth;
+
+    // neighbour router for each (router,port) / NO_NEIGHBOUR on the boundaries
+    size_t                      *m_neighbour;     // [router*5 + port]
+
+    // input fifos (ring buffers)
+    uint64_t                    *r_in_data;       // [(router*5 + port)*in_depth + slot]
+    bool                        *r_in_eop;        // [(router*5 + port)*in_depth + slot]
+    uint8_t                     *r_in_ptr;        // [router*5 + port] read pointer
+    uint8_t                     *r_in_count;      // [router*5 + port] filled slots
+
+    // output fifos (ring buffers)
+    uint64_t                    *r_out_data;      // [(router*5 + port)*out_depth + slot]
+    bool                        *r_out_eop;       // [(router*5 + port)*out_depth + slot]
+    uint8_t                     *r_out_ptr;       // [router*5 + port] read pointer
+    uint8_t                     *r_out_count;     // [router*5 + port] filled slots
+
+    // input & output ports state
+    uint8_t                     *r_alloc_out;     // [router] allocated output ports (bit-vector)
+    uint8_t                     *r_index_out;     // [router*5 + port] allocated input port
+    uint8_t                     *r_fsm_in;        // [router*5 + port] input port FSM
+    uint8_t                     *r_index_in;      // [router*5 + port] requested output port
+
+    // fifo commands computed by transition() before the fifos update
+    uint8_t                     *m_in_get;        // [router] bit-vector
+    uint8_t                     *m_in_put;        // [router] bit-vector
+    uint64_t                    *m_in_wdata;      // [router*5 + port]
+    bool                        *m_in_weop;       // [router*5 + port]
+    uint8_t                     *m_out_get;       // [router] bit-vector
+    uint8_t                     *m_out_put;       // [router] bit-vector
+    uint64_t                    *m_out_wdata;     // [router*5 + port]
+    bool                        *m_out_weop;      // [router*5 + port]
+
+    // local ports values sampled at the beginning of transition()
+    bool                        *m_local_write;   // [router]
+    bool                        *m_local_read;    // [router]
+
+    static const size_t         NO_NEIGHBOUR = (size_t)-1;
+
+    soclib_static_assert(flit_width <= 64);
+
+    // methods
+    void    transition();
+    void    genMoore();
+    size_t  route(size_t router, uint64_t data) const;
+    void    router_transition(size_t router);
+
+    static size_t opposite(size_t port)
+    {
+        return port ^ 1;   // NORTH <-> SOUTH / EAST <-> WEST
+    }
+
+    public:
+
+    void    print_trace(size_t x, size_t y);
+    void    print_trace();
+};
+
+}} // end namespace
+
+#endif // DSPIN_MESH_TSAR_H_
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
@@ -0,0 +1,567 @@
+/* -*- c++ -*-
+  *
+  * File : dspin_mesh_tsar.cpp
+  * Copyright (c) UPMC, Lip6
+  *
+  * SOCLIB_LGPL_HEADER_BEGIN
+  *
+  * This file is part of SoCLib, GNU LGPLv2.1.
+  *
+  * SoCLib is free software; you can redistribute it and/or modify it
+  * under the terms of the GNU Lesser General Public License as published
+  * by the Free Software Foundation; version 2.1 of the License.
+  *
+  * SoCLib is distributed in the hope that it will be useful, but
+  * WITHOUT ANY WARRANTY; without even the implied warranty of
+  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  * Lesser General Public License for more details.
+  *
+  * You should have received a copy of the GNU Lesser General Public
+  * License along with SoCLib; if not, write to the Free Software
+  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+  * 02110-1301 USA
+  *
+  * SOCLIB_LGPL_HEADER_END
+  *
+  */
+
+#include <cstring>
+#include <cassert>
+#include "../include/dspin_mesh_tsar.h"
+
+namespace soclib { namespace caba {
+
+using namespace soclib::common;
+using namespace soclib::caba;
+
+#define tmpl(x) template<int flit_width> x DspinMeshTsar<flit_width>
+
+    template<int flit_width> const size_t DspinMeshTsar<flit_width>::NO_NEIGHBOUR;
+
+    ////////////////////////////////////////////////
+    //              constructor
+    ////////////////////////////////////////////////
+    tmpl(/**/)::DspinMeshTsar(
+                sc_module_name name,
+                const size_t   x_size,         // number of clusters in a row
+                const size_t   y_size,         // number of clusters in a column
+                const size_t   x_width,        // x field width in first flit
+                const size_t   y_width,        // y field width in first flit
+                const size_t   in_fifo_depth,  // input fifo depth
+                const size_t   out_fifo_depth) // output fifo depth
+	: soclib::caba::BaseModule(name),
+
+      p_clk( "p_clk" ),
+      p_resetn( "p_resetn" ),
+      p_local_in( alloc_elems<DspinInput<flit_width> >("p_local_in", x_size, y_size) ),
+      p_local_out( alloc_elems<DspinOutput<flit_width> >("p_local_out", x_size, y_size) ),
+
+      m_x_size( x_size ),
+      m_y_size( y_size ),
+      m_routers( x_size * y_size ),
+
+      m_x_shift( flit_width - x_width ),
+      m_x_mask( (0x1 << x_width) - 1 ),
+
+      m_y_shift( flit_width - x_width - y_width ),
+      m_y_mask( (0x1 << y_width) - 1 ),
+
+      m_in_depth( in_fifo_depth ),
+      m_out_depth( out_fifo_depth )
+    {
+        std::cout << "  - Building DspinMeshTsar : " << name << std::endl;
+
+        assert( (in_fifo_depth > 0) and (in_fifo_depth < 256) and
+                (out_fifo_depth > 0) and (out_fifo_depth < 256) and
+                "DSPIN_MESH ERROR : illegal fifo depth" );
+
+        assert( (x_size <= (size_t)(1 << x_width)) and
+                (y_size <= (size_t)(1 << y_width)) and
+                "DSPIN_MESH ERROR : mesh larger than the x/y fields" );
+
+	    SC_METHOD (transition);
+	    dont_initialize();
+	    sensitive << p_clk.pos();
+
+   	    SC_METHOD (genMoore);
+	    dont_initialize();
+	    sensitive  << p_clk.neg();
+
+        const size_t ports = m_routers * 5;
+
+        m_neighbour   = new size_t[ports];
+
+        r_in_data     = new uint64_t[ports * m_in_depth];
+        r_in_eop      = new bool[ports * m_in_depth];
+        r_in_ptr      = new uint8_t[ports];
+        r_in_count    = new uint8_t[ports];
+
+        r_out_data    = new uint64_t[ports * m_out_depth];
+        r_out_eop     = new bool[ports * m_out_depth];
+        r_out_ptr     = new uint8_t[ports];
+        r_out_count   = new uint8_t[ports];
+
+        r_alloc_out   = new uint8_t[m_routers];
+        r_index_out   = new uint8_t[ports];
+        r_fsm_in      = new uint8_t[ports];
+        r_index_in    = new uint8_t[ports];
+
+        m_in_get      = new uint8_t[m_routers];
+        m_in_put      = new uint8_t[m_routers];
+        m_in_wdata    = new uint64_t[ports];
+        m_in_weop     = new bool[ports];
+        m_out_get     = new uint8_t[m_routers];
+        m_out_put     = new uint8_t[m_routers];
+        m_out_wdata   = new uint64_t[ports];
+        m_out_weop    = new bool[ports];
+
+        m_local_write = new bool[m_routers];
+        m_local_read  = new bool[m_routers];
+
+        std::memset(r_in_data,  0, sizeof(uint64_t) * ports * m_in_depth);
+        std::memset(r_in_eop,   0, sizeof(bool) * ports * m_in_depth);
+        std::memset(r_out_data, 0, sizeof(uint64_t) * ports * m_out_depth);
+        std::memset(r_out_eop,  0, sizeof(bool) * ports * m_out_depth);
+
+        // mesh topology : router index is (x * y_size + y)
+        for ( size_t x = 0 ; x < m_x_size ; x++ )
+        {
+            for ( size_t y = 0 ; y < m_y_size ; y++ )
+            {
+                size_t r = x * m_y_size + y;
+
+                m_neighbour[r*5 + DSPIN_NORTH] = (y < m_y_size - 1) ? r + 1 : NO_NEIGHBOUR;
+                m_neighbour[r*5 + DSPIN_SOUTH] = (y > 0) ? r - 1 : NO_NEIGHBOUR;
+                m_neighbour[r*5 + DSPIN_EAST]  = (x < m_x_size - 1) ? r + m_y_size : NO_NEIGHBOUR;
+                m_neighbour[r*5 + DSPIN_WEST]  = (x > 0) ? r - m_y_size : NO_NEIGHBOUR;
+                m_neighbour[r*5 + DSPIN_LOCAL] = NO_NEIGHBOUR;
+            }
+        }
+    } //  end constructor
+
+    ////////////////////////////////////////////////
+    //              destructor
+    ////////////////////////////////////////////////
+    tmpl(/**/)::~DspinMeshTsar()
+    {
+        dealloc_elems<DspinInput<flit_width> >(p_local_in, m_x_size, m_y_size);
+        dealloc_elems<DspinOutput<flit_width> >(p_local_out, m_x_size, m_y_size);
+
+        delete [] m_neighbour;
+        delete [] r_in_data;
+        delete [] r_in_eop;
+        delete [] r_in_ptr;
+        delete [] r_in_count;
+        delete [] r_out_data;
+        delete [] r_out_eop;
+        delete [] r_out_ptr;
+        delete [] r_out_count;
+        delete [] r_alloc_out;
+        delete [] r_index_out;
+        delete [] r_fsm_in;
+        delete [] r_index_in;
+        delete [] m_in_get;
+        delete [] m_in_put;
+        delete [] m_in_wdata;
+        delete [] m_in_weop;
+        delete [] m_out_get;
+        delete [] m_out_put;
+        delete [] m_out_wdata;
+        delete [] m_out_weop;
+        delete [] m_local_write;
+        delete [] m_local_read;
+    }
+
+    /////////////////////////////////////////////////////////
+    tmpl(size_t)::route( size_t router, uint64_t data ) const
+    {
+        size_t xdest  = (size_t)(data >> m_x_shift) & m_x_mask;
+        size_t ydest  = (size_t)(data >> m_y_shift) & m_y_mask;
+        size_t xlocal = router / m_y_size;
+        size_t ylocal = router % m_y_size;
+
+        if      (xdest < xlocal ) return DSPIN_WEST;
+        else if (xdest > xlocal ) return DSPIN_EAST;
+        else if (ydest < ylocal ) return DSPIN_SOUTH;
+        else if (ydest > ylocal ) return DSPIN_NORTH;
+        else                      return DSPIN_LOCAL;
+    } // end route()
+
+    /////////////////////////////////////////
+    tmpl(void)::print_trace(size_t x, size_t y)
+    {
+        const char* port_name[] = {"NORTH","SOUTH","EAST ","WEST ","LOCAL"};
+
+        size_t r = x * m_y_size + y;
+
+        std::cout << "DSPIN_MESH " << name() << "[" << x << "][" << y << "]" << std::hex;
+        for ( size_t out=0 ; out<5 ; out++)  // loop on output ports
+        {
+            if ( r_alloc_out[r] & (1 << out) )
+            {
+                int in = r_index_out[r*5 + out];
+                std::cout << " / " << port_name[in] << " -> " << port_name[out] ;
+            }
+        }
+        std::cout << std::dec << std::endl;
+    }
+
+    /////////////////////////
+    tmpl(void)::print_trace()
+    {
+        for ( size_t x = 0 ; x < m_x_size ; x++ )
+        {
+            for ( size_t y = 0 ; y < m_y_size ; y++ )
+            {
+                if ( r_alloc_out[x * m_y_size + y] ) print_trace(x, y);
+            }
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////
+    // This function computes the next state of one router, and the
+    // commands of its input and output fifos, as the transition()
+    // function of the DspinRouterTsar component (without the IOB
+    // special cases of its routing function), itself derived from the
+    // soclib DspinRouter component. The fifos of all
+    // routers are updated later, as the input ports of this router
+    // depend on the fifos state of the neighbour routers.
+    ///////////////////////////////////////////////////////////////////
+    tmpl(void)::router_transition( size_t r )
+    {
+        const size_t    base = r * 5;
+
+        // input ports : WRITE/DATA/EOP, output ports : READ
+        bool            in_write = false;   // at least one flit received
+        bool            in_put[5];          // input port -> input fifo
+        bool            out_read[5];        // output fifo -> output port
+
+        for ( size_t i = 0 ; i < 5 ; i++ )
+        {
+            size_t n = m_neighbour[base + i];
+
+            if ( i == DSPIN_LOCAL )
+            {
+                in_put[i]   = m_local_write[r];
+                out_read[i] = m_local_read[r];
+                if ( in_put[i] )
+                {
+                    DspinInput<flit_width> & port = p_local_in[r / m_y_size][r % m_y_size];
+                    m_in_wdata[base + i] = (uint64_t)port.data.read();
+                    m_in_weop[base + i]  = port.eop.read();
+                }
+            }
+            else if ( n == NO_NEIGHBOUR )   // mesh boundary
+            {
+                in_put[i]   = false;
+                out_read[i] = true;
+            }
+            else
+            {
+                size_t nf   = n * 5 + opposite(i);
+                in_put[i]   = (r_out_count[nf] != 0);
+                out_read[i] = (r_in_count[nf] < m_in_depth);
+                if ( in_put[i] )
+                {
+                    size_t slot = nf * m_out_depth + r_out_ptr[nf];
+                    m_in_wdata[base + i] = r_out_data[slot];
+                    m_in_weop[base + i]  = r_out_eop[slot];
+                }
+            }
+            in_write = in_write or in_put[i];
+        }
+
+        // Quiescence fast path : when no packet is stored or routed,
+        // and no flit is received, the router state does not change.
+        bool quiescent = (not in_write) and (r_alloc_out[r] == 0);
+        for ( size_t i = 0 ; quiescent and (i < 5) ; i++ )
+        {
+            if ( r_in_count[base + i] or
+                 r_out_count[base + i] or
+                 (r_fsm_in[base + i] != INFSM_IDLE) ) quiescent = false;
+        }
+        if ( quiescent )
+        {
+            m_in_get[r]  = 0;
+            m_in_put[r]  = 0;
+            m_out_get[r] = 0;
+            m_out_put[r] = 0;
+            return;
+        }
+
+        // Long wires connecting input and output ports
+        size_t          req_in[5];          // input ports  -> output ports
+        size_t          get_out[5];         // output ports -> input ports
+        bool            put_in[5];          // input ports  -> output ports
+        uint64_t        data_in[5];         // input ports  -> output ports
+        bool            eop_in[5];          // input ports  -> output ports
+
+        // registers next values
+        uint8_t         alloc_out = r_alloc_out[r];
+        uint8_t         index_out[5];
+        uint8_t         fsm_in[5];
+        uint8_t         index_in[5];
+
+        // loop on the output ports:
+        // compute get_out[j] depending on the output port state
+        // and combining fifo_out[j].wok and r_alloc_out[j]
+        for ( size_t j = 0 ; j < 5 ; j++ )
+        {
+            index_out[j] = r_index_out[base + j];
+
+            if ( (r_alloc_out[r] & (1 << j)) and (r_out_count[base + j] < m_out_depth) )
+            {
+                get_out[j] = r_index_out[base + j];
+            }
+            else
+            {
+                get_out[j] = NO_PORT;
+            }
+        }
+
+        // loop on the input ports :
+        // The port state is defined by r_fsm_in[i], r_index_in[i]
+        // The req_in[i] computation implements the X-FIRST algorithm.
+        // Both put_in[i] and req_in[i] depend on the input port state.
+        for ( size_t i = 0 ; i < 5 ; i++ )
+        {
+            size_t   f    = base + i;
+            size_t   slot = f * m_in_depth + r_in_ptr[f];
+            bool     rok  = (r_in_count[f] != 0);
+
+            fsm_in[i]   = r_fsm_in[f];
+            index_in[i] = r_index_in[f];
+            data_in[i]  = r_in_data[slot];
+            eop_in[i]   = r_in_eop[slot];
+
+            switch ( r_fsm_in[f] )
+            {
+                case INFSM_IDLE:    // no output port allocated
+                {
+                    put_in[i] = false;
+                    if ( rok ) // packet available in input fifo
+                    {
+                        req_in[i]   = route( r, data_in[i] );
+                        index_in[i] = req_in[i];
+                        fsm_in[i]   = INFSM_REQ;
+                    }
+                    else
+                    {
+                        req_in[i] = NO_PORT;  // no request
+                    }
+                    break;
+                }
+                case INFSM_REQ:   // waiting output port allocation
+                {
+                    put_in[i] = rok;
+                    req_in[i] = r_index_in[f];
+                    if ( get_out[r_index_in[f]] == i ) // first flit transfered
+                    {
+                        if ( eop_in[i] ) fsm_in[i] = INFSM_IDLE;
+                        else             fsm_in[i] = INFSM_ALLOC;
+                    }
+                    break;
+                }
+                case INFSM_ALLOC:  // output port allocated
+                {
+                    put_in[i] = rok;
+                    req_in[i] = NO_PORT;                 // no request
+                    if ( eop_in[i] and rok and
+                         (get_out[r_index_in[f]] == i) ) // last flit transfered
+                    {
+                        fsm_in[i] = INFSM_IDLE;
+                    }
+                    break;
+                }
+            } // end switch
+        } // end for input ports
+
+        // loop on the output ports :
+	    // The r_alloc_out[j] and r_index_out[j] computation
+        // implements the round-robin allocation policy.
+	    for ( size_t j = 0 ; j < 5 ; j++ )
+        {
+		    if ( not (r_alloc_out[r] & (1 << j)) )  // not allocated: possible new allocation
+            {
+		        for ( size_t k = r_index_out[base + j] + 1 ;
+                      k < (size_t)(r_index_out[base + j] + 6) ; k++ )
+                {
+			        size_t i = k % 5;
+
+			        if ( req_in[i] == j )
+                    {
+			            alloc_out    = alloc_out | (1 << j);
+			            index_out[j] = i;
+                        break;
+                    }
+		        } // end loop on input ports
+		    }
+            else                                      // allocated: possible desallocation
+            {
+                size_t i = r_index_out[base + j];
+		        if ( eop_in[i] and
+                     (r_out_count[base + j] < m_out_depth) and
+                     put_in[i] )
+                {
+			        alloc_out = alloc_out & ~(1 << j);
+                }
+		    }
+		} // end loop on output ports
+
+        // fifo commands
+        uint8_t in_get     = 0;
+        uint8_t in_put_all = 0;
+        uint8_t out_get    = 0;
+        uint8_t out_put    = 0;
+
+	    for ( size_t i = 0 ; i < 5 ; i++ )
+        {
+            // input fifo : get data (depends on get_out[])
+		    if ( (r_fsm_in[base + i] != INFSM_IDLE) and
+                 (get_out[r_index_in[base + i]] == i) ) in_get = in_get | (1 << i);
+
+            // input fifo : put data (from the input port)
+            if ( in_put[i] ) in_put_all = in_put_all | (1 << i);
+
+            // output fifo : get data (to the output port)
+            if ( out_read[i] ) out_get = out_get | (1 << i);
+
+            // output fifo : put data (output port mux)
+		    if ( r_alloc_out[r] & (1 << i) )
+            {
+                size_t index = r_index_out[base + i];
+                if ( put_in[index] )
+                {
+                    out_put = out_put | (1 << i);
+                    m_out_wdata[base + i] = data_in[index];
+                    m_out_weop[base + i]  = eop_in[index];
+                }
+            }
+        }
+
+        m_in_get[r]  = in_get;
+        m_in_put[r]  = in_put_all;
+        m_out_get[r] = out_get;
+        m_out_put[r] = out_put;
+
+        // registers update
+        r_alloc_out[r] = alloc_out;
+	    for ( size_t i = 0 ; i < 5 ; i++ )
+        {
+            r_index_out[base + i] = index_out[i];
+            r_fsm_in[base + i]    = fsm_in[i];
+            r_index_in[base + i]  = index_in[i];
+        }
+    } // end router_transition()
+
+    ////////////////////////
+    tmpl(void)::transition()
+    {
+	    // Reset
+	    if ( p_resetn == false )
+        {
+            const size_t ports = m_routers * 5;
+
+            std::memset(r_alloc_out, 0, m_routers);
+            std::memset(r_index_out, 0, ports);
+            std::memset(r_index_in,  0, ports);
+            std::memset(r_fsm_in,    INFSM_IDLE, ports);
+            std::memset(r_in_ptr,    0, ports);
+            std::memset(r_in_count,  0, ports);
+            std::memset(r_out_ptr,   0, ports);
+            std::memset(r_out_count, 0, ports);
+            return;
+        }
+
+        // sample the local ports
+        for ( size_t x = 0 ; x < m_x_size ; x++ )
+        {
+            for ( size_t y = 0 ; y < m_y_size ; y++ )
+            {
+                size_t r = x * m_y_size + y;
+                m_local_write[r] = p_local_in[x][y].write.read();
+                m_local_read[r]  = p_local_out[x][y].read.read();
+            }
+        }
+
+        // compute the routers next state and the fifos commands,
+        // without modifying the fifos
+        for ( size_t r = 0 ; r < m_routers ; r++ ) router_transition( r );
+
+	    //  FIFOS update
+        for ( size_t r = 0 ; r < m_routers ; r++ )
+        {
+            if ( not (m_in_get[r] | m_in_put[r] | m_out_get[r] | m_out_put[r]) ) continue;
+
+	        for ( size_t i = 0 ; i < 5 ; i++ )
+            {
+                size_t f = r * 5 + i;
+
+                // input fifo
+                bool get = (m_in_get[r] & (1 << i)) and (r_in_count[f] != 0);
+                bool put = (m_in_put[r] & (1 << i)) and (r_in_count[f] < m_in_depth);
+                if ( put )
+                {
+                    size_t slot = f * m_in_depth + (r_in_ptr[f] + r_in_count[f]) % m_in_depth;
+                    r_in_data[slot] = m_in_wdata[f];
+                    r_in_eop[slot]  = m_in_weop[f];
+                    r_in_count[f]++;
+                }
+                if ( get )
+                {
+                    r_in_ptr[f] = (r_in_ptr[f] + 1) % m_in_depth;
+                    r_in_count[f]--;
+                }
+
+                // output fifo
+                get = (m_out_get[r] & (1 << i)) and (r_out_count[f] != 0);
+                put = (m_out_put[r] & (1 << i)) and (r_out_count[f] < m_out_depth);
+                if ( put )
+                {
+                    size_t slot = f * m_out_depth + (r_out_ptr[f] + r_out_count[f]) % m_out_depth;
+                    r_out_data[slot] = m_out_wdata[f];
+                    r_out_eop[slot]  = m_out_weop[f];
+                    r_out_count[f]++;
+                }
+                if ( get )
+                {
+                    r_out_ptr[f] = (r_out_ptr[f] + 1) % m_out_depth;
+                    r_out_count[f]--;
+                }
+            }
+	    }
+    } // end transition
+
+    ////////////////////////////////
+    //      genMoore
+    ////////////////////////////////
+    tmpl(void)::genMoore()
+    {
+        for ( size_t x = 0 ; x < m_x_size ; x++ )
+        {
+            for ( size_t y = 0 ; y < m_y_size ; y++ )
+            {
+                size_t f    = (x * m_y_size + y) * 5 + DSPIN_LOCAL;
+                size_t slot = f * m_out_depth + r_out_ptr[f];
+
+                // local input port : READ signal
+                p_local_in[x][y].read = (r_in_count[f] < m_in_depth);
+
+                // local output port : DATA & WRITE signals
+                p_local_out[x][y].data  = (sc_uint<flit_width>)r_out_data[slot];
+                p_local_out[x][y].eop   = r_out_eop[slot];
+                p_local_out[x][y].write = (r_out_count[f] != 0);
+            }
+        }
+    } // end genMoore
+
+}} // end namespace
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
@@ -47,6 +47,7 @@
 #include "generic_fifo.h"
 #include "dspin_interface.h"
 #include "alloc_elems.h"
+#include "static_assert.h"
 
 namespace soclib { namespace caba {
 
@@ -100,12 +101,15 @@ class DspinRouterTsar
                 const size_t   l_width);       // local srcid width
     private:
 
-    // define the FIFO flit
+    // define the FIFO flit : the flit is stored as a native 64 bits
+    // integer, and converted from/to sc_uint only on the DSPIN ports
     typedef struct internal_flit_s 
     {
-        sc_uint<flit_width>  data;
+        uint64_t             data;
         bool                 eop;
     } internal_flit_t;
+
+    soclib_static_assert(flit_width <= 64);
     
     // registers
 	sc_signal<bool>				*r_alloc_out;
@@ -136,7 +140,7 @@ class DspinRouterTsar
     // methods 
     void    transition();
     void    genMoore();
-    size_t  route( sc_uint<flit_width> data );
+    size_t  route( uint64_t data );
 
     public:
 
@@ -126,7 +126,7 @@ using namespace soclib::caba;
     } //  end constructor
 
     //////////////////////////////////////////////////
-    tmpl(size_t)::route( sc_uint<flit_width> data )
+    tmpl(size_t)::route( uint64_t data )
     {
         size_t xdest = (size_t)(data >> m_x_shift) & m_x_mask;
         size_t ydest = (size_t)(data >> m_y_shift) & m_y_mask;
@@ -195,6 +195,23 @@ using namespace soclib::caba;
             return;
         }
 
+        // Quiescence fast path : when no packet is stored or routed,
+        // and no flit is received, the router state does not change.
+        bool quiescent = true;
+        for(size_t i = 0 ; i < 5 ; i++) 
+        {
+            if ( p_in[i].write.read() or 
+                 r_fifo_in[i].rok() or 
+                 r_fifo_out[i].rok() or
+                 r_alloc_out[i].read() or 
+                 (r_fsm_in[i].read() != INFSM_IDLE) )
+            {
+                quiescent = false;
+                break;
+            }
+        }
+        if ( quiescent ) return;
+
 	    // fifos signals default values
 	    for(size_t i = 0 ; i < 5 ; i++) 
         {
@@ -355,7 +372,7 @@ using namespace soclib::caba;
 	        p_in[i].read = r_fifo_in[i].wok();
       
             // output ports : DATA & WRITE signals
-	        p_out[i].data  = r_fifo_out[i].read().data; 
+	        p_out[i].data  = (sc_uint<flit_width>)r_fifo_out[i].read().data; 
 	        p_out[i].eop   = r_fifo_out[i].read().eop; 
 	        p_out[i].write = r_fifo_out[i].rok();
         }
@@ -0,0 +1,408 @@
+/* -*- c++ -*-
+ *
+ * SOCLIB_LGPL_HEADER_BEGIN
+ *
+ * This file is part of SoCLib, GNU LGPLv2.1.
+ *
+ * SoCLib is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; version 2.1 of the License.
+ *
+ * SoCLib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with SoCLib; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * SOCLIB_LGPL_HEADER_END
+ */
+
+#ifndef SOCLIB_CABA_BLOCK_DEVICE_BACKEND_H
+#define SOCLIB_CABA_BLOCK_DEVICE_BACKEND_H
+
+#include <inttypes.h>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+namespace soclib { namespace caba {
+
+////////////////////////////////////////////////////////////////////////
+//                    The block device backends
+// This object performs the host accesses to the disk image of a block
+// device, one block at a time. It does not model any timing: the
+// simulated latency is defined by the block device.
+// The following backends are supported:
+// - BACKEND_FILE     : blocking pread() / pwrite() on the image file.
+// - BACKEND_MMAP     : the image is mapped (shared mapping), and the
+//                      accesses are memory copies. The writes are
+//                      written back in the image file.
+// - BACKEND_PREFETCH : same as BACKEND_FILE, but a helper thread reads
+//                      the next blocks (prefetch depth) after each read
+//                      in a small block cache. The writes are written
+//                      through, and update the cached copies.
+// - BACKEND_COW      : the image is opened read-only, and mapped
+//                      copy-on-write: the written blocks are kept in
+//                      private memory, and are lost at the end of the
+//                      simulation. Several simulations can share the
+//                      same base image.
+// With the mapped backends, the accesses beyond the end of the image
+// fail (the image cannot be extended).
+////////////////////////////////////////////////////////////////////////
+class BlockDeviceBackend {
+
+    public:
+
+        enum backend_t
+        {
+            BACKEND_FILE,
+            BACKEND_MMAP,
+            BACKEND_PREFETCH,
+            BACKEND_COW,
+        };
+
+    private:
+
+        // prefetch cache slot states
+        enum
+        {
+            SLOT_EMPTY,
+            SLOT_PENDING,   // waiting for the helper thread
+            SLOT_LOADING,   // being read by the helper thread
+            SLOT_VALID,
+        };
+
+        struct Slot
+        {
+            int         state;
+            uint64_t    lba;
+            bool        stale;      // written while loading
+            uint8_t *   data;
+        };
+
+        const backend_t     m_backend;
+        const size_t        m_block_size;   // bytes
+        int                 m_fd;
+        uint64_t            m_file_size;    // bytes
+        uint8_t *           m_image;        // mapped image (NULL if not mapped)
+
+        // prefetch cache (BACKEND_PREFETCH only)
+        std::vector<Slot>   m_slots;
+        size_t              m_depth;        // number of blocks read ahead
+        pthread_mutex_t     m_lock;
+        pthread_cond_t      m_cond;         // slot state changes
+        pthread_t           m_thread;
+        bool                m_stop;
+
+        BlockDeviceBackend(const BlockDeviceBackend &);
+        BlockDeviceBackend & operator=(const BlockDeviceBackend &);
+
+        static void * thread_entry(void *arg)
+        {
+            ((BlockDeviceBackend *)arg)->run();
+            return NULL;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The run() function is the loop of the helper thread : it reads
+        // the pending slots, and stops when m_stop is set.
+        /////////////////////////////////////////////////////////////////////
+        void run()
+        {
+            uint8_t * buffer = new uint8_t[m_block_size];
+
+            pthread_mutex_lock(&m_lock);
+            while (true)
+            {
+                Slot * slot = NULL;
+                for (size_t i = 0; (i < m_slots.size()) and (slot == NULL); i++)
+                {
+                    if (m_slots[i].state == SLOT_PENDING) slot = &m_slots[i];
+                }
+
+                if (slot == NULL)
+                {
+                    if (m_stop) break;
+                    pthread_cond_wait(&m_cond, &m_lock);
+                    continue;
+                }
+
+                uint64_t lba = slot->lba;
+                slot->state = SLOT_LOADING;
+                slot->stale = false;
+                pthread_mutex_unlock(&m_lock);
+
+                ssize_t nbytes = pread(m_fd, buffer, m_block_size, lba * m_block_size);
+
+                pthread_mutex_lock(&m_lock);
+                if ((nbytes == (ssize_t)m_block_size) and not slot->stale)
+                {
+                    memcpy(slot->data, buffer, m_block_size);
+                    slot->state = SLOT_VALID;
+                }
+                else
+                {
+                    slot->state = SLOT_EMPTY;
+                }
+                pthread_cond_broadcast(&m_cond);
+            }
+            pthread_mutex_unlock(&m_lock);
+
+            delete [] buffer;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The find_slot() function returns the slot containing (or loading)
+        // a block, or NULL. The lock must be taken.
+        /////////////////////////////////////////////////////////////////////
+        Slot * find_slot(uint64_t lba)
+        {
+            for (size_t i = 0; i < m_slots.size(); i++)
+            {
+                if ((m_slots[i].state != SLOT_EMPTY) and (m_slots[i].lba == lba))
+                    return &m_slots[i];
+            }
+            return NULL;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The prefetch() function requests the blocks [lba, lba + m_depth[
+        // that are not in the cache, in the slots containing blocks out of
+        // this window (and not being loaded). The lock must be taken.
+        /////////////////////////////////////////////////////////////////////
+        void prefetch(uint64_t lba)
+        {
+            size_t victim = 0;
+            for (uint64_t b = lba; b < lba + m_depth; b++)
+            {
+                if ((b + 1) * m_block_size > m_file_size) break;
+                if (find_slot(b)) continue;
+
+                while ((victim < m_slots.size()) and
+                       ((m_slots[victim].state == SLOT_LOADING) or
+                        ((m_slots[victim].state != SLOT_EMPTY) and
+                         (m_slots[victim].lba >= lba) and
+                         (m_slots[victim].lba < lba + m_depth)))) victim++;
+
+                if (victim == m_slots.size()) break;
+
+                m_slots[victim].state = SLOT_PENDING;
+                m_slots[victim].lba   = b;
+                victim++;
+            }
+            pthread_cond_broadcast(&m_cond);
+        }
+
+        void map_image(bool shared)
+        {
+            void * image = mmap(NULL, m_file_size,
+                                PROT_READ | PROT_WRITE,
+                                shared ? MAP_SHARED : MAP_PRIVATE,
+                                m_fd, 0);
+            if (image == MAP_FAILED)
+            {
+                perror("BLOCK DEVICE BACKEND ERROR : cannot map disk image");
+                exit(EXIT_FAILURE);
+            }
+            m_image = (uint8_t *)image;
+        }
+
+    public:
+
+        ////////////////////////
+        // Constructor
+        ////////////////////////
+        BlockDeviceBackend(const std::string &filename,
+                           size_t            block_size,
+                           backend_t         backend = BACKEND_FILE,
+                           size_t            depth   = 8)
+            : m_backend(backend), m_block_size(block_size),
+              m_image(NULL), m_depth(depth), m_stop(false)
+        {
+            m_fd = open(filename.c_str(), (backend == BACKEND_COW) ? O_RDONLY : O_RDWR);
+
+            struct stat st;
+            if ((m_fd < 0) or (fstat(m_fd, &st) < 0))
+            {
+                perror("BLOCK DEVICE BACKEND ERROR : cannot open disk image");
+                exit(EXIT_FAILURE);
+            }
+            m_file_size = st.st_size;
+
+            if ((backend == BACKEND_MMAP) or (backend == BACKEND_COW))
+            {
+                if (m_file_size == 0)
+                {
+                    fprintf(stderr, "BLOCK DEVICE BACKEND ERROR : empty disk image\n");
+                    exit(EXIT_FAILURE);
+                }
+                map_image(backend == BACKEND_MMAP);
+            }
+            else if (backend == BACKEND_PREFETCH)
+            {
+                assert((depth > 0) and
+                       "BLOCK DEVICE BACKEND ERROR : prefetch depth must be non zero");
+
+                // the cache contains the window of the next read
+                m_slots.resize(2 * depth);
+                for (size_t i = 0; i < m_slots.size(); i++)
+                {
+                    m_slots[i].state = SLOT_EMPTY;
+                    m_slots[i].lba   = 0;
+                    m_slots[i].stale = false;
+                    m_slots[i].data  = new uint8_t[block_size];
+                }
+
+                pthread_mutex_init(&m_lock, NULL);
+                pthread_cond_init(&m_cond, NULL);
+                if (pthread_create(&m_thread, NULL, thread_entry, this) != 0)
+                {
+                    perror("BLOCK DEVICE BACKEND ERROR : cannot create prefetch thread");
+                    exit(EXIT_FAILURE);
+                }
+            }
+        } // end constructor
+
+        /////////////////
+        // Destructor
+        /////////////////
+        ~BlockDeviceBackend()
+        {
+            if (m_backend == BACKEND_PREFETCH)
+            {
+                pthread_mutex_lock(&m_lock);
+                m_stop = true;
+                pthread_cond_broadcast(&m_cond);
+                pthread_mutex_unlock(&m_lock);
+                pthread_join(m_thread, NULL);
+
+                for (size_t i = 0; i < m_slots.size(); i++) delete [] m_slots[i].data;
+                pthread_cond_destroy(&m_cond);
+                pthread_mutex_destroy(&m_lock);
+            }
+            if (m_image) munmap(m_image, m_file_size);
+            close(m_fd);
+        }
+
+        backend_t backend() const
+        {
+            return m_backend;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The blocks() function returns the number of blocks of the image.
+        /////////////////////////////////////////////////////////////////////
+        uint64_t blocks() const
+        {
+            return m_file_size / m_block_size;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The read() and write() functions transfer one block between the
+        // image and a buffer. They return false in case of failure.
+        /////////////////////////////////////////////////////////////////////
+        bool read(uint64_t lba, void *buffer)
+        {
+            const uint64_t offset = lba * m_block_size;
+
+            if (m_image)
+            {
+                if (offset + m_block_size > m_file_size) return false;
+                memcpy(buffer, m_image + offset, m_block_size);
+                return true;
+            }
+
+            if (m_backend == BACKEND_PREFETCH)
+            {
+                pthread_mutex_lock(&m_lock);
+                Slot * slot = find_slot(lba);
+                if (slot and (slot->state == SLOT_PENDING))
+                {
+                    slot->state = SLOT_EMPTY;   // faster to read it here
+                    slot = NULL;
+                }
+                while (slot and (slot->state == SLOT_LOADING))
+                {
+                    pthread_cond_wait(&m_cond, &m_lock);
+                    slot = find_slot(lba);
+                }
+                bool hit = (slot != NULL) and (slot->state == SLOT_VALID);
+                if (hit) memcpy(buffer, slot->data, m_block_size);
+                prefetch(lba + 1);
+                pthread_mutex_unlock(&m_lock);
+
+                if (hit) return true;
+            }
+
+            return pread(m_fd, buffer, m_block_size, offset) >= 0;
+        }
+
+        bool write(uint64_t lba, const void *buffer)
+        {
+            const uint64_t offset = lba * m_block_size;
+
+            if (m_image)
+            {
+                if (offset + m_block_size > m_file_size) return false;
+                memcpy(m_image + offset, buffer, m_block_size);
+                return true;
+            }
+
+            if (pwrite(m_fd, buffer, m_block_size, offset) < 0) return false;
+
+            if (offset + m_block_size > m_file_size) m_file_size = offset + m_block_size;
+
+            if (m_backend == BACKEND_PREFETCH)
+            {
+                pthread_mutex_lock(&m_lock);
+                Slot * slot = find_slot(lba);
+                if (slot)
+                {
+                    if      (slot->state == SLOT_VALID)   memcpy(slot->data, buffer, m_block_size);
+                    else if (slot->state == SLOT_LOADING) slot->stale = true;
+                }
+                pthread_mutex_unlock(&m_lock);
+            }
+            return true;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The parse() function decodes the command line values
+        // ("file", "mmap", "prefetch", "cow").
+        /////////////////////////////////////////////////////////////////////
+        static bool parse(const char *s, backend_t &backend)
+        {
+            if      (strcmp(s, "file")     == 0) backend = BACKEND_FILE;
+            else if (strcmp(s, "mmap")     == 0) backend = BACKEND_MMAP;
+            else if (strcmp(s, "prefetch") == 0) backend = BACKEND_PREFETCH;
+            else if (strcmp(s, "cow")      == 0) backend = BACKEND_COW;
+            else return false;
+            return true;
+        }
+
+}; // end class BlockDeviceBackend
+
+}} // end namespaces
+
+#endif
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
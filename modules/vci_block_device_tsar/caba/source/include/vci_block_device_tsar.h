@@ -75,6 +75,14 @@
 // the initiator FSM state to IDLE, and acknowledge the IRQ.
 // Any write access to registers BUFFER, COUNT, LBA, OP is ignored
 // if the device is not IDLE.
+//
+// The host accesses to the disk image are performed by a backend
+// (see block_device_backend.h), selected by the set_backend() function:
+// blocking file accesses (default), mapped image, asynchronous prefetch
+// of the next blocks, or copy-on-write mapping of a read-only image.
+// A read-only image is an error, unless the copy-on-write backend is
+// explicitly selected.
+// The backend does not change the simulated latency.
 ///////////////////////////////////////////////////////////////////////////
 
 #ifndef SOCLIB_VCI_BLOCK_DEVICE_TSAR_H
@@ -87,6 +95,7 @@
 #include "mapping_table.h"
 #include "vci_initiator.h"
 #include "vci_target.h"
+#include "block_device_backend.h"
 
 namespace soclib {
 namespace caba {
@@ -126,8 +135,10 @@ private:
     // structural parameters
     std::list<soclib::common::Segment> m_seglist;
     uint32_t                           m_srcid;        	   // initiator index
-    int                                m_fd;           	   // File descriptor
+    const std::string                  m_filename;         // disk image pathname
+    BlockDeviceBackend *               m_backend;          // disk image accesses
     uint64_t                           m_device_size;  	   // Total number of blocks
+    const uint32_t                     m_block_size;       // number of bytes in a block
     const uint32_t                     m_words_per_block;  // number of words in a block
     const uint32_t                     m_words_per_burst;  // number of words in a burst
     const uint32_t                     m_bursts_per_block; // number of bursts in a block
@@ -221,6 +232,9 @@ public:
 
     void print_trace();
 
+    // The backend must be selected before the simulation starts
+    void set_backend(BlockDeviceBackend::backend_t backend, size_t prefetch_depth = 8);
+
     // Constructor   
     VciBlockDeviceTsar(
 		sc_module_name                      name,
@@ -44,6 +44,15 @@ tmpl(void)::transition()
 {
     if(p_resetn.read() == false)
     {
+        if ( m_backend == NULL )
+        {
+            std::cout << "Error in component VciBlockDeviceTsar : " << name()
+                      << " Unable to open file " << m_filename
+                      << " for writing (read-only images require the cow backend)"
+                      << std::endl;
+            exit(1);
+        }
+
         r_initiator_fsm   = M_IDLE;
         r_target_fsm      = T_IDLE;
         r_irq_enable      = true;
@@ -281,8 +290,7 @@ std::cout << "  <BDEV_TGT WRITE_IRQEN> value = " << r_tdata.read() << std::endl;
         if ( r_latency_count.read() == 0 )
         {
             r_latency_count = m_latency;
-            ::lseek(m_fd, (r_lba + r_block_count)*m_words_per_block*4, SEEK_SET);
-            if( ::read(m_fd, r_local_buffer, m_words_per_block*4) < 0 )
+            if( not m_backend->read(r_lba.read() + r_block_count.read(), r_local_buffer) )
             {
                 r_initiator_fsm = M_READ_ERROR;
             }
@@ -526,8 +534,7 @@ std::cout << "**********************************************************"
 */
 
             r_latency_count = m_latency;
-            ::lseek(m_fd, (r_lba + r_block_count)*m_words_per_block*4, SEEK_SET);
-            if( ::write(m_fd, r_local_buffer, m_words_per_block*4) < 0 )
+            if( not m_backend->write(r_lba.read() + r_block_count.read(), r_local_buffer) )
             {
                 r_initiator_fsm = M_WRITE_ERROR;
             }
@@ -733,6 +740,9 @@ tmpl(/**/)::VciBlockDeviceTsar( sc_core::sc_module_name              name,
 : caba::BaseModule(name),
     m_seglist(mt.getSegmentList(tgtid)),
     m_srcid(mt.indexForId(srcid)),
+    m_filename(filename),
+    m_backend(NULL),
+    m_block_size(block_size),
     m_words_per_block(block_size/4),
     m_words_per_burst(burst_size/4),
     m_bursts_per_block(block_size/burst_size),
@@ -815,21 +825,20 @@ tmpl(/**/)::VciBlockDeviceTsar( sc_core::sc_module_name              name,
         exit(1);
     }
 
-    m_fd = ::open(filename.c_str(), O_RDWR);
-    if ( m_fd < 0 )
+    if ( access(filename.c_str(), R_OK) != 0 )
     {
         std::cout << "Error in component VciBlockDeviceTsar : " << name
                   << " Unable to open file " << filename << std::endl;
         exit(1);
     }
-    m_device_size = lseek(m_fd, 0, SEEK_END) / block_size;
 
-    if ( m_device_size > ((uint64_t)1<<vci_param::N ) )
+    // a read-only image is an error, unless the copy-on-write backend
+    // (the writes are not saved) is explicitly selected by set_backend()
+    // before the simulation starts (checked at reset)
+    m_device_size = 0;
+    if ( access(filename.c_str(), W_OK) == 0 )
     {
-        std::cout << "Error in component VciBlockDeviceTsar" << name
-                  << " The file " << filename
-                  << " has more blocks than addressable with the VCI address" << std::endl;
-        exit(1);
+        set_backend(BlockDeviceBackend::BACKEND_FILE);
     }
 
     r_local_buffer = new uint32_t[m_words_per_block];
@@ -839,10 +848,26 @@ tmpl(/**/)::VciBlockDeviceTsar( sc_core::sc_module_name              name,
 /////////////////////////////////
 tmpl(/**/)::~VciBlockDeviceTsar()
 {
-    ::close(m_fd);
+    delete m_backend;
     delete [] r_local_buffer;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+tmpl(void)::set_backend(BlockDeviceBackend::backend_t backend, size_t prefetch_depth)
+{
+    delete m_backend;
+    m_backend = new BlockDeviceBackend(m_filename, m_block_size, backend, prefetch_depth);
+    m_device_size = m_backend->blocks();
+
+    if ( m_device_size > ((uint64_t)1<<vci_param::N ) )
+    {
+        std::cout << "Error in component VciBlockDeviceTsar" << name()
+                  << " The file " << m_filename
+                  << " has more blocks than addressable with the VCI address" << std::endl;
+        exit(1);
+    }
+}
+
 
 //////////////////////////
 tmpl(void)::print_trace()
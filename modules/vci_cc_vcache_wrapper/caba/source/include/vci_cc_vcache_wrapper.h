@@ -45,6 +45,9 @@
 #include "mapping_table.h"
 #include "static_assert.h"
 #include "iss2.h"
+#include "statistics_registry.h"
+#include "counter_block.h"
+#include "trace_sink.h"
 
 #define LLSC_TIMEOUT    10000
 
@@ -321,6 +324,7 @@ private:
     const size_t  						m_paddr_nbits;
     uint32_t                            m_debug_start_cycle;
     bool                                m_debug_ok;
+    soclib::TraceSource *               m_trace_source;     // binary trace (see binary_trace())
 
     uint32_t                            m_dcache_paddr_ext_reset;
     uint32_t                            m_icache_paddr_ext_reset;
@@ -336,6 +340,13 @@ private:
     /////////////////////////////////////////////
     // debug variables 
     /////////////////////////////////////////////
+    // last instruction line found in icache (see ICACHE_IDLE state)
+    bool                                m_ifetch_valid;
+    paddr_t                             m_ifetch_pline;    // line physical address
+    size_t                              m_ifetch_way;
+    size_t                              m_ifetch_set;
+    bool                                m_ifetch_cacheable; // segment table (ITLB not activated)
+
     bool                                m_debug_previous_i_hit;
     bool                                m_debug_previous_d_hit;
     bool                                m_debug_icache_fsm;
@@ -594,121 +605,128 @@ private:
     ////////////////////////////////
     // Activity counters
     ////////////////////////////////
-    uint32_t m_cpt_dcache_data_read;        // DCACHE DATA READ
-    uint32_t m_cpt_dcache_data_write;       // DCACHE DATA WRITE
-    uint32_t m_cpt_dcache_dir_read;         // DCACHE DIR READ
-    uint32_t m_cpt_dcache_dir_write;        // DCACHE DIR WRITE
-
-    uint32_t m_cpt_icache_data_read;        // ICACHE DATA READ
-    uint32_t m_cpt_icache_data_write;       // ICACHE DATA WRITE
-    uint32_t m_cpt_icache_dir_read;         // ICACHE DIR READ
-    uint32_t m_cpt_icache_dir_write;        // ICACHE DIR WRITE
-
-    uint32_t m_cpt_frz_cycles;	            // number of cycles where the cpu is frozen
-    uint32_t m_cpt_total_cycles;	        // total number of cycles
-
-    // Cache activity counters
-    uint32_t m_cpt_data_read;               // total number of read data
-    uint32_t m_cpt_data_write;              // total number of write data
-    uint32_t m_cpt_data_miss;               // number of read miss
-    uint32_t m_cpt_ins_miss;                // number of instruction miss
-    uint32_t m_cpt_unc_read;                // number of read uncached
-    uint32_t m_cpt_write_cached;            // number of cached write
-    uint32_t m_cpt_ins_read;                // number of instruction read
-    uint32_t m_cpt_ins_spc_miss;            // number of speculative instruction miss
-
-    uint32_t m_cost_write_frz;              // number of frozen cycles related to write buffer
-    uint32_t m_cost_data_miss_frz;          // number of frozen cycles related to data miss
-    uint32_t m_cost_unc_read_frz;           // number of frozen cycles related to uncached read
-    uint32_t m_cost_ins_miss_frz;           // number of frozen cycles related to ins miss
-
-    uint32_t m_cpt_imiss_transaction;       // number of VCI instruction miss transactions
-    uint32_t m_cpt_dmiss_transaction;       // number of VCI data miss transactions
-    uint32_t m_cpt_unc_transaction;         // number of VCI uncached read transactions
-    uint32_t m_cpt_write_transaction;       // number of VCI write transactions
-    uint32_t m_cpt_icache_unc_transaction;
-
-    uint32_t m_cost_imiss_transaction;      // cumulated duration for VCI IMISS transactions
-    uint32_t m_cost_dmiss_transaction;      // cumulated duration for VCI DMISS transactions
-    uint32_t m_cost_unc_transaction;        // cumulated duration for VCI UNC transactions
-    uint32_t m_cost_write_transaction;      // cumulated duration for VCI WRITE transactions
-    uint32_t m_cost_icache_unc_transaction; // cumulated duration for VCI IUNC transactions
-    uint32_t m_length_write_transaction;    // cumulated length for VCI WRITE transactions
-
-    // TLB activity counters
-    uint32_t m_cpt_ins_tlb_read;            // number of instruction tlb read
-    uint32_t m_cpt_ins_tlb_miss;            // number of instruction tlb miss
-    uint32_t m_cpt_ins_tlb_update_acc;      // number of instruction tlb update
-    uint32_t m_cpt_ins_tlb_occup_cache;     // number of instruction tlb occupy data cache line
-    uint32_t m_cpt_ins_tlb_hit_dcache;      // number of instruction tlb hit in data cache
-
-    uint32_t m_cpt_data_tlb_read;           // number of data tlb read
-    uint32_t m_cpt_data_tlb_miss;           // number of data tlb miss
-    uint32_t m_cpt_data_tlb_update_acc;     // number of data tlb update
-    uint32_t m_cpt_data_tlb_update_dirty;   // number of data tlb update dirty
-    uint32_t m_cpt_data_tlb_hit_dcache;     // number of data tlb hit in data cache
-    uint32_t m_cpt_data_tlb_occup_cache;    // number of data tlb occupy data cache line
-    uint32_t m_cpt_tlb_occup_dcache;
-
-    uint32_t m_cost_ins_tlb_miss_frz;       // number of frozen cycles related to instruction tlb miss
-    uint32_t m_cost_data_tlb_miss_frz;      // number of frozen cycles related to data tlb miss
-    uint32_t m_cost_ins_tlb_update_acc_frz;    // number of frozen cycles related to instruction tlb update acc
-    uint32_t m_cost_data_tlb_update_acc_frz;   // number of frozen cycles related to data tlb update acc
-    uint32_t m_cost_data_tlb_update_dirty_frz; // number of frozen cycles related to data tlb update dirty
-    uint32_t m_cost_ins_tlb_occup_cache_frz;   // number of frozen cycles related to instruction tlb miss operate in dcache
-    uint32_t m_cost_data_tlb_occup_cache_frz;  // number of frozen cycles related to data tlb miss operate in dcache
-
-    uint32_t m_cpt_itlbmiss_transaction;       // number of itlb miss transactions
-    uint32_t m_cpt_itlb_ll_transaction;        // number of itlb ll acc transactions
-    uint32_t m_cpt_itlb_sc_transaction;        // number of itlb sc acc transactions
-    uint32_t m_cpt_dtlbmiss_transaction;       // number of dtlb miss transactions
-    uint32_t m_cpt_dtlb_ll_transaction;        // number of dtlb ll acc transactions
-    uint32_t m_cpt_dtlb_sc_transaction;        // number of dtlb sc acc transactions
-    uint32_t m_cpt_dtlb_ll_dirty_transaction;  // number of dtlb ll dirty transactions
-    uint32_t m_cpt_dtlb_sc_dirty_transaction;  // number of dtlb sc dirty transactions
-
-    uint32_t m_cost_itlbmiss_transaction;       // cumulated duration for VCI instruction TLB miss transactions
-    uint32_t m_cost_itlb_ll_transaction;        // cumulated duration for VCI instruction TLB ll acc transactions
-    uint32_t m_cost_itlb_sc_transaction;        // cumulated duration for VCI instruction TLB sc acc transactions
-    uint32_t m_cost_dtlbmiss_transaction;       // cumulated duration for VCI data TLB miss transactions
-    uint32_t m_cost_dtlb_ll_transaction;        // cumulated duration for VCI data TLB ll acc transactions
-    uint32_t m_cost_dtlb_sc_transaction;        // cumulated duration for VCI data TLB sc acc transactions
-    uint32_t m_cost_dtlb_ll_dirty_transaction;  // cumulated duration for VCI data TLB ll dirty transactions
-    uint32_t m_cost_dtlb_sc_dirty_transaction;  // cumulated duration for VCI data TLB sc dirty transactions
-
-    // coherence activity counters
-    uint32_t m_cpt_cc_update_icache;            // number of coherence update instruction commands
-    uint32_t m_cpt_cc_update_dcache;            // number of coherence update data commands
-    uint32_t m_cpt_cc_inval_icache;             // number of coherence inval instruction commands
-    uint32_t m_cpt_cc_inval_dcache;             // number of coherence inval data commands
-    uint32_t m_cpt_cc_broadcast;                // number of coherence broadcast commands
-
-    uint32_t m_cost_updt_data_frz;              // number of frozen cycles related to coherence update data packets
-    uint32_t m_cost_inval_ins_frz;              // number of frozen cycles related to coherence inval instruction packets
-    uint32_t m_cost_inval_data_frz;             // number of frozen cycles related to coherence inval data packets
-    uint32_t m_cost_broadcast_frz;              // number of frozen cycles related to coherence broadcast packets
-
-    uint32_t m_cpt_cc_cleanup_ins;              // number of coherence cleanup packets
-    uint32_t m_cpt_cc_cleanup_data;             // number of coherence cleanup packets
-
-    uint32_t m_cpt_icleanup_transaction;        // number of instruction cleanup transactions
-    uint32_t m_cpt_dcleanup_transaction;        // number of instructinumber of data cleanup transactions
-    uint32_t m_cost_icleanup_transaction;       // cumulated duration for VCI instruction cleanup transactions
-    uint32_t m_cost_dcleanup_transaction;       // cumulated duration for VCI data cleanup transactions
-
-    uint32_t m_cost_ins_tlb_inval_frz;      // number of frozen cycles related to checking ins tlb invalidate
-    uint32_t m_cpt_ins_tlb_inval;           // number of ins tlb invalidate
-
-    uint32_t m_cost_data_tlb_inval_frz;     // number of frozen cycles related to checking data tlb invalidate
-    uint32_t m_cpt_data_tlb_inval;          // number of data tlb invalidate
-
-    // FSM activity counters
-    uint32_t m_cpt_fsm_icache     [64];
-    uint32_t m_cpt_fsm_dcache     [64];
-    uint32_t m_cpt_fsm_cmd        [64];
-    uint32_t m_cpt_fsm_rsp        [64];
-    uint32_t m_cpt_fsm_cc_receive [64];
-    uint32_t m_cpt_fsm_cc_send    [64];
+    // The activity counters (64 bits) are grouped in a contiguous block
+    // (see counter_block.h), and accessed as m_stats->cpt_xxx
+    struct counters_t
+    {
+        uint64_t cpt_dcache_data_read;        // DCACHE DATA READ
+        uint64_t cpt_dcache_data_write;       // DCACHE DATA WRITE
+        uint64_t cpt_dcache_dir_read;         // DCACHE DIR READ
+        uint64_t cpt_dcache_dir_write;        // DCACHE DIR WRITE
+
+        uint64_t cpt_icache_data_read;        // ICACHE DATA READ
+        uint64_t cpt_icache_data_write;       // ICACHE DATA WRITE
+        uint64_t cpt_icache_dir_read;         // ICACHE DIR READ
+        uint64_t cpt_icache_dir_write;        // ICACHE DIR WRITE
+
+        uint64_t cpt_frz_cycles;	            // number of cycles where the cpu is frozen
+        uint64_t cpt_total_cycles;	        // total number of cycles
+
+        // Cache activity counters
+        uint64_t cpt_data_read;               // total number of read data
+        uint64_t cpt_data_write;              // total number of write data
+        uint64_t cpt_data_miss;               // number of read miss
+        uint64_t cpt_ins_miss;                // number of instruction miss
+        uint64_t cpt_unc_read;                // number of read uncached
+        uint64_t cpt_write_cached;            // number of cached write
+        uint64_t cpt_ins_read;                // number of instruction read
+        uint64_t cpt_ins_spc_miss;            // number of speculative instruction miss
+
+        uint64_t cost_write_frz;              // number of frozen cycles related to write buffer
+        uint64_t cost_data_miss_frz;          // number of frozen cycles related to data miss
+        uint64_t cost_unc_read_frz;           // number of frozen cycles related to uncached read
+        uint64_t cost_ins_miss_frz;           // number of frozen cycles related to ins miss
+
+        uint64_t cpt_imiss_transaction;       // number of VCI instruction miss transactions
+        uint64_t cpt_dmiss_transaction;       // number of VCI data miss transactions
+        uint64_t cpt_unc_transaction;         // number of VCI uncached read transactions
+        uint64_t cpt_write_transaction;       // number of VCI write transactions
+        uint64_t cpt_icache_unc_transaction;
+
+        uint64_t cost_imiss_transaction;      // cumulated duration for VCI IMISS transactions
+        uint64_t cost_dmiss_transaction;      // cumulated duration for VCI DMISS transactions
+        uint64_t cost_unc_transaction;        // cumulated duration for VCI UNC transactions
+        uint64_t cost_write_transaction;      // cumulated duration for VCI WRITE transactions
+        uint64_t cost_icache_unc_transaction; // cumulated duration for VCI IUNC transactions
+        uint64_t length_write_transaction;    // cumulated length for VCI WRITE transactions
+
+        // TLB activity counters
+        uint64_t cpt_ins_tlb_read;            // number of instruction tlb read
+        uint64_t cpt_ins_tlb_miss;            // number of instruction tlb miss
+        uint64_t cpt_ins_tlb_update_acc;      // number of instruction tlb update
+        uint64_t cpt_ins_tlb_occup_cache;     // number of instruction tlb occupy data cache line
+        uint64_t cpt_ins_tlb_hit_dcache;      // number of instruction tlb hit in data cache
+
+        uint64_t cpt_data_tlb_read;           // number of data tlb read
+        uint64_t cpt_data_tlb_miss;           // number of data tlb miss
+        uint64_t cpt_data_tlb_update_acc;     // number of data tlb update
+        uint64_t cpt_data_tlb_update_dirty;   // number of data tlb update dirty
+        uint64_t cpt_data_tlb_hit_dcache;     // number of data tlb hit in data cache
+        uint64_t cpt_data_tlb_occup_cache;    // number of data tlb occupy data cache line
+        uint64_t cpt_tlb_occup_dcache;
+
+        uint64_t cost_ins_tlb_miss_frz;       // number of frozen cycles related to instruction tlb miss
+        uint64_t cost_data_tlb_miss_frz;      // number of frozen cycles related to data tlb miss
+        uint64_t cost_ins_tlb_update_acc_frz;    // number of frozen cycles related to instruction tlb update acc
+        uint64_t cost_data_tlb_update_acc_frz;   // number of frozen cycles related to data tlb update acc
+        uint64_t cost_data_tlb_update_dirty_frz; // number of frozen cycles related to data tlb update dirty
+        uint64_t cost_ins_tlb_occup_cache_frz;   // number of frozen cycles related to instruction tlb miss operate in dcache
+        uint64_t cost_data_tlb_occup_cache_frz;  // number of frozen cycles related to data tlb miss operate in dcache
+
+        uint64_t cpt_itlbmiss_transaction;       // number of itlb miss transactions
+        uint64_t cpt_itlb_ll_transaction;        // number of itlb ll acc transactions
+        uint64_t cpt_itlb_sc_transaction;        // number of itlb sc acc transactions
+        uint64_t cpt_dtlbmiss_transaction;       // number of dtlb miss transactions
+        uint64_t cpt_dtlb_ll_transaction;        // number of dtlb ll acc transactions
+        uint64_t cpt_dtlb_sc_transaction;        // number of dtlb sc acc transactions
+        uint64_t cpt_dtlb_ll_dirty_transaction;  // number of dtlb ll dirty transactions
+        uint64_t cpt_dtlb_sc_dirty_transaction;  // number of dtlb sc dirty transactions
+
+        uint64_t cost_itlbmiss_transaction;       // cumulated duration for VCI instruction TLB miss transactions
+        uint64_t cost_itlb_ll_transaction;        // cumulated duration for VCI instruction TLB ll acc transactions
+        uint64_t cost_itlb_sc_transaction;        // cumulated duration for VCI instruction TLB sc acc transactions
+        uint64_t cost_dtlbmiss_transaction;       // cumulated duration for VCI data TLB miss transactions
+        uint64_t cost_dtlb_ll_transaction;        // cumulated duration for VCI data TLB ll acc transactions
+        uint64_t cost_dtlb_sc_transaction;        // cumulated duration for VCI data TLB sc acc transactions
+        uint64_t cost_dtlb_ll_dirty_transaction;  // cumulated duration for VCI data TLB ll dirty transactions
+        uint64_t cost_dtlb_sc_dirty_transaction;  // cumulated duration for VCI data TLB sc dirty transactions
+
+        // coherence activity counters
+        uint64_t cpt_cc_update_icache;            // number of coherence update instruction commands
+        uint64_t cpt_cc_update_dcache;            // number of coherence update data commands
+        uint64_t cpt_cc_inval_icache;             // number of coherence inval instruction commands
+        uint64_t cpt_cc_inval_dcache;             // number of coherence inval data commands
+        uint64_t cpt_cc_broadcast;                // number of coherence broadcast commands
+
+        uint64_t cost_updt_data_frz;              // number of frozen cycles related to coherence update data packets
+        uint64_t cost_inval_ins_frz;              // number of frozen cycles related to coherence inval instruction packets
+        uint64_t cost_inval_data_frz;             // number of frozen cycles related to coherence inval data packets
+        uint64_t cost_broadcast_frz;              // number of frozen cycles related to coherence broadcast packets
+
+        uint64_t cpt_cc_cleanup_ins;              // number of coherence cleanup packets
+        uint64_t cpt_cc_cleanup_data;             // number of coherence cleanup packets
+
+        uint64_t cpt_icleanup_transaction;        // number of instruction cleanup transactions
+        uint64_t cpt_dcleanup_transaction;        // number of instructinumber of data cleanup transactions
+        uint64_t cost_icleanup_transaction;       // cumulated duration for VCI instruction cleanup transactions
+        uint64_t cost_dcleanup_transaction;       // cumulated duration for VCI data cleanup transactions
+
+        uint64_t cost_ins_tlb_inval_frz;      // number of frozen cycles related to checking ins tlb invalidate
+        uint64_t cpt_ins_tlb_inval;           // number of ins tlb invalidate
+
+        uint64_t cost_data_tlb_inval_frz;     // number of frozen cycles related to checking data tlb invalidate
+        uint64_t cpt_data_tlb_inval;          // number of data tlb invalidate
+
+        // FSM activity counters
+        uint64_t cpt_fsm_icache     [64];
+        uint64_t cpt_fsm_dcache     [64];
+        uint64_t cpt_fsm_cmd        [64];
+        uint64_t cpt_fsm_rsp        [64];
+        uint64_t cpt_fsm_cc_receive [64];
+        uint64_t cpt_fsm_cc_send    [64];
+    };
+
+    soclib::CounterBlock<counters_t> m_stats;
 
     uint32_t m_cpt_stop_simulation;		// used to stop simulation if frozen
     bool     m_monitor_ok;		        // used to debug cache output  
@@ -749,6 +767,7 @@ public:
     void print_stats();
     void clear_stats();
     void print_trace(size_t mode = 0);
+    void binary_trace(uint64_t cycle);
     void cache_monitor(paddr_t addr);
     void start_monitor(paddr_t,paddr_t);
     void stop_monitor();
@@ -782,9 +801,12 @@ public:
 private:
     void transition();
     void genMoore();
+    void publish_counters();
 
     soclib_static_assert((int)iss_t::SC_ATOMIC == (int)vci_param::STORE_COND_ATOMIC);
     soclib_static_assert((int)iss_t::SC_NOT_ATOMIC == (int)vci_param::STORE_COND_NOT_ATOMIC);
+    soclib_static_assert(dspin_in_width <= 64);
+    soclib_static_assert(dspin_out_width <= 64);
 };
 
 }}
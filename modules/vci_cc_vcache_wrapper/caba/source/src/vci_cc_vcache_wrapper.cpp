@@ -407,7 +407,9 @@ tmpl(/**/)::VciCcVCacheWrapper(
       r_icache("icache", icache_ways, icache_sets, icache_words),
       r_dcache("dcache", dcache_ways, dcache_sets, dcache_words),
       r_itlb("itlb", proc_id, itlb_ways,itlb_sets,vci_param::N),
-      r_dtlb("dtlb", proc_id, dtlb_ways,dtlb_sets,vci_param::N)
+      r_dtlb("dtlb", proc_id, dtlb_ways,dtlb_sets,vci_param::N),
+
+      m_stats(std::string(name))
 {
     std::cout << "  - Building VciCcVcacheWrapper : " << name << std::endl;
 
@@ -454,6 +456,11 @@ tmpl(/**/)::VciCcVCacheWrapper(
     cache_info.dcache_assoc = dcache_ways;
     cache_info.dcache_n_lines = dcache_sets;
     r_iss.setCacheInfo(cache_info);
+
+    m_trace_source = NULL;
+    m_ifetch_valid = false;
+
+    publish_counters();
 }
 
 /////////////////////////////////////
@@ -462,6 +469,60 @@ tmpl(/**/)::~VciCcVCacheWrapper()
 {
     delete [] r_dcache_in_tlb;
     delete [] r_dcache_contains_ptd;
+
+    soclib::StatisticsRegistry::instance().remove(name());
+}
+
+/////////////////////////////////////////////////////////////////////
+// The publish_counters() function names the activity counters in the
+// counter block, and registers them in the statistics registry (the
+// derived rates and costs printed by print_stats() can be computed
+// from these counters).
+/////////////////////////////////////////////////////////////////////
+tmpl(void)::publish_counters()
+/////////////////////////////////////////////////////////////////////
+{
+    m_stats.add("total_cycles",           "cycles",       &m_stats->cpt_total_cycles);
+    m_stats.add("frozen_cycles",          "cycles",       &m_stats->cpt_frz_cycles);
+
+    m_stats.add("data_read",              "requests",     &m_stats->cpt_data_read);
+    m_stats.add("data_write",             "requests",     &m_stats->cpt_data_write);
+    m_stats.add("data_miss",              "requests",     &m_stats->cpt_data_miss);
+    m_stats.add("ins_read",               "requests",     &m_stats->cpt_ins_read);
+    m_stats.add("ins_miss",               "requests",     &m_stats->cpt_ins_miss);
+    m_stats.add("ins_spc_miss",           "requests",     &m_stats->cpt_ins_spc_miss);
+    m_stats.add("unc_read",               "requests",     &m_stats->cpt_unc_read);
+    m_stats.add("write_cached",           "requests",     &m_stats->cpt_write_cached);
+
+    m_stats.add("write_frz",              "cycles",       &m_stats->cost_write_frz);
+    m_stats.add("data_miss_frz",          "cycles",       &m_stats->cost_data_miss_frz);
+    m_stats.add("unc_read_frz",           "cycles",       &m_stats->cost_unc_read_frz);
+    m_stats.add("ins_miss_frz",           "cycles",       &m_stats->cost_ins_miss_frz);
+
+    m_stats.add("imiss_transaction",      "transactions", &m_stats->cpt_imiss_transaction);
+    m_stats.add("dmiss_transaction",      "transactions", &m_stats->cpt_dmiss_transaction);
+    m_stats.add("unc_transaction",        "transactions", &m_stats->cpt_unc_transaction);
+    m_stats.add("write_transaction",      "transactions", &m_stats->cpt_write_transaction);
+    m_stats.add("imiss_transaction_cost", "cycles",       &m_stats->cost_imiss_transaction);
+    m_stats.add("dmiss_transaction_cost", "cycles",       &m_stats->cost_dmiss_transaction);
+    m_stats.add("unc_transaction_cost",   "cycles",       &m_stats->cost_unc_transaction);
+    m_stats.add("write_transaction_cost", "cycles",       &m_stats->cost_write_transaction);
+    m_stats.add("write_length",           "words",        &m_stats->length_write_transaction);
+
+    m_stats.add("ins_tlb_read",           "requests",     &m_stats->cpt_ins_tlb_read);
+    m_stats.add("ins_tlb_miss",           "requests",     &m_stats->cpt_ins_tlb_miss);
+    m_stats.add("data_tlb_read",          "requests",     &m_stats->cpt_data_tlb_read);
+    m_stats.add("data_tlb_miss",          "requests",     &m_stats->cpt_data_tlb_miss);
+    m_stats.add("ins_tlb_miss_frz",       "cycles",       &m_stats->cost_ins_tlb_miss_frz);
+    m_stats.add("data_tlb_miss_frz",      "cycles",       &m_stats->cost_data_tlb_miss_frz);
+
+    m_stats.add("cc_update_icache",       "commands",     &m_stats->cpt_cc_update_icache);
+    m_stats.add("cc_update_dcache",       "commands",     &m_stats->cpt_cc_update_dcache);
+    m_stats.add("cc_inval_icache",        "commands",     &m_stats->cpt_cc_inval_icache);
+    m_stats.add("cc_inval_dcache",        "commands",     &m_stats->cpt_cc_inval_dcache);
+    m_stats.add("cc_broadcast",           "commands",     &m_stats->cpt_cc_broadcast);
+    m_stats.add("cc_cleanup_ins",         "commands",     &m_stats->cpt_cc_cleanup_ins);
+    m_stats.add("cc_cleanup_data",        "commands",     &m_stats->cpt_cc_cleanup_data);
 }
 
 ////////////////////////
@@ -469,7 +530,7 @@ tmpl(void)::print_cpi()
 ////////////////////////
 {
     std::cout << name() << " CPI = "
-        << (float)m_cpt_total_cycles/(m_cpt_total_cycles - m_cpt_frz_cycles) << std::endl ;
+        << (float)m_stats->cpt_total_cycles/(m_stats->cpt_total_cycles - m_stats->cpt_frz_cycles) << std::endl ;
 }
 
 ////////////////////////////////////
@@ -546,6 +607,48 @@ tmpl(void)::print_trace(size_t mode)
     }
 }
 
+////////////////////////////////////////////////////////////////////////////
+// The binary_trace() function is the binary equivalent of the FSM states
+// line of print_trace(0) (the ISS requests and responses are not traced).
+// The trace source is described in the trace sink at the first call.
+////////////////////////////////////////////////////////////////////////////
+tmpl(void)::binary_trace(uint64_t cycle)
+////////////////////////////////////////////////////////////////////////////
+{
+    static const char * const updt_str[] = { "", " | P1_UPDT" };
+    static const char * const wbuf_str[] = { "", " | P1_WBUF" };
+
+    if (m_trace_source == NULL)
+    {
+        soclib::TraceSource * src = new soclib::TraceSource(std::string("PROC ") + name());
+        src->field("  ",  icache_fsm_state_str);
+        src->field(" | ", dcache_fsm_state_str);
+        src->field(" | ", cmd_fsm_state_str);
+        src->field(" | ", rsp_fsm_state_str);
+        src->field(" | ", cc_receive_fsm_state_str);
+        src->field(" | ", cc_send_fsm_state_str);
+        src->field(" | MMU = ");
+        src->field("", updt_str);
+        src->field("", wbuf_str);
+        soclib::TraceSink::instance().attach(src);
+        m_trace_source = src;
+    }
+
+    uint32_t values[9] =
+    {
+        (uint32_t)r_icache_fsm.read(),
+        (uint32_t)r_dcache_fsm.read(),
+        (uint32_t)r_vci_cmd_fsm.read(),
+        (uint32_t)r_vci_rsp_fsm.read(),
+        (uint32_t)r_cc_receive_fsm.read(),
+        (uint32_t)r_cc_send_fsm.read(),
+        (uint32_t)r_mmu_mode.read(),
+        (uint32_t)r_dcache_updt_req.read(),
+        (uint32_t)r_dcache_wbuf_req.read(),
+    };
+    m_trace_source->push(cycle, values);
+}
+
 //////////////////////////////////////////
 tmpl(void)::cache_monitor(paddr_t addr)
 //////////////////////////////////////////
@@ -565,7 +668,7 @@ tmpl(void)::cache_monitor(paddr_t addr)
     if (cache_hit != m_debug_previous_d_hit)
     {
         std::cout << "Monitor PROC " << name()
-                  << " DCACHE at cycle " << std::dec << m_cpt_total_cycles
+                  << " DCACHE at cycle " << std::dec << m_stats->cpt_total_cycles
                   << " / HIT = " << cache_hit
                   << " / PADDR = " << std::hex << addr
                   << " / DATA = " << cache_rdata
@@ -582,7 +685,7 @@ tmpl(void)::cache_monitor(paddr_t addr)
     if (cache_hit != m_debug_previous_i_hit)
     {
         std::cout << "Monitor PROC " << name()
-                  << " ICACHE at cycle " << std::dec << m_cpt_total_cycles
+                  << " ICACHE at cycle " << std::dec << m_stats->cpt_total_cycles
                   << " / HIT = " << cache_hit
                   << " / PADDR = " << std::hex << addr
                   << " / DATA = " << cache_rdata
@@ -596,143 +699,143 @@ tmpl(void)::cache_monitor(paddr_t addr)
 tmpl(void)::print_stats()
 ////////////////////////
 {
-    float run_cycles = (float)(m_cpt_total_cycles - m_cpt_frz_cycles);
+    float run_cycles = (float)(m_stats->cpt_total_cycles - m_stats->cpt_frz_cycles);
     std::cout << name() << std::endl
-        << "- CPI                    = " << (float)m_cpt_total_cycles/run_cycles << std::endl
-        << "- READ RATE              = " << (float)m_cpt_read/run_cycles << std::endl
-        << "- WRITE RATE             = " << (float)m_cpt_write/run_cycles << std::endl
-        << "- IMISS_RATE             = " << (float)m_cpt_ins_miss/m_cpt_ins_read << std::endl
-        << "- DMISS RATE             = " << (float)m_cpt_data_miss/(m_cpt_read-m_cpt_unc_read) << std::endl
-        << "- INS MISS COST          = " << (float)m_cost_ins_miss_frz/m_cpt_ins_miss << std::endl
-        << "- DATA MISS COST         = " << (float)m_cost_data_miss_frz/m_cpt_data_miss << std::endl
-        << "- WRITE COST             = " << (float)m_cost_write_frz/m_cpt_write << std::endl
-        << "- UNC COST               = " << (float)m_cost_unc_read_frz/m_cpt_unc_read << std::endl
-        << "- UNCACHED READ RATE     = " << (float)m_cpt_unc_read/m_cpt_read << std::endl
-        << "- CACHED WRITE RATE      = " << (float)m_cpt_write_cached/m_cpt_write << std::endl
-        << "- INS TLB MISS RATE      = " << (float)m_cpt_ins_tlb_miss/m_cpt_ins_tlb_read << std::endl
-        << "- DATA TLB MISS RATE     = " << (float)m_cpt_data_tlb_miss/m_cpt_data_tlb_read << std::endl
-        << "- ITLB MISS COST         = " << (float)m_cost_ins_tlb_miss_frz/m_cpt_ins_tlb_miss << std::endl
-        << "- DTLB MISS COST         = " << (float)m_cost_data_tlb_miss_frz/m_cpt_data_tlb_miss << std::endl
-        << "- ITLB UPDATE ACC COST   = " << (float)m_cost_ins_tlb_update_acc_frz/m_cpt_ins_tlb_update_acc << std::endl
-        << "- DTLB UPDATE ACC COST   = " << (float)m_cost_data_tlb_update_acc_frz/m_cpt_data_tlb_update_acc << std::endl
-        << "- DTLB UPDATE DIRTY COST = " << (float)m_cost_data_tlb_update_dirty_frz/m_cpt_data_tlb_update_dirty << std::endl
-        << "- ITLB HIT IN DCACHE RATE= " << (float)m_cpt_ins_tlb_hit_dcache/m_cpt_ins_tlb_miss << std::endl
-        << "- DTLB HIT IN DCACHE RATE= " << (float)m_cpt_data_tlb_hit_dcache/m_cpt_data_tlb_miss << std::endl
-        << "- DCACHE FROZEN BY ITLB  = " << (float)m_cost_ins_tlb_occup_cache_frz/m_cpt_dcache_frz_cycles << std::endl
-        << "- DCACHE FOR TLB %       = " << (float)m_cpt_tlb_occup_dcache/(m_dcache_ways*m_dcache_sets) << std::endl
-        << "- NB CC BROADCAST        = " << m_cpt_cc_broadcast << std::endl
-        << "- NB CC UPDATE DATA      = " << m_cpt_cc_update_data << std::endl
-        << "- NB CC INVAL DATA       = " << m_cpt_cc_inval_data << std::endl
-        << "- NB CC INVAL INS        = " << m_cpt_cc_inval_ins << std::endl
-        << "- CC BROADCAST COST      = " << (float)m_cost_broadcast_frz/m_cpt_cc_broadcast << std::endl
-        << "- CC UPDATE DATA COST    = " << (float)m_cost_updt_data_frz/m_cpt_cc_update_data << std::endl
-        << "- CC INVAL DATA COST     = " << (float)m_cost_inval_data_frz/m_cpt_cc_inval_data << std::endl
-        << "- CC INVAL INS COST      = " << (float)m_cost_inval_ins_frz/m_cpt_cc_inval_ins << std::endl
-        << "- NB CC CLEANUP DATA     = " << m_cpt_cc_cleanup_data << std::endl
-        << "- NB CC CLEANUP INS      = " << m_cpt_cc_cleanup_ins << std::endl
-        << "- IMISS TRANSACTION      = " << (float)m_cost_imiss_transaction/m_cpt_imiss_transaction << std::endl
-        << "- DMISS TRANSACTION      = " << (float)m_cost_dmiss_transaction/m_cpt_dmiss_transaction << std::endl
-        << "- UNC TRANSACTION        = " << (float)m_cost_unc_transaction/m_cpt_unc_transaction << std::endl
-        << "- WRITE TRANSACTION      = " << (float)m_cost_write_transaction/m_cpt_write_transaction << std::endl
-        << "- WRITE LENGTH           = " << (float)m_length_write_transaction/m_cpt_write_transaction << std::endl
-        << "- ITLB MISS TRANSACTION  = " << (float)m_cost_itlbmiss_transaction/m_cpt_itlbmiss_transaction << std::endl
-        << "- DTLB MISS TRANSACTION  = " << (float)m_cost_dtlbmiss_transaction/m_cpt_dtlbmiss_transaction << std::endl;
+        << "- CPI                    = " << (float)m_stats->cpt_total_cycles/run_cycles << std::endl
+        << "- READ RATE              = " << (float)m_stats->cpt_read/run_cycles << std::endl
+        << "- WRITE RATE             = " << (float)m_stats->cpt_write/run_cycles << std::endl
+        << "- IMISS_RATE             = " << (float)m_stats->cpt_ins_miss/m_stats->cpt_ins_read << std::endl
+        << "- DMISS RATE             = " << (float)m_stats->cpt_data_miss/(m_stats->cpt_read-m_stats->cpt_unc_read) << std::endl
+        << "- INS MISS COST          = " << (float)m_stats->cost_ins_miss_frz/m_stats->cpt_ins_miss << std::endl
+        << "- DATA MISS COST         = " << (float)m_stats->cost_data_miss_frz/m_stats->cpt_data_miss << std::endl
+        << "- WRITE COST             = " << (float)m_stats->cost_write_frz/m_stats->cpt_write << std::endl
+        << "- UNC COST               = " << (float)m_stats->cost_unc_read_frz/m_stats->cpt_unc_read << std::endl
+        << "- UNCACHED READ RATE     = " << (float)m_stats->cpt_unc_read/m_stats->cpt_read << std::endl
+        << "- CACHED WRITE RATE      = " << (float)m_stats->cpt_write_cached/m_stats->cpt_write << std::endl
+        << "- INS TLB MISS RATE      = " << (float)m_stats->cpt_ins_tlb_miss/m_stats->cpt_ins_tlb_read << std::endl
+        << "- DATA TLB MISS RATE     = " << (float)m_stats->cpt_data_tlb_miss/m_stats->cpt_data_tlb_read << std::endl
+        << "- ITLB MISS COST         = " << (float)m_stats->cost_ins_tlb_miss_frz/m_stats->cpt_ins_tlb_miss << std::endl
+        << "- DTLB MISS COST         = " << (float)m_stats->cost_data_tlb_miss_frz/m_stats->cpt_data_tlb_miss << std::endl
+        << "- ITLB UPDATE ACC COST   = " << (float)m_stats->cost_ins_tlb_update_acc_frz/m_stats->cpt_ins_tlb_update_acc << std::endl
+        << "- DTLB UPDATE ACC COST   = " << (float)m_stats->cost_data_tlb_update_acc_frz/m_stats->cpt_data_tlb_update_acc << std::endl
+        << "- DTLB UPDATE DIRTY COST = " << (float)m_stats->cost_data_tlb_update_dirty_frz/m_stats->cpt_data_tlb_update_dirty << std::endl
+        << "- ITLB HIT IN DCACHE RATE= " << (float)m_stats->cpt_ins_tlb_hit_dcache/m_stats->cpt_ins_tlb_miss << std::endl
+        << "- DTLB HIT IN DCACHE RATE= " << (float)m_stats->cpt_data_tlb_hit_dcache/m_stats->cpt_data_tlb_miss << std::endl
+        << "- DCACHE FROZEN BY ITLB  = " << (float)m_stats->cost_ins_tlb_occup_cache_frz/m_stats->cpt_dcache_frz_cycles << std::endl
+        << "- DCACHE FOR TLB %       = " << (float)m_stats->cpt_tlb_occup_dcache/(m_dcache_ways*m_dcache_sets) << std::endl
+        << "- NB CC BROADCAST        = " << m_stats->cpt_cc_broadcast << std::endl
+        << "- NB CC UPDATE DATA      = " << m_stats->cpt_cc_update_data << std::endl
+        << "- NB CC INVAL DATA       = " << m_stats->cpt_cc_inval_data << std::endl
+        << "- NB CC INVAL INS        = " << m_stats->cpt_cc_inval_ins << std::endl
+        << "- CC BROADCAST COST      = " << (float)m_stats->cost_broadcast_frz/m_stats->cpt_cc_broadcast << std::endl
+        << "- CC UPDATE DATA COST    = " << (float)m_stats->cost_updt_data_frz/m_stats->cpt_cc_update_data << std::endl
+        << "- CC INVAL DATA COST     = " << (float)m_stats->cost_inval_data_frz/m_stats->cpt_cc_inval_data << std::endl
+        << "- CC INVAL INS COST      = " << (float)m_stats->cost_inval_ins_frz/m_stats->cpt_cc_inval_ins << std::endl
+        << "- NB CC CLEANUP DATA     = " << m_stats->cpt_cc_cleanup_data << std::endl
+        << "- NB CC CLEANUP INS      = " << m_stats->cpt_cc_cleanup_ins << std::endl
+        << "- IMISS TRANSACTION      = " << (float)m_stats->cost_imiss_transaction/m_stats->cpt_imiss_transaction << std::endl
+        << "- DMISS TRANSACTION      = " << (float)m_stats->cost_dmiss_transaction/m_stats->cpt_dmiss_transaction << std::endl
+        << "- UNC TRANSACTION        = " << (float)m_stats->cost_unc_transaction/m_stats->cpt_unc_transaction << std::endl
+        << "- WRITE TRANSACTION      = " << (float)m_stats->cost_write_transaction/m_stats->cpt_write_transaction << std::endl
+        << "- WRITE LENGTH           = " << (float)m_stats->length_write_transaction/m_stats->cpt_write_transaction << std::endl
+        << "- ITLB MISS TRANSACTION  = " << (float)m_stats->cost_itlbmiss_transaction/m_stats->cpt_itlbmiss_transaction << std::endl
+        << "- DTLB MISS TRANSACTION  = " << (float)m_stats->cost_dtlbmiss_transaction/m_stats->cpt_dtlbmiss_transaction << std::endl;
 }
 
 ////////////////////////
 tmpl(void)::clear_stats()
 ////////////////////////
 {
-    m_cpt_dcache_data_read  = 0;
-    m_cpt_dcache_data_write = 0;
-    m_cpt_dcache_dir_read   = 0;
-    m_cpt_dcache_dir_write  = 0;
-    m_cpt_icache_data_read  = 0;
-    m_cpt_icache_data_write = 0;
-    m_cpt_icache_dir_read   = 0;
-    m_cpt_icache_dir_write  = 0;
-
-    m_cpt_frz_cycles        = 0;
-    m_cpt_dcache_frz_cycles = 0;
-    m_cpt_total_cycles      = 0;
-
-    m_cpt_read         = 0;
-    m_cpt_write        = 0;
-    m_cpt_data_miss    = 0;
-    m_cpt_ins_miss     = 0;
-    m_cpt_unc_read     = 0;
-    m_cpt_write_cached = 0;
-    m_cpt_ins_read     = 0;
-
-    m_cost_write_frz     = 0;
-    m_cost_data_miss_frz = 0;
-    m_cost_unc_read_frz  = 0;
-    m_cost_ins_miss_frz  = 0;
-
-    m_cpt_imiss_transaction      = 0;
-    m_cpt_dmiss_transaction      = 0;
-    m_cpt_unc_transaction        = 0;
-    m_cpt_write_transaction      = 0;
-    m_cpt_icache_unc_transaction = 0;
-
-    m_cost_imiss_transaction      = 0;
-    m_cost_dmiss_transaction      = 0;
-    m_cost_unc_transaction        = 0;
-    m_cost_write_transaction      = 0;
-    m_cost_icache_unc_transaction = 0;
-    m_length_write_transaction    = 0;
-
-    m_cpt_ins_tlb_read       = 0;
-    m_cpt_ins_tlb_miss       = 0;
-    m_cpt_ins_tlb_update_acc = 0;
-
-    m_cpt_data_tlb_read         = 0;
-    m_cpt_data_tlb_miss         = 0;
-    m_cpt_data_tlb_update_acc   = 0;
-    m_cpt_data_tlb_update_dirty = 0;
-    m_cpt_ins_tlb_hit_dcache    = 0;
-    m_cpt_data_tlb_hit_dcache   = 0;
-    m_cpt_ins_tlb_occup_cache   = 0;
-    m_cpt_data_tlb_occup_cache  = 0;
-
-    m_cost_ins_tlb_miss_frz          = 0;
-    m_cost_data_tlb_miss_frz         = 0;
-    m_cost_ins_tlb_update_acc_frz    = 0;
-    m_cost_data_tlb_update_acc_frz   = 0;
-    m_cost_data_tlb_update_dirty_frz = 0;
-    m_cost_ins_tlb_occup_cache_frz   = 0;
-    m_cost_data_tlb_occup_cache_frz  = 0;
-
-    m_cpt_itlbmiss_transaction      = 0;
-    m_cpt_itlb_ll_transaction       = 0;
-    m_cpt_itlb_sc_transaction       = 0;
-    m_cpt_dtlbmiss_transaction      = 0;
-    m_cpt_dtlb_ll_transaction       = 0;
-    m_cpt_dtlb_sc_transaction       = 0;
-    m_cpt_dtlb_ll_dirty_transaction = 0;
-    m_cpt_dtlb_sc_dirty_transaction = 0;
-
-    m_cost_itlbmiss_transaction      = 0;
-    m_cost_itlb_ll_transaction       = 0;
-    m_cost_itlb_sc_transaction       = 0;
-    m_cost_dtlbmiss_transaction      = 0;
-    m_cost_dtlb_ll_transaction       = 0;
-    m_cost_dtlb_sc_transaction       = 0;
-    m_cost_dtlb_ll_dirty_transaction = 0;
-    m_cost_dtlb_sc_dirty_transaction = 0;
-
-    m_cpt_cc_update_data = 0;
-    m_cpt_cc_inval_ins   = 0;
-    m_cpt_cc_inval_data  = 0;
-    m_cpt_cc_broadcast   = 0;
-
-    m_cost_updt_data_frz  = 0;
-    m_cost_inval_ins_frz  = 0;
-    m_cost_inval_data_frz = 0;
-    m_cost_broadcast_frz  = 0;
-
-    m_cpt_cc_cleanup_data = 0;
-    m_cpt_cc_cleanup_ins  = 0;
+    m_stats->cpt_dcache_data_read  = 0;
+    m_stats->cpt_dcache_data_write = 0;
+    m_stats->cpt_dcache_dir_read   = 0;
+    m_stats->cpt_dcache_dir_write  = 0;
+    m_stats->cpt_icache_data_read  = 0;
+    m_stats->cpt_icache_data_write = 0;
+    m_stats->cpt_icache_dir_read   = 0;
+    m_stats->cpt_icache_dir_write  = 0;
+
+    m_stats->cpt_frz_cycles        = 0;
+    m_stats->cpt_dcache_frz_cycles = 0;
+    m_stats->cpt_total_cycles      = 0;
+
+    m_stats->cpt_read         = 0;
+    m_stats->cpt_write        = 0;
+    m_stats->cpt_data_miss    = 0;
+    m_stats->cpt_ins_miss     = 0;
+    m_stats->cpt_unc_read     = 0;
+    m_stats->cpt_write_cached = 0;
+    m_stats->cpt_ins_read     = 0;
+
+    m_stats->cost_write_frz     = 0;
+    m_stats->cost_data_miss_frz = 0;
+    m_stats->cost_unc_read_frz  = 0;
+    m_stats->cost_ins_miss_frz  = 0;
+
+    m_stats->cpt_imiss_transaction      = 0;
+    m_stats->cpt_dmiss_transaction      = 0;
+    m_stats->cpt_unc_transaction        = 0;
+    m_stats->cpt_write_transaction      = 0;
+    m_stats->cpt_icache_unc_transaction = 0;
+
+    m_stats->cost_imiss_transaction      = 0;
+    m_stats->cost_dmiss_transaction      = 0;
+    m_stats->cost_unc_transaction        = 0;
+    m_stats->cost_write_transaction      = 0;
+    m_stats->cost_icache_unc_transaction = 0;
+    m_stats->length_write_transaction    = 0;
+
+    m_stats->cpt_ins_tlb_read       = 0;
+    m_stats->cpt_ins_tlb_miss       = 0;
+    m_stats->cpt_ins_tlb_update_acc = 0;
+
+    m_stats->cpt_data_tlb_read         = 0;
+    m_stats->cpt_data_tlb_miss         = 0;
+    m_stats->cpt_data_tlb_update_acc   = 0;
+    m_stats->cpt_data_tlb_update_dirty = 0;
+    m_stats->cpt_ins_tlb_hit_dcache    = 0;
+    m_stats->cpt_data_tlb_hit_dcache   = 0;
+    m_stats->cpt_ins_tlb_occup_cache   = 0;
+    m_stats->cpt_data_tlb_occup_cache  = 0;
+
+    m_stats->cost_ins_tlb_miss_frz          = 0;
+    m_stats->cost_data_tlb_miss_frz         = 0;
+    m_stats->cost_ins_tlb_update_acc_frz    = 0;
+    m_stats->cost_data_tlb_update_acc_frz   = 0;
+    m_stats->cost_data_tlb_update_dirty_frz = 0;
+    m_stats->cost_ins_tlb_occup_cache_frz   = 0;
+    m_stats->cost_data_tlb_occup_cache_frz  = 0;
+
+    m_stats->cpt_itlbmiss_transaction      = 0;
+    m_stats->cpt_itlb_ll_transaction       = 0;
+    m_stats->cpt_itlb_sc_transaction       = 0;
+    m_stats->cpt_dtlbmiss_transaction      = 0;
+    m_stats->cpt_dtlb_ll_transaction       = 0;
+    m_stats->cpt_dtlb_sc_transaction       = 0;
+    m_stats->cpt_dtlb_ll_dirty_transaction = 0;
+    m_stats->cpt_dtlb_sc_dirty_transaction = 0;
+
+    m_stats->cost_itlbmiss_transaction      = 0;
+    m_stats->cost_itlb_ll_transaction       = 0;
+    m_stats->cost_itlb_sc_transaction       = 0;
+    m_stats->cost_dtlbmiss_transaction      = 0;
+    m_stats->cost_dtlb_ll_transaction       = 0;
+    m_stats->cost_dtlb_sc_transaction       = 0;
+    m_stats->cost_dtlb_ll_dirty_transaction = 0;
+    m_stats->cost_dtlb_sc_dirty_transaction = 0;
+
+    m_stats->cpt_cc_update_data = 0;
+    m_stats->cpt_cc_inval_ins   = 0;
+    m_stats->cpt_cc_inval_data  = 0;
+    m_stats->cpt_cc_broadcast   = 0;
+
+    m_stats->cost_updt_data_frz  = 0;
+    m_stats->cost_inval_ins_frz  = 0;
+    m_stats->cost_inval_data_frz = 0;
+    m_stats->cost_broadcast_frz  = 0;
+
+    m_stats->cpt_cc_cleanup_data = 0;
+    m_stats->cpt_cc_cleanup_ins  = 0;
 }
 
 */
@@ -747,6 +850,7 @@ tmpl(void)::transition()
         r_wbuf.reset();
         r_icache.reset();
         r_dcache.reset();
+        m_ifetch_valid = false;
         r_itlb.reset();
         r_dtlb.reset();
 
@@ -840,109 +944,109 @@ tmpl(void)::transition()
         m_debug_cmd_fsm            = false;
 
         // activity counters
-        m_cpt_dcache_data_read  = 0;
-        m_cpt_dcache_data_write = 0;
-        m_cpt_dcache_dir_read   = 0;
-        m_cpt_dcache_dir_write  = 0;
-        m_cpt_icache_data_read  = 0;
-        m_cpt_icache_data_write = 0;
-        m_cpt_icache_dir_read   = 0;
-        m_cpt_icache_dir_write  = 0;
-
-        m_cpt_frz_cycles        = 0;
-        m_cpt_total_cycles      = 0;
+        m_stats->cpt_dcache_data_read  = 0;
+        m_stats->cpt_dcache_data_write = 0;
+        m_stats->cpt_dcache_dir_read   = 0;
+        m_stats->cpt_dcache_dir_write  = 0;
+        m_stats->cpt_icache_data_read  = 0;
+        m_stats->cpt_icache_data_write = 0;
+        m_stats->cpt_icache_dir_read   = 0;
+        m_stats->cpt_icache_dir_write  = 0;
+
+        m_stats->cpt_frz_cycles        = 0;
+        m_stats->cpt_total_cycles      = 0;
         m_cpt_stop_simulation   = 0;
 
-        m_cpt_data_miss         = 0;
-        m_cpt_ins_miss          = 0;
-        m_cpt_unc_read          = 0;
-        m_cpt_write_cached      = 0;
-        m_cpt_ins_read          = 0;
-
-        m_cost_write_frz        = 0;
-        m_cost_data_miss_frz    = 0;
-        m_cost_unc_read_frz     = 0;
-        m_cost_ins_miss_frz     = 0;
-
-        m_cpt_imiss_transaction = 0;
-        m_cpt_dmiss_transaction = 0;
-        m_cpt_unc_transaction   = 0;
-        m_cpt_write_transaction = 0;
-        m_cpt_icache_unc_transaction = 0;
-
-        m_cost_imiss_transaction      = 0;
-        m_cost_dmiss_transaction      = 0;
-        m_cost_unc_transaction        = 0;
-        m_cost_write_transaction      = 0;
-        m_cost_icache_unc_transaction = 0;
-        m_length_write_transaction    = 0;
-
-        m_cpt_ins_tlb_read       = 0;
-        m_cpt_ins_tlb_miss       = 0;
-        m_cpt_ins_tlb_update_acc = 0;
-
-        m_cpt_data_tlb_read         = 0;
-        m_cpt_data_tlb_miss         = 0;
-        m_cpt_data_tlb_update_acc   = 0;
-        m_cpt_data_tlb_update_dirty = 0;
-        m_cpt_ins_tlb_hit_dcache    = 0;
-        m_cpt_data_tlb_hit_dcache   = 0;
-        m_cpt_ins_tlb_occup_cache   = 0;
-        m_cpt_data_tlb_occup_cache  = 0;
-
-        m_cost_ins_tlb_miss_frz          = 0;
-        m_cost_data_tlb_miss_frz         = 0;
-        m_cost_ins_tlb_update_acc_frz    = 0;
-        m_cost_data_tlb_update_acc_frz   = 0;
-        m_cost_data_tlb_update_dirty_frz = 0;
-        m_cost_ins_tlb_occup_cache_frz   = 0;
-        m_cost_data_tlb_occup_cache_frz  = 0;
-
-        m_cpt_ins_tlb_inval       = 0;
-        m_cpt_data_tlb_inval      = 0;
-        m_cost_ins_tlb_inval_frz  = 0;
-        m_cost_data_tlb_inval_frz = 0;
-
-        m_cpt_cc_broadcast   = 0;
-
-        m_cost_updt_data_frz  = 0;
-        m_cost_inval_ins_frz  = 0;
-        m_cost_inval_data_frz = 0;
-        m_cost_broadcast_frz  = 0;
-
-        m_cpt_cc_cleanup_data = 0;
-        m_cpt_cc_cleanup_ins  = 0;
-
-        m_cpt_itlbmiss_transaction      = 0;
-        m_cpt_itlb_ll_transaction       = 0;
-        m_cpt_itlb_sc_transaction       = 0;
-        m_cpt_dtlbmiss_transaction      = 0;
-        m_cpt_dtlb_ll_transaction       = 0;
-        m_cpt_dtlb_sc_transaction       = 0;
-        m_cpt_dtlb_ll_dirty_transaction = 0;
-        m_cpt_dtlb_sc_dirty_transaction = 0;
-
-        m_cost_itlbmiss_transaction      = 0;
-        m_cost_itlb_ll_transaction       = 0;
-        m_cost_itlb_sc_transaction       = 0;
-        m_cost_dtlbmiss_transaction      = 0;
-        m_cost_dtlb_ll_transaction       = 0;
-        m_cost_dtlb_sc_transaction       = 0;
-        m_cost_dtlb_ll_dirty_transaction = 0;
-        m_cost_dtlb_sc_dirty_transaction = 0;
+        m_stats->cpt_data_miss         = 0;
+        m_stats->cpt_ins_miss          = 0;
+        m_stats->cpt_unc_read          = 0;
+        m_stats->cpt_write_cached      = 0;
+        m_stats->cpt_ins_read          = 0;
+
+        m_stats->cost_write_frz        = 0;
+        m_stats->cost_data_miss_frz    = 0;
+        m_stats->cost_unc_read_frz     = 0;
+        m_stats->cost_ins_miss_frz     = 0;
+
+        m_stats->cpt_imiss_transaction = 0;
+        m_stats->cpt_dmiss_transaction = 0;
+        m_stats->cpt_unc_transaction   = 0;
+        m_stats->cpt_write_transaction = 0;
+        m_stats->cpt_icache_unc_transaction = 0;
+
+        m_stats->cost_imiss_transaction      = 0;
+        m_stats->cost_dmiss_transaction      = 0;
+        m_stats->cost_unc_transaction        = 0;
+        m_stats->cost_write_transaction      = 0;
+        m_stats->cost_icache_unc_transaction = 0;
+        m_stats->length_write_transaction    = 0;
+
+        m_stats->cpt_ins_tlb_read       = 0;
+        m_stats->cpt_ins_tlb_miss       = 0;
+        m_stats->cpt_ins_tlb_update_acc = 0;
+
+        m_stats->cpt_data_tlb_read         = 0;
+        m_stats->cpt_data_tlb_miss         = 0;
+        m_stats->cpt_data_tlb_update_acc   = 0;
+        m_stats->cpt_data_tlb_update_dirty = 0;
+        m_stats->cpt_ins_tlb_hit_dcache    = 0;
+        m_stats->cpt_data_tlb_hit_dcache   = 0;
+        m_stats->cpt_ins_tlb_occup_cache   = 0;
+        m_stats->cpt_data_tlb_occup_cache  = 0;
+
+        m_stats->cost_ins_tlb_miss_frz          = 0;
+        m_stats->cost_data_tlb_miss_frz         = 0;
+        m_stats->cost_ins_tlb_update_acc_frz    = 0;
+        m_stats->cost_data_tlb_update_acc_frz   = 0;
+        m_stats->cost_data_tlb_update_dirty_frz = 0;
+        m_stats->cost_ins_tlb_occup_cache_frz   = 0;
+        m_stats->cost_data_tlb_occup_cache_frz  = 0;
+
+        m_stats->cpt_ins_tlb_inval       = 0;
+        m_stats->cpt_data_tlb_inval      = 0;
+        m_stats->cost_ins_tlb_inval_frz  = 0;
+        m_stats->cost_data_tlb_inval_frz = 0;
+
+        m_stats->cpt_cc_broadcast   = 0;
+
+        m_stats->cost_updt_data_frz  = 0;
+        m_stats->cost_inval_ins_frz  = 0;
+        m_stats->cost_inval_data_frz = 0;
+        m_stats->cost_broadcast_frz  = 0;
+
+        m_stats->cpt_cc_cleanup_data = 0;
+        m_stats->cpt_cc_cleanup_ins  = 0;
+
+        m_stats->cpt_itlbmiss_transaction      = 0;
+        m_stats->cpt_itlb_ll_transaction       = 0;
+        m_stats->cpt_itlb_sc_transaction       = 0;
+        m_stats->cpt_dtlbmiss_transaction      = 0;
+        m_stats->cpt_dtlb_ll_transaction       = 0;
+        m_stats->cpt_dtlb_sc_transaction       = 0;
+        m_stats->cpt_dtlb_ll_dirty_transaction = 0;
+        m_stats->cpt_dtlb_sc_dirty_transaction = 0;
+
+        m_stats->cost_itlbmiss_transaction      = 0;
+        m_stats->cost_itlb_ll_transaction       = 0;
+        m_stats->cost_itlb_sc_transaction       = 0;
+        m_stats->cost_dtlbmiss_transaction      = 0;
+        m_stats->cost_dtlb_ll_transaction       = 0;
+        m_stats->cost_dtlb_sc_transaction       = 0;
+        m_stats->cost_dtlb_ll_dirty_transaction = 0;
+        m_stats->cost_dtlb_sc_dirty_transaction = 0;
 /*
-        m_cpt_dcache_frz_cycles = 0;
-        m_cpt_read = 0;
-        m_cpt_write = 0;
-        m_cpt_cc_update_data = 0;
-        m_cpt_cc_inval_ins   = 0;
-        m_cpt_cc_inval_data  = 0;
+        m_stats->cpt_dcache_frz_cycles = 0;
+        m_stats->cpt_read = 0;
+        m_stats->cpt_write = 0;
+        m_stats->cpt_cc_update_data = 0;
+        m_stats->cpt_cc_inval_ins   = 0;
+        m_stats->cpt_cc_inval_data  = 0;
 */
 
-        for (uint32_t i = 0; i < 32; ++i) m_cpt_fsm_icache[i] = 0;
-        for (uint32_t i = 0; i < 32; ++i) m_cpt_fsm_dcache[i] = 0;
-        for (uint32_t i = 0; i < 32; ++i) m_cpt_fsm_cmd[i] = 0;
-        for (uint32_t i = 0; i < 32; ++i) m_cpt_fsm_rsp[i] = 0;
+        for (uint32_t i = 0; i < 32; ++i) m_stats->cpt_fsm_icache[i] = 0;
+        for (uint32_t i = 0; i < 32; ++i) m_stats->cpt_fsm_dcache[i] = 0;
+        for (uint32_t i = 0; i < 32; ++i) m_stats->cpt_fsm_cmd[i] = 0;
+        for (uint32_t i = 0; i < 32; ++i) m_stats->cpt_fsm_rsp[i] = 0;
 
         // init the llsc reservation buffer
         r_dcache_llsc_valid = false;
@@ -968,22 +1072,22 @@ tmpl(void)::transition()
     bool     cc_receive_updt_fifo_eop  = false;
 
 #ifdef INSTRUMENTATION
-    m_cpt_fsm_dcache [r_dcache_fsm.read() ] ++;
-    m_cpt_fsm_icache [r_icache_fsm.read() ] ++;
-    m_cpt_fsm_cmd    [r_vci_cmd_fsm.read()] ++;
-    m_cpt_fsm_rsp    [r_vci_rsp_fsm.read()] ++;
-    m_cpt_fsm_tgt    [r_tgt_fsm.read()    ] ++;
-    m_cpt_fsm_cleanup[r_cleanup_cmd_fsm.read()] ++;
+    m_stats->cpt_fsm_dcache [r_dcache_fsm.read() ] ++;
+    m_stats->cpt_fsm_icache [r_icache_fsm.read() ] ++;
+    m_stats->cpt_fsm_cmd    [r_vci_cmd_fsm.read()] ++;
+    m_stats->cpt_fsm_rsp    [r_vci_rsp_fsm.read()] ++;
+    m_stats->cpt_fsm_tgt    [r_tgt_fsm.read()    ] ++;
+    m_stats->cpt_fsm_cleanup[r_cleanup_cmd_fsm.read()] ++;
 #endif
 
-    m_cpt_total_cycles++;
+    m_stats->cpt_total_cycles++;
 
     m_debug_icache_fsm = m_debug_icache_fsm ||
-        ((m_cpt_total_cycles > m_debug_start_cycle) and m_debug_ok);
+        ((m_stats->cpt_total_cycles > m_debug_start_cycle) and m_debug_ok);
     m_debug_dcache_fsm = m_debug_dcache_fsm ||
-        ((m_cpt_total_cycles > m_debug_start_cycle) and m_debug_ok);
+        ((m_stats->cpt_total_cycles > m_debug_start_cycle) and m_debug_ok);
     m_debug_cmd_fsm = m_debug_cmd_fsm ||
-        ((m_cpt_total_cycles > m_debug_start_cycle) and m_debug_ok);
+        ((m_stats->cpt_total_cycles > m_debug_start_cycle) and m_debug_ok);
 
     /////////////////////////////////////////////////////////////////////
     // Get data and instruction requests from processor
@@ -1048,6 +1152,9 @@ tmpl(void)::transition()
     m_irsp.error = false;
     m_irsp.instruction = 0;
 
+    // the icache can only be modified outside the IDLE state
+    if (r_icache_fsm.read() != ICACHE_IDLE) m_ifetch_valid = false;
+
     switch (r_icache_fsm.read())
     {
     /////////////////
@@ -1133,6 +1240,7 @@ tmpl(void)::transition()
             size_t     cache_set;
             size_t     cache_word;
             int        cache_state = CACHE_SLOT_STATE_EMPTY;
+            bool       same_line   = false;
 
             // We register processor request
             r_icache_vaddr_save = m_ireq.addr;
@@ -1143,7 +1251,7 @@ tmpl(void)::transition()
             {
 
 #ifdef INSTRUMENTATION
-                m_cpt_itlb_read++;
+                m_stats->cpt_itlb_read++;
 #endif
                 tlb_hit = r_itlb.translate(m_ireq.addr,
                                            &paddr,
@@ -1163,15 +1271,38 @@ tmpl(void)::transition()
 
 
 #ifdef INSTRUMENTATION
-                m_cpt_icache_data_read++;
-                m_cpt_icache_dir_read++;
+                m_stats->cpt_icache_data_read++;
+                m_stats->cpt_icache_dir_read++;
 #endif
-                r_icache.read(paddr,
-                              &cache_inst,
-                              &cache_way,
-                              &cache_set,
-                              &cache_word,
-                              &cache_state);
+                const paddr_t line_mask = (paddr_t)((m_icache_words << 2) - 1);
+
+                same_line = m_ifetch_valid and ((paddr & ~line_mask) == m_ifetch_pline);
+
+                if (same_line)
+                {
+                    // same line as the previous hit : the slot is still VALID,
+                    // as the icache has not been modified since
+                    cache_way   = m_ifetch_way;
+                    cache_set   = m_ifetch_set;
+                    cache_word  = (size_t)(paddr & line_mask) >> 2;
+                    cache_state = CACHE_SLOT_STATE_VALID;
+                    cache_inst  = r_icache.read_slot(cache_way, cache_set, cache_word);
+                }
+                else
+                {
+                    r_icache.read(paddr,
+                                  &cache_inst,
+                                  &cache_way,
+                                  &cache_set,
+                                  &cache_word,
+                                  &cache_state);
+
+                    m_ifetch_valid     = (cache_state == CACHE_SLOT_STATE_VALID);
+                    m_ifetch_pline     = paddr & ~line_mask;
+                    m_ifetch_way       = cache_way;
+                    m_ifetch_set       = cache_set;
+                    m_ifetch_cacheable = m_cacheability_table[(uint64_t)(uint32_t)paddr];
+                }
             }
 
             // We compute cacheability and check access rights:
@@ -1182,8 +1313,9 @@ tmpl(void)::transition()
 
             if (not (r_mmu_mode.read() & INS_TLB_MASK)) // tlb not activated:
             {
-                // cacheability
+                // cacheability (memorised with the last line found in icache)
                 if   (not (r_mmu_mode.read() & INS_CACHE_MASK)) cacheable = false;
+                else if (same_line) cacheable = m_ifetch_cacheable;
                 else cacheable = m_cacheability_table[(uint64_t) m_ireq.addr];
             }
             else // itlb activated
@@ -1230,7 +1362,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                 {
 
 #ifdef INSTRUMENTATION
-                    m_cpt_itlb_miss++;
+                    m_stats->cpt_itlb_miss++;
 #endif
                     r_icache_fsm          = ICACHE_TLB_WAIT;
                     r_icache_tlb_miss_req = true;
@@ -1248,7 +1380,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                 {
 
 #ifdef INSTRUMENTATION
-                    m_cpt_icache_miss++;
+                    m_stats->cpt_icache_miss++;
 #endif
                     // we request a VCI transaction
                     r_icache_fsm = ICACHE_MISS_SELECT;
@@ -1268,7 +1400,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                 {
 
 #ifdef INSTRUMENTATION
-                    m_cpt_ins_read++;
+                    m_stats->cpt_ins_read++;
 #endif
                     // return instruction to processor
                     m_irsp.valid       = true;
@@ -1323,7 +1455,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
             break;
         }
 
-        if (m_ireq.valid) m_cost_ins_tlb_miss_frz++;
+        if (m_ireq.valid) m_stats->cost_ins_tlb_miss_frz++;
 
         // DCACHE FSM signals response by reseting the request flip-flop
         if (not r_icache_tlb_miss_req.read())
@@ -1383,7 +1515,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
             size_t set = r_icache_flush_count.read() % m_icache_sets;
 
 #ifdef INSTRUMENTATION
-            m_cpt_icache_dir_read++;
+            m_stats->cpt_icache_dir_read++;
 #endif
             r_icache.read_dir(way,
                               set,
@@ -1427,7 +1559,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         size_t set = r_icache_miss_set.read();
 
 #ifdef INSTRUMENTATION
-        m_cpt_icache_dir_write++;
+        m_stats->cpt_icache_dir_write++;
 #endif
 
         r_icache.write_dir(way,
@@ -1471,7 +1603,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         {
 
 #ifdef INSTRUMENTATION
-            m_cpt_itlb_read++;
+            m_stats->cpt_itlb_read++;
 #endif
             hit = r_itlb.translate(r_dcache_save_wdata.read(), &paddr);
         }
@@ -1490,7 +1622,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         {
 
 #ifdef INSTRUMENTATION
-            m_cpt_itlb_miss++;
+            m_stats->cpt_itlb_miss++;
 #endif
             r_icache_tlb_miss_req = true;
             r_icache_vaddr_save   = r_dcache_save_wdata.read();
@@ -1509,7 +1641,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         size_t word;
 
 #ifdef INSTRUMENTATION
-        m_cpt_icache_dir_read++;
+        m_stats->cpt_icache_dir_read++;
 #endif
         r_icache.read_dir(r_icache_vci_paddr.read(),
                           &state,
@@ -1537,7 +1669,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         {
 
 #ifdef INSTRUMENTATION
-            m_cpt_icache_dir_write++;
+            m_stats->cpt_icache_dir_write++;
 #endif
             r_icache.write_dir(r_icache_miss_way.read(),
                                r_icache_miss_set.read(),
@@ -1566,7 +1698,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                                    // The r_icache_miss_clack flip-flop is set
                                    // when a cleanup is required
     {
-        if (m_ireq.valid) m_cost_ins_miss_frz++;
+        if (m_ireq.valid) m_stats->cost_ins_miss_frz++;
 
         // coherence clack interrupt
         if (r_icache_clack_req.read())
@@ -1592,7 +1724,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         paddr_t victim;
 
 #ifdef INSTRUMENTATION
-        m_cpt_icache_dir_read++;
+        m_stats->cpt_icache_dir_read++;
 #endif
         r_icache.read_select(r_icache_vci_paddr.read(),
                              &victim,
@@ -1649,10 +1781,10 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
     ///////////////////////
     case ICACHE_MISS_CLEAN:   // switch the slot to zombi state
     {
-        if (m_ireq.valid) m_cost_ins_miss_frz++;
+        if (m_ireq.valid) m_stats->cost_ins_miss_frz++;
 
 #ifdef INSTRUMENTATION
-        m_cpt_icache_dir_write++;
+        m_stats->cpt_icache_dir_write++;
 #endif
         r_icache.write_dir(r_icache_miss_way.read(),
                            r_icache_miss_set.read(),
@@ -1673,7 +1805,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
     //////////////////////
     case ICACHE_MISS_WAIT: // waiting response from VCI_RSP FSM
     {
-        if (m_ireq.valid) m_cost_ins_miss_frz++;
+        if (m_ireq.valid) m_stats->cost_ins_miss_frz++;
 
         // send cleanup victim request
         if (r_icache_cleanup_victim_req.read() and not r_icache_cc_send_req.read())
@@ -1720,13 +1852,13 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
     ///////////////////////////
     case ICACHE_MISS_DATA_UPDT:  // update the cache (one word per cycle)
     {
-        if (m_ireq.valid) m_cost_ins_miss_frz++;
+        if (m_ireq.valid) m_stats->cost_ins_miss_frz++;
 
         if (r_vci_rsp_fifo_icache.rok()) // response available
         {
 
 #ifdef INSTRUMENTATION
-            m_cpt_icache_data_write++;
+            m_stats->cpt_icache_data_write++;
 #endif
             r_icache.write(r_icache_miss_way.read(),
                            r_icache_miss_set.read(),
@@ -1762,7 +1894,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                                 // - If matching coherence request, switch directory slot
                                 //   to ZOMBI state, and send a cleanup request.
     {
-        if (m_ireq.valid ) m_cost_ins_miss_frz++;
+        if (m_ireq.valid ) m_stats->cost_ins_miss_frz++;
 
         // send cleanup victim request
         if (r_icache_cleanup_victim_req.read() and not r_icache_cc_send_req.read())
@@ -1804,7 +1936,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                     r_icache_cc_send_type  = CC_TYPE_CLEANUP;
 
 #ifdef INSTRUMENTATION
-                    m_cpt_icache_dir_write++;
+                    m_stats->cpt_icache_dir_write++;
 #endif
                     r_icache.write_dir(r_icache_vci_paddr.read(),
                                        r_icache_miss_way.read(),
@@ -1828,7 +1960,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
             {
 
 #ifdef INSTRUMENTATION
-                m_cpt_icache_dir_write++;
+                m_stats->cpt_icache_dir_write++;
 #endif
                 r_icache.write_dir(r_icache_vci_paddr.read(),
                                    r_icache_miss_way.read(),
@@ -1908,10 +2040,10 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         if (r_icache_clack_req.read())
         {
 
-            if (m_ireq.valid) m_cost_ins_miss_frz++;
+            if (m_ireq.valid) m_stats->cost_ins_miss_frz++;
 
 #ifdef INSTRUMENTATION
-            m_cpt_icache_dir_write++;
+            m_stats->cpt_icache_dir_write++;
 #endif
             r_icache.write_dir(0,
                                r_icache_clack_way.read(),
@@ -1988,7 +2120,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         size_t word = 0;
 
 #ifdef INSTRUMENTATION
-        m_cpt_icache_dir_read++;
+        m_stats->cpt_icache_dir_read++;
 #endif
         r_icache.read_dir(paddr,
                           &state,
@@ -2040,7 +2172,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                 "must not be set");
 
 #ifdef INSTRUMENTATION
-        m_cpt_icache_dir_read++;
+        m_stats->cpt_icache_dir_read++;
 #endif
 
         // Switch slot state to ZOMBI and send CLEANUP command
@@ -2093,7 +2225,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
             r_icache_cc_word = word + 1;
 
 #ifdef INSTRUMENTATION
-            m_cpt_icache_data_write++;
+            m_stats->cpt_icache_data_write++;
 #endif
 
 #if DEBUG_ICACHE
@@ -2277,7 +2409,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                                            &tlb_way,
                                            &tlb_set);
 #ifdef INSTRUMENTATION
-                m_cpt_dtlb_read++;
+                m_stats->cpt_dtlb_read++;
 #endif
             }
             else // identity mapping
@@ -2306,8 +2438,8 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                                r_dcache_save_wdata.read(),
                                r_dcache_save_be.read());
 #ifdef INSTRUMENTATION
-                m_cpt_dcache_dir_read++;
-                m_cpt_dcache_data_write++;
+                m_stats->cpt_dcache_dir_read++;
+                m_stats->cpt_dcache_data_write++;
 #endif
             }
             else if (m_dreq.valid and not r_dcache_updt_req.read()) // read DIR and DATA
@@ -2320,8 +2452,8 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                               &cache_state);
 
 #ifdef INSTRUMENTATION
-                m_cpt_dcache_dir_read++;
-                m_cpt_dcache_data_read++;
+                m_stats->cpt_dcache_dir_read++;
+                m_stats->cpt_dcache_data_read++;
 #endif
             }
             else if (not m_dreq.valid and r_dcache_updt_req.read()) // write DATA
@@ -2332,7 +2464,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                                r_dcache_save_wdata.read(),
                                r_dcache_save_be.read());
 #ifdef INSTRUMENTATION
-                m_cpt_dcache_data_write++;
+                m_stats->cpt_dcache_data_write++;
 #endif
             }
         } // end dcache access
@@ -2380,7 +2512,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                                     r_dcache_save_wdata.read(),
                                     true);
 #ifdef INSTRUMENTATION
-            m_cpt_wbuf_write++;
+            m_stats->cpt_wbuf_write++;
 #endif
             if (not wok ) // miss if write buffer full
             {
@@ -2765,7 +2897,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                             if (cache_state == CACHE_SLOT_STATE_EMPTY)   // cache miss
                             {
 #ifdef INSTRUMENTATION
-                                m_cpt_dcache_miss++;
+                                m_stats->cpt_dcache_miss++;
 #endif
                                 // request a VCI DMISS transaction
                                 r_dcache_vci_paddr    = paddr;
@@ -2793,7 +2925,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                             else                                      // cache hit
                             {
 #ifdef INSTRUMENTATION
-                                m_cpt_data_read++;
+                                m_stats->cpt_data_read++;
 #endif
                                 // returns data to processor
                                 m_drsp.valid = true;
@@ -2872,7 +3004,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                         else // Write request accepted
                         {
 #ifdef INSTRUMENTATION
-                            m_cpt_data_write++;
+                            m_stats->cpt_data_write++;
 #endif
                             // cleaning llsc buffer if address matching
                             if (paddr == r_dcache_llsc_paddr.read())
@@ -2955,7 +3087,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                         else // SC request accepted
                         {
 #ifdef INSTRUMENTATION
-                            m_cpt_data_sc++;
+                            m_stats->cpt_data_sc++;
 #endif
                             // checking local success
                             if (r_dcache_llsc_valid.read() and
@@ -3082,8 +3214,8 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                       &word,
                       &cache_state);
 #ifdef INSTRUMENTATION
-        m_cpt_dcache_data_read++;
-        m_cpt_dcache_dir_read++;
+        m_stats->cpt_dcache_data_read++;
+        m_stats->cpt_dcache_dir_read++;
 #endif
         if (cache_state == CACHE_SLOT_STATE_VALID)   // hit in dcache
         {
@@ -3215,7 +3347,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                           &way,
                           &set);
 #ifdef INSTRUMENTATION
-            m_cpt_itlb_read++;
+            m_stats->cpt_itlb_read++;
 #endif
         }
         else
@@ -3225,7 +3357,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                           &way,
                           &set);
 #ifdef INSTRUMENTATION
-            m_cpt_dtlb_read++;
+            m_stats->cpt_dtlb_read++;
 #endif
         }
         r_dcache_tlb_way = way;
@@ -3301,7 +3433,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                              r_dcache_tlb_set.read(),
                              nline);
 #ifdef INSTRUMENTATION
-                m_cpt_itlb_write++;
+                m_stats->cpt_itlb_write++;
 #endif
 
 #if DEBUG_DCACHE
@@ -3325,7 +3457,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                              r_dcache_tlb_set.read(),
                              nline);
 #ifdef INSTRUMENTATION
-                m_cpt_dtlb_write++;
+                m_stats->cpt_dtlb_write++;
 #endif
 
 #if DEBUG_DCACHE
@@ -3390,8 +3522,8 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                       &word,
                       &cache_state);
 #ifdef INSTRUMENTATION
-        m_cpt_dcache_data_read++;
-        m_cpt_dcache_dir_read++;
+        m_stats->cpt_dcache_data_read++;
+        m_stats->cpt_dcache_dir_read++;
 #endif
         if (cache_state == CACHE_SLOT_STATE_VALID) // hit in dcache
         {
@@ -3490,7 +3622,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                           &way,
                           &set);
 #ifdef INSTRUMENTATION
-            m_cpt_itlb_read++;
+            m_stats->cpt_itlb_read++;
 #endif
         }
         else
@@ -3500,7 +3632,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                           &way,
                           &set);
 #ifdef INSTRUMENTATION
-            m_cpt_dtlb_read++;
+            m_stats->cpt_dtlb_read++;
 #endif
         }
 
@@ -3577,7 +3709,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                               r_dcache_tlb_set.read(),
                               nline );
 #ifdef INSTRUMENTATION
-                m_cpt_itlb_write++;
+                m_stats->cpt_itlb_write++;
 #endif
 
 #if DEBUG_DCACHE
@@ -3601,7 +3733,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                              r_dcache_tlb_set.read(),
                              nline);
 #ifdef INSTRUMENTATION
-                m_cpt_dtlb_write++;
+                m_stats->cpt_dtlb_write++;
 #endif
 
 #if DEBUG_DCACHE
@@ -3859,7 +3991,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
             size_t  set = r_dcache_flush_count.read() % m_dcache_sets;
 
 #ifdef INSTRUMENTATION
-            m_cpt_dcache_dir_read++;
+            m_stats->cpt_dcache_dir_read++;
 #endif
             r_dcache.read_dir(way,
                               set,
@@ -3906,7 +4038,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         r_dcache_contains_ptd[m_dcache_sets * way + set] = false;
 
 #ifdef INSTRUMENTATION
-        m_cpt_dcache_dir_write++;
+        m_stats->cpt_dcache_dir_write++;
 #endif
         r_dcache.write_dir(way,
                            set,
@@ -3946,7 +4078,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         {
 
 #ifdef INSTRUMENTATION
-            m_cpt_dtlb_read++;
+            m_stats->cpt_dtlb_read++;
 #endif
             hit = r_dtlb.translate(r_dcache_save_wdata.read(),
                                    &paddr);
@@ -3968,7 +4100,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         {
 
 #ifdef INSTRUMENTATION
-            m_cpt_dtlb_miss++;
+            m_stats->cpt_dtlb_miss++;
 #endif
             r_dcache_tlb_ins   = false; // dtlb
             r_dcache_tlb_vaddr = r_dcache_save_wdata.read();
@@ -3998,7 +4130,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         int    state;
 
 #ifdef INSTRUMENTATION
-        m_cpt_dcache_dir_read++;
+        m_stats->cpt_dcache_dir_read++;
 #endif
         r_dcache.read_dir(r_dcache_save_paddr.read(),
                           &state,
@@ -4043,7 +4175,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
             paddr_t nline = r_dcache_save_paddr.read() / (m_dcache_words << 2);
 
 #ifdef INSTRUMENTATION
-            m_cpt_dcache_dir_write++;
+            m_stats->cpt_dcache_dir_write++;
 #endif
             r_dcache.write_dir(way,
                                set,
@@ -4107,7 +4239,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                                    // The r_icache_miss_clack flip-flop is set
                                    // when a cleanup is required
     {
-        if (m_dreq.valid) m_cost_data_miss_frz++;
+        if (m_dreq.valid) m_stats->cost_data_miss_frz++;
 
         // coherence clack request (from DSPIN CLACK)
         if (r_dcache_clack_req.read())
@@ -4132,7 +4264,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         paddr_t victim = 0;
 
 #ifdef INSTRUMENTATION
-        m_cpt_dcache_dir_read++;
+        m_stats->cpt_dcache_dir_read++;
 #endif
         r_dcache.read_select(r_dcache_save_paddr.read(),
                              &victim,
@@ -4193,13 +4325,13 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
     case DCACHE_MISS_CLEAN:     // switch the slot to ZOMBI state
                                 // and possibly request itlb or dtlb invalidate
     {
-        if (m_dreq.valid) m_cost_data_miss_frz++;
+        if (m_dreq.valid) m_stats->cost_data_miss_frz++;
 
         size_t way = r_dcache_miss_way.read();
         size_t set = r_dcache_miss_set.read();
 
 #ifdef INSTRUMENTATION
-        m_cpt_dcache_dir_read++;
+        m_stats->cpt_dcache_dir_read++;
 #endif
         r_dcache.write_dir(way,
                            set,
@@ -4246,7 +4378,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                             // This state is in charge of error signaling
                             // There is 5 types of error depending on the requester
     {
-        if (m_dreq.valid) m_cost_data_miss_frz++;
+        if (m_dreq.valid) m_stats->cost_data_miss_frz++;
 
         // send cleanup victim request
         if (r_dcache_cleanup_victim_req.read() and not r_dcache_cc_send_req.read())
@@ -4340,12 +4472,12 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
     //////////////////////////
     case DCACHE_MISS_DATA_UPDT:  // update the dcache (one word per cycle)
     {
-        if (m_dreq.valid) m_cost_data_miss_frz++;
+        if (m_dreq.valid) m_stats->cost_data_miss_frz++;
 
         if (r_vci_rsp_fifo_dcache.rok()) // one word available
         {
 #ifdef INSTRUMENTATION
-            m_cpt_dcache_data_write++;
+            m_stats->cpt_dcache_data_write++;
 #endif
             r_dcache.write(r_dcache_miss_way.read(),
                                r_dcache_miss_set.read(),
@@ -4381,7 +4513,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                                 // - If matching coherence request, switch directory slot
                                 //   to ZOMBI state, and send a cleanup request.
     {
-        if (m_dreq.valid) m_cost_data_miss_frz++;
+        if (m_dreq.valid) m_stats->cost_data_miss_frz++;
 
         // send cleanup victim request
         if (r_dcache_cleanup_victim_req.read() and not r_dcache_cc_send_req.read())
@@ -4425,7 +4557,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
                     r_dcache_cc_send_type  = CC_TYPE_CLEANUP;
 
 #ifdef INSTRUMENTATION
-                    m_cpt_dcache_dir_write++;
+                    m_stats->cpt_dcache_dir_write++;
 #endif
                     r_dcache.write_dir( r_dcache_save_paddr.read(),
                                         r_dcache_miss_way.read(),
@@ -4447,7 +4579,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
             {
 
 #ifdef INSTRUMENTATION
-                m_cpt_dcache_dir_write++;
+                m_stats->cpt_dcache_dir_write++;
 #endif
                 r_dcache.write_dir(r_dcache_save_paddr.read(),
                                    r_dcache_miss_way.read(),
@@ -4631,8 +4763,8 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         int      state;
 
 #ifdef INSTRUMENTATION
-        m_cpt_dcache_data_read++;
-        m_cpt_dcache_dir_read++;
+        m_stats->cpt_dcache_data_read++;
+        m_stats->cpt_dcache_dir_read++;
 #endif
         r_dcache.read(r_dcache_dirty_paddr.read(),
                       &pte,
@@ -4734,10 +4866,10 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         // r_dcache_miss_clack if the cleanup ack is matching a pending miss.
         if (r_dcache_clack_req.read())
         {
-            if (m_dreq.valid ) m_cost_data_miss_frz++;
+            if (m_dreq.valid ) m_stats->cost_data_miss_frz++;
 
 #ifdef INSTRUMENTATION
-            m_cpt_dcache_dir_write++;
+            m_stats->cpt_dcache_dir_write++;
 #endif
             r_dcache.write_dir(0,
                                r_dcache_clack_way.read(),
@@ -4816,7 +4948,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         size_t word  = 0;
 
 #ifdef INSTRUMENTATION
-        m_cpt_dcache_dir_read++;
+        m_stats->cpt_dcache_dir_read++;
 #endif
         r_dcache.read_dir(paddr,
                           &state,
@@ -4977,7 +5109,7 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
         {
 
 #ifdef INSTRUMENTATION
-            m_cpt_dcache_data_write++;
+            m_stats->cpt_dcache_data_write++;
 #endif
             r_dcache.write(way,
                            set,
@@ -5095,13 +5227,13 @@ std::cout << "  <PROC " << name() << " ICACHE_IDLE> MMU Executable Violation"
     // is larger than the m_max_frozen_cycles (constructor parameter)
     if ((m_ireq.valid and not m_irsp.valid) or (m_dreq.valid and not m_drsp.valid))
     {
-        m_cpt_frz_cycles++;      // used for instrumentation
+        m_stats->cpt_frz_cycles++;      // used for instrumentation
         m_cpt_stop_simulation++; // used for debug
         if (m_cpt_stop_simulation > m_max_frozen_cycles)
         {
             std::cout << std::dec << "ERROR in CC_VCACHE_WRAPPER " << name() << std::endl
-                      << " stop at cycle " << m_cpt_total_cycles << std::endl
-                      << " frozen since cycle " << m_cpt_total_cycles - m_max_frozen_cycles
+                      << " stop at cycle " << m_stats->cpt_total_cycles << std::endl
+                      << " frozen since cycle " << m_stats->cpt_total_cycles - m_max_frozen_cycles
                       << std::endl;
                       r_iss.dump();
             r_wbuf.printTrace();
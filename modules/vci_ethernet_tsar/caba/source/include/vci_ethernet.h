@@ -34,12 +34,7 @@
 #include <stdint.h>
 #include <systemc>
 
-#include <linux/if_tun.h>
-#include <sys/ioctl.h>
-#include <sys/socket.h>
-#include <net/if.h>
-#include <netinet/in.h>
-
+#include "vci_ethernet_io.h"
 #include "vci_target_fsm.h"
 #include "vci_initiator_fsm.h"
 #include "caba_base_module.h"
@@ -93,8 +88,6 @@ private:
     int _tx_done;     //< number of tx buffers ready to pop
     int _tx_count;    //< total number of tx buffers
 
-    int _link_check_counter;
-
     bool _dma_busy;
     bool _link_up;
     bool _link_changed;
@@ -110,11 +103,9 @@ private:
     bool _link_irq_en;
     bool _soft_reset;
 
-	int _fd;
+    EthernetIo _io;   //< host side (TAP interface or pcap file)
     uint8_t _mac[6];
 
-    struct ifreq _tap_ifr;
-
 	inline void ended(int status);
 
 protected:
@@ -129,7 +120,7 @@ public:
 
 	VciEthernet(sc_module_name name, const soclib::common::MappingTable &mt,
                 const soclib::common::IntTab &srcid, const soclib::common::IntTab &tgtid,
-                const std::string &if_name = "soclib0");
+                const std::string &if_name = "soclib0");  // or "pcap:<rx_file>[:<tx_file>]"
 
 	~VciEthernet();
 };
@@ -0,0 +1,637 @@
+/* -*- c++ -*-
+ *
+ * SOCLIB_LGPL_HEADER_BEGIN
+ *
+ * This file is part of SoCLib, GNU LGPLv2.1.
+ *
+ * SoCLib is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; version 2.1 of the License.
+ *
+ * SoCLib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with SoCLib; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * SOCLIB_LGPL_HEADER_END
+ */
+
+#ifndef SOCLIB_VCI_ETHERNET_IO_H
+#define SOCLIB_VCI_ETHERNET_IO_H
+
+#include <stdint.h>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <linux/if_tun.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <netinet/in.h>
+
+namespace soclib {
+namespace caba {
+
+////////////////////////////////////////////////////////////////////////
+// The EthernetIo object contains the host side of the VciEthernet
+// controller. With a TAP interface, the frames are exchanged with the
+// simulation through two lock-free rings (single producer / single
+// consumer):
+// - the RX ring is filled by a background I/O thread,
+//   and emptied by the transition() function,
+// - the TX ring is filled by the transition() function,
+//   and drained by the background I/O thread.
+// The simulation thread only accesses memory, except for one eventfd
+// write per transmitted frame (to wake up the I/O thread).
+//
+// Two backends are supported, depending on the interface name:
+// - "<ifname>" : a TAP interface (requires the CAP_NET_ADMIN capability).
+//   The I/O thread waits on the TAP file descriptor (epoll), and checks
+//   the interface status every ETHERNET_IO_LINK_PERIOD milliseconds.
+//   A TAP read error is reported once, and the link is down until a read
+//   succeeds again (the read is retried at each interface status check).
+// - "pcap:<rx_file>[:<tx_file>]" : the received frames are replayed from
+//   a pcap capture file, and the transmitted frames are dropped, or
+//   written in a pcap capture file. There is no I/O thread : the next
+//   record is read by the receive() function, and written by the send()
+//   function, so that a replay is reproducible (the frame arrival only
+//   depends on the simulated cycle). The link is always up.
+////////////////////////////////////////////////////////////////////////
+
+#define ETHERNET_IO_RING_SIZE   16      // must be a power of 2
+#define ETHERNET_IO_FRAME_SIZE  2048    // max frame size (bytes)
+#define ETHERNET_IO_LINK_PERIOD 100     // link status check period (ms)
+
+class EthernetIo
+{
+    /////////////////////////////////////////////////////////////////////
+    // A frame
+    /////////////////////////////////////////////////////////////////////
+    struct Frame
+    {
+        int32_t size;
+        uint8_t data[ETHERNET_IO_FRAME_SIZE];
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // A lock-free ring of frames
+    // The head and tail are free running counters : head is only written
+    // by the producer, and tail is only written by the consumer.
+    /////////////////////////////////////////////////////////////////////
+    struct FrameRing
+    {
+        Frame             slots[ETHERNET_IO_RING_SIZE];
+        volatile uint32_t head;
+        volatile uint32_t tail;
+
+        void init()
+        {
+            head = 0;
+            tail = 0;
+        }
+
+        // producer side : free slot (NULL if the ring is full)
+        Frame * back()
+        {
+            if (head - tail == ETHERNET_IO_RING_SIZE) return NULL;
+            __sync_synchronize();
+            return &slots[head % ETHERNET_IO_RING_SIZE];
+        }
+
+        void push()
+        {
+            __sync_synchronize();
+            head = head + 1;
+        }
+
+        // consumer side : oldest frame (NULL if the ring is empty)
+        Frame * front()
+        {
+            if (head == tail) return NULL;
+            __sync_synchronize();
+            return &slots[tail % ETHERNET_IO_RING_SIZE];
+        }
+
+        void pop()
+        {
+            __sync_synchronize();
+            tail = tail + 1;
+        }
+    };
+
+    /////////////////////////////////////////////////////////////////////
+    // pcap file headers
+    /////////////////////////////////////////////////////////////////////
+    struct PcapHeader
+    {
+        uint32_t magic;
+        uint16_t version_major;
+        uint16_t version_minor;
+        int32_t  thiszone;
+        uint32_t sigfigs;
+        uint32_t snaplen;
+        uint32_t linktype;
+    };
+
+    struct PcapRecord
+    {
+        uint32_t ts_sec;
+        uint32_t ts_usec;
+        uint32_t caplen;
+        uint32_t len;
+    };
+
+    const std::string   m_name;
+
+    FrameRing           m_rx_ring;
+    FrameRing           m_tx_ring;
+
+    int                 m_tap_fd;       // TAP device (-1 if not used)
+    int                 m_sock;         // socket for the link status check
+    struct ifreq        m_tap_ifr;
+    FILE *              m_pcap_rx;      // replayed capture (NULL if not used)
+    FILE *              m_pcap_tx;      // transmitted frames (NULL if not used)
+    bool                m_pcap_swap;    // replayed capture byte order
+    bool                m_pcap_eof;     // end of the replayed capture
+
+    int                 m_event_fd;     // wake up of the I/O thread
+    int                 m_epoll_fd;
+    bool                m_tap_armed;    // TAP fd in the epoll set
+    pthread_t           m_thread;
+    bool                m_running;      // I/O thread started
+    bool                m_ready;        // backend operational
+
+    volatile bool       m_stop;         // I/O thread termination request
+    volatile bool       m_link_up;      // written by the I/O thread
+    bool                m_rx_error;     // last TAP read failed
+    volatile bool       m_rx_stalled;   // I/O thread waiting for a free RX slot
+
+    EthernetIo(const EthernetIo &);
+    EthernetIo & operator=(const EthernetIo &);
+
+    static uint32_t swap32(uint32_t v)
+    {
+        return ((v >> 24) & 0xFF) | ((v >> 8) & 0xFF00) |
+               ((v << 8) & 0xFF0000) | (v << 24);
+    }
+
+    static uint64_t now_ms()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The wakeup() function wakes up the I/O thread
+    /////////////////////////////////////////////////////////////////////
+    void wakeup()
+    {
+        uint64_t one = 1;
+        if (::write(m_event_fd, &one, sizeof(one)) < 0) { /* already pending */ }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The open_tap() function configures the TAP interface
+    /////////////////////////////////////////////////////////////////////
+    bool open_tap(const std::string &if_name)
+    {
+        m_tap_fd = open("/dev/net/tun", O_RDWR);
+
+        if (m_tap_fd < 0) {
+            std::cerr << m_name << ": Unable to open /dev/net/tun" << std::endl;
+            return false;
+        }
+
+        int flags = fcntl(m_tap_fd, F_GETFL, 0);
+        fcntl(m_tap_fd, F_SETFL, flags | O_NONBLOCK);
+
+        memset((void*)&m_tap_ifr, 0, sizeof(m_tap_ifr));
+        m_tap_ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+        strncpy(m_tap_ifr.ifr_name, if_name.c_str(), IFNAMSIZ);
+
+        if (ioctl(m_tap_fd, TUNSETIFF, (void *) &m_tap_ifr) < 0) {
+            close(m_tap_fd);
+            m_tap_fd = -1;
+            std::cerr << m_name << ": Unable to setup tap interface, check privileges."
+#ifdef __linux__
+                << " (try: sudo setcap cap_net_admin=eip ./system.x)"
+#endif
+                << std::endl;
+            return false;
+        }
+        flags = 2;
+        if (ioctl(m_tap_fd, TUNSETDEBUG, (void *) &flags) < 0) {
+            std::cerr << "Warning couldn't use debug option for TAP" << std::endl;
+        }
+
+        m_sock = socket(AF_INET, SOCK_DGRAM, 0);
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The open_pcap() function opens the capture files
+    // The spec argument is "<rx_file>[:<tx_file>]"
+    /////////////////////////////////////////////////////////////////////
+    bool open_pcap(const std::string &spec)
+    {
+        std::string rx_file = spec;
+        std::string tx_file;
+        size_t      sep     = spec.find(':');
+
+        if (sep != std::string::npos) {
+            rx_file = spec.substr(0, sep);
+            tx_file = spec.substr(sep + 1);
+        }
+
+        PcapHeader header;
+
+        m_pcap_rx = fopen(rx_file.c_str(), "rb");
+        if (m_pcap_rx == NULL or
+            fread(&header, sizeof(header), 1, m_pcap_rx) != 1) {
+            std::cerr << m_name << ": Unable to read pcap file " << rx_file << std::endl;
+            return false;
+        }
+
+        if (header.magic == 0xa1b2c3d4 or header.magic == 0xa1b23c4d) {
+            m_pcap_swap = false;
+        } else if (header.magic == 0xd4c3b2a1 or header.magic == 0x4d3cb2a1) {
+            m_pcap_swap = true;
+        } else {
+            std::cerr << m_name << ": Bad pcap file " << rx_file << std::endl;
+            return false;
+        }
+
+        uint32_t linktype = m_pcap_swap ? swap32(header.linktype) : header.linktype;
+        if (linktype != 1) {
+            std::cerr << m_name << ": pcap file " << rx_file
+                << " is not an ethernet capture" << std::endl;
+            return false;
+        }
+
+        if (tx_file.empty()) return true;
+
+        m_pcap_tx = fopen(tx_file.c_str(), "wb");
+        if (m_pcap_tx == NULL) {
+            std::cerr << m_name << ": Unable to create pcap file " << tx_file << std::endl;
+            return false;
+        }
+
+        header.magic         = 0xa1b2c3d4;
+        header.version_major = 2;
+        header.version_minor = 4;
+        header.thiszone      = 0;
+        header.sigfigs       = 0;
+        header.snaplen       = ETHERNET_IO_FRAME_SIZE;
+        header.linktype      = 1;
+        fwrite(&header, sizeof(header), 1, m_pcap_tx);
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The check_link() function updates the link status
+    /////////////////////////////////////////////////////////////////////
+    void check_link()
+    {
+        if (m_sock < 0) return;
+
+        if (ioctl(m_sock, SIOCGIFFLAGS, &m_tap_ifr) < 0) {
+            std::cout << m_name << ": link status check error: " << m_tap_ifr.ifr_flags << std::endl;
+        } else {
+            m_link_up = !!(m_tap_ifr.ifr_flags & IFF_UP) and !m_rx_error;
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The receive_frame() function reads the next TAP frame
+    // into the RX ring slot. It returns false if there is no frame.
+    /////////////////////////////////////////////////////////////////////
+    bool receive_frame(Frame *f)
+    {
+        int rd;
+        do {
+            rd = ::read(m_tap_fd, f->data, ETHERNET_IO_FRAME_SIZE);
+        } while (rd < 0 && errno == EINTR);
+
+        if (rd < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return false;
+        if (rd < 0) {
+            if (!m_rx_error) {
+                std::cout << m_name << ": RX tap read error: " << strerror(errno)
+                          << ", link down" << std::endl;
+                m_rx_error = true;
+                m_link_up  = false;
+            }
+            return false;
+        }
+        if (rd == 0) return false;
+        if (m_rx_error) {
+            std::cout << m_name << ": RX tap read recovered" << std::endl;
+            m_rx_error = false;
+            check_link();
+        }
+        f->size = rd;
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The read_pcap() function reads the next record of the replayed
+    // capture in the buffer (truncated to size bytes). It returns the
+    // number of copied bytes, or 0 at the end of the capture.
+    /////////////////////////////////////////////////////////////////////
+    int read_pcap(uint8_t *buffer, uint32_t size)
+    {
+        if (m_pcap_eof) return 0;
+
+        PcapRecord record;
+
+        if (fread(&record, sizeof(record), 1, m_pcap_rx) != 1) {
+            m_pcap_eof = true;
+            return 0;
+        }
+
+        uint32_t caplen = m_pcap_swap ? swap32(record.caplen) : record.caplen;
+        uint32_t length = std::min(caplen, size);
+
+        if (fread(buffer, 1, length, m_pcap_rx) != length) {
+            m_pcap_eof = true;
+            return 0;
+        }
+        if (caplen > length) fseek(m_pcap_rx, caplen - length, SEEK_CUR);
+
+        return length;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The write_pcap() function writes a transmitted frame
+    // in the TX capture (if any)
+    /////////////////////////////////////////////////////////////////////
+    void write_pcap(const uint8_t *data, uint32_t size)
+    {
+        if (m_pcap_tx == NULL) return;
+
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+
+        PcapRecord record;
+        record.ts_sec  = tv.tv_sec;
+        record.ts_usec = tv.tv_usec;
+        record.caplen  = size;
+        record.len     = size;
+        fwrite(&record, sizeof(record), 1, m_pcap_tx);
+        fwrite(data, 1, size, m_pcap_tx);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The send_frame() function transmits a frame from the TX ring
+    /////////////////////////////////////////////////////////////////////
+    void send_frame(const Frame *f)
+    {
+        if (::write(m_tap_fd, f->data, f->size) != f->size) {
+            std::cout << m_name << ": TX tap write error" << std::endl;
+            check_link();
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The arm_tap() function adds (or removes) the TAP file descriptor
+    // in the epoll set, depending on the RX ring state.
+    /////////////////////////////////////////////////////////////////////
+    void arm_tap(bool arm)
+    {
+        if (m_tap_fd < 0 or arm == m_tap_armed) return;
+
+        struct epoll_event ev;
+        ev.events  = EPOLLIN;
+        ev.data.fd = m_tap_fd;
+        epoll_ctl(m_epoll_fd, arm ? EPOLL_CTL_ADD : EPOLL_CTL_DEL, m_tap_fd, &ev);
+        m_tap_armed = arm;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The I/O thread main loop
+    /////////////////////////////////////////////////////////////////////
+    void run()
+    {
+        uint64_t next_check = 0;
+
+        while (!m_stop) {
+            // link status check
+            bool check = false;
+            if (now_ms() >= next_check) {
+                check_link();
+                next_check = now_ms() + ETHERNET_IO_LINK_PERIOD;
+                check      = true;
+            }
+
+            // drain the TX ring
+            Frame *f;
+            while ((f = m_tx_ring.front()) != NULL) {
+                send_frame(f);
+                m_tx_ring.pop();
+            }
+
+            // fill the RX ring (after a read error, only at the status check)
+            bool stalled = false;
+            while (!m_rx_error or check) {
+                check = false;
+                f = m_rx_ring.back();
+                if (f == NULL) {
+                    // the consumer can free a slot between the test and
+                    // the m_rx_stalled update : test again after the update
+                    m_rx_stalled = true;
+                    __sync_synchronize();
+                    if ((f = m_rx_ring.back()) == NULL) {
+                        stalled = true;
+                        break;
+                    }
+                    m_rx_stalled = false;
+                }
+                if (!receive_frame(f)) break;
+                m_rx_ring.push();
+            }
+            if (!stalled) m_rx_stalled = false;
+
+            // wait for an event (new frame, or TX frame / free RX slot)
+            arm_tap(!stalled and !m_rx_error);
+
+            struct epoll_event events[2];
+            int n = epoll_wait(m_epoll_fd, events, 2, ETHERNET_IO_LINK_PERIOD);
+
+            for (int i = 0; i < n; i++) {
+                if (events[i].data.fd == m_event_fd) {
+                    uint64_t count;
+                    if (::read(m_event_fd, &count, sizeof(count)) < 0) { /* EAGAIN */ }
+                }
+            }
+        }
+    }
+
+    static void * thread_entry(void *arg)
+    {
+        ((EthernetIo *)arg)->run();
+        return NULL;
+    }
+
+public:
+
+    /////////////////////////////////////////////////////////////////////
+    // Constructor : opens the backend and starts the I/O thread
+    // (TAP backend only)
+    /////////////////////////////////////////////////////////////////////
+    EthernetIo(const std::string &name, const std::string &if_name)
+        : m_name(name),
+          m_tap_fd(-1),
+          m_sock(-1),
+          m_pcap_rx(NULL),
+          m_pcap_tx(NULL),
+          m_pcap_swap(false),
+          m_pcap_eof(false),
+          m_event_fd(-1),
+          m_epoll_fd(-1),
+          m_tap_armed(false),
+          m_running(false),
+          m_ready(false),
+          m_stop(false),
+          m_link_up(false),
+          m_rx_error(false),
+          m_rx_stalled(false)
+    {
+        m_rx_ring.init();
+        m_tx_ring.init();
+
+        if (if_name.compare(0, 5, "pcap:") == 0) {
+            m_ready   = open_pcap(if_name.substr(5));
+            m_link_up = m_ready;
+            return;
+        }
+        if (!open_tap(if_name)) return;
+
+        m_event_fd = eventfd(0, EFD_NONBLOCK);
+        m_epoll_fd = epoll_create(2);
+
+        struct epoll_event ev;
+        ev.events  = EPOLLIN;
+        ev.data.fd = m_event_fd;
+        epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_event_fd, &ev);
+
+        if (pthread_create(&m_thread, NULL, thread_entry, this) != 0) {
+            std::cerr << m_name << ": Unable to start the I/O thread" << std::endl;
+            return;
+        }
+        m_running = true;
+        m_ready   = true;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // Destructor : stops the I/O thread and closes the backend
+    /////////////////////////////////////////////////////////////////////
+    ~EthernetIo()
+    {
+        if (m_running) {
+            m_stop = true;
+            wakeup();
+            pthread_join(m_thread, NULL);
+        }
+
+        if (m_epoll_fd >= 0) close(m_epoll_fd);
+        if (m_event_fd >= 0) close(m_event_fd);
+        if (m_sock >= 0)     close(m_sock);
+        if (m_tap_fd >= 0)   close(m_tap_fd);
+        if (m_pcap_rx)       fclose(m_pcap_rx);
+        if (m_pcap_tx)       fclose(m_pcap_tx);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The ready() function returns true if the backend is operational
+    /////////////////////////////////////////////////////////////////////
+    bool ready() const
+    {
+        return m_ready;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The link_up() function returns the last known link status
+    /////////////////////////////////////////////////////////////////////
+    bool link_up() const
+    {
+        return m_ready and m_link_up;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The receive() function copies the oldest received frame
+    // in the buffer (truncated to size bytes). It returns :
+    // - the number of copied bytes,
+    // - 0 if there is no received frame.
+    /////////////////////////////////////////////////////////////////////
+    int receive(uint8_t *buffer, uint32_t size)
+    {
+        if (m_pcap_rx) return read_pcap(buffer, size);
+
+        Frame *f = m_rx_ring.front();
+        if (f == NULL) return 0;
+
+        int rd = f->size;
+        if (rd > (int)size) rd = size;
+        if (rd > 0) memcpy(buffer, f->data, rd);
+        m_rx_ring.pop();
+
+        __sync_synchronize();
+        if (m_rx_stalled) wakeup();
+
+        return rd;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The send() function posts a frame in the TX ring.
+    // It returns false if the frame cannot be transmitted.
+    /////////////////////////////////////////////////////////////////////
+    bool send(const uint8_t *data, uint32_t size)
+    {
+        if (!m_ready or size > ETHERNET_IO_FRAME_SIZE) return false;
+
+        if (m_pcap_rx) {
+            write_pcap(data, size);
+            return true;
+        }
+
+        Frame *f = m_tx_ring.back();
+        if (f == NULL) return false;
+
+        memcpy(f->data, data, size);
+        f->size = size;
+        m_tx_ring.push();
+        wakeup();
+
+        return true;
+    }
+};
+
+}}
+
+#endif /* SOCLIB_VCI_ETHERNET_IO_H */
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
+
@@ -252,10 +252,9 @@ namespace soclib { namespace caba {
 #endif
             f->status = ETHERNET_TX_DONE;
 
-            if (!_link_up || ::write(_fd, f->data, f->size) != f->size) {
+            if (!_link_up || !_io.send(f->data, f->size)) {
                 std::cout << name() << ": TX tap write error for packet @" << f->addr << std::endl;
                 f->status = ETHERNET_TX_PHY_ERR;
-                _link_check_counter = 1;
             }
 
             _tx_done++;
@@ -295,29 +294,18 @@ namespace soclib { namespace caba {
             _rx_start = _rx_free = _rx_done = _rx_count = 0;
             _tx_start = _tx_waiting = _tx_done = _tx_count = 0;
             _rx_irq_en = _tx_irq_en = _link_irq_en = false;        
-            _link_check_counter = 1;
             _link_changed = _link_up = false;
             _dma_busy = false;
             return;
         }
 
-        if (_fd >= 0 && --_link_check_counter <= 0) {
-            _link_check_counter = 100000;
-
-            int sock = socket(AF_INET, SOCK_DGRAM, 0);
-
-            if (sock >= 0) {
-                if (ioctl(sock, SIOCGIFFLAGS, &_tap_ifr) < 0) {
-                    std::cout << name() << ": link status check error: " << _tap_ifr.ifr_flags << std::endl;
-                } else if (_link_up != !!(_tap_ifr.ifr_flags & IFF_UP)) {
-                    _link_up = !_link_up;
-                    _link_changed = true;
+        // the link status is updated by the I/O thread
+        if (_link_up != _io.link_up()) {
+            _link_up = !_link_up;
+            _link_changed = true;
 #ifdef SOCLIB_MODULE_DEBUG
-                    std::cout << name() << ": link status changed to: " << (_link_up ? "up" : "down") << std::endl;
+            std::cout << name() << ": link status changed to: " << (_link_up ? "up" : "down") << std::endl;
 #endif
-                }
-                close(sock);
-            }
         }
 
         if (!_dma_busy) {
@@ -343,15 +331,9 @@ namespace soclib { namespace caba {
             } else if (_rx_free > 0 && _link_up) {
 
                 fifo_entry_t *f = _rx_fifo + (_rx_start + _rx_count - _rx_free) % VCI_ETHERNET_FIFO_SIZE;
-                int rd = ::read(_fd, f->data, f->size);
+                int rd = _io.receive(f->data, f->size);
 
-                if (rd < 0 && errno != EAGAIN) {
-                    f->status = ETHERNET_RX_PHY_ERR;
-                    _rx_done++;
-                    std::cout << name() << ": tap read error on RX" << std::endl;
-                    _link_check_counter = 1;
-
-                }  else if (rd > 0) {
+                if (rd > 0) {
                     if (_rx_free > 0) {
                         f->size = rd;
                         _rx_free--;
@@ -397,6 +379,7 @@ namespace soclib { namespace caba {
         : caba::BaseModule(name),
         m_vci_target_fsm(p_vci_target, mt.getSegmentList(tgtid)),
         m_vci_init_fsm(p_vci_initiator, mt.indexForId(srcid)),
+        _io((const char *)name, if_name),
         p_clk("clk"),
         p_resetn("resetn"),
         p_vci_target("vci_target"),
@@ -404,35 +387,8 @@ namespace soclib { namespace caba {
         p_irq("irq")
     {
         m_vci_target_fsm.on_read_write(on_read, on_write);
-        _fd = open("/dev/net/tun", O_RDWR);
-
-        if ( _fd < 0 ) {
-            std::cerr << name << ": Unable to open /dev/net/tun" << std::endl;
-        } else {
-            int flags = fcntl(_fd, F_GETFL, 0);
-            fcntl(_fd, F_SETFL, flags | O_NONBLOCK);
 
-            memset((void*)&_tap_ifr, 0, sizeof(_tap_ifr));
-            _tap_ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
-            strncpy(_tap_ifr.ifr_name, if_name.c_str(), IFNAMSIZ);
-
-
-            if (ioctl(_fd, TUNSETIFF, (void *) &_tap_ifr) < 0) {
-                close(_fd);
-                _fd = -1;
-                std::cerr << name << ": Unable to setup tap interface, check privileges."
-#ifdef __linux__
-                    << " (try: sudo setcap cap_net_admin=eip ./system.x)"
-#endif
-                    << std::endl;
-            }
-            flags = 2;
-            if (ioctl(_fd, TUNSETDEBUG, (void *) &flags) < 0) {
-                std::cerr << "Warning couldn't use debug option for TAP" << std::endl;
-            }
-
-        /*    ioctl(_fd, SIOCGIFHWADDR, &_tap_ifr);
-            memcpy(_mac, _tap_ifr.ifr_hwaddr.sa_data, 6);*/
+        if (_io.ready()) {
               srand(time(0) * getpid());
                 _mac[0] = 0x00;
                 _mac[1] = 0x16;
@@ -442,7 +398,6 @@ namespace soclib { namespace caba {
                 _mac[5] = rand();
         }
 
-        _link_check_counter = 1;
         _rx_start = _rx_free = _rx_done = _rx_count = 0;
         _tx_start = _tx_waiting = _tx_done = _tx_count = 0;
         _dma_busy = false;
@@ -460,9 +415,6 @@ namespace soclib { namespace caba {
     tmpl(/**/)::~VciEthernet()
     {
         cleanup_fifos();
-
-        if (_fd >= 0)
-            close(_fd);
     }
 
 }}
@@ -5,30 +5,13 @@
 #include <systemc>
 #include <cassert>
 #include <cstring>
+#include <vector>
 #include "arithmetics.h"
 
-//#define RANDOM_EVICTION
-
 namespace soclib { namespace caba {
 
 using namespace sc_core;
 
-////////////////////////////////////////////////////////////////////////
-//                    A LRU entry 
-////////////////////////////////////////////////////////////////////////
-class LruEntry {
-
-    public:
-
-        bool recent;            
-
-        void init()
-        {
-            recent = false;
-        }
-
-}; // end class LruEntry
-
 ////////////////////////////////////////////////////////////////////////
 //                    An Owner
 ////////////////////////////////////////////////////////////////////////
@@ -153,15 +136,276 @@ class DirectoryEntry {
 
 }; // end class DirectoryEntry
 
+////////////////////////////////////////////////////////////////////////
+//                 The directory replacement policies
+// A replacement policy is the template parameter of the CacheDirectory.
+// It keeps its own per set state (bit fields packed in 64 bits words,
+// as a set contains at most 64 ways), and provides :
+// - init(ways, sets)      : allocation and reset of the state,
+// - reset()               : reset of the state,
+// - access(set, way)      : update on a read hit,
+// - write(set, way, fill) : update on a write (fill is true when a new
+//                           line is written in the way),
+// - victims(set)          : bit-vector of the ways that can be evinced
+//                           (the CacheDirectory selects the lowest way
+//                           that is not locked).
+////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
+// Bit PLRU : one recent bit per way. A read hit sets the recent bit,
+// and a write sets it, or resets the recent bits of the set when all
+// other ways are recent. The victims are the not recent ways.
+// This is the default policy.
+////////////////////////////////////////////////////////////////////////
+class BitPlruReplacement
+{
+    std::vector<uint64_t> m_recent;     // recent bits (one word per set)
+    uint64_t              m_ways_mask;
+
+    public:
+
+    void init(size_t ways, size_t sets)
+    {
+        m_ways_mask = (ways == 64) ? ~(uint64_t)0 : ((uint64_t)1 << ways) - 1;
+        m_recent.resize(sets);
+        reset();
+    }
+
+    void reset()
+    {
+        for (size_t set = 0; set < m_recent.size(); set++) m_recent[set] = 0;
+    }
+
+    inline void access(size_t set, size_t way)
+    {
+        m_recent[set] |= (uint64_t)1 << way;
+    }
+
+    inline void write(size_t set, size_t way, bool)
+    {
+        const uint64_t bit    = (uint64_t)1 << way;
+        const uint64_t others = m_ways_mask & ~bit;
+
+        if ((m_recent[set] & others) == others) m_recent[set] = 0;
+        else                                    m_recent[set] |= bit;
+    }
+
+    inline uint64_t victims(size_t set) const
+    {
+        return m_ways_mask & ~m_recent[set];
+    }
+}; // end class BitPlruReplacement
+
+////////////////////////////////////////////////////////////////////////
+// Tree PLRU : a binary tree of (ways - 1) bits per set (the number of
+// ways must be a power of 2). Node n has children 2n and 2n+1, and the
+// leaves (ways + way) are the ways. Each node bit points to the subtree
+// containing the victim (0 : left, 1 : right), and an access makes the
+// nodes on the way path point away from the way.
+////////////////////////////////////////////////////////////////////////
+class TreePlruReplacement
+{
+    std::vector<uint64_t> m_tree;       // node n is bit n (one word per set)
+    size_t                m_ways;
+    size_t                m_levels;
+
+    public:
+
+    void init(size_t ways, size_t sets)
+    {
+        assert(IS_POW_OF_2(ways) &&
+               "Cache Directory : tree PLRU requires a power of 2 number of ways");
+
+        m_ways   = ways;
+        m_levels = soclib::common::uint32_log2(ways);
+        m_tree.resize(sets);
+        reset();
+    }
+
+    void reset()
+    {
+        for (size_t set = 0; set < m_tree.size(); set++) m_tree[set] = 0;
+    }
+
+    inline void access(size_t set, size_t way)
+    {
+        uint64_t tree = m_tree[set];
+        for (size_t node = m_ways + way; node > 1; node = node >> 1)
+        {
+            const uint64_t bit  = (uint64_t)1 << (node >> 1);
+            const uint64_t away = (uint64_t)(~node & 1) << (node >> 1);
+            tree = (tree & ~bit) | away;
+        }
+        m_tree[set] = tree;
+    }
+
+    inline void write(size_t set, size_t way, bool)
+    {
+        access(set, way);
+    }
+
+    inline uint64_t victims(size_t set) const
+    {
+        const uint64_t tree = m_tree[set];
+        size_t         node = 1;
+        for (size_t level = 0; level < m_levels; level++)
+        {
+            node = (node << 1) | ((tree >> node) & 1);
+        }
+        return (uint64_t)1 << (node - m_ways);
+    }
+}; // end class TreePlruReplacement
+
+////////////////////////////////////////////////////////////////////////
+// Random : the victim is selected by a 32 bits LFSR.
+////////////////////////////////////////////////////////////////////////
+class RandomReplacement
+{
+    size_t   m_ways;
+    uint32_t m_lfsr;
+
+    public:
+
+    void init(size_t ways, size_t)
+    {
+        m_ways = ways;
+        reset();
+    }
+
+    void reset()
+    {
+        m_lfsr = -1;
+    }
+
+    inline void access(size_t, size_t)
+    {
+    }
+
+    inline void write(size_t, size_t, bool)
+    {
+    }
+
+    inline uint64_t victims(size_t)
+    {
+        m_lfsr = (m_lfsr >> 1) ^ ((-(m_lfsr & 1)) & 0xd0000001);
+        return (uint64_t)1 << (m_lfsr % m_ways);
+    }
+}; // end class RandomReplacement
+
+////////////////////////////////////////////////////////////////////////
+// SRRIP : 2 bits re-reference prediction value (RRPV) per way, stored
+// in two bit planes per set. A new line is inserted with RRPV = 2, a
+// hit resets the RRPV to 0. The victims are the ways with RRPV = 3,
+// after aging the set (all RRPV incremented) until there is one.
+////////////////////////////////////////////////////////////////////////
+class SrripReplacement
+{
+    std::vector<uint64_t> m_hi;         // RRPV bit 1 (one word per set)
+    std::vector<uint64_t> m_lo;         // RRPV bit 0 (one word per set)
+    uint64_t              m_ways_mask;
+
+    public:
+
+    void init(size_t ways, size_t sets)
+    {
+        m_ways_mask = (ways == 64) ? ~(uint64_t)0 : ((uint64_t)1 << ways) - 1;
+        m_hi.resize(sets);
+        m_lo.resize(sets);
+        reset();
+    }
+
+    void reset()
+    {
+        // all ways are distant (RRPV = 3)
+        for (size_t set = 0; set < m_hi.size(); set++)
+        {
+            m_hi[set] = m_ways_mask;
+            m_lo[set] = m_ways_mask;
+        }
+    }
+
+    inline void access(size_t set, size_t way)
+    {
+        const uint64_t bit = (uint64_t)1 << way;
+        m_hi[set] &= ~bit;
+        m_lo[set] &= ~bit;
+    }
+
+    inline void write(size_t set, size_t way, bool fill)
+    {
+        const uint64_t bit = (uint64_t)1 << way;
+        if (fill) 
+        {
+            m_hi[set] |= bit;
+            m_lo[set] &= ~bit;
+        }
+        else
+        {
+            access(set, way);
+        }
+    }
+
+    inline uint64_t victims(size_t set)
+    {
+        uint64_t hi = m_hi[set];
+        uint64_t lo = m_lo[set];
+
+        // aging : at most 3 increments of the RRPV lower than 3
+        while (not (hi & lo))
+        {
+            hi = hi | lo;
+            lo = ~lo & m_ways_mask;
+        }
+        m_hi[set] = hi;
+        m_lo[set] = lo;
+        return hi & lo;
+    }
+}; // end class SrripReplacement
+
 ////////////////////////////////////////////////////////////////////////
 //                       The directory  
+// The directory is stored as flat, set-major arrays (struct of arrays):
+// - m_tag_tab   : the tags of all ways of a set are contiguous,
+// - m_state_tab : one byte of state bits (valid, is_cnt, dirty, lock)
+//                 per entry,
+// - m_info_tab  : the other fields (count, owner, ptr), that are only
+//                 accessed for the selected way.
+// The tag comparison over the ways of a set is a single branch-free
+// scan building a bit-vector of matching ways (at most 64 ways).
+// The replacement state is kept by the Replacement template parameter
+// (see the replacement policies above).
 ////////////////////////////////////////////////////////////////////////
+template<typename Replacement = BitPlruReplacement>
 class CacheDirectory {
 
     typedef sc_dt::sc_uint<40> addr_t;
     typedef uint32_t data_t;
     typedef uint32_t tag_t;
 
+    // state bits
+    enum
+    {
+        STATE_VALID  = 0x01,
+        STATE_IS_CNT = 0x02,
+        STATE_DIRTY  = 0x04,
+        STATE_LOCK   = 0x08,
+    };
+
+    // presence summary granularity (bytes)
+    enum
+    {
+        PAGE_SHIFT = 12,
+    };
+
+    // cold part of an entry
+    struct InfoEntry
+    {
+        uint32_t count;         // number of copies
+        uint32_t owner_srcid;   // SRCID of an owner of the line
+        uint32_t ptr;           // pointer to the next owner
+        bool     owner_inst;    // is the owner an ICache ?
+    };
+
     private:
 
     // Directory constants
@@ -169,11 +413,129 @@ class CacheDirectory {
     size_t   m_sets;
     size_t   m_words;
     size_t   m_width;
-    uint32_t lfsr;
+    size_t   m_set_shift;
+    size_t   m_tag_shift;
+    uint64_t m_ways_mask;
+
+    Replacement m_replacement;
+
+    // the directory tables (indexed by set * m_ways + way)
+    tag_t     * m_tag_tab;
+    uint8_t   * m_state_tab;
+    InfoEntry * m_info_tab;
+
+    // presence summary : number of valid entries per page, for the
+    // pages of the memory segments (see enable_presence()).
+    // It is not maintained (NULL) when not enabled.
+    size_t     m_sets_log2;
+    size_t     m_page_shift;        // log2(lines per page)
+    uint64_t   m_presence_base;     // first page index
+    uint64_t   m_presence_pages;    // number of pages
+    uint32_t * m_presence;          // [page - m_presence_base]
+
+    /////////////////////////////////////////////////////////////////////
+    // The page() function returns the page index of a (tag,set) entry.
+    // The presence_incr() and presence_decr() functions update the
+    // presence summary when a (tag,set) entry becomes valid or invalid.
+    /////////////////////////////////////////////////////////////////////
+    inline uint64_t page(const tag_t &tag, const size_t &set) const
+    {
+        return ((((uint64_t)tag) << m_sets_log2) | set) >> m_page_shift;
+    }
+
+    inline void presence_incr(const tag_t &tag, const size_t &set)
+    {
+        if (m_presence == NULL) return;
+
+        const uint64_t p = page(tag, set) - m_presence_base;
+
+        assert((p < m_presence_pages) and
+               "Cache Directory : line outside the presence summary");
+
+        m_presence[p]++;
+    }
 
-    // the directory & lru tables
-    DirectoryEntry ** m_dir_tab;
-    LruEntry       ** m_lru_tab;
+    inline void presence_decr(const tag_t &tag, const size_t &set)
+    {
+        if (m_presence == NULL) return;
+
+        const uint64_t p = page(tag, set) - m_presence_base;
+
+        assert((p < m_presence_pages) and (m_presence[p] != 0) and
+               "Cache Directory : inconsistent presence summary");
+
+        m_presence[p]--;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The hit_mask() function returns a bit-vector of the valid ways
+    // of a set whose tag matches the tag argument.
+    /////////////////////////////////////////////////////////////////////
+    inline uint64_t hit_mask(const size_t &set, const tag_t &tag) const
+    {
+        const tag_t   * tags  = &m_tag_tab[set * m_ways];
+        const uint8_t * state = &m_state_tab[set * m_ways];
+        uint64_t        mask  = 0;
+
+        for (size_t i = 0; i < m_ways; i++)
+        {
+            mask |= (uint64_t)((tags[i] == tag) & (state[i] & STATE_VALID)) << i;
+        }
+        return mask;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The state_mask() function returns a bit-vector of the ways of a
+    // set whose state contains the bit argument.
+    /////////////////////////////////////////////////////////////////////
+    inline uint64_t state_mask(const size_t &set, const uint8_t bit) const
+    {
+        const uint8_t * state = &m_state_tab[set * m_ways];
+        uint64_t        mask  = 0;
+
+        for (size_t i = 0; i < m_ways; i++)
+        {
+            mask |= (uint64_t)((state[i] & bit) != 0) << i;
+        }
+        return mask;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The entry() function builds a copy of the entry (set,way)
+    /////////////////////////////////////////////////////////////////////
+    inline DirectoryEntry entry(const size_t &set, const size_t &way) const
+    {
+        const size_t      index = set * m_ways + way;
+        const uint8_t     state = m_state_tab[index];
+        const InfoEntry & info  = m_info_tab[index];
+        DirectoryEntry    entry;
+
+        entry.valid       = state & STATE_VALID;
+        entry.is_cnt      = state & STATE_IS_CNT;
+        entry.dirty       = state & STATE_DIRTY;
+        entry.lock        = state & STATE_LOCK;
+        entry.tag         = m_tag_tab[index];
+        entry.count       = info.count;
+        entry.owner.inst  = info.owner_inst;
+        entry.owner.srcid = info.owner_srcid;
+        entry.ptr         = info.ptr;
+        return entry;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The lowest() function returns the index of the lowest set bit
+    // (mask must be non zero)
+    /////////////////////////////////////////////////////////////////////
+    static inline size_t lowest(uint64_t mask)
+    {
+        size_t i = 0;
+        while (not (mask & 1))
+        {
+            mask = mask >> 1;
+            i++;
+        }
+        return i;
+    }
 
     public:
 
@@ -182,22 +544,33 @@ class CacheDirectory {
     ////////////////////////
     CacheDirectory( size_t ways, size_t sets, size_t words, size_t address_width)     
     {
+        assert((ways <= 64) && "Cache Directory : at most 64 ways");
+
         m_ways  = ways; 
         m_sets  = sets;
         m_words = words;
         m_width = address_width;
-        lfsr = -1;
+        m_ways_mask = (ways == 64) ? ~(uint64_t)0 : ((uint64_t)1 << ways) - 1;
+        m_replacement.init(ways, sets);
 
-        m_dir_tab = new DirectoryEntry*[sets];
-        for (size_t i = 0; i < sets; i++ ) {
-            m_dir_tab[i] = new DirectoryEntry[ways];
-            for (size_t j = 0; j < ways; j++) m_dir_tab[i][j].init();
-        }
-        m_lru_tab = new LruEntry*[sets];
-        for (size_t i = 0; i < sets; i++) {
-            m_lru_tab[i] = new LruEntry[ways];
-            for (size_t j = 0; j < ways; j++) m_lru_tab[i][j].init();
-        }
+#define L2 soclib::common::uint32_log2
+        m_set_shift  = L2(m_words) + 2;
+        m_tag_shift  = L2(m_sets) + L2(m_words) + 2;
+        m_sets_log2  = L2(m_sets);
+        m_page_shift = (m_set_shift < PAGE_SHIFT) ? PAGE_SHIFT - m_set_shift : 0;
+#undef L2
+
+        m_presence_base  = 0;
+        m_presence_pages = 0;
+        m_presence       = NULL;
+
+        m_tag_tab   = new tag_t[sets * ways];
+        m_state_tab = new uint8_t[sets * ways];
+        m_info_tab  = new InfoEntry[sets * ways];
+
+        std::memset(m_tag_tab,   0, sizeof(tag_t) * sets * ways);
+        std::memset(m_state_tab, 0, sizeof(uint8_t) * sets * ways);
+        std::memset(m_info_tab,  0, sizeof(InfoEntry) * sets * ways);
     } // end constructor
 
     /////////////////
@@ -205,12 +578,10 @@ class CacheDirectory {
     /////////////////
     ~CacheDirectory()
     {
-        for(size_t i = 0; i < m_sets; i++){
-            delete [] m_dir_tab[i];
-            delete [] m_lru_tab[i];
-        }
-        delete [] m_dir_tab;
-        delete [] m_lru_tab;
+        delete [] m_tag_tab;
+        delete [] m_state_tab;
+        delete [] m_info_tab;
+        delete [] m_presence;
     } // end destructor
 
     /////////////////////////////////////////////////////////////////////
@@ -223,28 +594,15 @@ class CacheDirectory {
     /////////////////////////////////////////////////////////////////////
     DirectoryEntry read(const addr_t &address, size_t &way)
     {
+        const size_t set  = (size_t)(address >> m_set_shift) & (m_sets - 1);
+        const tag_t  tag  = (tag_t)(address >> m_tag_shift);
+        const uint64_t hit = hit_mask(set, tag);
 
-#define L2 soclib::common::uint32_log2
-        const size_t set = (size_t)(address >> (L2(m_words) + 2)) & (m_sets - 1);
-        const tag_t  tag = (tag_t)(address >> (L2(m_sets) + L2(m_words) + 2));
-#undef L2
-
-        bool hit = false;
-        for (size_t i = 0; i < m_ways; i++ ) 
-        {
-            bool equal = (m_dir_tab[set][i].tag == tag);
-            bool valid = m_dir_tab[set][i].valid;
-            hit        = equal && valid;
-            if (hit) 
-            {            
-                way = i;
-                break;
-            } 
-        }
         if (hit) 
-        {
-            m_lru_tab[set][way].recent = true;
-            return DirectoryEntry(m_dir_tab[set][way]);
+        {            
+            way = lowest(hit);
+            m_replacement.access(set, way);
+            return entry(set, way);
         } 
         else 
         {
@@ -258,7 +616,12 @@ class CacheDirectory {
     /////////////////////////////////////////////////////////////////////
     void inval(const size_t &way, const size_t &set)
     {
-        m_dir_tab[set][way].init();
+        const size_t index = set * m_ways + way;
+
+        if (m_state_tab[index] & STATE_VALID) presence_decr(m_tag_tab[index], set);
+
+        m_state_tab[index]       = 0;
+        m_info_tab[index].count  = 0;
     }
 
     /////////////////////////////////////////////////////////////////////
@@ -272,29 +635,22 @@ class CacheDirectory {
             size_t * ret_way,
             size_t * ret_set )
     {
+        const size_t set  = (size_t)(address >> m_set_shift) & (m_sets - 1);
+        const tag_t  tag  = (tag_t)(address >> m_tag_shift);
+        const uint64_t hit = hit_mask(set, tag);
 
-#define L2 soclib::common::uint32_log2
-        size_t set = (size_t) (address >> (L2(m_words) + 2)) & (m_sets - 1);
-        tag_t  tag = (tag_t) (address >> (L2(m_sets) + L2(m_words) + 2));
-#undef L2
-
-        for (size_t way = 0; way < m_ways; way++)
+        if (hit)
         {
-            bool equal = (m_dir_tab[set][way].tag == tag);
-            bool valid = m_dir_tab[set][way].valid;
-            if (equal and valid)
-            {
-                *ret_set = set;
-                *ret_way = way; 
-                return DirectoryEntry(m_dir_tab[set][way]);
-            }
-        } 
+            *ret_set = set;
+            *ret_way = lowest(hit); 
+            return entry(set, *ret_way);
+        }
         return DirectoryEntry();
     } // end read_neutral()
 
     /////////////////////////////////////////////////////////////////////
     // The write function writes a new entry, 
-    // and updates the LRU bits if necessary.
+    // and updates the replacement state.
     // Arguments :
     // - set : the set of the entry
     // - way : the way of the entry
@@ -307,23 +663,31 @@ class CacheDirectory {
         assert((set < m_sets) && "Cache Directory write : The set index is invalid");
         assert((way < m_ways) && "Cache Directory write : The way index is invalid");
 
-        // update Directory
-        m_dir_tab[set][way].copy(entry);
+        const size_t index = set * m_ways + way;
+        uint8_t *    state = &m_state_tab[set * m_ways];
 
-        // update LRU bits
-        bool all_recent = true;
-        for (size_t i = 0; i < m_ways; i++) 
-        {
-            if (i != way) all_recent = m_lru_tab[set][i].recent && all_recent;
-        }
-        if (all_recent) 
-        {
-            for (size_t i = 0; i < m_ways; i++) m_lru_tab[set][i].recent = false;
-        } 
-        else 
+        // update presence summary if the line changes
+        const bool old_valid = state[way] & STATE_VALID;
+        const bool changed   = (old_valid != entry.valid) or (m_tag_tab[index] != entry.tag);
+        if (changed)
         {
-            m_lru_tab[set][way].recent = true;
+            if (old_valid)   presence_decr(m_tag_tab[index], set);
+            if (entry.valid) presence_incr(entry.tag, set);
         }
+
+        // update Directory
+        m_tag_tab[index]              = entry.tag;
+        m_info_tab[index].count       = entry.count;
+        m_info_tab[index].owner_inst  = entry.owner.inst;
+        m_info_tab[index].owner_srcid = entry.owner.srcid;
+        m_info_tab[index].ptr         = entry.ptr;
+        state[way] = (entry.valid  ? STATE_VALID  : 0) |
+                     (entry.is_cnt ? STATE_IS_CNT : 0) |
+                     (entry.dirty  ? STATE_DIRTY  : 0) |
+                     (entry.lock   ? STATE_LOCK   : 0);
+
+        // update replacement state
+        m_replacement.write(set, way, changed and entry.valid);
     } // end write()
 
     /////////////////////////////////////////////////////////////////////
@@ -335,7 +699,7 @@ class CacheDirectory {
     void print(const size_t &set, const size_t &way)
     {
         std::cout << std::dec << " set : " << set << " ; way : " << way << " ; " ;
-        m_dir_tab[set][way].print();
+        entry(set, way).print();
     } // end print()
 
     /////////////////////////////////////////////////////////////////////
@@ -350,70 +714,95 @@ class CacheDirectory {
                 && "Cache Directory : (select) The set index is invalid");
 
         // looking for an empty slot
-        for (size_t i = 0; i < m_ways; i++)
+        const uint64_t empty = m_ways_mask & ~state_mask(set, STATE_VALID);
+        if (empty)
         {
-            if (not m_dir_tab[set][i].valid)
-            {
-                way = i;
-                return DirectoryEntry(m_dir_tab[set][way]);
-            }
+            way = lowest(empty);
+            return entry(set, way);
         }
 
-#ifdef RANDOM_EVICTION
-        lfsr = (lfsr >> 1) ^ ((-(lfsr & 1)) & 0xd0000001);
-        way = lfsr % m_ways;
-        return DirectoryEntry(m_dir_tab[set][way]);
-#endif
+        // looking for a not locked victim, then a locked victim,
+        // then a not locked entry (way 0 if all entries are locked)
+        const uint64_t locked  = state_mask(set, STATE_LOCK);
+        const uint64_t victims = m_replacement.victims(set);
+        uint64_t       select  = victims & ~locked;
+        if (not select) select = victims & locked;
+        if (not select) select = m_ways_mask & ~victims & ~locked;
 
-        // looking for a not locked and not recently used entry
-        for (size_t i = 0; i < m_ways; i++)
+        way = select ? lowest(select) : 0;
+        return entry(set, way);
+    } // end select()
+
+    /////////////////////////////////////////////////////////////////////
+    //         Global initialisation function
+    /////////////////////////////////////////////////////////////////////
+    void init()
+    {
+        for (size_t i = 0; i < m_sets * m_ways; i++) 
         {
-            if ((not m_lru_tab[set][i].recent) && (not m_dir_tab[set][i].lock))
-            {
-                way = i;
-                return DirectoryEntry(m_dir_tab[set][way]);
-            }
+            m_state_tab[i]      = 0;
+            m_info_tab[i].count = 0;
         }
-
-        // looking for a locked not recently used entry
-        for (size_t i = 0; i < m_ways; i++)
+        m_replacement.reset();
+        if (m_presence != NULL)
         {
-            if ((not m_lru_tab[set][i].recent) && (m_dir_tab[set][i].lock))
-            {
-                way = i;
-                return DirectoryEntry(m_dir_tab[set][way]);
-            }
+            std::memset(m_presence, 0, sizeof(uint32_t) * m_presence_pages);
         }
+    } // end init()
 
-        // looking for a recently used entry not locked
-        for (size_t i = 0; i < m_ways; i++)
+    /////////////////////////////////////////////////////////////////////
+    // The enable_presence() function allocates the presence summary
+    // for the physical address range [base, base + size[, that must
+    // contain all the lines cached in the directory. The summary is
+    // only maintained when enabled (used by absent_lines()).
+    /////////////////////////////////////////////////////////////////////
+    void enable_presence(const addr_t &base, const uint64_t &size)
+    {
+        const uint64_t first = ((uint64_t)base >> m_set_shift) >> m_page_shift;
+        const uint64_t last  = (((uint64_t)base + size - 1) >> m_set_shift) >> m_page_shift;
+
+        delete [] m_presence;
+        m_presence_base  = first;
+        m_presence_pages = last - first + 1;
+        m_presence       = new uint32_t[m_presence_pages];
+        std::memset(m_presence, 0, sizeof(uint32_t) * m_presence_pages);
+
+        for (size_t i = 0; i < m_sets * m_ways; i++)
         {
-            if ((m_lru_tab[set][i].recent) && (not m_dir_tab[set][i].lock))
-            {
-                way = i;
-                return DirectoryEntry(m_dir_tab[set][way]);
-            }
+            if (m_state_tab[i] & STATE_VALID) presence_incr(m_tag_tab[i], i / m_ways);
         }
-
-        // select way 0 (even if entry is locked and recently used)
-        way = 0;
-        return DirectoryEntry(m_dir_tab[set][0]);
-    } // end select()
+    } // end enable_presence()
 
     /////////////////////////////////////////////////////////////////////
-    //         Global initialisation function
+    // The absent_lines() function uses the presence summary to return
+    // the number of consecutive lines, starting at the address argument,
+    // that are not present in the directory (at most the lines argument).
+    // It returns 0 if the page containing the address is not empty, or
+    // if the presence summary is not enabled.
+    // It does not change the LRU.
     /////////////////////////////////////////////////////////////////////
-    void init()
+    size_t absent_lines(const addr_t &address, const size_t &lines) const
     {
-        for (size_t set = 0; set < m_sets; set++) 
+        if (m_presence == NULL) return 0;
+
+        const uint64_t nline = (uint64_t)address >> m_set_shift;
+        uint64_t       p     = nline >> m_page_shift;
+
+        // the pages outside the summary contain no valid entry
+        if ((p - m_presence_base < m_presence_pages) and
+            (m_presence[p - m_presence_base] != 0)) return 0;   // page not empty
+
+        for (p = (p < m_presence_base) ? m_presence_base : p + 1;
+             (p - m_presence_base < m_presence_pages) and
+             (((p << m_page_shift) - nline) < lines); p++)
         {
-            for (size_t way = 0; way < m_ways; way++) 
+            if (m_presence[p - m_presence_base] != 0)
             {
-                m_dir_tab[set][way].init();
-                m_lru_tab[set][way].init();
+                return (size_t)((p << m_page_shift) - nline);    // first valid page
             }
         }
-    } // end init()
+        return lines;
+    } // end absent_lines()
 
 }; // end class CacheDirectory
 
@@ -622,8 +1011,236 @@ class HeapDirectory{
 
 }; // end class HeapDirectory
 
+////////////////////////////////////////////////////////////////////////
+//                    The Sharer Directory
+// This is an alternative to the heap, used when the memory cache is in
+// bitset directory mode: the copies of a line that are not registered
+// in the directory entry itself (the owner) are registered in a bitset
+// attached to the directory entry (full-map directory).
+// To keep the bitsets small, a bit does not directly correspond to a
+// SRCID : each L1 cache (srcid, inst) is dynamically allocated a slot
+// the first time it gets a copy, and the slot is never released.
+// The number of slots (the bitset width) is a constructor parameter,
+// and must be at least the number of L1 caches (instruction and data)
+// sharing the memory cache. The add() function returns false when no
+// slot is available, and the line must then switch to counter mode.
+// The bitsets are stored in a flat array indexed by set * ways + way.
+// The slot of an L1 cache is found in a table directly indexed by
+// (srcid << 1 | inst), whose size depends on the SRCID width.
+// A copy must not be registered twice for the same entry.
+////////////////////////////////////////////////////////////////////////
+class SharerDirectory
+{
+    private:
+
+    const size_t                m_ways;
+    const size_t                m_sets;
+    const size_t                m_slots;        // number of slots (bitset width)
+    const size_t                m_words;        // number of 64 bits words per bitset
+    uint64_t *                  m_bits;         // [(set * ways + way) * words + word]
+    Owner *                     m_slot_tab;     // L1 cache registered in each slot
+    size_t                      m_slot_count;   // number of allocated slots
+    const size_t                m_keys;         // size of the slot index table
+    size_t *                    m_slot_index;   // [srcid << 1 | inst] -> slot
+
+    inline uint64_t * bits(const size_t &set, const size_t &way) const
+    {
+        return &m_bits[(set * m_ways + way) * m_words];
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The slot() function returns the slot allocated to an L1 cache,
+    // and allocates a new one if required and possible.
+    // It returns m_slots if the L1 cache has no slot.
+    /////////////////////////////////////////////////////////////////////
+    size_t slot(const Owner &owner, bool allocate)
+    {
+        const size_t key = (owner.srcid << 1) | (owner.inst ? 1 : 0);
+
+        assert((key < m_keys) && "SharerDirectory error : SRCID out of range");
+
+        if (m_slot_index[key] != m_slots) return m_slot_index[key];
+        if (not allocate or (m_slot_count == m_slots)) return m_slots;
+
+        m_slot_tab[m_slot_count] = owner;
+        m_slot_index[key]        = m_slot_count;
+        return m_slot_count++;
+    }
+
+    public:
+
+    ////////////////////////
+    // Constructor
+    ////////////////////////
+    SharerDirectory(size_t ways, size_t sets, size_t slots, size_t srcid_width)
+        : m_ways(ways),
+          m_sets(sets),
+          m_slots(slots),
+          m_words((slots + 63) / 64),
+          m_slot_count(0),
+          m_keys((size_t)2 << srcid_width)
+    {
+        assert((slots > 0) && "SharerDirectory constructor : invalid number of slots");
+
+        m_bits       = new uint64_t[sets * ways * m_words];
+        m_slot_tab   = new Owner[slots];
+        m_slot_index = new size_t[m_keys];
+        std::memset(m_bits, 0, sizeof(uint64_t) * sets * ways * m_words);
+        for (size_t k = 0; k < m_keys; k++) m_slot_index[k] = m_slots;
+    } // end constructor
+
+    /////////////////
+    // Destructor
+    /////////////////
+    ~SharerDirectory()
+    {
+        delete [] m_bits;
+        delete [] m_slot_tab;
+        delete [] m_slot_index;
+    } // end destructor
+
+    /////////////////////////////////////////////////////////////////////
+    //         Global initialisation function
+    /////////////////////////////////////////////////////////////////////
+    void init()
+    {
+        std::memset(m_bits, 0, sizeof(uint64_t) * m_sets * m_ways * m_words);
+        for (size_t k = 0; k < m_keys; k++) m_slot_index[k] = m_slots;
+        m_slot_count = 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The words() function returns the number of 64 bits words of a
+    // bitset (size of the buffers used by the copy() function).
+    /////////////////////////////////////////////////////////////////////
+    size_t words() const
+    {
+        return m_words;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The clear() function removes all copies registered for an entry.
+    /////////////////////////////////////////////////////////////////////
+    void clear(const size_t &set, const size_t &way)
+    {
+        std::memset(bits(set, way), 0, sizeof(uint64_t) * m_words);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The add() function registers a copy for an entry.
+    // It returns false if there is no slot available for this copy.
+    // The copy must not be already registered: the memory cache relies
+    // on the count field being the number of registered copies.
+    /////////////////////////////////////////////////////////////////////
+    bool add(const size_t &set, const size_t &way, const Owner &owner)
+    {
+        const size_t s = slot(owner, true);
+        if (s == m_slots) return false;
+
+        uint64_t &     word = bits(set, way)[s >> 6];
+        const uint64_t mask = (uint64_t)1 << (s & 63);
+
+        assert(not (word & mask) && "SharerDirectory error : copy already registered");
+
+        word |= mask;
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The remove() function removes a copy registered for an entry.
+    // It returns false if the copy was not registered.
+    /////////////////////////////////////////////////////////////////////
+    bool remove(const size_t &set, const size_t &way, const Owner &owner)
+    {
+        const size_t s = slot(owner, false);
+        if (s == m_slots) return false;
+
+        uint64_t *     word = &bits(set, way)[s >> 6];
+        const uint64_t mask = (uint64_t)1 << (s & 63);
+        if (not (*word & mask)) return false;
+
+        *word &= ~mask;
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The copy() function copies the bitset of an entry in a buffer
+    // of words() words, to be scanned by the first() function.
+    /////////////////////////////////////////////////////////////////////
+    void copy(const size_t &set, const size_t &way, uint64_t * buffer) const
+    {
+        std::memcpy(buffer, bits(set, way), sizeof(uint64_t) * m_words);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The first() function returns the slot of the first copy
+    // registered in a bitset buffer, or false if the buffer is empty.
+    /////////////////////////////////////////////////////////////////////
+    bool first(const uint64_t * buffer, size_t &s) const
+    {
+        for (size_t w = 0; w < m_words; w++)
+        {
+            uint64_t word = buffer[w];
+            if (word == 0) continue;
+
+            size_t i = 0;
+#ifdef __GNUC__
+            i = __builtin_ctzll(word);
+#else
+            while (not (word & 1))
+            {
+                word = word >> 1;
+                i++;
+            }
+#endif
+            s = (w << 6) + i;
+            return true;
+        }
+        return false;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The empty() function returns true if a bitset buffer is empty.
+    /////////////////////////////////////////////////////////////////////
+    bool empty(const uint64_t * buffer) const
+    {
+        size_t s;
+        return not first(buffer, s);
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The front() functions return the first copy registered in a
+    // bitset buffer, or for an entry (the bitset must not be empty).
+    /////////////////////////////////////////////////////////////////////
+    Owner front(const uint64_t * buffer) const
+    {
+        size_t s = 0;
+        bool   found = first(buffer, s);
+
+        assert(found && "SharerDirectory error : no copy in the bitset");
+        return found ? m_slot_tab[s] : Owner();
+    }
+
+    Owner front(const size_t &set, const size_t &way) const
+    {
+        return front(bits(set, way));
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The pop() function removes the first copy from a bitset buffer.
+    /////////////////////////////////////////////////////////////////////
+    void pop(uint64_t * buffer) const
+    {
+        size_t s = 0;
+        if (first(buffer, s)) buffer[s >> 6] &= ~((uint64_t)1 << (s & 63));
+    }
+
+}; // end class SharerDirectory
+
 ////////////////////////////////////////////////////////////////////////
 //                        Cache Data 
+// The data array is a single set-major buffer: the words of a cache
+// line are contiguous, and the lines of a set are contiguous.
 ////////////////////////////////////////////////////////////////////////
 class CacheData 
 {
@@ -632,7 +1249,12 @@ class CacheData
         const uint32_t m_ways;
         const uint32_t m_words;
 
-        uint32_t *** m_cache_data;
+        uint32_t * m_cache_data;
+
+        inline uint32_t * line(const uint32_t &way, const uint32_t &set) const
+        {
+            return &m_cache_data[((size_t)set * m_ways + way) * m_words];
+        }
 
     public:
 
@@ -640,35 +1262,15 @@ class CacheData
         CacheData(uint32_t ways, uint32_t sets, uint32_t words)
             : m_sets(sets), m_ways(ways), m_words(words) 
         {
-            m_cache_data = new uint32_t ** [ways];
-            for (size_t i = 0; i < ways; i++) 
-            {
-                m_cache_data[i] = new uint32_t * [sets];
-            }
-            for (size_t i = 0; i < ways; i++) 
-            {
-                for (size_t j = 0; j < sets; j++) 
-                {
-                    m_cache_data[i][j] = new uint32_t[words];
-                    // Init to avoid potential errors from memory checkers
-                    std::memset(m_cache_data[i][j], 0, sizeof(uint32_t) * words);
-                }
-            }
+            const size_t size = (size_t)sets * ways * words;
+
+            m_cache_data = new uint32_t[size];
+            // Init to avoid potential errors from memory checkers
+            std::memset(m_cache_data, 0, sizeof(uint32_t) * size);
         }
         ////////////
         ~CacheData() 
         {
-            for (size_t i = 0; i < m_ways; i++)
-            {
-                for (size_t j = 0; j < m_sets; j++)
-                {
-                    delete [] m_cache_data[i][j];
-                }
-            }
-            for (size_t i = 0; i < m_ways; i++)
-            {
-                delete [] m_cache_data[i];
-            }
             delete [] m_cache_data;
         }
         //////////////////////////////////////////
@@ -680,18 +1282,23 @@ class CacheData
             assert((way  < m_ways)  && "Cache data error: Trying to read a wrong way" );
             assert((word < m_words) && "Cache data error: Trying to read a wrong word");
 
-            return m_cache_data[way][set][word];
+            return line(way, set)[word];
         }
         //////////////////////////////////////////
+        // The line_t type can be any array of registers
+        // providing a write() function (sc_signal array,
+        // or RegisterArray).
+        template<typename line_t>
         void read_line(const uint32_t &way,
                 const uint32_t &set,
-                sc_core::sc_signal<uint32_t> * cache_line)
+                line_t &cache_line)
         {
             assert((set < m_sets) && "Cache data error: Trying to read a wrong set" );
             assert((way < m_ways) && "Cache data error: Trying to read a wrong way" );
 
+            const uint32_t * data = line(way, set);
             for (uint32_t word = 0; word < m_words; word++) {
-                cache_line[word].write(m_cache_data[way][set][word]);
+                cache_line[word].write(data[word]);
             }
         }
         /////////////////////////////////////////
@@ -709,9 +1316,11 @@ class CacheData
 
             if (be == 0x0) return;
 
+            uint32_t * target = &line(way, set)[word];
+
             if (be == 0xF)
             {
-                m_cache_data[way][set][word] = data; 
+                *target = data; 
                 return;
             }
 
@@ -721,8 +1330,7 @@ class CacheData
             if (be & 0x4) mask = mask | 0x00FF0000;
             if (be & 0x8) mask = mask | 0xFF000000;
 
-            m_cache_data[way][set][word] = 
-                (data & mask) | (m_cache_data[way][set][word] & ~mask);
+            *target = (data & mask) | (*target & ~mask);
         }
 }; // end class CacheData
 
@@ -0,0 +1,229 @@
+#ifndef SOCLIB_CABA_MEM_CACHE_REGISTER_H
+#define SOCLIB_CABA_MEM_CACHE_REGISTER_H
+
+#include <cassert>
+#include <cstddef>
+
+namespace soclib { namespace caba {
+
+////////////////////////////////////////////////////////////////////////
+// The internal registers of the memory cache are not connected to any
+// other component: they are only written by the transition() function,
+// and read by the transition() and genMoore() functions.
+// They do not need the SystemC signal update/notify machinery, and are
+// implemented as two-phase registers: a write is only visible after the
+// commit() of the RegisterFile, that must be called at the end of the
+// transition() function. This reproduces the sc_signal semantic.
+// Only the registers written during the cycle are committed.
+////////////////////////////////////////////////////////////////////////
+
+class RegisterFile;
+
+////////////////////////////////////////////////////////////////////////
+//                    A register (base class)
+////////////////////////////////////////////////////////////////////////
+class RegisterBase {
+
+    friend class RegisterFile;
+
+    protected:
+
+        RegisterFile * m_file;      // register file containing the register
+        RegisterBase * m_next;      // next register in the written list
+        bool           m_written;   // register written in the current cycle
+
+        RegisterBase()
+            : m_file(NULL), m_next(NULL), m_written(false)
+        {}
+
+        virtual ~RegisterBase()
+        {}
+
+        virtual void commit() = 0;
+
+        inline void written();
+
+    public:
+
+        void bind(RegisterFile &file)
+        {
+            m_file = &file;
+        }
+
+}; // end class RegisterBase
+
+////////////////////////////////////////////////////////////////////////
+//                    The register file
+////////////////////////////////////////////////////////////////////////
+class RegisterFile {
+
+    friend class RegisterBase;
+
+    private:
+
+        RegisterBase * m_written;   // list of registers written in the cycle
+
+        RegisterFile(const RegisterFile &);
+        RegisterFile & operator=(const RegisterFile &);
+
+    public:
+
+        RegisterFile()
+            : m_written(NULL)
+        {}
+
+        /////////////////////////////////////////////////////////////////////
+        // The commit() function makes visible all values written since
+        // the previous commit(). It must be called once per cycle.
+        // It returns true if at least one register has been written.
+        /////////////////////////////////////////////////////////////////////
+        bool commit()
+        {
+            RegisterBase * reg     = m_written;
+            bool           written = (reg != NULL);
+            while (reg != NULL)
+            {
+                RegisterBase * next = reg->m_next;
+                reg->commit();
+                reg->m_next    = NULL;
+                reg->m_written = false;
+                reg = next;
+            }
+            m_written = NULL;
+            return written;
+        }
+
+}; // end class RegisterFile
+
+inline void RegisterBase::written()
+{
+    assert(m_file && "Register error : register not bound to a register file");
+
+    if (m_written) return;
+    m_written       = true;
+    m_next          = m_file->m_written;
+    m_file->m_written = this;
+}
+
+////////////////////////////////////////////////////////////////////////
+//                    A register
+// The interface is the subset of the sc_signal interface used
+// by the memory cache FSMs.
+////////////////////////////////////////////////////////////////////////
+template<typename T>
+class Register : public RegisterBase {
+
+    private:
+
+        T m_value;      // current value
+        T m_new_value;  // value written in the current cycle
+
+        Register(const Register &);
+
+        void commit()
+        {
+            m_value = m_new_value;
+        }
+
+    public:
+
+        Register()
+            : m_value(), m_new_value()
+        {}
+
+        Register(RegisterFile &file)
+            : m_value(), m_new_value()
+        {
+            bind(file);
+        }
+
+        const T & read() const
+        {
+            return m_value;
+        }
+
+        void write(const T &value)
+        {
+            m_new_value = value;
+            written();
+        }
+
+        operator const T & () const
+        {
+            return m_value;
+        }
+
+        Register & operator=(const T &value)
+        {
+            write(value);
+            return *this;
+        }
+
+        Register & operator=(const Register &reg)
+        {
+            write(reg.read());
+            return *this;
+        }
+
+}; // end class Register
+
+////////////////////////////////////////////////////////////////////////
+//                    An array of registers
+// (for instance one register per word of a cache line)
+////////////////////////////////////////////////////////////////////////
+template<typename T>
+class RegisterArray {
+
+    private:
+
+        const size_t  m_size;
+        Register<T> * m_regs;
+
+        RegisterArray(const RegisterArray &);
+        RegisterArray & operator=(const RegisterArray &);
+
+    public:
+
+        RegisterArray(RegisterFile &file, size_t size)
+            : m_size(size)
+        {
+            m_regs = new Register<T>[size];
+            for (size_t i = 0; i < size; i++) m_regs[i].bind(file);
+        }
+
+        ~RegisterArray()
+        {
+            delete [] m_regs;
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        Register<T> & operator[](size_t i)
+        {
+            assert((i < m_size) && "RegisterArray error : index out of range");
+            return m_regs[i];
+        }
+
+        const Register<T> & operator[](size_t i) const
+        {
+            assert((i < m_size) && "RegisterArray error : index out of range");
+            return m_regs[i];
+        }
+
+}; // end class RegisterArray
+
+}} // end namespaces
+
+#endif
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
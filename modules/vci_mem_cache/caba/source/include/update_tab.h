@@ -134,6 +134,11 @@ class UpdateTabEntry {
 
 ////////////////////////////////////////////////////////////////////////
 //                        The update tab             
+// The free entries are registered in a bitmask (the lowest free entry
+// is allocated), and the valid entries are chained in a small hash
+// table indexed by the nline,
+// so that the allocation, the full / empty tests and the searches
+// by nline do not scan the whole tab.
 ////////////////////////////////////////////////////////////////////////
 class UpdateTab{
 
@@ -143,18 +148,97 @@ class UpdateTab{
   size_t                      size_tab;
   std::vector<UpdateTabEntry> tab;
 
+  std::vector<uint64_t>       free_mask;    // one bit per free entry
+  size_t                      free_count;   // number of free entries
+  std::vector<size_t>         hash_head;    // first entry of each bucket
+  std::vector<size_t>         hash_next;    // next entry in the same bucket
+  size_t                      hash_mask;
+  size_t                      hash_shift;
+
+  // size_tab is used as the null entry index in the hash chains
+
+  size_t bucket(const addr_t nline) const
+  {
+    return (size_t)(nline ^ (nline >> hash_shift)) & hash_mask;
+  }
+
+  void hash_insert(const size_t index)
+  {
+    size_t b         = bucket(tab[index].nline);
+    hash_next[index] = hash_head[b];
+    hash_head[b]     = index;
+  }
+
+  void hash_remove(const size_t index)
+  {
+    size_t * link = &hash_head[bucket(tab[index].nline)];
+    while (*link != index)
+    {
+      assert((*link != size_tab) && "Update Tab hash corrupted");
+      link = &hash_next[*link];
+    }
+    *link = hash_next[index];
+  }
+
+  // returns the lowest free entry (the tab must not be full)
+  size_t lowest_free() const
+  {
+    for (size_t w = 0; w < free_mask.size(); w++)
+    {
+      uint64_t word = free_mask[w];
+      if (word == 0) continue;
+
+      size_t i = 0;
+#ifdef __GNUC__
+      i = __builtin_ctzll(word);
+#else
+      while (not (word & 1))
+      {
+        word = word >> 1;
+        i++;
+      }
+#endif
+      return w * 64 + i;
+    }
+    assert(false && "Update Tab free mask corrupted");
+    return size_tab;
+  }
+
+  void build()
+  {
+    // number of buckets : power of 2, at least twice the number of entries
+    hash_shift = 1;
+    while ((size_t)(1 << hash_shift) < 2 * size_tab) hash_shift++;
+    hash_mask = (1 << hash_shift) - 1;
+
+    free_mask.resize((size_tab + 63) / 64);
+    hash_next.resize(size_tab);
+    hash_head.resize(hash_mask + 1);
+    reset_lists();
+  }
+
+  void reset_lists()
+  {
+    for (size_t w = 0; w < free_mask.size(); w++) free_mask[w] = 0;
+    for (size_t i = 0; i < size_tab; i++) free_mask[i / 64] |= (uint64_t)1 << (i % 64);
+    free_count = size_tab;
+    for (size_t b = 0; b <= hash_mask; b++) hash_head[b] = size_tab;
+  }
+
   public:
 
   UpdateTab()
     : tab(0)
   {
     size_tab=0;
+    build();
   }
 
   UpdateTab(size_t size_tab_i)
     : tab(size_tab_i)
   {
     size_tab=size_tab_i;
+    build();
   }
 
   ////////////////////////////////////////////////////////////////////
@@ -185,6 +269,7 @@ class UpdateTab{
   void init()
   {
     for ( size_t i=0; i<size_tab; i++) tab[i].init();
+    reset_lists();
   }
 
   /////////////////////////////////////////////////////////////////////
@@ -221,25 +306,27 @@ class UpdateTab{
            const size_t count,
            size_t       &index)
   {
-    for ( size_t i=0 ; i<size_tab ; i++ ) 
-    {
-      if( !tab[i].valid ) 
-      {
-        tab[i].valid		= true;
-        tab[i].update		= update;
-        tab[i].brdcast      = brdcast;
-        tab[i].rsp          = rsp;
-        tab[i].ack          = ack;
-        tab[i].srcid		= (size_t) srcid;
-        tab[i].trdid		= (size_t) trdid;
-        tab[i].pktid		= (size_t) pktid;
-        tab[i].nline		= (addr_t) nline;
-        tab[i].count		= (size_t) count;
-        index			    = i;
-        return true;
-      }
-    }
-    return false;
+    if ( free_count == 0 ) return false;
+
+    size_t i = lowest_free();
+    assert(!tab[i].valid && "Update Tab free mask corrupted");
+
+    free_mask[i / 64] &= ~((uint64_t)1 << (i % 64));
+    free_count--;
+
+    tab[i].valid		= true;
+    tab[i].update		= update;
+    tab[i].brdcast      = brdcast;
+    tab[i].rsp          = rsp;
+    tab[i].ack          = ack;
+    tab[i].srcid		= (size_t) srcid;
+    tab[i].trdid		= (size_t) trdid;
+    tab[i].pktid		= (size_t) pktid;
+    tab[i].nline		= (addr_t) nline;
+    tab[i].count		= (size_t) count;
+    index			    = i;
+    hash_insert(i);
+    return true;
   } // end set()
 
   /////////////////////////////////////////////////////////////////////
@@ -270,11 +357,7 @@ class UpdateTab{
   /////////////////////////////////////////////////////////////////////
   bool is_full()
   {
-    for(size_t i = 0 ; i < size_tab ; i++)
-    {
-      if(!tab[i].valid) return false;
-    }
-    return true;
+    return (free_count == 0);
   }
 
   /////////////////////////////////////////////////////////////////////
@@ -282,11 +365,7 @@ class UpdateTab{
   /////////////////////////////////////////////////////////////////////
   bool is_not_empty()
   {
-    for(size_t i = 0 ; i < size_tab ; i++)
-    {
-      if(tab[i].valid) return true;
-    }
-    return false;
+    return (free_count != size_tab);
   }
 
   /////////////////////////////////////////////////////////////////////
@@ -381,40 +460,43 @@ class UpdateTab{
   // The search_inval() function returns the index of the entry in UPT
   // Arguments :
   // - nline : the line number of the entry in the directory
+  // If several entries match, the lowest index is returned.
   /////////////////////////////////////////////////////////////////////
   bool search_inval(const addr_t nline,size_t &index)
   {
-    size_t i ;
+    bool found = false;
 
-    for (i = 0 ; i < size_tab ; i++)
+    for (size_t i = hash_head[bucket(nline)] ; i != size_tab ; i = hash_next[i])
     {
-      if ( (tab[i].nline == nline) and tab[i].valid and not tab[i].update )
+      if ( (tab[i].nline == nline) and not tab[i].update and
+           (not found or (i < index)) )
       {
         index = i ;
-        return true;
+        found = true;
       }
     }
-    return false;
+    return found;
   }
 
   /////////////////////////////////////////////////////////////////////
   // The read_nline() function returns the index of the entry in UPT
   // Arguments :
   // - nline : the line number of the entry in the directory
+  // If several entries match, the lowest index is returned.
   /////////////////////////////////////////////////////////////////////
   bool read_nline(const addr_t nline,size_t &index) 
   {
-    size_t i ;
+    bool found = false;
 
-    for (i = 0 ; i < size_tab ; i++)
+    for (size_t i = hash_head[bucket(nline)] ; i != size_tab ; i = hash_next[i])
     {
-      if ( (tab[i].nline == nline) and tab[i].valid )
+      if ( (tab[i].nline == nline) and (not found or (i < index)) )
       {
         index = i ;
-        return true;
+        found = true;
       }
     }
-    return false;
+    return found;
   }
 
   /////////////////////////////////////////////////////////////////////
@@ -425,7 +507,13 @@ class UpdateTab{
   void clear(const size_t index)
   {
     assert(index<size_tab && "Bad Update Tab Entry");
-    tab[index].valid=false;
+    if ( tab[index].valid )
+    {
+      hash_remove(index);
+      tab[index].valid=false;
+      free_mask[index / 64] |= (uint64_t)1 << (index % 64);
+      free_count++;
+    }
     return;	
   }
 
@@ -36,6 +36,7 @@
 #include <inttypes.h>
 #include <systemc>
 #include <list>
+#include <deque>
 #include <cassert>
 #include "arithmetics.h"
 #include "alloc_elems.h"
@@ -47,16 +48,29 @@
 #include "int_tab.h"
 #include "generic_llsc_global_table.h"
 #include "mem_cache_directory.h"
+#include "mem_cache_register.h"
 #include "xram_transaction.h"
 #include "update_tab.h"
+#include "xram_backing_store.h"
+#include "statistics_registry.h"
+#include "counter_block.h"
+#include "trace_sink.h"
 #include "dspin_interface.h"
 #include "dspin_dhccp_param.h"
+#include "static_assert.h"
 
 #define TRT_ENTRIES      4      // Number of entries in TRT
 #define UPT_ENTRIES      4      // Number of entries in UPT
 #define IVT_ENTRIES      4      // Number of entries in IVT
 #define HEAP_ENTRIES     1024   // Number of entries in HEAP
 
+// Replacement policy of the directory (see mem_cache_directory.h) :
+// BitPlruReplacement, TreePlruReplacement, RandomReplacement or
+// SrripReplacement (can be defined on the compiler command line)
+#ifndef MEMC_REPLACEMENT
+#define MEMC_REPLACEMENT BitPlruReplacement
+#endif
+
 namespace soclib {  namespace caba {
 
   using namespace sc_core;
@@ -402,60 +416,66 @@ namespace soclib {  namespace caba {
       data_t *             m_debug_previous_data;
       data_t *             m_debug_data;
 
-      // instrumentation counters
-      uint64_t     m_cpt_cycles;         // Counter of cycles
-      uint64_t     m_cpt_reset_count;    // Cycle at which the counters were last reset
-
-      // Counters accessible in software (not yet but eventually)
-      uint32_t     m_cpt_read_local;     // Number of local READ transactions
-      uint32_t     m_cpt_read_remote;    // number of remote READ transactions
-      uint32_t     m_cpt_read_cost;      // Number of (flits * distance) for READs
-
-      uint32_t     m_cpt_write_local;    // Number of local WRITE transactions
-      uint32_t     m_cpt_write_remote;   // number of remote WRITE transactions
-      uint32_t     m_cpt_write_flits_local;  // number of flits for local WRITEs
-      uint32_t     m_cpt_write_flits_remote; // number of flits for remote WRITEs
-      uint32_t     m_cpt_write_cost;     // Number of (flits * distance) for WRITEs
-
-      uint32_t     m_cpt_ll_local;       // Number of local LL transactions
-      uint32_t     m_cpt_ll_remote;      // number of remote LL transactions
-      uint32_t     m_cpt_ll_cost;        // Number of (flits * distance) for LLs
-
-      uint32_t     m_cpt_sc_local;       // Number of local SC transactions
-      uint32_t     m_cpt_sc_remote;      // number of remote SC transactions
-      uint32_t     m_cpt_sc_cost;        // Number of (flits * distance) for SCs
-
-      uint32_t     m_cpt_cas_local;      // Number of local SC transactions
-      uint32_t     m_cpt_cas_remote;     // number of remote SC transactions
-      uint32_t     m_cpt_cas_cost;       // Number of (flits * distance) for SCs
-
-      uint32_t     m_cpt_update;         // Number of requests causing an UPDATE
-      uint32_t     m_cpt_update_local;   // Number of local UPDATE transactions
-      uint32_t     m_cpt_update_remote;  // Number of remote UPDATE transactions
-      uint32_t     m_cpt_update_cost;    // Number of (flits * distance) for UPDT
-
-      uint32_t     m_cpt_minval;         // Number of requests causing M_INV
-      uint32_t     m_cpt_minval_local;   // Number of local M_INV transactions
-      uint32_t     m_cpt_minval_remote;  // Number of remote M_INV transactions
-      uint32_t     m_cpt_minval_cost;    // Number of (flits * distance) for M_INV
-
-      uint32_t     m_cpt_binval;         // Number of BROADCAST INVAL
-
-      uint32_t     m_cpt_cleanup_local;  // Number of local CLEANUP transactions
-      uint32_t     m_cpt_cleanup_remote; // Number of remote CLEANUP transactions
-      uint32_t     m_cpt_cleanup_cost;   // Number of (flits * distance) for CLEANUPs
-
-      // Counters not accessible by software
-      uint32_t     m_cpt_read_miss;      // Number of MISS READ
-      uint32_t     m_cpt_write_miss;     // Number of MISS WRITE
-      uint32_t     m_cpt_write_dirty;    // Cumulated length for WRITE transactions
-      uint32_t     m_cpt_write_broadcast;// Number of BROADCAST INVAL because of writes
-
-      uint32_t     m_cpt_trt_rb;         // Read blocked by a hit in trt
-      uint32_t     m_cpt_trt_full;       // Transaction blocked due to a full trt
+      // instrumentation counters (64 bits), grouped in a contiguous block
+      // (see counter_block.h), and accessed as m_stats->cpt_xxx
+      struct counters_t
+      {
+          uint64_t cpt_cycles;         // Counter of cycles
+          uint64_t cpt_reset_count;    // Cycle at which the counters were last reset
+
+          // Counters accessible in software (MEMC_INSTRM registers)
+          uint64_t cpt_read_local;     // Number of local READ transactions
+          uint64_t cpt_read_remote;    // number of remote READ transactions
+          uint64_t cpt_read_cost;      // Number of (flits * distance) for READs
+
+          uint64_t cpt_write_local;    // Number of local WRITE transactions
+          uint64_t cpt_write_remote;   // number of remote WRITE transactions
+          uint64_t cpt_write_flits_local;  // number of flits for local WRITEs
+          uint64_t cpt_write_flits_remote; // number of flits for remote WRITEs
+          uint64_t cpt_write_cost;     // Number of (flits * distance) for WRITEs
+
+          uint64_t cpt_ll_local;       // Number of local LL transactions
+          uint64_t cpt_ll_remote;      // number of remote LL transactions
+          uint64_t cpt_ll_cost;        // Number of (flits * distance) for LLs
+
+          uint64_t cpt_sc_local;       // Number of local SC transactions
+          uint64_t cpt_sc_remote;      // number of remote SC transactions
+          uint64_t cpt_sc_cost;        // Number of (flits * distance) for SCs
+
+          uint64_t cpt_cas_local;      // Number of local SC transactions
+          uint64_t cpt_cas_remote;     // number of remote SC transactions
+          uint64_t cpt_cas_cost;       // Number of (flits * distance) for SCs
+
+          uint64_t cpt_update;         // Number of requests causing an UPDATE
+          uint64_t cpt_update_local;   // Number of local UPDATE transactions
+          uint64_t cpt_update_remote;  // Number of remote UPDATE transactions
+          uint64_t cpt_update_cost;    // Number of (flits * distance) for UPDT
+
+          uint64_t cpt_minval;         // Number of requests causing M_INV
+          uint64_t cpt_minval_local;   // Number of local M_INV transactions
+          uint64_t cpt_minval_remote;  // Number of remote M_INV transactions
+          uint64_t cpt_minval_cost;    // Number of (flits * distance) for M_INV
+
+          uint64_t cpt_binval;         // Number of BROADCAST INVAL
+
+          uint64_t cpt_cleanup_local;  // Number of local CLEANUP transactions
+          uint64_t cpt_cleanup_remote; // Number of remote CLEANUP transactions
+          uint64_t cpt_cleanup_cost;   // Number of (flits * distance) for CLEANUPs
+
+          // Counters not accessible by software
+          uint64_t cpt_read_miss;      // Number of MISS READ
+          uint64_t cpt_write_miss;     // Number of MISS WRITE
+          uint64_t cpt_write_dirty;    // Cumulated length for WRITE transactions
+          uint64_t cpt_write_broadcast;// Number of BROADCAST INVAL because of writes
+
+          uint64_t cpt_trt_rb;         // Read blocked by a hit in trt
+          uint64_t cpt_trt_full;       // Transaction blocked due to a full trt
+
+          uint64_t cpt_get;
+          uint64_t cpt_put;
+      };
 
-      uint32_t     m_cpt_get;
-      uint32_t     m_cpt_put;
+      soclib::CounterBlock<counters_t> m_stats;
 
       size_t       m_prev_count;
 
@@ -518,15 +538,24 @@ namespace soclib {  namespace caba {
       void reset_counters();
       void print_stats(bool activity_counters = true, bool stats = true);
       void print_trace( size_t detailed = 0 );
+      void binary_trace( uint64_t cycle );
       void cache_monitor(addr_t addr, bool single_word = false);
       void start_monitor(addr_t addr, addr_t length);
       void stop_monitor();
+      void set_xram_store(XramBackingStore * store, size_t latency);
+      void set_sharer_directory(size_t slots);
+      void set_config_skip(size_t lines_per_cycle);
 
       private:
 
+      // the DSPIN flits are handled as native 64 bits integers
+      soclib_static_assert(memc_dspin_in_width <= 64);
+      soclib_static_assert(memc_dspin_out_width <= 64);
+
       void transition();
       void genMoore();
       void check_monitor(addr_t addr, data_t data, bool read);
+      void publish_counters();
 
       uint32_t req_distance(uint32_t req_srcid);
       bool is_local_req(uint32_t req_srcid);
@@ -554,10 +583,11 @@ namespace soclib {  namespace caba {
       uint32_t                           m_upt_lines;
       UpdateTab                          m_upt;              // pending update
       UpdateTab                          m_ivt;              // pending invalidate
-      CacheDirectory                     m_cache_directory;  // data cache directory
+      CacheDirectory<MEMC_REPLACEMENT>   m_cache_directory;  // data cache directory
       CacheData                          m_cache_data;       // data array[set][way][word]
       HeapDirectory                      m_heap;             // heap for copies
       size_t                             m_max_copies;       // max number of copies in heap
+      SharerDirectory *                  m_sharers;          // bitsets for copies (NULL if heap)
       GenericLLSCGlobalTable
       < 32  ,    // number of slots
         4096,    // number of processors in the system
@@ -610,64 +640,89 @@ namespace soclib {  namespace caba {
       // Fifo between CC_RECEIVE fsm and MULTI_ACK fsm
       GenericFifo<uint64_t>  m_cc_receive_to_multi_ack_fifo;
 
+      // Internal registers (committed at the end of transition())
+      RegisterFile           m_registers;
+
+      // Direct XRAM access (no VCI transaction on the IXR port)
+      struct XramDirectRsp
+      {
+          uint32_t cycle;   // cycle at which the response is available
+          size_t   index;   // TRT index
+          addr_t   address; // cache line address
+          bool     get;     // GET or PUT transaction
+      };
+      XramBackingStore *          m_xram_store;       // NULL if VCI access to XRAM
+      size_t                      m_xram_latency;     // XRAM access latency (cycles)
+      std::deque<XramDirectRsp>   m_xram_rsp_queue;   // pending XRAM responses
+
+      // Binary trace (see binary_trace())
+      soclib::TraceSource *  m_trace_source;       // NULL before the first sample
+
+      // Quiescence detection (see transition())
+      bool                   m_quiescent;          // no state change in last cycle
+      uint32_t               m_quiescent_inputs;   // handshake inputs in last cycle
+
       // Buffer between TGT_CMD fsm and TGT_RSP fsm
       // (segmentation violation response request)
-      sc_signal<bool>     r_tgt_cmd_to_tgt_rsp_req;
+      Register<bool>      r_tgt_cmd_to_tgt_rsp_req;
 
-      sc_signal<uint32_t> r_tgt_cmd_to_tgt_rsp_rdata;
-      sc_signal<size_t>   r_tgt_cmd_to_tgt_rsp_error;
-      sc_signal<size_t>   r_tgt_cmd_to_tgt_rsp_srcid;
-      sc_signal<size_t>   r_tgt_cmd_to_tgt_rsp_trdid;
-      sc_signal<size_t>   r_tgt_cmd_to_tgt_rsp_pktid;
+      Register<uint32_t>  r_tgt_cmd_to_tgt_rsp_rdata;
+      Register<size_t>    r_tgt_cmd_to_tgt_rsp_error;
+      Register<size_t>    r_tgt_cmd_to_tgt_rsp_srcid;
+      Register<size_t>    r_tgt_cmd_to_tgt_rsp_trdid;
+      Register<size_t>    r_tgt_cmd_to_tgt_rsp_pktid;
 
-      sc_signal<addr_t>   r_tgt_cmd_config_addr;
-      sc_signal<size_t>   r_tgt_cmd_config_cmd;
+      Register<addr_t>    r_tgt_cmd_config_addr;
+      Register<size_t>    r_tgt_cmd_config_cmd;
 
       //////////////////////////////////////////////////
       // Registers controlled by the TGT_CMD fsm
       //////////////////////////////////////////////////
 
-      sc_signal<int>         r_tgt_cmd_fsm;
+      Register<int>          r_tgt_cmd_fsm;
 
       ///////////////////////////////////////////////////////
       // Registers controlled by the CONFIG fsm
       ///////////////////////////////////////////////////////
 
-      sc_signal<int>      r_config_fsm;               // FSM state
-      sc_signal<int>      r_config_cmd;               // config request type  
-      sc_signal<addr_t>   r_config_address;           // target buffer physical address
-      sc_signal<size_t>   r_config_srcid;             // config request srcid
-      sc_signal<size_t>   r_config_trdid;             // config request trdid
-      sc_signal<size_t>   r_config_pktid;             // config request pktid
-      sc_signal<size_t>   r_config_cmd_lines;         // number of lines to be handled
-      sc_signal<size_t>   r_config_rsp_lines;         // number of lines not completed
-      sc_signal<size_t>   r_config_dir_way;           // DIR: selected way
-      sc_signal<bool>     r_config_dir_lock;          // DIR: locked entry
-      sc_signal<size_t>   r_config_dir_count;         // DIR: number of copies
-      sc_signal<bool>     r_config_dir_is_cnt;        // DIR: counter mode (broadcast)
-      sc_signal<size_t>   r_config_dir_copy_srcid;    // DIR: first copy SRCID
-      sc_signal<bool>     r_config_dir_copy_inst;     // DIR: first copy L1 type
-      sc_signal<size_t>   r_config_dir_ptr;           // DIR: index of next copy in HEAP
-      sc_signal<size_t>   r_config_heap_next;         // current pointer to scan HEAP
-      sc_signal<size_t>   r_config_trt_index;         // selected entry in TRT
-      sc_signal<size_t>   r_config_ivt_index;         // selected entry in IVT 
+      Register<int>       r_config_fsm;               // FSM state
+      Register<int>       r_config_cmd;               // config request type  
+      Register<addr_t>    r_config_address;           // target buffer physical address
+      Register<size_t>    r_config_srcid;             // config request srcid
+      Register<size_t>    r_config_trdid;             // config request trdid
+      Register<size_t>    r_config_pktid;             // config request pktid
+      Register<size_t>    r_config_cmd_lines;         // number of lines to be handled
+      Register<size_t>    r_config_rsp_lines;         // number of lines not completed
+      Register<size_t>    r_config_dir_way;           // DIR: selected way
+      Register<bool>      r_config_dir_lock;          // DIR: locked entry
+      Register<size_t>    r_config_dir_count;         // DIR: number of copies
+      Register<bool>      r_config_dir_is_cnt;        // DIR: counter mode (broadcast)
+      Register<size_t>    r_config_dir_copy_srcid;    // DIR: first copy SRCID
+      Register<bool>      r_config_dir_copy_inst;     // DIR: first copy L1 type
+      Register<size_t>    r_config_dir_ptr;           // DIR: index of next copy in HEAP
+      Register<size_t>    r_config_heap_next;         // current pointer to scan HEAP
+      uint64_t *          m_config_sharers;           // copies to scan (bitset mode)
+      Register<size_t>    r_config_trt_index;         // selected entry in TRT
+      Register<size_t>    r_config_ivt_index;         // selected entry in IVT 
+      Register<size_t>    r_config_skip_delay;        // cycles to wait after a skip
+      size_t              m_config_skip_rate;         // absent lines skipped per cycle (0 if no skip)
 
       // Buffer between CONFIG fsm and IXR_CMD fsm
-      sc_signal<bool>     r_config_to_ixr_cmd_req;    // valid request
-      sc_signal<size_t>   r_config_to_ixr_cmd_index;  // TRT index
+      Register<bool>      r_config_to_ixr_cmd_req;    // valid request
+      Register<size_t>    r_config_to_ixr_cmd_index;  // TRT index
 
       // Buffer between CONFIG fsm and TGT_RSP fsm (send a done response to L1 cache)
-      sc_signal<bool>     r_config_to_tgt_rsp_req;    // valid request
-      sc_signal<bool>     r_config_to_tgt_rsp_error;  // error response
-      sc_signal<size_t>   r_config_to_tgt_rsp_srcid;  // Transaction srcid
-      sc_signal<size_t>   r_config_to_tgt_rsp_trdid;  // Transaction trdid
-      sc_signal<size_t>   r_config_to_tgt_rsp_pktid;  // Transaction pktid
+      Register<bool>      r_config_to_tgt_rsp_req;    // valid request
+      Register<bool>      r_config_to_tgt_rsp_error;  // error response
+      Register<size_t>    r_config_to_tgt_rsp_srcid;  // Transaction srcid
+      Register<size_t>    r_config_to_tgt_rsp_trdid;  // Transaction trdid
+      Register<size_t>    r_config_to_tgt_rsp_pktid;  // Transaction pktid
 
       // Buffer between CONFIG fsm and CC_SEND fsm (multi-inval / broadcast-inval)
-      sc_signal<bool>     r_config_to_cc_send_multi_req;    // multi-inval request
-      sc_signal<bool>     r_config_to_cc_send_brdcast_req;  // broadcast-inval request
-      sc_signal<addr_t>   r_config_to_cc_send_nline;        // line index
-      sc_signal<size_t>   r_config_to_cc_send_trdid;        // UPT index
+      Register<bool>      r_config_to_cc_send_multi_req;    // multi-inval request
+      Register<bool>      r_config_to_cc_send_brdcast_req;  // broadcast-inval request
+      Register<addr_t>    r_config_to_cc_send_nline;        // line index
+      Register<size_t>    r_config_to_cc_send_trdid;        // UPT index
       GenericFifo<bool>   m_config_to_cc_send_inst_fifo;    // fifo for the L1 type
       GenericFifo<size_t> m_config_to_cc_send_srcid_fifo;   // fifo for owners srcid
 
@@ -675,198 +730,200 @@ namespace soclib {  namespace caba {
       // Registers controlled by the READ fsm
       ///////////////////////////////////////////////////////
 
-      sc_signal<int>      r_read_fsm;                 // FSM state
-      sc_signal<size_t>   r_read_copy;                // Srcid of the first copy
-      sc_signal<size_t>   r_read_copy_cache;          // Srcid of the first copy
-      sc_signal<bool>     r_read_copy_inst;           // Type of the first copy
-      sc_signal<tag_t>    r_read_tag;                 // cache line tag (in directory)
-      sc_signal<bool>     r_read_is_cnt;              // is_cnt bit (in directory)
-      sc_signal<bool>     r_read_lock;                // lock bit (in directory)
-      sc_signal<bool>     r_read_dirty;               // dirty bit (in directory)
-      sc_signal<size_t>   r_read_count;               // number of copies
-      sc_signal<size_t>   r_read_ptr;                 // pointer to the heap
-      sc_signal<data_t> * r_read_data;                // data (one cache line)
-      sc_signal<size_t>   r_read_way;                 // associative way (in cache)
-      sc_signal<size_t>   r_read_trt_index;           // Transaction Table index
-      sc_signal<size_t>   r_read_next_ptr;            // Next entry to point to
-      sc_signal<bool>     r_read_last_free;           // Last free entry
-      sc_signal<addr_t>   r_read_ll_key;              // LL key from llsc_global_table
+      Register<int>       r_read_fsm;                 // FSM state
+      Register<size_t>    r_read_copy;                // Srcid of the first copy
+      Register<size_t>    r_read_copy_cache;          // Srcid of the first copy
+      Register<bool>      r_read_copy_inst;           // Type of the first copy
+      Register<tag_t>     r_read_tag;                 // cache line tag (in directory)
+      Register<bool>      r_read_is_cnt;              // is_cnt bit (in directory)
+      Register<bool>      r_read_lock;                // lock bit (in directory)
+      Register<bool>      r_read_dirty;               // dirty bit (in directory)
+      Register<size_t>    r_read_count;               // number of copies
+      Register<size_t>    r_read_ptr;                 // pointer to the heap
+      RegisterArray<data_t> r_read_data;              // data (one cache line)
+      Register<size_t>    r_read_way;                 // associative way (in cache)
+      Register<size_t>    r_read_trt_index;           // Transaction Table index
+      Register<size_t>    r_read_next_ptr;            // Next entry to point to
+      Register<bool>      r_read_last_free;           // Last free entry
+      Register<addr_t>    r_read_ll_key;              // LL key from llsc_global_table
 
       // Buffer between READ fsm and IXR_CMD fsm 
-      sc_signal<bool>     r_read_to_ixr_cmd_req;      // valid request
-      sc_signal<size_t>   r_read_to_ixr_cmd_index;    // TRT index
+      Register<bool>      r_read_to_ixr_cmd_req;      // valid request
+      Register<size_t>    r_read_to_ixr_cmd_index;    // TRT index
 
       // Buffer between READ fsm and TGT_RSP fsm (send a hit read response to L1 cache)
-      sc_signal<bool>     r_read_to_tgt_rsp_req;      // valid request
-      sc_signal<size_t>   r_read_to_tgt_rsp_srcid;    // Transaction srcid
-      sc_signal<size_t>   r_read_to_tgt_rsp_trdid;    // Transaction trdid
-      sc_signal<size_t>   r_read_to_tgt_rsp_pktid;    // Transaction pktid
-      sc_signal<data_t> * r_read_to_tgt_rsp_data;     // data (one cache line)
-      sc_signal<size_t>   r_read_to_tgt_rsp_word;     // first word of the response
-      sc_signal<size_t>   r_read_to_tgt_rsp_length;   // length of the response
-      sc_signal<addr_t>   r_read_to_tgt_rsp_ll_key;   // LL key from llsc_global_table
+      Register<bool>      r_read_to_tgt_rsp_req;      // valid request
+      Register<size_t>    r_read_to_tgt_rsp_srcid;    // Transaction srcid
+      Register<size_t>    r_read_to_tgt_rsp_trdid;    // Transaction trdid
+      Register<size_t>    r_read_to_tgt_rsp_pktid;    // Transaction pktid
+      RegisterArray<data_t> r_read_to_tgt_rsp_data;   // data (one cache line)
+      Register<size_t>    r_read_to_tgt_rsp_word;     // first word of the response
+      Register<size_t>    r_read_to_tgt_rsp_length;   // length of the response
+      Register<addr_t>    r_read_to_tgt_rsp_ll_key;   // LL key from llsc_global_table
 
       ///////////////////////////////////////////////////////////////
       // Registers controlled by the WRITE fsm
       ///////////////////////////////////////////////////////////////
 
-      sc_signal<int>      r_write_fsm;                // FSM state
-      sc_signal<addr_t>   r_write_address;            // first word address
-      sc_signal<size_t>   r_write_word_index;         // first word index in line
-      sc_signal<size_t>   r_write_word_count;         // number of words in line
-      sc_signal<size_t>   r_write_srcid;              // transaction srcid
-      sc_signal<size_t>   r_write_trdid;              // transaction trdid
-      sc_signal<size_t>   r_write_pktid;              // transaction pktid
-      sc_signal<data_t> * r_write_data;               // data (one cache line)
-      sc_signal<be_t>   * r_write_be;                 // one byte enable per word
-      sc_signal<bool>     r_write_byte;               // (BE != 0X0) and (BE != 0xF)
-      sc_signal<bool>     r_write_is_cnt;             // is_cnt bit (in directory)
-      sc_signal<bool>     r_write_lock;               // lock bit (in directory)
-      sc_signal<tag_t>    r_write_tag;                // cache line tag (in directory)
-      sc_signal<size_t>   r_write_copy;               // first owner of the line
-      sc_signal<size_t>   r_write_copy_cache;         // first owner of the line
-      sc_signal<bool>     r_write_copy_inst;          // is this owner a ICache ?
-      sc_signal<size_t>   r_write_count;              // number of copies
-      sc_signal<size_t>   r_write_ptr;                // pointer to the heap
-      sc_signal<size_t>   r_write_next_ptr;           // next pointer to the heap
-      sc_signal<bool>     r_write_to_dec;             // need to decrement update counter
-      sc_signal<size_t>   r_write_way;                // way of the line
-      sc_signal<size_t>   r_write_trt_index;          // index in Transaction Table
-      sc_signal<size_t>   r_write_upt_index;          // index in Update Table
-      sc_signal<bool>     r_write_sc_fail;            // sc command failed
-      sc_signal<data_t>   r_write_sc_key;             // sc command key
-      sc_signal<bool>     r_write_bc_data_we;         // Write enable for data buffer
+      Register<int>       r_write_fsm;                // FSM state
+      Register<addr_t>    r_write_address;            // first word address
+      Register<size_t>    r_write_word_index;         // first word index in line
+      Register<size_t>    r_write_word_count;         // number of words in line
+      Register<size_t>    r_write_srcid;              // transaction srcid
+      Register<size_t>    r_write_trdid;              // transaction trdid
+      Register<size_t>    r_write_pktid;              // transaction pktid
+      RegisterArray<data_t> r_write_data;             // data (one cache line)
+      RegisterArray<be_t> r_write_be;                 // one byte enable per word
+      Register<bool>      r_write_byte;               // (BE != 0X0) and (BE != 0xF)
+      Register<bool>      r_write_is_cnt;             // is_cnt bit (in directory)
+      Register<bool>      r_write_lock;               // lock bit (in directory)
+      Register<tag_t>     r_write_tag;                // cache line tag (in directory)
+      Register<size_t>    r_write_copy;               // first owner of the line
+      Register<size_t>    r_write_copy_cache;         // first owner of the line
+      Register<bool>      r_write_copy_inst;          // is this owner a ICache ?
+      Register<size_t>    r_write_count;              // number of copies
+      Register<size_t>    r_write_ptr;                // pointer to the heap
+      Register<size_t>    r_write_next_ptr;           // next pointer to the heap
+      uint64_t *          m_write_sharers;            // copies to scan (bitset mode)
+      Register<bool>      r_write_to_dec;             // need to decrement update counter
+      Register<size_t>    r_write_way;                // way of the line
+      Register<size_t>    r_write_trt_index;          // index in Transaction Table
+      Register<size_t>    r_write_upt_index;          // index in Update Table
+      Register<bool>      r_write_sc_fail;            // sc command failed
+      Register<data_t>    r_write_sc_key;             // sc command key
+      Register<bool>      r_write_bc_data_we;         // Write enable for data buffer
 
       // Buffer between WRITE fsm and TGT_RSP fsm (acknowledge a write command from L1)
-      sc_signal<bool>     r_write_to_tgt_rsp_req;     // valid request
-      sc_signal<size_t>   r_write_to_tgt_rsp_srcid;   // transaction srcid
-      sc_signal<size_t>   r_write_to_tgt_rsp_trdid;   // transaction trdid
-      sc_signal<size_t>   r_write_to_tgt_rsp_pktid;   // transaction pktid
-      sc_signal<bool>     r_write_to_tgt_rsp_sc_fail; // sc command failed
+      Register<bool>      r_write_to_tgt_rsp_req;     // valid request
+      Register<size_t>    r_write_to_tgt_rsp_srcid;   // transaction srcid
+      Register<size_t>    r_write_to_tgt_rsp_trdid;   // transaction trdid
+      Register<size_t>    r_write_to_tgt_rsp_pktid;   // transaction pktid
+      Register<bool>      r_write_to_tgt_rsp_sc_fail; // sc command failed
 
       // Buffer between WRITE fsm and IXR_CMD fsm 
-      sc_signal<bool>     r_write_to_ixr_cmd_req;     // valid request
-      sc_signal<size_t>   r_write_to_ixr_cmd_index;   // TRT index 
+      Register<bool>      r_write_to_ixr_cmd_req;     // valid request
+      Register<size_t>    r_write_to_ixr_cmd_index;   // TRT index 
 
       // Buffer between WRITE fsm and CC_SEND fsm (Update/Invalidate L1 caches)
-      sc_signal<bool>     r_write_to_cc_send_multi_req;     // valid multicast request
-      sc_signal<bool>     r_write_to_cc_send_brdcast_req;   // valid brdcast request
-      sc_signal<addr_t>   r_write_to_cc_send_nline;         // cache line index
-      sc_signal<size_t>   r_write_to_cc_send_trdid;         // index in Update Table
-      sc_signal<data_t> * r_write_to_cc_send_data;          // data (one cache line)
-      sc_signal<be_t>   * r_write_to_cc_send_be;            // word enable
-      sc_signal<size_t>   r_write_to_cc_send_count;         // number of words in line
-      sc_signal<size_t>   r_write_to_cc_send_index;         // index of first word in line
+      Register<bool>      r_write_to_cc_send_multi_req;     // valid multicast request
+      Register<bool>      r_write_to_cc_send_brdcast_req;   // valid brdcast request
+      Register<addr_t>    r_write_to_cc_send_nline;         // cache line index
+      Register<size_t>    r_write_to_cc_send_trdid;         // index in Update Table
+      RegisterArray<data_t> r_write_to_cc_send_data;        // data (one cache line)
+      RegisterArray<be_t> r_write_to_cc_send_be;            // word enable
+      Register<size_t>    r_write_to_cc_send_count;         // number of words in line
+      Register<size_t>    r_write_to_cc_send_index;         // index of first word in line
       GenericFifo<bool>   m_write_to_cc_send_inst_fifo;     // fifo for the L1 type
       GenericFifo<size_t> m_write_to_cc_send_srcid_fifo;    // fifo for srcids
 
       // Buffer between WRITE fsm and MULTI_ACK fsm (Decrement UPT entry)
-      sc_signal<bool>     r_write_to_multi_ack_req;       // valid request
-      sc_signal<size_t>   r_write_to_multi_ack_upt_index; // index in update table
+      Register<bool>      r_write_to_multi_ack_req;       // valid request
+      Register<size_t>    r_write_to_multi_ack_upt_index; // index in update table
 
       /////////////////////////////////////////////////////////
       // Registers controlled by MULTI_ACK fsm
       //////////////////////////////////////////////////////////
 
-      sc_signal<int>      r_multi_ack_fsm;       // FSM state
-      sc_signal<size_t>   r_multi_ack_upt_index; // index in the Update Table
-      sc_signal<size_t>   r_multi_ack_srcid;     // pending write srcid
-      sc_signal<size_t>   r_multi_ack_trdid;     // pending write trdid
-      sc_signal<size_t>   r_multi_ack_pktid;     // pending write pktid
-      sc_signal<addr_t>   r_multi_ack_nline;     // pending write nline
+      Register<int>       r_multi_ack_fsm;       // FSM state
+      Register<size_t>    r_multi_ack_upt_index; // index in the Update Table
+      Register<size_t>    r_multi_ack_srcid;     // pending write srcid
+      Register<size_t>    r_multi_ack_trdid;     // pending write trdid
+      Register<size_t>    r_multi_ack_pktid;     // pending write pktid
+      Register<addr_t>    r_multi_ack_nline;     // pending write nline
 
       // Buffer between MULTI_ACK fsm and TGT_RSP fsm (complete write/update transaction)
-      sc_signal<bool>     r_multi_ack_to_tgt_rsp_req;   // valid request
-      sc_signal<size_t>   r_multi_ack_to_tgt_rsp_srcid; // Transaction srcid
-      sc_signal<size_t>   r_multi_ack_to_tgt_rsp_trdid; // Transaction trdid
-      sc_signal<size_t>   r_multi_ack_to_tgt_rsp_pktid; // Transaction pktid
+      Register<bool>      r_multi_ack_to_tgt_rsp_req;   // valid request
+      Register<size_t>    r_multi_ack_to_tgt_rsp_srcid; // Transaction srcid
+      Register<size_t>    r_multi_ack_to_tgt_rsp_trdid; // Transaction trdid
+      Register<size_t>    r_multi_ack_to_tgt_rsp_pktid; // Transaction pktid
 
       ///////////////////////////////////////////////////////
       // Registers controlled by CLEANUP fsm
       ///////////////////////////////////////////////////////
 
-      sc_signal<int>      r_cleanup_fsm;           // FSM state
-      sc_signal<size_t>   r_cleanup_srcid;         // transaction srcid
-      sc_signal<bool>     r_cleanup_inst;          // Instruction or Data ?
-      sc_signal<size_t>   r_cleanup_way_index;     // L1 Cache Way index
-      sc_signal<addr_t>   r_cleanup_nline;         // cache line index
-
-
-      sc_signal<copy_t>   r_cleanup_copy;          // first copy
-      sc_signal<copy_t>   r_cleanup_copy_cache;    // first copy
-      sc_signal<size_t>   r_cleanup_copy_inst;     // type of the first copy
-      sc_signal<copy_t>   r_cleanup_count;         // number of copies
-      sc_signal<size_t>   r_cleanup_ptr;           // pointer to the heap
-      sc_signal<size_t>   r_cleanup_prev_ptr;      // previous pointer to the heap
-      sc_signal<size_t>   r_cleanup_prev_srcid;    // srcid of previous heap entry
-      sc_signal<size_t>   r_cleanup_prev_cache_id; // srcid of previous heap entry
-      sc_signal<bool>     r_cleanup_prev_inst;     // inst bit of previous heap entry
-      sc_signal<size_t>   r_cleanup_next_ptr;      // next pointer to the heap
-      sc_signal<tag_t>    r_cleanup_tag;           // cache line tag (in directory)
-      sc_signal<bool>     r_cleanup_is_cnt;        // inst bit (in directory)
-      sc_signal<bool>     r_cleanup_lock;          // lock bit (in directory)
-      sc_signal<bool>     r_cleanup_dirty;         // dirty bit (in directory)
-      sc_signal<size_t>   r_cleanup_way;           // associative way (in cache)
-
-      sc_signal<size_t>   r_cleanup_write_srcid;   // srcid of write rsp
-      sc_signal<size_t>   r_cleanup_write_trdid;   // trdid of write rsp
-      sc_signal<size_t>   r_cleanup_write_pktid;   // pktid of write rsp
-
-      sc_signal<bool>     r_cleanup_need_rsp;      // write response required
-      sc_signal<bool>     r_cleanup_need_ack;      // config acknowledge required
-
-      sc_signal<size_t>   r_cleanup_index;         // index of the INVAL line (in the UPT)
+      Register<int>       r_cleanup_fsm;           // FSM state
+      Register<size_t>    r_cleanup_srcid;         // transaction srcid
+      Register<bool>      r_cleanup_inst;          // Instruction or Data ?
+      Register<size_t>    r_cleanup_way_index;     // L1 Cache Way index
+      Register<addr_t>    r_cleanup_nline;         // cache line index
+
+
+      Register<copy_t>    r_cleanup_copy;          // first copy
+      Register<copy_t>    r_cleanup_copy_cache;    // first copy
+      Register<size_t>    r_cleanup_copy_inst;     // type of the first copy
+      Register<copy_t>    r_cleanup_count;         // number of copies
+      Register<size_t>    r_cleanup_ptr;           // pointer to the heap
+      Register<size_t>    r_cleanup_prev_ptr;      // previous pointer to the heap
+      Register<size_t>    r_cleanup_prev_srcid;    // srcid of previous heap entry
+      Register<size_t>    r_cleanup_prev_cache_id; // srcid of previous heap entry
+      Register<bool>      r_cleanup_prev_inst;     // inst bit of previous heap entry
+      Register<size_t>    r_cleanup_next_ptr;      // next pointer to the heap
+      Register<tag_t>     r_cleanup_tag;           // cache line tag (in directory)
+      Register<bool>      r_cleanup_is_cnt;        // inst bit (in directory)
+      Register<bool>      r_cleanup_lock;          // lock bit (in directory)
+      Register<bool>      r_cleanup_dirty;         // dirty bit (in directory)
+      Register<size_t>    r_cleanup_way;           // associative way (in cache)
+
+      Register<size_t>    r_cleanup_write_srcid;   // srcid of write rsp
+      Register<size_t>    r_cleanup_write_trdid;   // trdid of write rsp
+      Register<size_t>    r_cleanup_write_pktid;   // pktid of write rsp
+
+      Register<bool>      r_cleanup_need_rsp;      // write response required
+      Register<bool>      r_cleanup_need_ack;      // config acknowledge required
+
+      Register<size_t>    r_cleanup_index;         // index of the INVAL line (in the UPT)
 
       // Buffer between CLEANUP fsm and TGT_RSP fsm (acknowledge a write command from L1)
-      sc_signal<bool>     r_cleanup_to_tgt_rsp_req;   // valid request
-      sc_signal<size_t>   r_cleanup_to_tgt_rsp_srcid; // transaction srcid
-      sc_signal<size_t>   r_cleanup_to_tgt_rsp_trdid; // transaction trdid
-      sc_signal<size_t>   r_cleanup_to_tgt_rsp_pktid; // transaction pktid
+      Register<bool>      r_cleanup_to_tgt_rsp_req;   // valid request
+      Register<size_t>    r_cleanup_to_tgt_rsp_srcid; // transaction srcid
+      Register<size_t>    r_cleanup_to_tgt_rsp_trdid; // transaction trdid
+      Register<size_t>    r_cleanup_to_tgt_rsp_pktid; // transaction pktid
 
       ///////////////////////////////////////////////////////
       // Registers controlled by CAS fsm
       ///////////////////////////////////////////////////////
 
-      sc_signal<int>      r_cas_fsm;              // FSM state
-      sc_signal<data_t>   r_cas_wdata;            // write data word
-      sc_signal<data_t> * r_cas_rdata;            // read data word
-      sc_signal<uint32_t> r_cas_lfsr;             // lfsr for random introducing
-      sc_signal<size_t>   r_cas_cpt;              // size of command
-      sc_signal<copy_t>   r_cas_copy;             // Srcid of the first copy
-      sc_signal<copy_t>   r_cas_copy_cache;       // Srcid of the first copy
-      sc_signal<bool>     r_cas_copy_inst;        // Type of the first copy
-      sc_signal<size_t>   r_cas_count;            // number of copies
-      sc_signal<size_t>   r_cas_ptr;              // pointer to the heap
-      sc_signal<size_t>   r_cas_next_ptr;         // next pointer to the heap
-      sc_signal<bool>     r_cas_is_cnt;           // is_cnt bit (in directory)
-      sc_signal<bool>     r_cas_dirty;            // dirty bit (in directory)
-      sc_signal<size_t>   r_cas_way;              // way in directory
-      sc_signal<size_t>   r_cas_set;              // set in directory
-      sc_signal<data_t>   r_cas_tag;              // cache line tag (in directory)
-      sc_signal<size_t>   r_cas_trt_index;        // Transaction Table index
-      sc_signal<size_t>   r_cas_upt_index;        // Update Table index
-      sc_signal<data_t> * r_cas_data;             // cache line data
+      Register<int>       r_cas_fsm;              // FSM state
+      Register<data_t>    r_cas_wdata;            // write data word
+      RegisterArray<data_t> r_cas_rdata;          // read data word
+      Register<uint32_t>  r_cas_lfsr;             // lfsr for random introducing
+      Register<size_t>    r_cas_cpt;              // size of command
+      Register<copy_t>    r_cas_copy;             // Srcid of the first copy
+      Register<copy_t>    r_cas_copy_cache;       // Srcid of the first copy
+      Register<bool>      r_cas_copy_inst;        // Type of the first copy
+      Register<size_t>    r_cas_count;            // number of copies
+      Register<size_t>    r_cas_ptr;              // pointer to the heap
+      Register<size_t>    r_cas_next_ptr;         // next pointer to the heap
+      uint64_t *          m_cas_sharers;          // copies to scan (bitset mode)
+      Register<bool>      r_cas_is_cnt;           // is_cnt bit (in directory)
+      Register<bool>      r_cas_dirty;            // dirty bit (in directory)
+      Register<size_t>    r_cas_way;              // way in directory
+      Register<size_t>    r_cas_set;              // set in directory
+      Register<data_t>    r_cas_tag;              // cache line tag (in directory)
+      Register<size_t>    r_cas_trt_index;        // Transaction Table index
+      Register<size_t>    r_cas_upt_index;        // Update Table index
+      RegisterArray<data_t> r_cas_data;           // cache line data
 
       // Buffer between CAS fsm and IXR_CMD fsm 
-      sc_signal<bool>     r_cas_to_ixr_cmd_req;   // valid request
-      sc_signal<size_t>   r_cas_to_ixr_cmd_index; // TRT index 
+      Register<bool>      r_cas_to_ixr_cmd_req;   // valid request
+      Register<size_t>    r_cas_to_ixr_cmd_index; // TRT index 
 
       // Buffer between CAS fsm and TGT_RSP fsm
-      sc_signal<bool>     r_cas_to_tgt_rsp_req;   // valid request
-      sc_signal<data_t>   r_cas_to_tgt_rsp_data;  // read data word
-      sc_signal<size_t>   r_cas_to_tgt_rsp_srcid; // Transaction srcid
-      sc_signal<size_t>   r_cas_to_tgt_rsp_trdid; // Transaction trdid
-      sc_signal<size_t>   r_cas_to_tgt_rsp_pktid; // Transaction pktid
+      Register<bool>      r_cas_to_tgt_rsp_req;   // valid request
+      Register<data_t>    r_cas_to_tgt_rsp_data;  // read data word
+      Register<size_t>    r_cas_to_tgt_rsp_srcid; // Transaction srcid
+      Register<size_t>    r_cas_to_tgt_rsp_trdid; // Transaction trdid
+      Register<size_t>    r_cas_to_tgt_rsp_pktid; // Transaction pktid
 
       // Buffer between CAS fsm and CC_SEND fsm (Update/Invalidate L1 caches)
-      sc_signal<bool>     r_cas_to_cc_send_multi_req;     // valid request
-      sc_signal<bool>     r_cas_to_cc_send_brdcast_req;   // brdcast request
-      sc_signal<addr_t>   r_cas_to_cc_send_nline;         // cache line index
-      sc_signal<size_t>   r_cas_to_cc_send_trdid;         // index in Update Table
-      sc_signal<data_t>   r_cas_to_cc_send_wdata;         // data (one word)
-      sc_signal<bool>     r_cas_to_cc_send_is_long;       // it is a 64 bits CAS
-      sc_signal<data_t>   r_cas_to_cc_send_wdata_high;    // data high (one word)
-      sc_signal<size_t>   r_cas_to_cc_send_index;         // index of the word in line
+      Register<bool>      r_cas_to_cc_send_multi_req;     // valid request
+      Register<bool>      r_cas_to_cc_send_brdcast_req;   // brdcast request
+      Register<addr_t>    r_cas_to_cc_send_nline;         // cache line index
+      Register<size_t>    r_cas_to_cc_send_trdid;         // index in Update Table
+      Register<data_t>    r_cas_to_cc_send_wdata;         // data (one word)
+      Register<bool>      r_cas_to_cc_send_is_long;       // it is a 64 bits CAS
+      Register<data_t>    r_cas_to_cc_send_wdata_high;    // data high (one word)
+      Register<size_t>    r_cas_to_cc_send_index;         // index of the word in line
       GenericFifo<bool>   m_cas_to_cc_send_inst_fifo;     // fifo for the L1 type
       GenericFifo<size_t> m_cas_to_cc_send_srcid_fifo;    // fifo for srcids
 
@@ -874,129 +931,130 @@ namespace soclib {  namespace caba {
       // Registers controlled by the IXR_RSP fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_ixr_rsp_fsm;                // FSM state
-      sc_signal<size_t>   r_ixr_rsp_trt_index;          // TRT entry index
-      sc_signal<size_t>   r_ixr_rsp_cpt;                // word counter
+      Register<int>       r_ixr_rsp_fsm;                // FSM state
+      Register<size_t>    r_ixr_rsp_trt_index;          // TRT entry index
+      Register<size_t>    r_ixr_rsp_cpt;                // word counter
 
       // Buffer between IXR_RSP fsm and CONFIG fsm  (response from the XRAM)
-      sc_signal<bool>     r_ixr_rsp_to_config_ack;      // one single bit   
+      Register<bool>      r_ixr_rsp_to_config_ack;      // one single bit   
 
       // Buffer between IXR_RSP fsm and XRAM_RSP fsm  (response from the XRAM)
-      sc_signal<bool>   * r_ixr_rsp_to_xram_rsp_rok;    // one bit per TRT entry
+      RegisterArray<bool> r_ixr_rsp_to_xram_rsp_rok;    // one bit per TRT entry
 
       ////////////////////////////////////////////////////
       // Registers controlled by the XRAM_RSP fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_xram_rsp_fsm;               // FSM state
-      sc_signal<size_t>   r_xram_rsp_trt_index;         // TRT entry index
+      Register<int>       r_xram_rsp_fsm;               // FSM state
+      Register<size_t>    r_xram_rsp_trt_index;         // TRT entry index
       TransactionTabEntry r_xram_rsp_trt_buf;           // TRT entry local buffer
-      sc_signal<bool>     r_xram_rsp_victim_inval;      // victim line invalidate
-      sc_signal<bool>     r_xram_rsp_victim_is_cnt;     // victim line inst bit
-      sc_signal<bool>     r_xram_rsp_victim_dirty;      // victim line dirty bit
-      sc_signal<size_t>   r_xram_rsp_victim_way;        // victim line way
-      sc_signal<size_t>   r_xram_rsp_victim_set;        // victim line set
-      sc_signal<addr_t>   r_xram_rsp_victim_nline;      // victim line index
-      sc_signal<copy_t>   r_xram_rsp_victim_copy;       // victim line first copy
-      sc_signal<copy_t>   r_xram_rsp_victim_copy_cache; // victim line first copy
-      sc_signal<bool>     r_xram_rsp_victim_copy_inst;  // victim line type of first copy
-      sc_signal<size_t>   r_xram_rsp_victim_count;      // victim line number of copies
-      sc_signal<size_t>   r_xram_rsp_victim_ptr;        // victim line pointer to the heap
-      sc_signal<data_t> * r_xram_rsp_victim_data;       // victim line data
-      sc_signal<size_t>   r_xram_rsp_ivt_index;         // IVT entry index
-      sc_signal<size_t>   r_xram_rsp_next_ptr;          // Next pointer to the heap
-      sc_signal<bool>     r_xram_rsp_rerror_irq;        // WRITE MISS rerror irq
-      sc_signal<bool>     r_xram_rsp_rerror_irq_enable; // WRITE MISS rerror irq enable
-      sc_signal<addr_t>   r_xram_rsp_rerror_address;    // WRITE MISS rerror address
-      sc_signal<size_t>   r_xram_rsp_rerror_rsrcid;     // WRITE MISS rerror srcid
+      Register<bool>      r_xram_rsp_victim_inval;      // victim line invalidate
+      Register<bool>      r_xram_rsp_victim_is_cnt;     // victim line inst bit
+      Register<bool>      r_xram_rsp_victim_dirty;      // victim line dirty bit
+      Register<size_t>    r_xram_rsp_victim_way;        // victim line way
+      Register<size_t>    r_xram_rsp_victim_set;        // victim line set
+      Register<addr_t>    r_xram_rsp_victim_nline;      // victim line index
+      Register<copy_t>    r_xram_rsp_victim_copy;       // victim line first copy
+      Register<copy_t>    r_xram_rsp_victim_copy_cache; // victim line first copy
+      Register<bool>      r_xram_rsp_victim_copy_inst;  // victim line type of first copy
+      Register<size_t>    r_xram_rsp_victim_count;      // victim line number of copies
+      Register<size_t>    r_xram_rsp_victim_ptr;        // victim line pointer to the heap
+      RegisterArray<data_t> r_xram_rsp_victim_data;     // victim line data
+      Register<size_t>    r_xram_rsp_ivt_index;         // IVT entry index
+      Register<size_t>    r_xram_rsp_next_ptr;          // Next pointer to the heap
+      uint64_t *          m_xram_rsp_sharers;           // victim copies to scan (bitset mode)
+      Register<bool>      r_xram_rsp_rerror_irq;        // WRITE MISS rerror irq
+      Register<bool>      r_xram_rsp_rerror_irq_enable; // WRITE MISS rerror irq enable
+      Register<addr_t>    r_xram_rsp_rerror_address;    // WRITE MISS rerror address
+      Register<size_t>    r_xram_rsp_rerror_rsrcid;     // WRITE MISS rerror srcid
 
       // Buffer between XRAM_RSP fsm and TGT_RSP fsm  (response to L1 cache)
-      sc_signal<bool>     r_xram_rsp_to_tgt_rsp_req;    // Valid request
-      sc_signal<size_t>   r_xram_rsp_to_tgt_rsp_srcid;  // Transaction srcid
-      sc_signal<size_t>   r_xram_rsp_to_tgt_rsp_trdid;  // Transaction trdid
-      sc_signal<size_t>   r_xram_rsp_to_tgt_rsp_pktid;  // Transaction pktid
-      sc_signal<data_t> * r_xram_rsp_to_tgt_rsp_data;   // data (one cache line)
-      sc_signal<size_t>   r_xram_rsp_to_tgt_rsp_word;   // first word index
-      sc_signal<size_t>   r_xram_rsp_to_tgt_rsp_length; // length of the response
-      sc_signal<bool>     r_xram_rsp_to_tgt_rsp_rerror; // send error to requester
-      sc_signal<addr_t>   r_xram_rsp_to_tgt_rsp_ll_key; // LL key from llsc_global_table
+      Register<bool>      r_xram_rsp_to_tgt_rsp_req;    // Valid request
+      Register<size_t>    r_xram_rsp_to_tgt_rsp_srcid;  // Transaction srcid
+      Register<size_t>    r_xram_rsp_to_tgt_rsp_trdid;  // Transaction trdid
+      Register<size_t>    r_xram_rsp_to_tgt_rsp_pktid;  // Transaction pktid
+      RegisterArray<data_t> r_xram_rsp_to_tgt_rsp_data; // data (one cache line)
+      Register<size_t>    r_xram_rsp_to_tgt_rsp_word;   // first word index
+      Register<size_t>    r_xram_rsp_to_tgt_rsp_length; // length of the response
+      Register<bool>      r_xram_rsp_to_tgt_rsp_rerror; // send error to requester
+      Register<addr_t>    r_xram_rsp_to_tgt_rsp_ll_key; // LL key from llsc_global_table
 
       // Buffer between XRAM_RSP fsm and CC_SEND fsm (Inval L1 Caches)
-      sc_signal<bool>     r_xram_rsp_to_cc_send_multi_req;     // Valid request
-      sc_signal<bool>     r_xram_rsp_to_cc_send_brdcast_req;   // Broadcast request
-      sc_signal<addr_t>   r_xram_rsp_to_cc_send_nline;         // cache line index;
-      sc_signal<size_t>   r_xram_rsp_to_cc_send_trdid;         // index of UPT entry
+      Register<bool>      r_xram_rsp_to_cc_send_multi_req;     // Valid request
+      Register<bool>      r_xram_rsp_to_cc_send_brdcast_req;   // Broadcast request
+      Register<addr_t>    r_xram_rsp_to_cc_send_nline;         // cache line index;
+      Register<size_t>    r_xram_rsp_to_cc_send_trdid;         // index of UPT entry
       GenericFifo<bool>   m_xram_rsp_to_cc_send_inst_fifo;     // fifo for the L1 type
       GenericFifo<size_t> m_xram_rsp_to_cc_send_srcid_fifo;    // fifo for srcids
 
       // Buffer between XRAM_RSP fsm and IXR_CMD fsm 
-      sc_signal<bool>     r_xram_rsp_to_ixr_cmd_req;   // Valid request
-      sc_signal<size_t>   r_xram_rsp_to_ixr_cmd_index; // TRT index 
+      Register<bool>      r_xram_rsp_to_ixr_cmd_req;   // Valid request
+      Register<size_t>    r_xram_rsp_to_ixr_cmd_index; // TRT index 
 
       ////////////////////////////////////////////////////
       // Registers controlled by the IXR_CMD fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_ixr_cmd_fsm;
-      sc_signal<size_t>   r_ixr_cmd_word;              // word index for a put
-      sc_signal<size_t>   r_ixr_cmd_trdid;             // TRT index value     
-      sc_signal<addr_t>   r_ixr_cmd_address;           // address to XRAM
-      sc_signal<data_t> * r_ixr_cmd_wdata;             // cache line buffer
-      sc_signal<bool>     r_ixr_cmd_get;               // transaction type (PUT/GET)
+      Register<int>       r_ixr_cmd_fsm;
+      Register<size_t>    r_ixr_cmd_word;              // word index for a put
+      Register<size_t>    r_ixr_cmd_trdid;             // TRT index value     
+      Register<addr_t>    r_ixr_cmd_address;           // address to XRAM
+      RegisterArray<data_t> r_ixr_cmd_wdata;           // cache line buffer
+      Register<bool>      r_ixr_cmd_get;               // transaction type (PUT/GET)
 
       ////////////////////////////////////////////////////
       // Registers controlled by TGT_RSP fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_tgt_rsp_fsm;
-      sc_signal<size_t>   r_tgt_rsp_cpt;
-      sc_signal<bool>     r_tgt_rsp_key_sent;
+      Register<int>       r_tgt_rsp_fsm;
+      Register<size_t>    r_tgt_rsp_cpt;
+      Register<bool>      r_tgt_rsp_key_sent;
 
       ////////////////////////////////////////////////////
       // Registers controlled by CC_SEND fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_cc_send_fsm;
-      sc_signal<size_t>   r_cc_send_cpt;
-      sc_signal<bool>     r_cc_send_inst;
+      Register<int>       r_cc_send_fsm;
+      Register<size_t>    r_cc_send_cpt;
+      Register<bool>      r_cc_send_inst;
 
       ////////////////////////////////////////////////////
       // Registers controlled by CC_RECEIVE fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_cc_receive_fsm;
+      Register<int>       r_cc_receive_fsm;
 
       ////////////////////////////////////////////////////
       // Registers controlled by ALLOC_DIR fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_alloc_dir_fsm;
-      sc_signal<unsigned> r_alloc_dir_reset_cpt;
+      Register<int>       r_alloc_dir_fsm;
+      Register<unsigned>  r_alloc_dir_reset_cpt;
 
       ////////////////////////////////////////////////////
       // Registers controlled by ALLOC_TRT fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_alloc_trt_fsm;
+      Register<int>       r_alloc_trt_fsm;
 
       ////////////////////////////////////////////////////
       // Registers controlled by ALLOC_UPT fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_alloc_upt_fsm;
+      Register<int>       r_alloc_upt_fsm;
 
       ////////////////////////////////////////////////////
       // Registers controlled by ALLOC_IVT fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_alloc_ivt_fsm;
+      Register<int>       r_alloc_ivt_fsm;
 
       ////////////////////////////////////////////////////
       // Registers controlled by ALLOC_HEAP fsm
       ////////////////////////////////////////////////////
 
-      sc_signal<int>      r_alloc_heap_fsm;
-      sc_signal<unsigned> r_alloc_heap_reset_cpt;
+      Register<int>       r_alloc_heap_fsm;
+      Register<unsigned>  r_alloc_heap_reset_cpt;
     }; // end class VciMemCache
 
 }}
@@ -0,0 +1,210 @@
+#ifndef SOCLIB_CABA_XRAM_BACKING_STORE_H
+#define SOCLIB_CABA_XRAM_BACKING_STORE_H
+
+#include <inttypes.h>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace soclib { namespace caba {
+
+////////////////////////////////////////////////////////////////////////
+//                    The XRAM backing store
+// This object contains the physical memory segment behind a memory
+// cache, when the memory cache accesses directly the XRAM contents,
+// instead of sending VCI transactions on the IXR port.
+// The segment is a lazily allocated private memory mapping:
+// - without image file, the pages are zero-filled on first access,
+//   and must be loaded with the binary code (see buffer()).
+// - with an image file (a flat physical memory image, whose offset
+//   is the physical address), the file is mapped copy-on-write,
+//   and only the touched pages are read from the file.
+// The pages of an image file are shared by all the simulators mapping
+// the same image (in the host page cache), until they are written.
+// Such an image can be built once from the binary code (see save()),
+// so that a parameter sweep does not hold one private copy of the
+// memory contents per simulator.
+////////////////////////////////////////////////////////////////////////
+class XramBackingStore {
+
+    typedef uint32_t data_t;
+
+    private:
+
+        const uint64_t m_base;      // physical base address
+        const uint64_t m_size;      // segment size (bytes)
+        uint8_t *      m_buffer;    // host memory mapping
+
+        XramBackingStore(const XramBackingStore &);
+        XramBackingStore & operator=(const XramBackingStore &);
+
+    public:
+
+        ////////////////////////
+        // Constructor
+        ////////////////////////
+        XramBackingStore(uint64_t base, uint64_t size, const char * image = NULL)
+            : m_base(base), m_size(size)
+        {
+            void * buffer = mmap(NULL, size,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                 -1, 0);
+            if (buffer == MAP_FAILED)
+            {
+                perror("XRAM BACKING STORE ERROR : cannot allocate segment");
+                exit(EXIT_FAILURE);
+            }
+            m_buffer = (uint8_t *)buffer;
+
+            if (image == NULL) return;
+
+            int         fd = open(image, O_RDONLY);
+            struct stat st;
+
+            if ((fd < 0) or (fstat(fd, &st) < 0))
+            {
+                perror("XRAM BACKING STORE ERROR : cannot open memory image");
+                exit(EXIT_FAILURE);
+            }
+
+            assert(((base % sysconf(_SC_PAGESIZE)) == 0) and
+                    "XRAM BACKING STORE ERROR : base address must be page aligned");
+
+            // map the part of the image covering the segment (if any)
+            if ((uint64_t)st.st_size > base)
+            {
+                uint64_t length = (uint64_t)st.st_size - base;
+                if (length > size) length = size;
+
+                if (mmap(m_buffer, length,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_FIXED,
+                         fd, base) == MAP_FAILED)
+                {
+                    perror("XRAM BACKING STORE ERROR : cannot map memory image");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            close(fd);
+        } // end constructor
+
+        /////////////////
+        // Destructor
+        /////////////////
+        ~XramBackingStore()
+        {
+            munmap(m_buffer, m_size);
+        }
+
+        uint64_t base() const
+        {
+            return m_base;
+        }
+
+        uint64_t size() const
+        {
+            return m_size;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The buffer() function returns the host address of the segment,
+        // (to be used by the soclib Loader to load the binary code).
+        /////////////////////////////////////////////////////////////////////
+        void * buffer()
+        {
+            return m_buffer;
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The save() function writes the segment in a flat physical memory
+        // image (at the offset defined by the physical address), that can
+        // be mapped by the constructor. The image file is created if it
+        // does not exist, and is not truncated, so that the segments of
+        // several backing stores can be saved in the same image. The pages
+        // containing only zeros are not written (sparse file).
+        // It returns the number of written pages.
+        /////////////////////////////////////////////////////////////////////
+        size_t save(const char * image) const
+        {
+            const uint64_t page    = sysconf(_SC_PAGESIZE);
+            int            fd      = open(image, O_WRONLY | O_CREAT, 0644);
+            size_t         written = 0;
+
+            if (fd < 0)
+            {
+                perror("XRAM BACKING STORE ERROR : cannot create memory image");
+                exit(EXIT_FAILURE);
+            }
+
+            for (uint64_t offset = 0; offset < m_size; offset += page)
+            {
+                const uint64_t   length = (m_size - offset < page) ? m_size - offset : page;
+                const uint64_t * words  = (const uint64_t *)(m_buffer + offset);
+                bool             zero   = true;
+
+                for (size_t i = 0; zero and (i < length / sizeof(uint64_t)); i++)
+                {
+                    zero = (words[i] == 0);
+                }
+                if (zero) continue;
+
+                if (pwrite(fd, m_buffer + offset, length, m_base + offset) != (ssize_t)length)
+                {
+                    perror("XRAM BACKING STORE ERROR : cannot write memory image");
+                    exit(EXIT_FAILURE);
+                }
+                written++;
+            }
+            close(fd);
+            return written;
+        } // end save()
+
+        /////////////////////////////////////////////////////////////////////
+        // The contains() function returns true if the physical address
+        // range [address, address + bytes[ is inside the segment.
+        /////////////////////////////////////////////////////////////////////
+        bool contains(uint64_t address, uint64_t bytes) const
+        {
+            return (address >= m_base) and
+                   ((address - m_base) + bytes <= m_size);
+        }
+
+        /////////////////////////////////////////////////////////////////////
+        // The read() and write() functions access a 32 bits word.
+        // The address must be contained in the segment.
+        /////////////////////////////////////////////////////////////////////
+        data_t read(uint64_t address) const
+        {
+            assert(contains(address, sizeof(data_t)) and
+                    "XRAM BACKING STORE ERROR : address out of segment");
+
+            return *(const data_t *)(m_buffer + (address - m_base));
+        }
+
+        void write(uint64_t address, data_t data)
+        {
+            assert(contains(address, sizeof(data_t)) and
+                    "XRAM BACKING STORE ERROR : address out of segment");
+
+            *(data_t *)(m_buffer + (address - m_base)) = data;
+        }
+
+}; // end class XramBackingStore
+
+}} // end namespaces
+
+#endif
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
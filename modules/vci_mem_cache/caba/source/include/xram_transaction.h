@@ -4,10 +4,38 @@
 #include <inttypes.h>
 #include <systemc>
 #include <cassert>
+#include <vector>
 #include "arithmetics.h"
 
 #define DEBUG_XRAM_TRANSACTION 0
 
+// maximum number of words in a cache line
+// (the write buffers are contained in the transaction tab entries)
+#define TRT_MAX_LINE_WORDS 16
+
+////////////////////////////////////////////////////////////////////////
+//                  A constant cache line
+// This object can be used as argument of the TransactionTab set()
+// and write_data_mask() functions, when all words of the line
+// (or all be of the line) have the same value.
+////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+class ConstantLine
+{
+    const T m_value;
+
+    public:
+    ConstantLine(const T value)
+        : m_value(value)
+    {}
+
+    T operator[](size_t) const
+    {
+        return m_value;
+    }
+}; // end class ConstantLine
+
 ////////////////////////////////////////////////////////////////////////
 //                  A transaction tab entry         
 ////////////////////////////////////////////////////////////////////////
@@ -29,8 +57,9 @@ class TransactionTabEntry
     bool   proc_read;             // read request from processor
     size_t read_length;           // length of the read (for the response)
     size_t word_index;            // index of the first read word (for response)
-    std::vector<data_t> wdata;    // write buffer (one cache line)
-    std::vector<be_t>   wdata_be; // be for each data in the write buffer
+    size_t  words;                // number of words in the write buffer
+    data_t  wdata[TRT_MAX_LINE_WORDS];    // write buffer (one cache line)
+    be_t    wdata_be[TRT_MAX_LINE_WORDS]; // be for each data in the write buffer
     bool    rerror;               // error returned by xram
     data_t  ll_key;               // LL key returned by the llsc_global_table
     bool    config;               // transaction required by CONFIG FSM
@@ -46,17 +75,19 @@ class TransactionTabEntry
     }
 
     /////////////////////////////////////////////////////////////////////
-    // The alloc() function initializes the vectors of an entry
+    // The alloc() function initializes the write buffer of an entry
     // The "n_words" argument is the number of words in a cache line.
     /////////////////////////////////////////////////////////////////////
     void alloc(size_t n_words)
     {
-        wdata_be.reserve((int) n_words);
-        wdata.reserve((int) n_words);
+        assert((n_words <= TRT_MAX_LINE_WORDS) and
+                "MEMC ERROR: Too many words per line in TRT alloc()");
+
+        words = n_words;
         for (size_t i = 0; i < n_words; i++)
         {
-            wdata_be.push_back(0);
-            wdata.push_back(0);
+            wdata_be[i] = 0;
+            wdata[i]    = 0;
         }
     }
 
@@ -74,8 +105,12 @@ class TransactionTabEntry
         proc_read   = source.proc_read;
         read_length = source.read_length;
         word_index  = source.word_index;
-        wdata_be.assign(source.wdata_be.begin(),source.wdata_be.end());
-        wdata.assign(source.wdata.begin(),source.wdata.end());
+        words       = source.words;
+        for (size_t i = 0; i < words; i++)
+        {
+            wdata_be[i] = source.wdata_be[i];
+            wdata[i]    = source.wdata[i];
+        }
         rerror      = source.rerror;
         ll_key      = source.ll_key;
         config      = source.config;
@@ -91,7 +126,7 @@ class TransactionTabEntry
             << " / error = " << rerror 
             << " / get = " << xram_read 
             << " / config = " << config << std::hex
-            << " / address = " << nline*4*wdata.size()
+            << " / address = " << nline*4*words
             << " / srcid = " << srcid << std::endl;
         if (mode)
         {
@@ -102,7 +137,7 @@ class TransactionTabEntry
                 << " / word_index  = " << word_index << std::hex 
                 << " / ll_key = " << ll_key << std::endl;
             std::cout << "        wdata = ";
-            for (size_t i = 0; i < wdata.size(); i++)
+            for (size_t i = 0; i < words; i++)
             {
                 std::cout << std::hex << wdata[i] << " / ";
             }
@@ -116,8 +151,7 @@ class TransactionTabEntry
 
     TransactionTabEntry()
     {
-        wdata_be.clear();
-        wdata.clear();
+        words  = 0;
         valid  = false;
         rerror = false;
         config = false;
@@ -125,26 +159,23 @@ class TransactionTabEntry
 
     TransactionTabEntry(const TransactionTabEntry &source)
     {
-        valid       = source.valid;
-        xram_read   = source.xram_read;
-        nline       = source.nline;
-        srcid       = source.srcid;
-        trdid       = source.trdid;
-        pktid       = source.pktid;
-        proc_read   = source.proc_read;
-        read_length = source.read_length;
-        word_index  = source.word_index;
-        wdata_be.assign(source.wdata_be.begin(), source.wdata_be.end());
-        wdata.assign(source.wdata.begin(), source.wdata.end());    
-        rerror      = source.rerror;
-        ll_key      = source.ll_key;
-        config      = source.config;
+        copy(source);
+    }
+
+    TransactionTabEntry & operator=(const TransactionTabEntry &source)
+    {
+        copy(source);
+        return *this;
     }
 
 }; // end class TransactionTabEntry
 
 ////////////////////////////////////////////////////////////////////////
 //                  The transaction tab                              
+// The free entries are registered in a bitmask, and the valid entries
+// are chained in a small hash table indexed by the nline, both updated
+// by the set() and erase() functions: the full(), hit_read() and
+// hit_write() functions do not scan the whole tab.
 ////////////////////////////////////////////////////////////////////////
 class TransactionTab
 {
@@ -175,6 +206,66 @@ class TransactionTab
         return ret;
     }
 
+    std::vector<uint64_t> free_mask;    // one bit per free entry
+    size_t                free_count;   // number of free entries
+    std::vector<size_t>   hash_head;    // first valid entry of each bucket
+    std::vector<size_t>   hash_next;    // next valid entry in the same bucket
+    size_t                hash_mask;
+    size_t                hash_shift;
+
+    // size_tab is used as the null entry index in the hash chains
+
+    size_t bucket(const addr_t nline) const
+    {
+        uint64_t key = nline.to_uint64();
+        return (size_t)(key ^ (key >> hash_shift)) & hash_mask;
+    }
+
+    void build()
+    {
+        // number of buckets : power of 2, at least twice the number of entries
+        hash_shift = 1;
+        while ((size_t)(1 << hash_shift) < 2 * size_tab) hash_shift++;
+        hash_mask = (1 << hash_shift) - 1;
+
+        free_mask.resize((size_tab + 63) / 64);
+        hash_next.resize(size_tab);
+        hash_head.resize(hash_mask + 1);
+        reset_index();
+    }
+
+    void reset_index()
+    {
+        for (size_t w = 0; w < free_mask.size(); w++) free_mask[w] = 0;
+        for (size_t i = 0; i < size_tab; i++) free_mask[i / 64] |= (uint64_t)1 << (i % 64);
+        free_count = size_tab;
+        for (size_t b = 0; b <= hash_mask; b++) hash_head[b] = size_tab;
+    }
+
+    void hash_remove(const size_t index)
+    {
+        size_t * link = &hash_head[bucket(tab[index].nline)];
+        while (*link != index)
+        {
+            assert((*link != size_tab) and "MEMC ERROR: TRT hash corrupted");
+            link = &hash_next[*link];
+        }
+        *link = hash_next[index];
+
+        free_mask[index / 64] |= (uint64_t)1 << (index % 64);
+        free_count++;
+    }
+
+    void hash_insert(const size_t index)
+    {
+        size_t b         = bucket(tab[index].nline);
+        hash_next[index] = hash_head[b];
+        hash_head[b]     = index;
+
+        free_mask[index / 64] &= ~((uint64_t)1 << (index % 64));
+        free_count--;
+    }
+
     public:
     TransactionTabEntry * tab; // The transaction tab
 
@@ -185,6 +276,7 @@ class TransactionTab
     {
         size_tab = 0;
         tab = NULL;
+        build();
     }
 
     TransactionTab(const std::string &name,
@@ -198,6 +290,7 @@ class TransactionTab
         {
             tab[i].alloc(n_words);
         }
+        build();
     }
 
     ~TransactionTab()
@@ -220,6 +313,7 @@ class TransactionTab
         {
             tab[i].init();
         }
+        reset_index();
     }
     /////////////////////////////////////////////////////////////////////
     // The print() function prints TRT content.
@@ -238,7 +332,7 @@ class TransactionTab
     // Arguments :
     // - index : the index of the entry to read
     /////////////////////////////////////////////////////////////////////
-    TransactionTabEntry read(const size_t index)
+    const TransactionTabEntry & read(const size_t index)
     {
         assert((index < size_tab) and "MEMC ERROR: Invalid Transaction Tab Entry");
 
@@ -248,18 +342,32 @@ class TransactionTab
     // The full() function returns the state of the transaction tab
     // Arguments :
     // - index : (return argument) the index of an empty entry 
+    // (the lowest one)
     // The function returns true if the transaction tab is full
     /////////////////////////////////////////////////////////////////////
     bool full(size_t & index)
     {
-        for (size_t i = 0; i < size_tab; i++)
+        if (free_count == 0) return true;
+
+        for (size_t w = 0; w < free_mask.size(); w++)
         {
-            if (!tab[i].valid)
+            uint64_t word = free_mask[w];
+            if (word == 0) continue;
+
+            size_t i = 0;
+#ifdef __GNUC__
+            i = __builtin_ctzll(word);
+#else
+            while (not (word & 1))
             {
-                index = i;
-                return false;    
+                word = word >> 1;
+                i++;
             }
+#endif
+            index = w * 64 + i;
+            return false;
         }
+        assert(false and "MEMC ERROR: TRT free mask corrupted");
         return true;
     }
     /////////////////////////////////////////////////////////////////////
@@ -272,15 +380,17 @@ class TransactionTab
     //////////////////////////////////////////////////////////////////////
     bool hit_read(const addr_t nline,size_t &index)
     {
-        for (size_t i = 0; i < size_tab; i++)
+        bool hit = false;
+        for (size_t i = hash_head[bucket(nline)]; i != size_tab; i = hash_next[i])
         {
-            if ((tab[i].valid && (nline == tab[i].nline)) && (tab[i].xram_read)) 
+            // the lowest index is returned, as several entries can match
+            if ((nline == tab[i].nline) && (tab[i].xram_read) && (!hit || (i < index))) 
             {
                 index = i;
-                return true;    
+                hit   = true;
             }
         }
-        return false;
+        return hit;
     }
     ///////////////////////////////////////////////////////////////////////
     // The hit_write() function looks if an XRAM write transaction exists 
@@ -291,9 +401,9 @@ class TransactionTab
     ///////////////////////////////////////////////////////////////////////
     bool hit_write(const addr_t nline)
     {
-        for (size_t i = 0; i < size_tab; i++)
+        for (size_t i = hash_head[bucket(nline)]; i != size_tab; i = hash_next[i])
         {
-            if (tab[i].valid && (nline == tab[i].nline) && !(tab[i].xram_read)) 
+            if ((nline == tab[i].nline) && !(tab[i].xram_read)) 
             {
                 return true;    
             }
@@ -301,28 +411,26 @@ class TransactionTab
         return false;
     }
     /////////////////////////////////////////////////////////////////////
-    // The write_data_mask() function writes a vector of data (a line).
+    // The write_data_mask() function writes a line of data.
     // The data is written only if the corresponding bits are set
-    // in the be vector. 
+    // in the be line. 
+    // The be and data arguments can be any object providing an
+    // operator[] for each word of the line (RegisterArray, array,
+    // ConstantLine...), and are read without copy.
     // Arguments :
     // - index : the index of the request in the transaction tab
-    // - be   : vector of be 
-    // - data : vector of data
+    // - be   : line of be 
+    // - data : line of data
     /////////////////////////////////////////////////////////////////////
+    template<typename BeLine, typename DataLine>
     void write_data_mask(const size_t index, 
-            const std::vector<be_t> & be, 
-            const std::vector<data_t> & data) 
+            const BeLine & be, 
+            const DataLine & data) 
     {
         assert( (index < size_tab) and
                 "MEMC ERROR: The selected entry is out of range in TRT write_data_mask()");
 
-        assert( (be.size() == tab[index].wdata_be.size()) and
-                "MEMC ERROR: Bad be size in TRT write_data_mask()");
-
-        assert( (data.size() == tab[index].wdata.size()) and
-                "MEMC ERROR: Bad data size in TRT write_data_mask()");
-
-        for (size_t i = 0; i < tab[index].wdata_be.size(); i++) 
+        for (size_t i = 0; i < tab[index].words; i++) 
         {
             tab[index].wdata_be[i] = tab[index].wdata_be[i] | be[i];
             data_t mask = be_to_mask(be[i]);
@@ -346,7 +454,10 @@ class TransactionTab
     // - data_be : the mask of the data to write (in case of write)
     // - ll_key  : the ll key (if any) returned by the llsc_global_table
     // - config  : transaction required by config FSM
+    // The data_be and data arguments can be any object providing an
+    // operator[] for each word of the line (see write_data_mask()).
     /////////////////////////////////////////////////////////////////////
+    template<typename BeLine, typename DataLine>
     void set(const size_t index,
             const bool xram_read,
             const addr_t nline,
@@ -356,19 +467,15 @@ class TransactionTab
             const bool proc_read,
             const size_t read_length,
             const size_t word_index,
-            const std::vector<be_t> & data_be,
-            const std::vector<data_t> & data, 
+            const BeLine & data_be,
+            const DataLine & data, 
             const data_t ll_key = 0,
             const bool config = false) 
     {
         assert((index < size_tab) and
                 "MEMC ERROR: The selected entry is out of range in TRT set()");
 
-        assert((data_be.size()==tab[index].wdata_be.size()) and 
-                "MEMC ERROR: Bad data_be argument in TRT set()");
-
-        assert((data.size()==tab[index].wdata.size()) and 
-                "MEMC ERROR: Bad data argument in TRT set()");
+        if (tab[index].valid) hash_remove(index);
 
         tab[index].valid       = true;
         tab[index].xram_read   = xram_read;
@@ -381,11 +488,12 @@ class TransactionTab
         tab[index].word_index  = word_index;
         tab[index].ll_key      = ll_key;
         tab[index].config      = config;
-        for (size_t i = 0; i < tab[index].wdata.size(); i++) 
+        for (size_t i = 0; i < tab[index].words; i++) 
         {
             tab[index].wdata_be[i] = data_be[i];
             tab[index].wdata[i]    = data[i];
         }
+        hash_insert(index);
     }
 
     /////////////////////////////////////////////////////////////////////
@@ -408,7 +516,7 @@ class TransactionTab
         assert((index < size_tab) and
                 "MEMC ERROR: The selected entry is out of range in TRT write_rsp()");
 
-        assert((word < tab[index].wdata_be.size()) and 
+        assert((word + 1 < tab[index].words) and 
                 "MEMC ERROR: Bad word index in TRT write_rsp()");
 
         assert((tab[index].valid) and
@@ -443,6 +551,7 @@ class TransactionTab
         assert( (index < size_tab) and 
                 "MEMC ERROR: The selected entry is out of range in TRT erase()");
 
+        if (tab[index].valid) hash_remove(index);
         tab[index].valid  = false;
         tab[index].rerror = false;
     }
@@ -38,7 +38,7 @@
 //////   debug services   /////////////////////////////////////////////////////////////
 // All debug messages are conditionned by two variables:
 // - compile time   : DEBUG_MEMC_*** : defined below
-// - execution time : m_debug  = (m_debug_ok) and (m_cpt_cycle > m_debug_start_cycle)
+// - execution time : m_debug  = (m_debug_ok) and (m_stats->cpt_cycles > m_debug_start_cycle)
 ///////////////////////////////////////////////////////////////////////////////////////
 
 #define DEBUG_MEMC_GLOBAL    0 // synthetic trace of all FSMs
@@ -349,6 +349,8 @@ namespace soclib { namespace caba {
 
         : soclib::caba::BaseModule(name),
 
+        m_stats(std::string(name)),
+
         p_clk("p_clk"),
         p_resetn("p_resetn"),
         p_irq ("p_irq"),
@@ -400,7 +402,7 @@ namespace soclib { namespace caba {
         m_config_regr_idx_mask((1 << m_config_regr_width) - 1),
         m_config_func_idx_mask((1 << m_config_func_width) - 1),
 
-        //  FIFOs
+        //  FIFOs and internal registers
         m_cmd_read_addr_fifo("m_cmd_read_addr_fifo", 4),
         m_cmd_read_length_fifo("m_cmd_read_length_fifo", 4),
         m_cmd_read_srcid_fifo("m_cmd_read_srcid_fifo", 4),
@@ -423,51 +425,303 @@ namespace soclib { namespace caba {
         m_cmd_cas_wdata_fifo("m_cmd_cas_wdata_fifo",4),
 
         m_cc_receive_to_cleanup_fifo("m_cc_receive_to_cleanup_fifo", 4),
-        m_cc_receive_to_multi_ack_fifo("m_cc_receive_to_multi_ack_fifo", 4),
 
-        r_tgt_cmd_fsm("r_tgt_cmd_fsm"),
-
-        r_config_fsm("r_config_fsm"),
+        m_cc_receive_to_multi_ack_fifo("m_cc_receive_to_multi_ack_fifo", 4),
 
+        r_tgt_cmd_to_tgt_rsp_req(m_registers),
+
+        r_tgt_cmd_to_tgt_rsp_rdata(m_registers),
+        r_tgt_cmd_to_tgt_rsp_error(m_registers),
+        r_tgt_cmd_to_tgt_rsp_srcid(m_registers),
+        r_tgt_cmd_to_tgt_rsp_trdid(m_registers),
+        r_tgt_cmd_to_tgt_rsp_pktid(m_registers),
+
+        r_tgt_cmd_config_addr(m_registers),
+        r_tgt_cmd_config_cmd(m_registers),
+
+        r_tgt_cmd_fsm(m_registers),
+
+        r_config_fsm(m_registers),
+        r_config_cmd(m_registers),
+        r_config_address(m_registers),
+        r_config_srcid(m_registers),
+        r_config_trdid(m_registers),
+        r_config_pktid(m_registers),
+        r_config_cmd_lines(m_registers),
+        r_config_rsp_lines(m_registers),
+        r_config_dir_way(m_registers),
+        r_config_dir_lock(m_registers),
+        r_config_dir_count(m_registers),
+        r_config_dir_is_cnt(m_registers),
+        r_config_dir_copy_srcid(m_registers),
+        r_config_dir_copy_inst(m_registers),
+        r_config_dir_ptr(m_registers),
+        r_config_heap_next(m_registers),
+        r_config_trt_index(m_registers),
+        r_config_ivt_index(m_registers),
+        r_config_skip_delay(m_registers),
+
+        r_config_to_ixr_cmd_req(m_registers),
+        r_config_to_ixr_cmd_index(m_registers),
+
+        r_config_to_tgt_rsp_req(m_registers),
+        r_config_to_tgt_rsp_error(m_registers),
+        r_config_to_tgt_rsp_srcid(m_registers),
+        r_config_to_tgt_rsp_trdid(m_registers),
+        r_config_to_tgt_rsp_pktid(m_registers),
+
+        r_config_to_cc_send_multi_req(m_registers),
+        r_config_to_cc_send_brdcast_req(m_registers),
+        r_config_to_cc_send_nline(m_registers),
+        r_config_to_cc_send_trdid(m_registers),
         m_config_to_cc_send_inst_fifo("m_config_to_cc_send_inst_fifo", 8),
         m_config_to_cc_send_srcid_fifo("m_config_to_cc_send_srcid_fifo", 8),
 
-        r_read_fsm("r_read_fsm"),
-
-        r_write_fsm("r_write_fsm"),
-
+        r_read_fsm(m_registers),
+        r_read_copy(m_registers),
+        r_read_copy_cache(m_registers),
+        r_read_copy_inst(m_registers),
+        r_read_tag(m_registers),
+        r_read_is_cnt(m_registers),
+        r_read_lock(m_registers),
+        r_read_dirty(m_registers),
+        r_read_count(m_registers),
+        r_read_ptr(m_registers),
+        r_read_data(m_registers, nwords),
+        r_read_way(m_registers),
+        r_read_trt_index(m_registers),
+        r_read_next_ptr(m_registers),
+        r_read_last_free(m_registers),
+        r_read_ll_key(m_registers),
+
+        r_read_to_ixr_cmd_req(m_registers),
+        r_read_to_ixr_cmd_index(m_registers),
+
+        r_read_to_tgt_rsp_req(m_registers),
+        r_read_to_tgt_rsp_srcid(m_registers),
+        r_read_to_tgt_rsp_trdid(m_registers),
+        r_read_to_tgt_rsp_pktid(m_registers),
+        r_read_to_tgt_rsp_data(m_registers, nwords),
+        r_read_to_tgt_rsp_word(m_registers),
+        r_read_to_tgt_rsp_length(m_registers),
+        r_read_to_tgt_rsp_ll_key(m_registers),
+
+        r_write_fsm(m_registers),
+        r_write_address(m_registers),
+        r_write_word_index(m_registers),
+        r_write_word_count(m_registers),
+        r_write_srcid(m_registers),
+        r_write_trdid(m_registers),
+        r_write_pktid(m_registers),
+        r_write_data(m_registers, nwords),
+        r_write_be(m_registers, nwords),
+        r_write_byte(m_registers),
+        r_write_is_cnt(m_registers),
+        r_write_lock(m_registers),
+        r_write_tag(m_registers),
+        r_write_copy(m_registers),
+        r_write_copy_cache(m_registers),
+        r_write_copy_inst(m_registers),
+        r_write_count(m_registers),
+        r_write_ptr(m_registers),
+        r_write_next_ptr(m_registers),
+        r_write_to_dec(m_registers),
+        r_write_way(m_registers),
+        r_write_trt_index(m_registers),
+        r_write_upt_index(m_registers),
+        r_write_sc_fail(m_registers),
+        r_write_sc_key(m_registers),
+        r_write_bc_data_we(m_registers),
+
+        r_write_to_tgt_rsp_req(m_registers),
+        r_write_to_tgt_rsp_srcid(m_registers),
+        r_write_to_tgt_rsp_trdid(m_registers),
+        r_write_to_tgt_rsp_pktid(m_registers),
+        r_write_to_tgt_rsp_sc_fail(m_registers),
+
+        r_write_to_ixr_cmd_req(m_registers),
+        r_write_to_ixr_cmd_index(m_registers),
+
+        r_write_to_cc_send_multi_req(m_registers),
+        r_write_to_cc_send_brdcast_req(m_registers),
+        r_write_to_cc_send_nline(m_registers),
+        r_write_to_cc_send_trdid(m_registers),
+        r_write_to_cc_send_data(m_registers, nwords),
+        r_write_to_cc_send_be(m_registers, nwords),
+        r_write_to_cc_send_count(m_registers),
+        r_write_to_cc_send_index(m_registers),
         m_write_to_cc_send_inst_fifo("m_write_to_cc_send_inst_fifo",8),
         m_write_to_cc_send_srcid_fifo("m_write_to_cc_send_srcid_fifo",8),
 
-        r_multi_ack_fsm("r_multi_ack_fsm"),
-
-        r_cleanup_fsm("r_cleanup_fsm"),
-
-        r_cas_fsm("r_cas_fsm"),
-
+        r_write_to_multi_ack_req(m_registers),
+        r_write_to_multi_ack_upt_index(m_registers),
+
+        r_multi_ack_fsm(m_registers),
+        r_multi_ack_upt_index(m_registers),
+        r_multi_ack_srcid(m_registers),
+        r_multi_ack_trdid(m_registers),
+        r_multi_ack_pktid(m_registers),
+        r_multi_ack_nline(m_registers),
+
+        r_multi_ack_to_tgt_rsp_req(m_registers),
+        r_multi_ack_to_tgt_rsp_srcid(m_registers),
+        r_multi_ack_to_tgt_rsp_trdid(m_registers),
+        r_multi_ack_to_tgt_rsp_pktid(m_registers),
+
+        r_cleanup_fsm(m_registers),
+        r_cleanup_srcid(m_registers),
+        r_cleanup_inst(m_registers),
+        r_cleanup_way_index(m_registers),
+        r_cleanup_nline(m_registers),
+
+        r_cleanup_copy(m_registers),
+        r_cleanup_copy_cache(m_registers),
+        r_cleanup_copy_inst(m_registers),
+        r_cleanup_count(m_registers),
+        r_cleanup_ptr(m_registers),
+        r_cleanup_prev_ptr(m_registers),
+        r_cleanup_prev_srcid(m_registers),
+        r_cleanup_prev_cache_id(m_registers),
+        r_cleanup_prev_inst(m_registers),
+        r_cleanup_next_ptr(m_registers),
+        r_cleanup_tag(m_registers),
+        r_cleanup_is_cnt(m_registers),
+        r_cleanup_lock(m_registers),
+        r_cleanup_dirty(m_registers),
+        r_cleanup_way(m_registers),
+
+        r_cleanup_write_srcid(m_registers),
+        r_cleanup_write_trdid(m_registers),
+        r_cleanup_write_pktid(m_registers),
+
+        r_cleanup_need_rsp(m_registers),
+        r_cleanup_need_ack(m_registers),
+
+        r_cleanup_index(m_registers),
+
+        r_cleanup_to_tgt_rsp_req(m_registers),
+        r_cleanup_to_tgt_rsp_srcid(m_registers),
+        r_cleanup_to_tgt_rsp_trdid(m_registers),
+        r_cleanup_to_tgt_rsp_pktid(m_registers),
+
+        r_cas_fsm(m_registers),
+        r_cas_wdata(m_registers),
+        r_cas_rdata(m_registers, 2),
+        r_cas_lfsr(m_registers),
+        r_cas_cpt(m_registers),
+        r_cas_copy(m_registers),
+        r_cas_copy_cache(m_registers),
+        r_cas_copy_inst(m_registers),
+        r_cas_count(m_registers),
+        r_cas_ptr(m_registers),
+        r_cas_next_ptr(m_registers),
+        r_cas_is_cnt(m_registers),
+        r_cas_dirty(m_registers),
+        r_cas_way(m_registers),
+        r_cas_set(m_registers),
+        r_cas_tag(m_registers),
+        r_cas_trt_index(m_registers),
+        r_cas_upt_index(m_registers),
+        r_cas_data(m_registers, nwords),
+
+        r_cas_to_ixr_cmd_req(m_registers),
+        r_cas_to_ixr_cmd_index(m_registers),
+
+        r_cas_to_tgt_rsp_req(m_registers),
+        r_cas_to_tgt_rsp_data(m_registers),
+        r_cas_to_tgt_rsp_srcid(m_registers),
+        r_cas_to_tgt_rsp_trdid(m_registers),
+        r_cas_to_tgt_rsp_pktid(m_registers),
+
+        r_cas_to_cc_send_multi_req(m_registers),
+        r_cas_to_cc_send_brdcast_req(m_registers),
+        r_cas_to_cc_send_nline(m_registers),
+        r_cas_to_cc_send_trdid(m_registers),
+        r_cas_to_cc_send_wdata(m_registers),
+        r_cas_to_cc_send_is_long(m_registers),
+        r_cas_to_cc_send_wdata_high(m_registers),
+        r_cas_to_cc_send_index(m_registers),
         m_cas_to_cc_send_inst_fifo("m_cas_to_cc_send_inst_fifo",8),
         m_cas_to_cc_send_srcid_fifo("m_cas_to_cc_send_srcid_fifo",8),
 
-        r_ixr_rsp_fsm("r_ixr_rsp_fsm"),
-        r_xram_rsp_fsm("r_xram_rsp_fsm"),
-
+        r_ixr_rsp_fsm(m_registers),
+        r_ixr_rsp_trt_index(m_registers),
+        r_ixr_rsp_cpt(m_registers),
+
+        r_ixr_rsp_to_config_ack(m_registers),
+
+        r_ixr_rsp_to_xram_rsp_rok(m_registers, trt_lines),
+
+        r_xram_rsp_fsm(m_registers),
+        r_xram_rsp_trt_index(m_registers),
+
+        r_xram_rsp_victim_inval(m_registers),
+        r_xram_rsp_victim_is_cnt(m_registers),
+        r_xram_rsp_victim_dirty(m_registers),
+        r_xram_rsp_victim_way(m_registers),
+        r_xram_rsp_victim_set(m_registers),
+        r_xram_rsp_victim_nline(m_registers),
+        r_xram_rsp_victim_copy(m_registers),
+        r_xram_rsp_victim_copy_cache(m_registers),
+        r_xram_rsp_victim_copy_inst(m_registers),
+        r_xram_rsp_victim_count(m_registers),
+        r_xram_rsp_victim_ptr(m_registers),
+        r_xram_rsp_victim_data(m_registers, nwords),
+        r_xram_rsp_ivt_index(m_registers),
+        r_xram_rsp_next_ptr(m_registers),
+        r_xram_rsp_rerror_irq(m_registers),
+        r_xram_rsp_rerror_irq_enable(m_registers),
+        r_xram_rsp_rerror_address(m_registers),
+        r_xram_rsp_rerror_rsrcid(m_registers),
+
+        r_xram_rsp_to_tgt_rsp_req(m_registers),
+        r_xram_rsp_to_tgt_rsp_srcid(m_registers),
+        r_xram_rsp_to_tgt_rsp_trdid(m_registers),
+        r_xram_rsp_to_tgt_rsp_pktid(m_registers),
+        r_xram_rsp_to_tgt_rsp_data(m_registers, nwords),
+        r_xram_rsp_to_tgt_rsp_word(m_registers),
+        r_xram_rsp_to_tgt_rsp_length(m_registers),
+        r_xram_rsp_to_tgt_rsp_rerror(m_registers),
+        r_xram_rsp_to_tgt_rsp_ll_key(m_registers),
+
+        r_xram_rsp_to_cc_send_multi_req(m_registers),
+        r_xram_rsp_to_cc_send_brdcast_req(m_registers),
+        r_xram_rsp_to_cc_send_nline(m_registers),
+        r_xram_rsp_to_cc_send_trdid(m_registers),
         m_xram_rsp_to_cc_send_inst_fifo("m_xram_rsp_to_cc_send_inst_fifo",8),
         m_xram_rsp_to_cc_send_srcid_fifo("m_xram_rsp_to_cc_send_srcid_fifo",8),
 
-        r_ixr_cmd_fsm("r_ixr_cmd_fsm"),
+        r_xram_rsp_to_ixr_cmd_req(m_registers),
+        r_xram_rsp_to_ixr_cmd_index(m_registers),
+
+        r_ixr_cmd_fsm(m_registers),
+        r_ixr_cmd_word(m_registers),
+        r_ixr_cmd_trdid(m_registers),
+        r_ixr_cmd_address(m_registers),
+        r_ixr_cmd_wdata(m_registers, nwords),
+        r_ixr_cmd_get(m_registers),
+
+        r_tgt_rsp_fsm(m_registers),
+        r_tgt_rsp_cpt(m_registers),
+        r_tgt_rsp_key_sent(m_registers),
+
+        r_cc_send_fsm(m_registers),
+        r_cc_send_cpt(m_registers),
+        r_cc_send_inst(m_registers),
+
+        r_cc_receive_fsm(m_registers),
 
-        r_tgt_rsp_fsm("r_tgt_rsp_fsm"),
+        r_alloc_dir_fsm(m_registers),
+        r_alloc_dir_reset_cpt(m_registers),
 
-        r_cc_send_fsm("r_cc_send_fsm"),
-        r_cc_receive_fsm("r_cc_receive_fsm"),
+        r_alloc_trt_fsm(m_registers),
 
-        r_alloc_dir_fsm("r_alloc_dir_fsm"),
-        r_alloc_dir_reset_cpt("r_alloc_dir_reset_cpt"),
-        r_alloc_trt_fsm("r_alloc_trt_fsm"),
-        r_alloc_upt_fsm("r_alloc_upt_fsm"),
-        r_alloc_ivt_fsm("r_alloc_ivt_fsm"),
-        r_alloc_heap_fsm("r_alloc_heap_fsm"),
-        r_alloc_heap_reset_cpt("r_alloc_heap_reset_cpt")
+        r_alloc_upt_fsm(m_registers),
+
+        r_alloc_ivt_fsm(m_registers),
+
+        r_alloc_heap_fsm(m_registers),
+        r_alloc_heap_reset_cpt(m_registers)
 
 #if MONITOR_MEMCACHE_FSM == 1
         ,
@@ -543,33 +797,30 @@ namespace soclib { namespace caba {
             m_x_self = (gid >> m_y_width) & ((1 << m_x_width) - 1);
             m_y_self =  gid               & ((1 << m_y_width) - 1);
 
-            // Allocation for IXR_RSP FSM
-            r_ixr_rsp_to_xram_rsp_rok  = new sc_signal<bool>[m_trt_lines];
+            // Allocation for debug
+            m_debug_previous_data      = new data_t[nwords];
+            m_debug_data               = new data_t[nwords];
 
-            // Allocation for XRAM_RSP FSM
-            r_xram_rsp_victim_data     = new sc_signal<data_t>[nwords];
-            r_xram_rsp_to_tgt_rsp_data = new sc_signal<data_t>[nwords];
+            m_trace_source             = NULL;
 
-            // Allocation for READ FSM
-            r_read_data                = new sc_signal<data_t>[nwords];
-            r_read_to_tgt_rsp_data     = new sc_signal<data_t>[nwords];
+            m_quiescent                = false;
+            m_quiescent_inputs         = 0;
 
-            // Allocation for WRITE FSM
-            r_write_data               = new sc_signal<data_t>[nwords];
-            r_write_be                 = new sc_signal<be_t>[nwords];
-            r_write_to_cc_send_data    = new sc_signal<data_t>[nwords];
-            r_write_to_cc_send_be      = new sc_signal<be_t>[nwords];
+            // VCI access to XRAM (see set_xram_store())
+            m_xram_store               = NULL;
+            m_xram_latency             = 0;
 
-            // Allocation for CAS FSM
-            r_cas_data                 = new sc_signal<data_t>[nwords];
-            r_cas_rdata                = new sc_signal<data_t>[2];
+            // copies registered in the heap (see set_sharer_directory())
+            m_sharers                  = NULL;
+            m_config_sharers           = NULL;
+            m_write_sharers            = NULL;
+            m_cas_sharers              = NULL;
+            m_xram_rsp_sharers         = NULL;
 
-            // Allocation for IXR_CMD FSM
-            r_ixr_cmd_wdata            = new sc_signal<data_t>[nwords];
+            // one directory access per line in CONFIG FSM (see set_config_skip())
+            m_config_skip_rate         = 0;
 
-            // Allocation for debug
-            m_debug_previous_data      = new data_t[nwords];
-            m_debug_data               = new data_t[nwords];
+            publish_counters();
 
             SC_METHOD(transition);
             dont_initialize();
@@ -580,6 +831,82 @@ namespace soclib { namespace caba {
             sensitive << p_clk.neg();
         } // end constructor
 
+    /////////////////////////////////////////////////////////////////////////////
+    // The set_xram_store() function selects the direct XRAM access mode:
+    // The IXR_CMD and IXR_RSP FSMs read and write the cache lines directly
+    // in the backing store, with a fixed latency, and no VCI transaction
+    // is sent on the p_vci_ixr port. The backing store must contain all
+    // the memory segments associated to this memory cache.
+    /////////////////////////////////////////////////////////////////////////////
+    tmpl(void)::set_xram_store(XramBackingStore * store, size_t latency)
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        for (size_t seg_id = 0; seg_id < m_nseg; seg_id++)
+        {
+            if (m_seg[seg_id]->special()) continue;
+
+            assert(store->contains(m_seg[seg_id]->baseAddress(), m_seg[seg_id]->size()) and
+                    "MEMC ERROR : the XRAM backing store does not contain the memory segments");
+        }
+        m_xram_store   = store;
+        m_xram_latency = latency;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // The set_sharer_directory() function selects the bitset directory mode:
+    // The copies that are not registered in the directory entry itself are
+    // registered in a bitset attached to the directory entry (full-map), and
+    // not in the linked lists of the heap. The slots argument is the bitset
+    // width, that must be at least the number of L1 caches (instruction and
+    // data) sharing this memory cache. A line switches to counter mode when
+    // it reaches the max number of copies, or when no slot is available.
+    // It must be called before the simulation starts.
+    /////////////////////////////////////////////////////////////////////////////
+    tmpl(void)::set_sharer_directory(size_t slots)
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        assert((m_sharers == NULL) and
+                "MEMC ERROR : the bitset directory mode is already selected");
+
+        m_sharers          = new SharerDirectory(m_ways, m_sets, slots,
+                                                 vci_param_int::S);
+        m_config_sharers   = new uint64_t[m_sharers->words()];
+        m_write_sharers    = new uint64_t[m_sharers->words()];
+        m_cas_sharers      = new uint64_t[m_sharers->words()];
+        m_xram_rsp_sharers = new uint64_t[m_sharers->words()];
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // The set_config_skip() function selects the bulk skip mode for the
+    // INVAL and SYNC config commands: the CONFIG FSM uses the presence
+    // summary of the directory to skip in one step all consecutive lines
+    // that are not in the cache, instead of one directory access per line.
+    // The lines_per_cycle argument defines the cost of a skip: skipping N
+    // lines takes N / lines_per_cycle cycles (at least one cycle).
+    // A zero value disables the skip mode (default), and the presence
+    // summary is then not maintained by the directory.
+    /////////////////////////////////////////////////////////////////////////////
+    tmpl(void)::set_config_skip(size_t lines_per_cycle)
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        m_config_skip_rate = lines_per_cycle;
+
+        if (lines_per_cycle == 0) return;
+
+        // the presence summary covers all the memory segments
+        uint64_t base = ~(uint64_t)0;
+        uint64_t end  = 0;
+        for (size_t seg_id = 0; seg_id < m_nseg; seg_id++)
+        {
+            if (m_seg[seg_id]->special()) continue;
+
+            uint64_t seg_base = m_seg[seg_id]->baseAddress();
+            uint64_t seg_end  = seg_base + m_seg[seg_id]->size();
+            if (seg_base < base) base = seg_base;
+            if (seg_end  > end)  end  = seg_end;
+        }
+        if (end > base) m_cache_directory.enable_presence((addr_t)base, end - base);
+    }
 
     //////////////////////////////////////////////////////////
     tmpl(void)::cache_monitor(addr_t addr, bool single_word)
@@ -624,7 +951,7 @@ namespace soclib { namespace caba {
             (entry.valid and (entry.dirty != m_debug_previous_dirty)) or data_change)
         {
             std::cout << "Monitor MEMC " << name()
-                      << " at cycle " << std::dec << m_cpt_cycles
+                      << " at cycle " << std::dec << m_stats->cpt_cycles
                       << " : address = " << std::hex << addr
                       << " / VAL = " << std::dec << entry.valid
                       << " / WAY = " << way
@@ -693,107 +1020,77 @@ namespace soclib { namespace caba {
     tmpl(int)::read_instrumentation(uint32_t regr, uint32_t & rdata)
     /////////////////////////////////////////////////////
     {
-        int error = 0;
+        const uint64_t * counter;
 
-        switch(regr)
+        // The counters are 64 bits: the LO register (even index) returns
+        // the 32 LSB and the HI register (next index) the 32 MSB.
+        switch(regr & ~0x1)
         {
             ///////////////////////////////////////////////////////
             //       DIRECT instrumentation registers            //
-            // Registers of 32 bits and therefore only LO is     //
-            // implemented.                                      //
-            //                                                   //
-            // The HI may be used in future implementations      //
             ///////////////////////////////////////////////////////
 
             // LOCAL
 
-            case MEMC_LOCAL_READ_LO   : rdata = m_cpt_read_local        ; break;
-            case MEMC_LOCAL_WRITE_LO  : rdata = m_cpt_write_flits_local ; break;
-            case MEMC_LOCAL_LL_LO     : rdata = m_cpt_ll_local          ; break;
-            case MEMC_LOCAL_SC_LO     : rdata = m_cpt_sc_local          ; break;
-            case MEMC_LOCAL_CAS_LO    : rdata = m_cpt_cas_local         ; break;
-            case MEMC_LOCAL_READ_HI   :
-            case MEMC_LOCAL_WRITE_HI  :
-            case MEMC_LOCAL_LL_HI     :
-            case MEMC_LOCAL_SC_HI     :
-            case MEMC_LOCAL_CAS_HI    : rdata = 0; break;
+            case MEMC_LOCAL_READ_LO   : counter = &m_stats->cpt_read_local        ; break;
+            case MEMC_LOCAL_WRITE_LO  : counter = &m_stats->cpt_write_flits_local ; break;
+            case MEMC_LOCAL_LL_LO     : counter = &m_stats->cpt_ll_local          ; break;
+            case MEMC_LOCAL_SC_LO     : counter = &m_stats->cpt_sc_local          ; break;
+            case MEMC_LOCAL_CAS_LO    : counter = &m_stats->cpt_cas_local         ; break;
 
             // REMOTE
 
-            case MEMC_REMOTE_READ_LO  : rdata = m_cpt_read_remote        ; break;
-            case MEMC_REMOTE_WRITE_LO : rdata = m_cpt_write_flits_remote ; break;
-            case MEMC_REMOTE_LL_LO    : rdata = m_cpt_ll_remote          ; break;
-            case MEMC_REMOTE_SC_LO    : rdata = m_cpt_sc_remote          ; break;
-            case MEMC_REMOTE_CAS_LO   : rdata = m_cpt_cas_remote         ; break;
-            case MEMC_REMOTE_READ_HI  :
-            case MEMC_REMOTE_WRITE_HI :
-            case MEMC_REMOTE_LL_HI    :
-            case MEMC_REMOTE_SC_HI    :
-            case MEMC_REMOTE_CAS_HI   : rdata = 0; break;
+            case MEMC_REMOTE_READ_LO  : counter = &m_stats->cpt_read_remote        ; break;
+            case MEMC_REMOTE_WRITE_LO : counter = &m_stats->cpt_write_flits_remote ; break;
+            case MEMC_REMOTE_LL_LO    : counter = &m_stats->cpt_ll_remote          ; break;
+            case MEMC_REMOTE_SC_LO    : counter = &m_stats->cpt_sc_remote          ; break;
+            case MEMC_REMOTE_CAS_LO   : counter = &m_stats->cpt_cas_remote         ; break;
 
             // COST
 
-            case MEMC_COST_READ_LO    : rdata = m_cpt_read_cost ; break;
-            case MEMC_COST_WRITE_LO   : rdata = m_cpt_write_cost; break;
-            case MEMC_COST_LL_LO      : rdata = m_cpt_ll_cost   ; break;
-            case MEMC_COST_SC_LO      : rdata = m_cpt_sc_cost   ; break;
-            case MEMC_COST_CAS_LO     : rdata = m_cpt_cas_cost  ; break;
-            case MEMC_COST_READ_HI    :
-            case MEMC_COST_WRITE_HI   :
-            case MEMC_COST_LL_HI      :
-            case MEMC_COST_SC_HI      :
-            case MEMC_COST_CAS_HI     : rdata = 0; break;
+            case MEMC_COST_READ_LO    : counter = &m_stats->cpt_read_cost ; break;
+            case MEMC_COST_WRITE_LO   : counter = &m_stats->cpt_write_cost; break;
+            case MEMC_COST_LL_LO      : counter = &m_stats->cpt_ll_cost   ; break;
+            case MEMC_COST_SC_LO      : counter = &m_stats->cpt_sc_cost   ; break;
+            case MEMC_COST_CAS_LO     : counter = &m_stats->cpt_cas_cost  ; break;
 
             ///////////////////////////////////////////////////////
             //       COHERENCE instrumentation registers         //
-            // Registers of 32 bits and therefore only LO is     //
-            // implemented.                                      //
-            //                                                   //
-            // The HI may be used in future implementations      //
             ///////////////////////////////////////////////////////
 
             // LOCAL
 
-            case MEMC_LOCAL_MUPDATE_LO  : rdata = m_cpt_update_local ; break;
-            case MEMC_LOCAL_MINVAL_LO   : rdata = m_cpt_minval_local ; break;
-            case MEMC_LOCAL_CLEANUP_LO  : rdata = m_cpt_cleanup_local; break;
-            case MEMC_LOCAL_MUPDATE_HI  :
-            case MEMC_LOCAL_MINVAL_HI   :
-            case MEMC_LOCAL_CLEANUP_HI  : rdata = 0; break;
+            case MEMC_LOCAL_MUPDATE_LO  : counter = &m_stats->cpt_update_local ; break;
+            case MEMC_LOCAL_MINVAL_LO   : counter = &m_stats->cpt_minval_local ; break;
+            case MEMC_LOCAL_CLEANUP_LO  : counter = &m_stats->cpt_cleanup_local; break;
 
             // REMOTE
 
-            case MEMC_REMOTE_MUPDATE_LO : rdata = m_cpt_update_remote ; break;
-            case MEMC_REMOTE_MINVAL_LO  : rdata = m_cpt_minval_remote ; break;
-            case MEMC_REMOTE_CLEANUP_LO : rdata = m_cpt_cleanup_remote; break;
-            case MEMC_REMOTE_MUPDATE_HI :
-            case MEMC_REMOTE_MINVAL_HI  :
-            case MEMC_REMOTE_CLEANUP_HI : rdata = 0; break;
+            case MEMC_REMOTE_MUPDATE_LO : counter = &m_stats->cpt_update_remote ; break;
+            case MEMC_REMOTE_MINVAL_LO  : counter = &m_stats->cpt_minval_remote ; break;
+            case MEMC_REMOTE_CLEANUP_LO : counter = &m_stats->cpt_cleanup_remote; break;
 
             // COST
 
-            case MEMC_COST_MUPDATE_LO   : rdata = m_cpt_update_cost   ; break;
-            case MEMC_COST_MINVAL_LO    : rdata = m_cpt_minval_cost   ; break;
-            case MEMC_COST_CLEANUP_LO   : rdata = m_cpt_cleanup_cost  ; break;
-            case MEMC_COST_MUPDATE_HI   :
-            case MEMC_COST_MINVAL_HI    :
-            case MEMC_COST_CLEANUP_HI   : rdata = 0; break;
+            case MEMC_COST_MUPDATE_LO   : counter = &m_stats->cpt_update_cost   ; break;
+            case MEMC_COST_MINVAL_LO    : counter = &m_stats->cpt_minval_cost   ; break;
+            case MEMC_COST_CLEANUP_LO   : counter = &m_stats->cpt_cleanup_cost  ; break;
 
             // TOTAL
 
-            case MEMC_TOTAL_MUPDATE_LO  : rdata = m_cpt_update ; break;
-            case MEMC_TOTAL_MINVAL_LO   : rdata = m_cpt_minval ; break;
-            case MEMC_TOTAL_BINVAL_LO   : rdata = m_cpt_binval ; break;
-            case MEMC_TOTAL_MUPDATE_HI  :
-            case MEMC_TOTAL_MINVAL_HI   :
-            case MEMC_TOTAL_BINVAL_HI   : rdata = 0; break;
+            case MEMC_TOTAL_MUPDATE_LO  : counter = &m_stats->cpt_update ; break;
+            case MEMC_TOTAL_MINVAL_LO   : counter = &m_stats->cpt_minval ; break;
+            case MEMC_TOTAL_BINVAL_LO   : counter = &m_stats->cpt_binval ; break;
 
             // unknown register
 
-            default                     : error = 1;
+            default                     : return 1;
         }
 
-        return error;
+        if (regr & 0x1) rdata = (uint32_t)(*counter >> 32);
+        else            rdata = (uint32_t)(*counter);
+
+        return 0;
     }
 
     //////////////////////////////////////////////////
@@ -823,60 +1120,178 @@ namespace soclib { namespace caba {
         if (detailed) m_trt.print(0);
     }
 
+    /////////////////////////////////////////////////////////////////////////////
+    // The binary_trace() function is the binary equivalent of print_trace(0):
+    // the FSM states are registered in the trace sink (see trace_sink.h),
+    // and the trace source is described at the first call.
+    /////////////////////////////////////////////////////////////////////////////
+    tmpl(void)::binary_trace(uint64_t cycle)
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        if (m_trace_source == NULL)
+        {
+            soclib::TraceSource * src = new soclib::TraceSource(std::string("MEMC ") + name());
+            src->field("  ",    tgt_cmd_fsm_str);
+            src->field(" | ",   tgt_rsp_fsm_str);
+            src->field(" | ",   read_fsm_str);
+            src->field(" | ",   write_fsm_str);
+            src->field(" | ",   cas_fsm_str);
+            src->field(" | ",   config_fsm_str);
+            src->field(" | ",   cleanup_fsm_str);
+            src->field("\n  ", cc_send_fsm_str);
+            src->field(" | ",   cc_receive_fsm_str);
+            src->field(" | ",   multi_ack_fsm_str);
+            src->field(" | ",   ixr_cmd_fsm_str);
+            src->field(" | ",   ixr_rsp_fsm_str);
+            src->field(" | ",   xram_rsp_fsm_str);
+            src->field("\n  ", alloc_dir_fsm_str);
+            src->field(" | ",   alloc_trt_fsm_str);
+            src->field(" | ",   alloc_upt_fsm_str);
+            src->field(" | ",   alloc_ivt_fsm_str);
+            src->field(" | ",   alloc_heap_fsm_str);
+            soclib::TraceSink::instance().attach(src);
+            m_trace_source = src;
+        }
+
+        uint32_t values[18] =
+        {
+            (uint32_t)r_tgt_cmd_fsm.read(),
+            (uint32_t)r_tgt_rsp_fsm.read(),
+            (uint32_t)r_read_fsm.read(),
+            (uint32_t)r_write_fsm.read(),
+            (uint32_t)r_cas_fsm.read(),
+            (uint32_t)r_config_fsm.read(),
+            (uint32_t)r_cleanup_fsm.read(),
+            (uint32_t)r_cc_send_fsm.read(),
+            (uint32_t)r_cc_receive_fsm.read(),
+            (uint32_t)r_multi_ack_fsm.read(),
+            (uint32_t)r_ixr_cmd_fsm.read(),
+            (uint32_t)r_ixr_rsp_fsm.read(),
+            (uint32_t)r_xram_rsp_fsm.read(),
+            (uint32_t)r_alloc_dir_fsm.read(),
+            (uint32_t)r_alloc_trt_fsm.read(),
+            (uint32_t)r_alloc_upt_fsm.read(),
+            (uint32_t)r_alloc_ivt_fsm.read(),
+            (uint32_t)r_alloc_heap_fsm.read(),
+        };
+        m_trace_source->push(cycle, values);
+    }
+
 
     /////////////////////////////////////////
     tmpl(void)::reset_counters()
     /////////////////////////////////////////
     {
-        m_cpt_reset_count        = m_cpt_cycles;
-
-        m_cpt_read_local         = 0;
-        m_cpt_read_remote        = 0;
-        m_cpt_read_cost          = 0;
-
-        m_cpt_write_local        = 0;
-        m_cpt_write_remote       = 0;
-        m_cpt_write_flits_local  = 0;
-        m_cpt_write_flits_remote = 0;
-        m_cpt_write_cost         = 0;
-
-        m_cpt_ll_local           = 0;
-        m_cpt_ll_remote          = 0;
-        m_cpt_ll_cost            = 0;
-
-        m_cpt_sc_local           = 0;
-        m_cpt_sc_remote          = 0;
-        m_cpt_sc_cost            = 0;
-
-        m_cpt_cas_local          = 0;
-        m_cpt_cas_remote         = 0;
-        m_cpt_cas_cost           = 0;
-
-        m_cpt_update             = 0;
-        m_cpt_update_local       = 0;
-        m_cpt_update_remote      = 0;
-        m_cpt_update_cost        = 0;
-
-        m_cpt_minval             = 0;
-        m_cpt_minval_local       = 0;
-        m_cpt_minval_remote      = 0;
-        m_cpt_minval_cost        = 0;
-
-        m_cpt_binval             = 0;
-        m_cpt_write_broadcast    = 0;
-
-        m_cpt_cleanup_local      = 0;
-        m_cpt_cleanup_remote     = 0;
-        m_cpt_cleanup_cost       = 0;
-
-        m_cpt_read_miss          = 0;
-        m_cpt_write_miss         = 0;
-        m_cpt_write_dirty        = 0;
-
-        m_cpt_trt_rb             = 0;
-        m_cpt_trt_full           = 0;
-        m_cpt_get                = 0;
-        m_cpt_put                = 0;
+        m_stats->cpt_reset_count        = m_stats->cpt_cycles;
+
+        m_stats->cpt_read_local         = 0;
+        m_stats->cpt_read_remote        = 0;
+        m_stats->cpt_read_cost          = 0;
+
+        m_stats->cpt_write_local        = 0;
+        m_stats->cpt_write_remote       = 0;
+        m_stats->cpt_write_flits_local  = 0;
+        m_stats->cpt_write_flits_remote = 0;
+        m_stats->cpt_write_cost         = 0;
+
+        m_stats->cpt_ll_local           = 0;
+        m_stats->cpt_ll_remote          = 0;
+        m_stats->cpt_ll_cost            = 0;
+
+        m_stats->cpt_sc_local           = 0;
+        m_stats->cpt_sc_remote          = 0;
+        m_stats->cpt_sc_cost            = 0;
+
+        m_stats->cpt_cas_local          = 0;
+        m_stats->cpt_cas_remote         = 0;
+        m_stats->cpt_cas_cost           = 0;
+
+        m_stats->cpt_update             = 0;
+        m_stats->cpt_update_local       = 0;
+        m_stats->cpt_update_remote      = 0;
+        m_stats->cpt_update_cost        = 0;
+
+        m_stats->cpt_minval             = 0;
+        m_stats->cpt_minval_local       = 0;
+        m_stats->cpt_minval_remote      = 0;
+        m_stats->cpt_minval_cost        = 0;
+
+        m_stats->cpt_binval             = 0;
+        m_stats->cpt_write_broadcast    = 0;
+
+        m_stats->cpt_cleanup_local      = 0;
+        m_stats->cpt_cleanup_remote     = 0;
+        m_stats->cpt_cleanup_cost       = 0;
+
+        m_stats->cpt_read_miss          = 0;
+        m_stats->cpt_write_miss         = 0;
+        m_stats->cpt_write_dirty        = 0;
+
+        m_stats->cpt_trt_rb             = 0;
+        m_stats->cpt_trt_full           = 0;
+        m_stats->cpt_get                = 0;
+        m_stats->cpt_put                = 0;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // The publish_counters() function names the activity counters in the
+    // counter block, and registers them in the statistics registry. The
+    // counter names are the metric names used by the platform scripts
+    // (see print_stats() for the tags).
+    /////////////////////////////////////////////////////////////////////////////
+    tmpl(void)::publish_counters()
+    /////////////////////////////////////////////////////////////////////////////
+    {
+        m_stats.add("counter_reset",      "cycle",        &m_stats->cpt_reset_count);
+        m_stats.add("ncycles",            "cycles",       &m_stats->cpt_cycles);
+
+        m_stats.add("local_read",         "transactions", &m_stats->cpt_read_local);
+        m_stats.add("remote_read",        "transactions", &m_stats->cpt_read_remote);
+        m_stats.add("read_cost",          "flits*hops",   &m_stats->cpt_read_cost);
+
+        m_stats.add("local_write",        "transactions", &m_stats->cpt_write_local);
+        m_stats.add("remote_write",       "transactions", &m_stats->cpt_write_remote);
+        m_stats.add("write_flits_local",  "flits",        &m_stats->cpt_write_flits_local);
+        m_stats.add("write_flits_remote", "flits",        &m_stats->cpt_write_flits_remote);
+        m_stats.add("write_cost",         "flits*hops",   &m_stats->cpt_write_cost);
+
+        m_stats.add("local_ll",           "transactions", &m_stats->cpt_ll_local);
+        m_stats.add("remote_ll",          "transactions", &m_stats->cpt_ll_remote);
+        m_stats.add("ll_cost",            "flits*hops",   &m_stats->cpt_ll_cost);
+
+        m_stats.add("local_sc",           "transactions", &m_stats->cpt_sc_local);
+        m_stats.add("remote_sc",          "transactions", &m_stats->cpt_sc_remote);
+        m_stats.add("sc_cost",            "flits*hops",   &m_stats->cpt_sc_cost);
+
+        m_stats.add("local_cas",          "transactions", &m_stats->cpt_cas_local);
+        m_stats.add("remote_cas",         "transactions", &m_stats->cpt_cas_remote);
+        m_stats.add("cas_cost",           "flits*hops",   &m_stats->cpt_cas_cost);
+
+        m_stats.add("req_trig_update",    "requests",     &m_stats->cpt_update);
+        m_stats.add("local_update",       "transactions", &m_stats->cpt_update_local);
+        m_stats.add("remote_update",      "transactions", &m_stats->cpt_update_remote);
+        m_stats.add("update_cost",        "flits*hops",   &m_stats->cpt_update_cost);
+
+        m_stats.add("req_trig_m_inv",     "requests",     &m_stats->cpt_minval);
+        m_stats.add("local_m_inv",        "transactions", &m_stats->cpt_minval_local);
+        m_stats.add("remote_m_inv",       "transactions", &m_stats->cpt_minval_remote);
+        m_stats.add("m_inv_cost",         "flits*hops",   &m_stats->cpt_minval_cost);
+
+        m_stats.add("broadcast",          "transactions", &m_stats->cpt_binval);
+        m_stats.add("write_broadcast",    "transactions", &m_stats->cpt_write_broadcast);
+
+        m_stats.add("local_cleanup",      "transactions", &m_stats->cpt_cleanup_local);
+        m_stats.add("remote_cleanup",     "transactions", &m_stats->cpt_cleanup_remote);
+        m_stats.add("cleanup_cost",       "flits*hops",   &m_stats->cpt_cleanup_cost);
+
+        m_stats.add("read_miss",          "requests",     &m_stats->cpt_read_miss);
+        m_stats.add("write_miss",         "requests",     &m_stats->cpt_write_miss);
+        m_stats.add("write_dirty",        "requests",     &m_stats->cpt_write_dirty);
+
+        m_stats.add("read_hit_trt",       "requests",     &m_stats->cpt_trt_rb);
+        m_stats.add("trans_full_trt",     "requests",     &m_stats->cpt_trt_full);
+        m_stats.add("put",                "transactions", &m_stats->cpt_put);
+        m_stats.add("get",                "transactions", &m_stats->cpt_get);
     }
 
     //////////////////////////////////////////////////////////////
@@ -892,62 +1307,62 @@ namespace soclib { namespace caba {
             std::cout << "---     Activity Counters      ---" << std::dec << std::endl;
             std::cout << "----------------------------------" << std::dec << std::endl;
             std::cout
-                << "[000] COUNTERS RESET AT CYCLE   = " << m_cpt_reset_count << std::endl
-                << "[001] NUMBER OF CYCLES          = " << m_cpt_cycles << std::endl
+                << "[000] COUNTERS RESET AT CYCLE   = " << m_stats->cpt_reset_count << std::endl
+                << "[001] NUMBER OF CYCLES          = " << m_stats->cpt_cycles << std::endl
                 << std::endl
-                << "[010] LOCAL READ                = " << m_cpt_read_local << std::endl
-                << "[011] REMOTE READ               = " << m_cpt_read_remote << std::endl
-                << "[012] READ COST (FLITS * DIST)  = " << m_cpt_read_cost << std::endl
+                << "[010] LOCAL READ                = " << m_stats->cpt_read_local << std::endl
+                << "[011] REMOTE READ               = " << m_stats->cpt_read_remote << std::endl
+                << "[012] READ COST (FLITS * DIST)  = " << m_stats->cpt_read_cost << std::endl
                 << std::endl
-                << "[020] LOCAL WRITE               = " << m_cpt_write_local << std::endl
-                << "[021] REMOTE WRITE              = " << m_cpt_write_remote << std::endl
-                << "[022] WRITE FLITS LOCAL         = " << m_cpt_write_flits_local << std::endl
-                << "[023] WRITE FLITS REMOTE        = " << m_cpt_write_flits_remote << std::endl
-                << "[024] WRITE COST (FLITS * DIST) = " << m_cpt_write_cost << std::endl
+                << "[020] LOCAL WRITE               = " << m_stats->cpt_write_local << std::endl
+                << "[021] REMOTE WRITE              = " << m_stats->cpt_write_remote << std::endl
+                << "[022] WRITE FLITS LOCAL         = " << m_stats->cpt_write_flits_local << std::endl
+                << "[023] WRITE FLITS REMOTE        = " << m_stats->cpt_write_flits_remote << std::endl
+                << "[024] WRITE COST (FLITS * DIST) = " << m_stats->cpt_write_cost << std::endl
                 << "[025] WRITE L1 MISS NCC         = " << "0" << std::endl
                 << std::endl
-                << "[030] LOCAL LL                  = " << m_cpt_ll_local << std::endl
-                << "[031] REMOTE LL                 = " << m_cpt_ll_remote << std::endl
-                << "[032] LL COST (FLITS * DIST)    = " << m_cpt_ll_cost << std::endl
+                << "[030] LOCAL LL                  = " << m_stats->cpt_ll_local << std::endl
+                << "[031] REMOTE LL                 = " << m_stats->cpt_ll_remote << std::endl
+                << "[032] LL COST (FLITS * DIST)    = " << m_stats->cpt_ll_cost << std::endl
                 << std::endl
-                << "[040] LOCAL SC                  = " << m_cpt_sc_local << std::endl
-                << "[041] REMOTE SC                 = " << m_cpt_sc_remote << std::endl
-                << "[042] SC COST (FLITS * DIST)    = " << m_cpt_sc_cost << std::endl
+                << "[040] LOCAL SC                  = " << m_stats->cpt_sc_local << std::endl
+                << "[041] REMOTE SC                 = " << m_stats->cpt_sc_remote << std::endl
+                << "[042] SC COST (FLITS * DIST)    = " << m_stats->cpt_sc_cost << std::endl
                 << std::endl
-                << "[050] LOCAL CAS                 = " << m_cpt_cas_local << std::endl
-                << "[051] REMOTE CAS                = " << m_cpt_cas_remote << std::endl
-                << "[052] CAS COST (FLITS * DIST)   = " << m_cpt_cas_cost << std::endl
+                << "[050] LOCAL CAS                 = " << m_stats->cpt_cas_local << std::endl
+                << "[051] REMOTE CAS                = " << m_stats->cpt_cas_remote << std::endl
+                << "[052] CAS COST (FLITS * DIST)   = " << m_stats->cpt_cas_cost << std::endl
                 << std::endl
-                << "[060] REQUESTS TRIG. UPDATE     = " << m_cpt_update << std::endl
-                << "[061] LOCAL UPDATE              = " << m_cpt_update_local << std::endl
-                << "[062] REMOTE UPDATE             = " << m_cpt_update_remote << std::endl
-                << "[063] UPDT COST (FLITS * DIST)  = " << m_cpt_update_cost << std::endl
+                << "[060] REQUESTS TRIG. UPDATE     = " << m_stats->cpt_update << std::endl
+                << "[061] LOCAL UPDATE              = " << m_stats->cpt_update_local << std::endl
+                << "[062] REMOTE UPDATE             = " << m_stats->cpt_update_remote << std::endl
+                << "[063] UPDT COST (FLITS * DIST)  = " << m_stats->cpt_update_cost << std::endl
                 << std::endl
-                << "[070] REQUESTS TRIG. M_INV      = " << m_cpt_minval << std::endl
-                << "[071] LOCAL M_INV               = " << m_cpt_minval_local << std::endl
-                << "[072] REMOTE M_INV              = " << m_cpt_minval_remote << std::endl
-                << "[073] M_INV COST (FLITS * DIST) = " << m_cpt_minval_cost << std::endl
+                << "[070] REQUESTS TRIG. M_INV      = " << m_stats->cpt_minval << std::endl
+                << "[071] LOCAL M_INV               = " << m_stats->cpt_minval_local << std::endl
+                << "[072] REMOTE M_INV              = " << m_stats->cpt_minval_remote << std::endl
+                << "[073] M_INV COST (FLITS * DIST) = " << m_stats->cpt_minval_cost << std::endl
                 << std::endl
-                << "[080] BROADCAT INVAL            = " << m_cpt_binval << std::endl
-                << "[081] WRITE BROADCAST           = " << m_cpt_write_broadcast << std::endl
+                << "[080] BROADCAT INVAL            = " << m_stats->cpt_binval << std::endl
+                << "[081] WRITE BROADCAST           = " << m_stats->cpt_write_broadcast << std::endl
                 << "[082] GETM BROADCAST            = " << "0" << std::endl
                 << std::endl
-                << "[090] LOCAL CLEANUP             = " << m_cpt_cleanup_local << std::endl
-                << "[091] REMOTE CLEANUP            = " << m_cpt_cleanup_remote << std::endl
-                << "[092] CLNUP COST (FLITS * DIST) = " << m_cpt_cleanup_cost << std::endl
+                << "[090] LOCAL CLEANUP             = " << m_stats->cpt_cleanup_local << std::endl
+                << "[091] REMOTE CLEANUP            = " << m_stats->cpt_cleanup_remote << std::endl
+                << "[092] CLNUP COST (FLITS * DIST) = " << m_stats->cpt_cleanup_cost << std::endl
                 << "[093] LOCAL CLEANUP DATA        = " << "0" << std::endl
                 << "[094] REMOTE CLEANUP DATA       = " << "0" << std::endl
                 << "[095] CLEANUP DATA COST         = " << "0" << std::endl
                 << std::endl
-                << "[100] READ MISS                 = " << m_cpt_read_miss << std::endl
-                << "[101] WRITE MISS                = " << m_cpt_write_miss << std::endl
-                << "[102] WRITE DIRTY               = " << m_cpt_write_dirty << std::endl
+                << "[100] READ MISS                 = " << m_stats->cpt_read_miss << std::endl
+                << "[101] WRITE MISS                = " << m_stats->cpt_write_miss << std::endl
+                << "[102] WRITE DIRTY               = " << m_stats->cpt_write_dirty << std::endl
                 << "[103] GETM MISS                 = " << "0" << std::endl
                 << std::endl
-                << "[110] RD BLOCKED BY HIT IN TRT  = " << m_cpt_trt_rb << std::endl
-                << "[111] TRANS BLOCKED BY FULL TRT = " << m_cpt_trt_full << std::endl
-                << "[120] PUT (UNIMPLEMENTED)       = " << m_cpt_put << std::endl
-                << "[121] GET (UNIMPLEMENTED)       = " << m_cpt_get << std::endl
+                << "[110] RD BLOCKED BY HIT IN TRT  = " << m_stats->cpt_trt_rb << std::endl
+                << "[111] TRANS BLOCKED BY FULL TRT = " << m_stats->cpt_trt_full << std::endl
+                << "[120] PUT (UNIMPLEMENTED)       = " << m_stats->cpt_put << std::endl
+                << "[121] GET (UNIMPLEMENTED)       = " << m_stats->cpt_get << std::endl
                 << "[130] MIN HEAP SLOT AV. (UNIMP) = " << "0" << std::endl
                 << std::endl
                 << "[140] NCC TO CC (READ)          = " << "0" << std::endl
@@ -972,25 +1387,17 @@ namespace soclib { namespace caba {
     {
         delete [] m_seg;
 
-        delete [] r_ixr_rsp_to_xram_rsp_rok;
-        delete [] r_xram_rsp_victim_data;
-        delete [] r_xram_rsp_to_tgt_rsp_data;
-
-        delete [] r_read_data;
-        delete [] r_read_to_tgt_rsp_data;
-
-        delete [] r_write_data;
-        delete [] r_write_be;
-        delete [] r_write_to_cc_send_data;
-        delete [] r_write_to_cc_send_be;
-
-        delete [] r_cas_data;
-        delete [] r_cas_rdata;
-
-        delete [] r_ixr_cmd_wdata;
         delete [] m_debug_previous_data;
         delete [] m_debug_data;
 
+        delete m_sharers;
+        delete [] m_config_sharers;
+        delete [] m_write_sharers;
+        delete [] m_cas_sharers;
+        delete [] m_xram_rsp_sharers;
+
+        soclib::StatisticsRegistry::instance().remove(name());
+
         //print_stats();
     }
 
@@ -1026,6 +1433,9 @@ namespace soclib { namespace caba {
 
             m_debug                = false;
             m_debug_previous_valid = false;
+            m_quiescent            = false;
+            m_quiescent_inputs     = 0;
+            m_xram_rsp_queue.clear();
             m_debug_previous_dirty = false;
             m_debug_previous_count = 0;
 
@@ -1034,6 +1444,7 @@ namespace soclib { namespace caba {
             m_upt.init();
             m_ivt.init();
             m_llsc_table.init();
+            if (m_sharers) m_sharers->init();
 
             // initializing FIFOs and communication Buffers
 
@@ -1058,6 +1469,7 @@ namespace soclib { namespace caba {
             m_cmd_cas_eop_fifo.init()   ;
 
             r_config_cmd  = MEMC_CMD_NOP;
+            r_config_skip_delay = 0;
 
             m_config_to_cc_send_inst_fifo.init();
             m_config_to_cc_send_srcid_fifo.init();
@@ -1116,57 +1528,58 @@ namespace soclib { namespace caba {
             r_tgt_rsp_key_sent  = false;
 
             // Activity counters
-            m_cpt_cycles             = 0;
-            m_cpt_reset_count        = 0;
-
-            m_cpt_read_local         = 0;
-            m_cpt_read_remote        = 0;
-            m_cpt_read_cost          = 0;
-
-            m_cpt_write_local        = 0;
-            m_cpt_write_remote       = 0;
-            m_cpt_write_flits_local  = 0;
-            m_cpt_write_flits_remote = 0;
-            m_cpt_write_cost         = 0;
-
-            m_cpt_ll_local           = 0;
-            m_cpt_ll_remote          = 0;
-            m_cpt_ll_cost            = 0;
-
-            m_cpt_sc_local           = 0;
-            m_cpt_sc_remote          = 0;
-            m_cpt_sc_cost            = 0;
-
-            m_cpt_cas_local          = 0;
-            m_cpt_cas_remote         = 0;
-            m_cpt_cas_cost           = 0;
-
-            m_cpt_update             = 0;
-            m_cpt_update_local       = 0;
-            m_cpt_update_remote      = 0;
-            m_cpt_update_cost        = 0;
-
-            m_cpt_minval             = 0;
-            m_cpt_minval_local       = 0;
-            m_cpt_minval_remote      = 0;
-            m_cpt_minval_cost        = 0;
-
-            m_cpt_binval             = 0;
-            m_cpt_write_broadcast    = 0;
-
-            m_cpt_cleanup_local      = 0;
-            m_cpt_cleanup_remote     = 0;
-            m_cpt_cleanup_cost       = 0;
-
-            m_cpt_read_miss          = 0;
-            m_cpt_write_miss         = 0;
-            m_cpt_write_dirty        = 0;
-
-            m_cpt_trt_rb             = 0;
-            m_cpt_trt_full           = 0;
-            m_cpt_get                = 0;
-            m_cpt_put                = 0;
-
+            m_stats->cpt_cycles             = 0;
+            m_stats->cpt_reset_count        = 0;
+
+            m_stats->cpt_read_local         = 0;
+            m_stats->cpt_read_remote        = 0;
+            m_stats->cpt_read_cost          = 0;
+
+            m_stats->cpt_write_local        = 0;
+            m_stats->cpt_write_remote       = 0;
+            m_stats->cpt_write_flits_local  = 0;
+            m_stats->cpt_write_flits_remote = 0;
+            m_stats->cpt_write_cost         = 0;
+
+            m_stats->cpt_ll_local           = 0;
+            m_stats->cpt_ll_remote          = 0;
+            m_stats->cpt_ll_cost            = 0;
+
+            m_stats->cpt_sc_local           = 0;
+            m_stats->cpt_sc_remote          = 0;
+            m_stats->cpt_sc_cost            = 0;
+
+            m_stats->cpt_cas_local          = 0;
+            m_stats->cpt_cas_remote         = 0;
+            m_stats->cpt_cas_cost           = 0;
+
+            m_stats->cpt_update             = 0;
+            m_stats->cpt_update_local       = 0;
+            m_stats->cpt_update_remote      = 0;
+            m_stats->cpt_update_cost        = 0;
+
+            m_stats->cpt_minval             = 0;
+            m_stats->cpt_minval_local       = 0;
+            m_stats->cpt_minval_remote      = 0;
+            m_stats->cpt_minval_cost        = 0;
+
+            m_stats->cpt_binval             = 0;
+            m_stats->cpt_write_broadcast    = 0;
+
+            m_stats->cpt_cleanup_local      = 0;
+            m_stats->cpt_cleanup_remote     = 0;
+            m_stats->cpt_cleanup_cost       = 0;
+
+            m_stats->cpt_read_miss          = 0;
+            m_stats->cpt_write_miss         = 0;
+            m_stats->cpt_write_dirty        = 0;
+
+            m_stats->cpt_trt_rb             = 0;
+            m_stats->cpt_trt_full           = 0;
+            m_stats->cpt_get                = 0;
+            m_stats->cpt_put                = 0;
+
+            m_registers.commit();
             return;
         }
 
@@ -1209,7 +1622,40 @@ namespace soclib { namespace caba {
         bool   cas_to_cc_send_fifo_inst  = false;
         size_t cas_to_cc_send_fifo_srcid = 0;
 
-        m_debug = (m_cpt_cycles > m_debug_start_cycle) and m_debug_ok;
+        m_debug = (m_stats->cpt_cycles > m_debug_start_cycle) and m_debug_ok;
+
+        ////////////////////////////////////////////////////////////////////////////////////
+        //    Quiescence fast path
+        ////////////////////////////////////////////////////////////////////////////////////
+        // The transition() function only depends on the internal state (registers,
+        // FIFOs and tables) and on the input ports. If the previous cycle did not modify
+        // the internal state (m_quiescent), and the input ports did not change, the
+        // current cycle will not modify it either, and the FSMs are not evaluated.
+        // The input data fields are only sampled when the corresponding request
+        // (cmdval, rspval, write) is set, so only the handshake signals are compared,
+        // and the fast path requires that no request is pending on the input ports.
+        ////////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t inputs = (p_vci_tgt.cmdval.read()   ? 0x01 : 0) |
+                          (p_vci_ixr.rspval.read()   ? 0x02 : 0) |
+                          (p_dspin_p2m.write.read()  ? 0x04 : 0) |
+                          (p_vci_tgt.rspack.read()   ? 0x08 : 0) |
+                          (p_vci_ixr.cmdack.read()   ? 0x10 : 0) |
+                          (p_dspin_m2p.read.read()   ? 0x20 : 0) |
+                          (p_dspin_clack.read.read() ? 0x40 : 0);
+
+        if (m_quiescent and not m_debug and
+            (inputs == m_quiescent_inputs) and not (inputs & 0x07))
+        {
+            m_stats->cpt_cycles++;
+            return;
+        }
+        m_quiescent_inputs = inputs;
+
+        // The P2M flit is converted once per cycle from the DSPIN port type
+        // (sc_uint) to the native 64 bits representation used by the
+        // CC_RECEIVE FSM and FIFOs.
+        const uint64_t p2m_flit = p_dspin_p2m.data.read();
 
 #if DEBUG_MEMC_GLOBAL
         if (m_debug)
@@ -1217,7 +1663,7 @@ namespace soclib { namespace caba {
             std::cout
                 << "---------------------------------------------"           << std::dec << std::endl
                 << "MEM_CACHE "            << name()
-                << " ; Time = "            << m_cpt_cycles                                << std::endl
+                << " ; Time = "            << m_stats->cpt_cycles                                << std::endl
                 << " - TGT_CMD FSM    = "  << tgt_cmd_fsm_str[r_tgt_cmd_fsm.read()]       << std::endl
                 << " - TGT_RSP FSM    = "  << tgt_rsp_fsm_str[r_tgt_rsp_fsm.read()]       << std::endl
                 << " - CC_SEND FSM  = "    << cc_send_fsm_str[r_cc_send_fsm.read()]       << std::endl
@@ -1664,27 +2110,27 @@ std::cout << "  <MEMC " << name()
                     {
                         if (is_local_req(p_vci_tgt.srcid.read()))
                         {
-                            m_cpt_ll_local++;
+                            m_stats->cpt_ll_local++;
                         }
                         else
                         {
-                            m_cpt_ll_remote++;
+                            m_stats->cpt_ll_remote++;
                         }
                         // (1 (CMD) + 2 (RSP)) VCI flits for LL => 2 + 3 dspin flits
-                        m_cpt_ll_cost += 5 * req_distance(p_vci_tgt.srcid.read());
+                        m_stats->cpt_ll_cost += 5 * req_distance(p_vci_tgt.srcid.read());
                     }
                     else
                     {
                         if (is_local_req(p_vci_tgt.srcid.read()))
                         {
-                            m_cpt_read_local++;
+                            m_stats->cpt_read_local++;
                         }
                         else
                         {
-                            m_cpt_read_remote++;
+                            m_stats->cpt_read_remote++;
                         }
                         // (1 (CMD) + m_words (RSP)) flits VCI => 2 + m_words + 1 flits dspin
-                        m_cpt_read_cost += (3 + m_words) * req_distance(p_vci_tgt.srcid.read());
+                        m_stats->cpt_read_cost += (3 + m_words) * req_distance(p_vci_tgt.srcid.read());
                     }
                     // </Activity counters>
                     r_tgt_cmd_fsm = TGT_CMD_IDLE;
@@ -1715,11 +2161,11 @@ std::cout << "  <MEMC " << name()
                     {
                         if (is_local_req(p_vci_tgt.srcid.read()))
                         {
-                            m_cpt_write_flits_local++;
+                            m_stats->cpt_write_flits_local++;
                         }
                         else
                         {
-                            m_cpt_write_flits_remote++;
+                            m_stats->cpt_write_flits_remote++;
                         }
                     }
                     // </Activity counters>
@@ -1731,29 +2177,29 @@ std::cout << "  <MEMC " << name()
                         {
                             // SC
                             // (2 (CMD) + 1 (RSP)) flits VCI => 4 + (1 (success) || 2 (failure)) flits dspin
-                            m_cpt_sc_cost += 5 * req_distance(p_vci_tgt.srcid.read());
+                            m_stats->cpt_sc_cost += 5 * req_distance(p_vci_tgt.srcid.read());
                             if (is_local_req(p_vci_tgt.srcid.read()))
                             {
-                                m_cpt_sc_local++;
+                                m_stats->cpt_sc_local++;
                             }
                             else
                             {
-                                m_cpt_sc_remote++;
+                                m_stats->cpt_sc_remote++;
                             }
                         }
                         else
                         {
                             // Writes
                             // (burst_size + 1 (CMD) + 1 (RSP)) flits VCI => 2 + burst_size + 1 flits dspin
-                            m_cpt_write_cost += (3 + (plen >> 2)) * req_distance(p_vci_tgt.srcid.read());
+                            m_stats->cpt_write_cost += (3 + (plen >> 2)) * req_distance(p_vci_tgt.srcid.read());
 
                             if (is_local_req(p_vci_tgt.srcid.read()))
                             {
-                                m_cpt_write_local++;
+                                m_stats->cpt_write_local++;
                             }
                             else
                             {
-                                m_cpt_write_remote++;
+                                m_stats->cpt_write_remote++;
                             }
                         }
                         // </Activity counters>
@@ -1793,14 +2239,14 @@ std::cout << "  <MEMC " << name()
                         // <Activity counters>
                         if (is_local_req(p_vci_tgt.srcid.read()))
                         {
-                            m_cpt_cas_local++;
+                            m_stats->cpt_cas_local++;
                         }
                         else
                         {
-                            m_cpt_cas_remote++;
+                            m_stats->cpt_cas_remote++;
                         }
                         // (2 (CMD) + 1 (RSP)) flits VCI => 4 + (1 (success) || 2 (failure)) flits dspin
-                        m_cpt_cas_cost += 5 * req_distance(p_vci_tgt.srcid.read());
+                        m_stats->cpt_cas_cost += 5 * req_distance(p_vci_tgt.srcid.read());
                         // </Activity counters>
                         r_tgt_cmd_fsm = TGT_CMD_IDLE;
                     }
@@ -2022,6 +2468,11 @@ std::cout << "  <MEMC " << name()
         //   when a PUT response is received.
         //   The CONFIG SYNC response is sent only when the last PUT response is received.
         //
+        // In skip mode (see set_config_skip()), the LOOP state uses the presence
+        // summary of the directory to skip all consecutive lines that are not in
+        // the cache (typically most lines of a large buffer), with a configurable
+        // cost, and the directory is only accessed for the pages containing valid lines.
+        //
         // From the software point of view, a L2/L3 coherence request is a sequence
         // of 4 atomic accesses in an uncached segment:
         // - Write MEMC_ADDR_LO    : Set the buffer address LSB
@@ -2053,15 +2504,37 @@ std::cout << "  <MEMC " << name() << " CONFIG_IDLE> Config Request received"
             }
             /////////////////
             case CONFIG_LOOP:   // test if last line to be handled
+                                // skip the absent lines in skip mode
             {
-                if (r_config_cmd_lines.read() == 0)
+                size_t skip = 0;
+
+                if (r_config_skip_delay.read() != 0)   // wait end of previous skip
+                {
+                    r_config_skip_delay = r_config_skip_delay.read() - 1;
+                }
+                else if (r_config_cmd_lines.read() == 0)
                 {
                     r_config_cmd = MEMC_CMD_NOP;
                     r_config_fsm = CONFIG_WAIT;
                 }
                 else
                 {
-                    r_config_fsm = CONFIG_DIR_REQ;
+                    if (m_config_skip_rate != 0)
+                    {
+                        skip = m_cache_directory.absent_lines(r_config_address.read(),
+                                                              r_config_cmd_lines.read());
+                    }
+
+                    if (skip != 0)      // skip absent lines and stay in LOOP
+                    {
+                        r_config_cmd_lines  = r_config_cmd_lines.read() - skip;
+                        r_config_address    = r_config_address.read() + skip * (m_words << 2);
+                        r_config_skip_delay = (skip - 1) / m_config_skip_rate;
+                    }
+                    else
+                    {
+                        r_config_fsm = CONFIG_DIR_REQ;
+                    }
                 }
 
 #if DEBUG_MEMC_CONFIG
@@ -2069,6 +2542,7 @@ if (m_debug)
 std::cout << "  <MEMC " << name() << " CONFIG_LOOP>"
           << " / address = " << std::hex << r_config_address.read()
           << " / lines not handled = " << std::dec << r_config_cmd_lines.read()
+          << " / skipped lines = " << skip
           << " / command = " << r_config_cmd.read() << std::endl;
 #endif
                 break;
@@ -2143,6 +2617,12 @@ std::cout << "  <MEMC " << name() << " CONFIG_DIR_REQ>"
                 r_config_dir_count      = entry.count;
                 r_config_dir_ptr        = entry.ptr;
 
+                // bitset mode : copy the list of copies to scan in CONFIG_HEAP_SCAN
+                if (m_sharers and entry.valid)
+                {
+                    m_sharers->copy(m_y[(addr_t) (r_config_address.read())], way, m_config_sharers);
+                }
+
                 if (entry.valid and   // hit & inval command
                    (r_config_cmd.read() == MEMC_CMD_INVAL))
                 {
@@ -2236,12 +2716,10 @@ std::cout << "  <MEMC " << name() << " CONFIG_TRT_LOCK> Access TRT: "
                 // read data into cache
                 size_t way = r_config_dir_way.read();
                 size_t set = m_y[r_config_address.read()];
-                std::vector<data_t> data_vector;
-                data_vector.clear();
+                data_t data_line[TRT_MAX_LINE_WORDS];
                 for (size_t word = 0; word < m_words; word++)
                 {
-                    uint32_t data = m_cache_data.read(way, set, word);
-                    data_vector.push_back(data);
+                    data_line[word] = m_cache_data.read(way, set, word);
                 }
 
                 // post the PUT request in TRT
@@ -2254,8 +2732,8 @@ std::cout << "  <MEMC " << name() << " CONFIG_TRT_LOCK> Access TRT: "
                           false,                            // not proc_read
                           0,                                // read_length: unused
                           0,                                // word_index:  unused
-                          std::vector<be_t>(m_words, 0xF),  // byte-enable: unused
-                          data_vector,                      // data to be written
+                          ConstantLine<be_t>(0xF),          // byte-enable: unused
+                          data_line,                        // data to be written
                           0,                                // ll_key:      unused
                           true);                            // requested by config FSM
                 config_rsp_lines_incr = true;
@@ -2426,6 +2904,10 @@ std::cout << "  <MEMC " << name() << " CONFIG_BC_SEND>"
                         r_config_address = r_config_address.read() + (m_words << 2);
                         r_config_fsm = CONFIG_LOOP;
                     }
+                    else if (m_sharers)                    // several copies : scan the bitset
+                    {
+                        r_config_fsm = CONFIG_HEAP_SCAN;
+                    }
                     else                                   // several copies : must use heap
                     {
                         r_config_fsm = CONFIG_HEAP_REQ;
@@ -2460,9 +2942,22 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_REQ>"
             }
             //////////////////////
             case CONFIG_HEAP_SCAN: // scan HEAP and send inval to CC_SEND FSM
+            // (scan the m_config_sharers bitset in bitset mode)
             {
-                HeapEntry entry = m_heap.read(r_config_heap_next.read());
-                bool last_copy = (entry.next == r_config_heap_next.read());
+                HeapEntry entry;
+                bool last_copy;
+
+                if (m_sharers)
+                {
+                    entry.owner = m_sharers->front(m_config_sharers);
+                    m_sharers->pop(m_config_sharers);
+                    last_copy = m_sharers->empty(m_config_sharers);
+                }
+                else
+                {
+                    entry     = m_heap.read(r_config_heap_next.read());
+                    last_copy = (entry.next == r_config_heap_next.read());
+                }
 
                 // post one more copy into fifo
                 config_to_cc_send_fifo_srcid = entry.owner.srcid;
@@ -2484,7 +2979,8 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_REQ>"
                     // prepare next iteration (next line to be invalidated)
                     r_config_cmd_lines = r_config_cmd_lines.read() - 1;
                     r_config_address = r_config_address.read() + (m_words << 2);
-                    r_config_fsm = CONFIG_HEAP_LAST;
+                    if (m_sharers) r_config_fsm = CONFIG_LOOP;
+                    else           r_config_fsm = CONFIG_HEAP_LAST;
                 }
 #if DEBUG_MEMC_CONFIG
 if (m_debug)
@@ -2540,7 +3036,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
         //   in the r_read_to_tgt_rsp buffer. It waits if this buffer is not empty.
         //   The requesting initiator is registered in the cache directory.
         //   If the number of copy is larger than 1, the new copy is registered
-        //   in the HEAP.
+        //   in the HEAP (or in the bitset of the entry in bitset directory mode).
         //   If the number of copy is larger than the threshold, the HEAP is cleared,
         //   and the corresponding line switches to the counter mode.
         // - In case of MISS
@@ -2626,7 +3122,8 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                 if (entry.valid)    // hit
                 {
                     // test if we need to register a new copy in the heap
-                    if (entry.is_cnt or (entry.count == 0) or !cached_read)
+                    // (in bitset mode, the copy is registered in READ_DIR_HIT)
+                    if (entry.is_cnt or (entry.count == 0) or !cached_read or m_sharers)
                     {
                         r_read_fsm = READ_DIR_HIT;
                     }
@@ -2662,10 +3159,11 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             }
             //////////////////
             case READ_DIR_HIT:    //  read data in cache & update the directory
-            //  we enter this state in 3 cases:
+            //  we enter this state in 4 cases:
             //  - the read request is uncachable
             //  - the cache line is in counter mode
             //  - the cache line is valid but not replicated
+            //  - the copies are registered in bitsets (bitset directory mode)
             {
                 assert((r_alloc_dir_fsm.read() == ALLOC_DIR_READ) and
                         "MEMC ERROR in READ_DIR_HIT state: Bad DIR allocation");
@@ -2697,7 +3195,28 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
 
                 if (cached_read) // Cached read => we must update the copies
                 {
-                    if (!is_cnt)  // Not counter mode
+                    if (!is_cnt and (r_read_count.read() > 0))  // Bitset mode : new copy in bitset
+                    {
+                        Owner copy(inst_read, m_cmd_read_srcid_fifo.read());
+
+                        assert(not ((copy.srcid == r_read_copy.read()) and
+                                    (copy.inst == r_read_copy_inst.read())) and
+                                "MEMC ERROR in READ_DIR_HIT: copy already registered as owner");
+
+                        // creation of a new bitset
+                        if (r_read_count.read() == 1) m_sharers->clear(set, way);
+
+                        // enter counter mode when we reach the limit of copies
+                        // or when there is no slot for this copy
+                        bool go_cnt = (r_read_count.read() >= m_max_copies) or
+                                      not m_sharers->add(set, way, copy);
+
+                        entry.is_cnt      = go_cnt;
+                        entry.owner.srcid = go_cnt ? 0 : r_read_copy.read();
+                        entry.owner.inst  = go_cnt ? false : r_read_copy_inst.read();
+                        entry.count       = r_read_count.read() + 1;
+                    }
+                    else if (!is_cnt)  // Not counter mode
                     {
                         entry.owner.srcid = m_cmd_read_srcid_fifo.read();
                         entry.owner.inst  = inst_read;
@@ -2986,13 +3505,13 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
 
                     if (hit_read or !wok or hit_write) // line already requested or no space
                     {
-                        if (!wok)                  m_cpt_trt_full++;
-                        if (hit_read or hit_write) m_cpt_trt_rb++;
+                        if (!wok)                  m_stats->cpt_trt_full++;
+                        if (hit_read or hit_write) m_stats->cpt_trt_rb++;
                         r_read_fsm = READ_IDLE;
                     }
                     else // missing line is requested to the XRAM
                     {
-                        m_cpt_read_miss++;
+                        m_stats->cpt_read_miss++;
                         r_read_trt_index = index;
                         r_read_fsm       = READ_TRT_SET;
                     }
@@ -3023,8 +3542,8 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                             true,      // proc read
                             m_cmd_read_length_fifo.read(),
                             m_x[(addr_t) (m_cmd_read_addr_fifo.read())],
-                            std::vector<be_t> (m_words, 0),
-                            std::vector<data_t> (m_words, 0),
+                            ConstantLine<be_t>(0),
+                            ConstantLine<data_t>(0),
                             r_read_ll_key.read());
 #if DEBUG_MEMC_READ
                     if (m_debug)
@@ -3264,6 +3783,12 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                     r_write_ptr       = entry.ptr;
                     r_write_way       = way;
 
+                    // bitset mode : copy the list of copies to scan in WRITE_UPT_NEXT
+                    if (m_sharers)
+                    {
+                        m_sharers->copy(m_y[(addr_t) (r_write_address.read())], way, m_write_sharers);
+                    }
+
                     if (entry.is_cnt and entry.count) r_write_fsm = WRITE_BC_DIR_READ;
                     else                              r_write_fsm = WRITE_DIR_HIT;
                 }
@@ -3443,8 +3968,10 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
 #endif
                     r_write_upt_index = index;
                     // releases the lock protecting UPT and the DIR if no entry...
-                    if (wok) r_write_fsm = WRITE_UPT_HEAP_LOCK;
-                    else     r_write_fsm = WRITE_WAIT;
+                    // (the heap is not used in bitset mode)
+                    if      (not wok)   r_write_fsm = WRITE_WAIT;
+                    else if (m_sharers) r_write_fsm = WRITE_UPT_REQ;
+                    else                r_write_fsm = WRITE_UPT_HEAP_LOCK;
                 }
                 break;
             }
@@ -3550,29 +4077,46 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                 // As this decrement is done in the WRITE_UPT_DEC state,
                 // after the last copy has been found, the decrement request
                 // must be  registered in the r_write_to_dec flip-flop.
+                // In bitset mode, the copies are taken from the m_write_sharers
+                // bitset, instead of the heap.
 
-                HeapEntry entry = m_heap.read(r_write_ptr.read());
+                Owner copy;
+                bool  last;
+
+                if (m_sharers)
+                {
+                    copy = m_sharers->front(m_write_sharers);
+                    m_sharers->pop(m_write_sharers);
+                    last = m_sharers->empty(m_write_sharers);
+                }
+                else
+                {
+                    HeapEntry entry = m_heap.read(r_write_ptr.read());
+                    copy = entry.owner;
+                    last = (entry.next == r_write_ptr.read());
+                    r_write_ptr = entry.next;
+                }
 
                 bool dec_upt_counter;
 
                 // put the next srcid in the fifo
-                if ((entry.owner.srcid != r_write_srcid.read()) or
+                if ((copy.srcid != r_write_srcid.read()) or
                         ((r_write_pktid.read() & 0x7) == TYPE_SC) or
-                        entry.owner.inst)
+                        copy.inst)
                 {
                     dec_upt_counter             = false;
                     write_to_cc_send_fifo_put   = true;
-                    write_to_cc_send_fifo_inst  = entry.owner.inst;
-                    write_to_cc_send_fifo_srcid = entry.owner.srcid;
+                    write_to_cc_send_fifo_inst  = copy.inst;
+                    write_to_cc_send_fifo_srcid = copy.srcid;
 
 #if DEBUG_MEMC_WRITE
                     if (m_debug)
                     {
                         std::cout << "  <MEMC " << name() << " WRITE_UPT_NEXT> Post another request to CC_SEND FSM"
                             << " / heap_index = " << std::dec << r_write_ptr.read()
-                            << " / srcid = " << std::dec << r_write_copy.read()
-                            << " / inst = "  << std::dec << r_write_copy_inst.read() << std::endl;
-                        if (entry.next == r_write_ptr.read())
+                            << " / srcid = " << std::dec << copy.srcid
+                            << " / inst = "  << std::dec << copy.inst << std::endl;
+                        if (last)
                         {
                             std::cout << "        ... and this is the last" << std::endl;
                         }
@@ -3587,9 +4131,9 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                     {
                         std::cout << "  <MEMC " << name() << " WRITE_UPT_NEXT> Skip one entry in heap matching the writer"
                             << " / heap_index = " << std::dec << r_write_ptr.read()
-                            << " / srcid = " << std::dec << r_write_copy.read()
-                            << " / inst = "  << std::dec << r_write_copy_inst.read() << std::endl;
-                        if (entry.next == r_write_ptr.read())
+                            << " / srcid = " << std::dec << copy.srcid
+                            << " / inst = "  << std::dec << copy.inst << std::endl;
+                        if (last)
                         {
                             std::cout << "        ... and this is the last" << std::endl;
                         }
@@ -3608,9 +4152,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                     exit(0);
                 }
 
-                r_write_ptr = entry.next;
-
-                if (entry.next == r_write_ptr.read()) // last copy
+                if (last) // last copy
                 {
                     r_write_to_cc_send_multi_req = true;
                     if (r_write_to_dec.read() or dec_upt_counter) r_write_fsm = WRITE_UPT_DEC;
@@ -3737,7 +4279,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                     if (not hit_read and (not wok or hit_write))
                     {
                         r_write_fsm = WRITE_WAIT;
-                        m_cpt_trt_full++;
+                        m_stats->cpt_trt_full++;
 
                         break;
                     }
@@ -3753,7 +4295,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                     {
                         r_write_trt_index = hit_index;
                         r_write_fsm       = WRITE_MISS_TRT_DATA;
-                        m_cpt_write_miss++;
+                        m_stats->cpt_write_miss++;
                         break;
                     }
 
@@ -3762,7 +4304,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                     {
                         r_write_trt_index = wok_index;
                         r_write_fsm       = WRITE_MISS_TRT_SET;
-                        m_cpt_write_miss++;
+                        m_stats->cpt_write_miss++;
                         break;
                     }
 
@@ -3790,15 +4332,6 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             {
                 if (r_alloc_trt_fsm.read() == ALLOC_TRT_WRITE)
                 {
-                    std::vector<be_t> be_vector;
-                    std::vector<data_t> data_vector;
-                    be_vector.clear();
-                    data_vector.clear();
-                    for (size_t i = 0; i < m_words; i++)
-                    {
-                        be_vector.push_back(r_write_be[i]);
-                        data_vector.push_back(r_write_data[i]);
-                    }
                     m_trt.set(r_write_trt_index.read(),
                             true,     // read request to XRAM
                             m_nline[(addr_t)(r_write_address.read())],
@@ -3808,8 +4341,8 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                             false,      // not a processor read
                             0,        // not a single word
                             0,            // word index
-                            be_vector,
-                            data_vector);
+                            r_write_be,
+                            r_write_data);
                     r_write_fsm = WRITE_MISS_XRAM_REQ;
 
 #if DEBUG_MEMC_WRITE
@@ -3827,18 +4360,9 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             {
                 if (r_alloc_trt_fsm.read() == ALLOC_TRT_WRITE)
                 {
-                    std::vector<be_t> be_vector;
-                    std::vector<data_t> data_vector;
-                    be_vector.clear();
-                    data_vector.clear();
-                    for (size_t i = 0; i < m_words; i++)
-                    {
-                        be_vector.push_back(r_write_be[i]);
-                        data_vector.push_back(r_write_data[i]);
-                    }
                     m_trt.write_data_mask(r_write_trt_index.read(),
-                            be_vector,
-                            data_vector);
+                            r_write_be,
+                            r_write_data);
                     r_write_fsm = WRITE_RSP;
 
 #if DEBUG_MEMC_WRITE
@@ -4014,12 +4538,6 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                         "MEMC ERROR in WRITE_BC_DIR_INVAL state: Bad IVT allocation");
 
                 // register PUT request in TRT
-                std::vector<data_t> data_vector;
-                data_vector.clear();
-                for (size_t i = 0; i < m_words; i++)
-                {
-                    data_vector.push_back(r_write_data[i].read());
-                }
                 m_trt.set(r_write_trt_index.read(),
                         false,             // PUT request
                         m_nline[(addr_t) (r_write_address.read())],
@@ -4029,8 +4547,8 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                         false,             // not a processor read
                         0,                 // unused
                         0,                 // unused
-                        std::vector<be_t> (m_words, 0),
-                        data_vector);
+                        ConstantLine<be_t>(0),
+                        r_write_data);
 
                 // invalidate directory entry
                 DirectoryEntry entry;
@@ -4134,8 +4652,47 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
         //
         // The address and data to be written (for a PUT) are stored in TRT.
         // The trdid field contains always the TRT entry index.
+        //
+        // In direct XRAM access mode (m_xram_store), the commands are always
+        // accepted: the PUT data are written in the backing store (two words
+        // per cycle), and the response is posted in m_xram_rsp_queue.
         ////////////////////////////////////////////////////////////////////////
 
+        bool ixr_cmd_ack = p_vci_ixr.cmdack.read();
+
+        if ((m_xram_store != NULL) and
+            ((r_ixr_cmd_fsm.read() == IXR_CMD_READ_SEND) or
+             (r_ixr_cmd_fsm.read() == IXR_CMD_WRITE_SEND) or
+             (r_ixr_cmd_fsm.read() == IXR_CMD_CAS_SEND) or
+             (r_ixr_cmd_fsm.read() == IXR_CMD_XRAM_SEND) or
+             (r_ixr_cmd_fsm.read() == IXR_CMD_CONFIG_SEND)))
+        {
+            size_t        word = r_ixr_cmd_word.read();
+            addr_t        line = (addr_t) r_ixr_cmd_address.read();
+            XramDirectRsp rsp;
+
+            rsp.cycle   = m_stats->cpt_cycles + m_xram_latency;
+            rsp.index   = r_ixr_cmd_trdid.read();
+            rsp.address = line;
+            rsp.get     = r_ixr_cmd_get.read();
+
+            if (not r_ixr_cmd_get.read())   // PUT
+            {
+                assert(m_xram_store->contains(line, m_words << 2) and
+                        "MEMC ERROR in IXR_CMD FSM : PUT address out of the XRAM backing store");
+
+                m_xram_store->write(line + (word << 2),       r_ixr_cmd_wdata[word].read());
+                m_xram_store->write(line + ((word + 1) << 2), r_ixr_cmd_wdata[word + 1].read());
+
+                if (word == (m_words - 2)) m_xram_rsp_queue.push_back(rsp);
+            }
+            else                            // GET
+            {
+                m_xram_rsp_queue.push_back(rsp);
+            }
+            ixr_cmd_ack = true;
+        }
+
         switch (r_ixr_cmd_fsm.read())
         {
             ///////////////////////
@@ -4194,7 +4751,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             {
                 if (r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_CMD)
                 {
-                    TransactionTabEntry entry = m_trt.read(r_read_to_ixr_cmd_index.read());
+                    const TransactionTabEntry & entry = m_trt.read(r_read_to_ixr_cmd_index.read());
                     r_ixr_cmd_address = entry.nline * (m_words << 2);
                     r_ixr_cmd_trdid   = r_read_to_ixr_cmd_index.read();
                     r_ixr_cmd_get     = true;
@@ -4217,7 +4774,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             {
                 if (r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_CMD)
                 {
-                    TransactionTabEntry entry = m_trt.read(r_write_to_ixr_cmd_index.read());
+                    const TransactionTabEntry & entry = m_trt.read(r_write_to_ixr_cmd_index.read());
                     r_ixr_cmd_address = entry.nline * (m_words << 2);
                     r_ixr_cmd_trdid   = r_write_to_ixr_cmd_index.read();
                     r_ixr_cmd_get     = entry.xram_read;
@@ -4249,7 +4806,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             {
                 if (r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_CMD)
                 {
-                    TransactionTabEntry entry = m_trt.read(r_cas_to_ixr_cmd_index.read());
+                    const TransactionTabEntry & entry = m_trt.read(r_cas_to_ixr_cmd_index.read());
                     r_ixr_cmd_address = entry.nline * (m_words << 2);
                     r_ixr_cmd_trdid   = r_cas_to_ixr_cmd_index.read();
                     r_ixr_cmd_get     = entry.xram_read;
@@ -4281,7 +4838,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             {
                 if (r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_CMD)
                 {
-                    TransactionTabEntry entry = m_trt.read(r_xram_rsp_to_ixr_cmd_index.read());
+                    const TransactionTabEntry & entry = m_trt.read(r_xram_rsp_to_ixr_cmd_index.read());
                     r_ixr_cmd_address = entry.nline * (m_words << 2);
                     r_ixr_cmd_trdid   = r_xram_rsp_to_ixr_cmd_index.read();
                     r_ixr_cmd_get     = false;
@@ -4308,7 +4865,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             {
                 if (r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_CMD)
                 {
-                    TransactionTabEntry entry = m_trt.read(r_config_to_ixr_cmd_index.read());
+                    const TransactionTabEntry & entry = m_trt.read(r_config_to_ixr_cmd_index.read());
                     r_ixr_cmd_address = entry.nline * (m_words << 2);
                     r_ixr_cmd_trdid   = r_config_to_ixr_cmd_index.read();
                     r_ixr_cmd_get     = false;
@@ -4334,7 +4891,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             ///////////////////////
             case IXR_CMD_READ_SEND:      // send a get from READ FSM
             {
-                if (p_vci_ixr.cmdack)
+                if (ixr_cmd_ack)
                 {
                     r_ixr_cmd_fsm         = IXR_CMD_READ_IDLE;
                     r_read_to_ixr_cmd_req = false;
@@ -4352,7 +4909,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             ////////////////////////
             case IXR_CMD_WRITE_SEND:     // send a put or get from WRITE FSM
             {
-                if (p_vci_ixr.cmdack)
+                if (ixr_cmd_ack)
                 {
                     if (not r_ixr_cmd_get.read())   // PUT
                     {
@@ -4393,7 +4950,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             //////////////////////
             case IXR_CMD_CAS_SEND: // send a put or get command from CAS FSM
             {
-                if (p_vci_ixr.cmdack)
+                if (ixr_cmd_ack)
                 {
                     if (not r_ixr_cmd_get.read()) // PUT
                     {
@@ -4434,7 +4991,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             ///////////////////////
             case IXR_CMD_XRAM_SEND: // send a put from XRAM_RSP FSM
             {
-                if (p_vci_ixr.cmdack.read())
+                if (ixr_cmd_ack)
                 {
                     if (r_ixr_cmd_word.read() == (m_words - 2))
                     {
@@ -4459,7 +5016,7 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             /////////////////////////
             case IXR_CMD_CONFIG_SEND:     // send a put from CONFIG FSM
             {
-                if (p_vci_ixr.cmdack.read())
+                if (ixr_cmd_ack)
                 {
                     if (r_ixr_cmd_word.read() == (m_words - 2))
                     {
@@ -4502,6 +5059,10 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
         // (taking into account the write requests already stored in the TRT).
         // When the line is completely written, the r_ixr_rsp_to_xram_rsp_rok[index]
         // signal is set to inform the XRAM_RSP FSM.
+        //
+        // In direct XRAM access mode (m_xram_store), the responses are taken in
+        // m_xram_rsp_queue when their latency is elapsed, and a GET response
+        // writes the complete line in the TRT in one cycle.
         ///////////////////////////////////////////////////////////////////////////////
 
         //std::cout << std::endl << "ixr_rsp_fsm" << std::endl;
@@ -4511,6 +5072,35 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             //////////////////
             case IXR_RSP_IDLE:  // test transaction type: PUT/GET
             {
+                if (m_xram_store != NULL)
+                {
+                    if (not m_xram_rsp_queue.empty() and
+                        ((int32_t)(m_stats->cpt_cycles - m_xram_rsp_queue.front().cycle) >= 0))
+                    {
+                        r_ixr_rsp_cpt       = 0;
+                        r_ixr_rsp_trt_index = m_xram_rsp_queue.front().index;
+
+                        if (m_xram_rsp_queue.front().get)
+                        {
+                            r_ixr_rsp_fsm = IXR_RSP_TRT_READ;
+                        }
+                        else
+                        {
+                            r_ixr_rsp_fsm = IXR_RSP_TRT_ERASE;
+                            m_xram_rsp_queue.pop_front();
+                        }
+
+#if DEBUG_MEMC_IXR_RSP
+                        if (m_debug)
+                            std::cout << "  <MEMC " << name()
+                                << " IXR_RSP_IDLE> Direct response from XRAM backing store"
+                                << " / trt index = " << std::dec << r_ixr_rsp_trt_index.read()
+                                << std::endl;
+#endif
+                    }
+                    break;
+                }
+
                 if (p_vci_ixr.rspval.read())
                 {
                     r_ixr_rsp_cpt       = 0;
@@ -4571,7 +5161,38 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             //////////////////////
             case IXR_RSP_TRT_READ: // write a 64 bits data word in TRT
             {
-                if ((r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_RSP) and p_vci_ixr.rspval)
+                if ((r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_RSP) and (m_xram_store != NULL))
+                {
+                    size_t index  = r_ixr_rsp_trt_index.read();
+                    addr_t line   = m_xram_rsp_queue.front().address;
+                    bool   rerror = not m_xram_store->contains(line, m_words << 2);
+
+                    for (size_t word = 0; word < m_words; word = word + 2)
+                    {
+                        wide_data_t data = 0;
+                        if (not rerror)
+                        {
+                            data = ((wide_data_t) m_xram_store->read(line + (word << 2))) |
+                                   ((wide_data_t) m_xram_store->read(line + ((word + 1) << 2)) << 32);
+                        }
+                        m_trt.write_rsp(index, word, data, rerror);
+                    }
+                    m_xram_rsp_queue.pop_front();
+
+                    r_ixr_rsp_to_xram_rsp_rok[index] = true;
+                    r_ixr_rsp_fsm = IXR_RSP_IDLE;
+
+#if DEBUG_MEMC_IXR_RSP
+                    if (m_debug)
+                    {
+                        std::cout << "  <MEMC " << name() << " IXR_RSP_TRT_READ> Writing line in TRT : "
+                            << " index = " << std::dec << index
+                            << " / address = " << std::hex << line
+                            << " / rerror = " << rerror << std::endl;
+                    }
+#endif
+                }
+                else if ((r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_RSP) and p_vci_ixr.rspval)
                 {
                     size_t      index  = r_ixr_rsp_trt_index.read();
                     size_t      word   = r_ixr_rsp_cpt.read();
@@ -4712,6 +5333,9 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                 r_xram_rsp_victim_inval     = inval ;
                 r_xram_rsp_victim_dirty     = victim.dirty;
 
+                // bitset mode : copy the list of copies to scan in XRAM_RSP_HEAP_ERASE
+                if (m_sharers) m_sharers->copy(set, way, m_xram_rsp_sharers);
+
                 if (not r_xram_rsp_trt_buf.rerror) r_xram_rsp_fsm = XRAM_RSP_IVT_LOCK;
                 else                               r_xram_rsp_fsm = XRAM_RSP_ERROR_ERASE;
 
@@ -4916,12 +5540,6 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             {
                 if (r_alloc_trt_fsm.read() == ALLOC_TRT_XRAM_RSP)
                 {
-                    std::vector<data_t> data_vector;
-                    data_vector.clear();
-                    for (size_t i = 0; i < m_words; i++)
-                    {
-                        data_vector.push_back(r_xram_rsp_victim_data[i].read());
-                    }
                     m_trt.set(r_xram_rsp_trt_index.read(),
                             false,                          // PUT
                             r_xram_rsp_victim_nline.read(), // line index
@@ -4931,8 +5549,8 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                             false,                          // not proc_read
                             0,                              // unused
                             0,                              // unused
-                            std::vector<be_t>(m_words,0xF),
-                            data_vector);
+                            ConstantLine<be_t>(0xF),
+                            r_xram_rsp_victim_data);
 
 #if DEBUG_MEMC_XRAM_RSP
                     if (m_debug)
@@ -5002,7 +5620,9 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                     xram_rsp_to_cc_send_fifo_put      = multi_req;
                     r_xram_rsp_next_ptr               = r_xram_rsp_victim_ptr.read();
 
+                    // the heap lock is not required in bitset mode
                     if (r_xram_rsp_victim_dirty) r_xram_rsp_fsm = XRAM_RSP_WRITE_DIRTY;
+                    else if (not_last_multi_req and m_sharers) r_xram_rsp_fsm = XRAM_RSP_HEAP_ERASE;
                     else if (not_last_multi_req) r_xram_rsp_fsm = XRAM_RSP_HEAP_REQ;
                     else                         r_xram_rsp_fsm = XRAM_RSP_IDLE;
 
@@ -5025,14 +5645,16 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
                     r_xram_rsp_to_ixr_cmd_req = true;
                     r_xram_rsp_to_ixr_cmd_index = r_xram_rsp_trt_index.read();
 
-                    m_cpt_write_dirty++;
+                    m_stats->cpt_write_dirty++;
 
                     bool multi_req = not r_xram_rsp_victim_is_cnt.read() and
                         r_xram_rsp_victim_inval.read();
                     bool not_last_multi_req = multi_req and (r_xram_rsp_victim_count.read() != 1);
 
-                    if (not_last_multi_req) r_xram_rsp_fsm = XRAM_RSP_HEAP_REQ;
-                    else                    r_xram_rsp_fsm = XRAM_RSP_IDLE;
+                    // the heap lock is not required in bitset mode
+                    if (not_last_multi_req and m_sharers) r_xram_rsp_fsm = XRAM_RSP_HEAP_ERASE;
+                    else if (not_last_multi_req)          r_xram_rsp_fsm = XRAM_RSP_HEAP_REQ;
+                    else                                  r_xram_rsp_fsm = XRAM_RSP_IDLE;
 
 #if DEBUG_MEMC_XRAM_RSP
                     if (m_debug)
@@ -5064,15 +5686,28 @@ std::cout << "  <MEMC " << name() << " CONFIG_HEAP_LAST>"
             }
             /////////////////////////
             case XRAM_RSP_HEAP_ERASE: // erase the copies and send invalidations
+            // (the copies are taken from the m_xram_rsp_sharers bitset in bitset mode,
+            // and there is no heap housekeeping)
             {
-                if (r_alloc_heap_fsm.read() == ALLOC_HEAP_XRAM_RSP)
+                if (m_sharers or (r_alloc_heap_fsm.read() == ALLOC_HEAP_XRAM_RSP))
                 {
-                    HeapEntry entry = m_heap.read(r_xram_rsp_next_ptr.read());
+                    HeapEntry entry;
+                    if (m_sharers) entry.owner = m_sharers->front(m_xram_rsp_sharers);
+                    else           entry       = m_heap.read(r_xram_rsp_next_ptr.read());
 
                     xram_rsp_to_cc_send_fifo_srcid = entry.owner.srcid;
                     xram_rsp_to_cc_send_fifo_inst  = entry.owner.inst;
                     xram_rsp_to_cc_send_fifo_put   = true;
-                    if (m_xram_rsp_to_cc_send_inst_fifo.wok())
+                    if (m_xram_rsp_to_cc_send_inst_fifo.wok() and m_sharers)
+                    {
+                        m_sharers->pop(m_xram_rsp_sharers);
+                        if (m_sharers->empty(m_xram_rsp_sharers))   // last copy
+                        {
+                            r_xram_rsp_to_cc_send_multi_req = true;
+                            r_xram_rsp_fsm = XRAM_RSP_IDLE;
+                        }
+                    }
+                    else if (m_xram_rsp_to_cc_send_inst_fifo.wok())
                     {
                         r_xram_rsp_next_ptr = entry.next;
                         if (entry.next == r_xram_rsp_next_ptr.read())   // last copy
@@ -5332,7 +5967,7 @@ std::cout << "  <MEMC " << name() << " CLEANUP_DIR_REQ> Requesting DIR lock" <<
                     assert((entry.count > 0) and
                             "MEMC ERROR in CLEANUP_DIR_LOCK state, CLEANUP on valid entry with no copies");
 
-                    if ((entry.count == 1) or (entry.is_cnt)) // no access to the heap
+                    if ((entry.count == 1) or (entry.is_cnt) or m_sharers) // no access to the heap
                     {
                         r_cleanup_fsm = CLEANUP_DIR_WRITE;
                     }
@@ -5363,6 +5998,9 @@ std::cout << "  <MEMC " << name()
             }
             ///////////////////////
             case CLEANUP_DIR_WRITE:      // Update the directory entry without heap access
+            // In bitset mode, when there is several copies, the matching copy
+            // is removed from the bitset, or replaced by the first copy of the
+            // bitset if it is the copy registered in the directory entry.
             {
                 assert((r_alloc_dir_fsm.read() == ALLOC_DIR_CLEANUP) and
                         "MEMC ERROR in CLEANUP_DIR_LOCK: bad DIR allocation");
@@ -5372,8 +6010,10 @@ std::cout << "  <MEMC " << name()
                 bool match_srcid = (r_cleanup_copy.read() == r_cleanup_srcid.read());
                 bool match_inst  = (r_cleanup_copy_inst.read() == r_cleanup_inst.read());
                 bool match       = match_srcid and match_inst;
+                bool bitset      = (m_sharers != NULL) and not r_cleanup_is_cnt.read() and
+                                   (r_cleanup_count.read() > 1);
 
-                assert((r_cleanup_is_cnt.read() or match) and
+                assert((r_cleanup_is_cnt.read() or match or bitset) and
                         "MEMC ERROR in CLEANUP_DIR_LOCK: illegal CLEANUP on valid entry");
 
                 // update the cache directory (for the copies)
@@ -5388,6 +6028,23 @@ std::cout << "  <MEMC " << name()
                 entry.owner.srcid = 0;
                 entry.owner.inst  = 0;
 
+                if (bitset and match)  // the first copy of the bitset replaces the owner
+                {
+                    entry.owner = m_sharers->front(set, way);
+                    m_sharers->remove(set, way, entry.owner);
+                }
+                else if (bitset)       // the matching copy is removed from the bitset
+                {
+                    bool found = m_sharers->remove(set, way,
+                            Owner(r_cleanup_inst.read(), r_cleanup_srcid.read()));
+
+                    assert(found and
+                            "MEMC ERROR in CLEANUP_DIR_WRITE: illegal CLEANUP on valid entry");
+
+                    entry.owner.srcid = r_cleanup_copy.read();
+                    entry.owner.inst  = r_cleanup_copy_inst.read();
+                }
+
                 m_cache_directory.write(set, way, entry);
 
                 r_cleanup_fsm = CLEANUP_SEND_CLACK;
@@ -5883,6 +6540,12 @@ std::cout << "  <MEMC " << name()
                 r_cas_ptr       = entry.ptr;
                 r_cas_count     = entry.count;
 
+                // bitset mode : copy the list of copies to scan in CAS_UPT_NEXT
+                if (m_sharers and entry.valid)
+                {
+                    m_sharers->copy(m_y[(addr_t) (m_cmd_cas_addr_fifo.read())], way, m_cas_sharers);
+                }
+
                 if (entry.valid)  r_cas_fsm = CAS_DIR_HIT_READ;
                 else              r_cas_fsm = CAS_MISS_TRT_LOCK;
 
@@ -6088,7 +6751,9 @@ std::cout << "  <MEMC " << name()
                         }
 
                         r_cas_upt_index = index;
-                        r_cas_fsm = CAS_UPT_HEAP_LOCK;
+                        // the heap is not used in bitset mode
+                        if (m_sharers) r_cas_fsm = CAS_UPT_REQ;
+                        else           r_cas_fsm = CAS_UPT_HEAP_LOCK;
                     }
                     else       //  releases the locks protecting UPT and DIR UPT full
                     {
@@ -6141,7 +6806,7 @@ std::cout << "  <MEMC " << name()
             ////////////////
             case CAS_UPT_REQ:  // send a first update request to CC_SEND FSM
             {
-                assert((r_alloc_heap_fsm.read() == ALLOC_HEAP_CAS) and
+                assert((m_sharers or (r_alloc_heap_fsm.read() == ALLOC_HEAP_CAS)) and
                         "VCI_MEM_CACHE ERROR : bad HEAP allocation");
 
                 if (!r_cas_to_cc_send_multi_req.read() and !r_cas_to_cc_send_brdcast_req.read())
@@ -6195,19 +6860,34 @@ std::cout << "  <MEMC " << name()
             }
             /////////////////
             case CAS_UPT_NEXT:     // send a multi-update request to CC_SEND FSM
+            // (the copies are taken from the m_cas_sharers bitset in bitset mode)
             {
-                assert((r_alloc_heap_fsm.read() == ALLOC_HEAP_CAS)
+                assert((m_sharers or (r_alloc_heap_fsm.read() == ALLOC_HEAP_CAS))
                         and "VCI_MEM_CACHE ERROR : bad HEAP allocation");
 
-                HeapEntry entry = m_heap.read(r_cas_ptr.read());
+                HeapEntry entry;
+                if (m_sharers) entry.owner = m_sharers->front(m_cas_sharers);
+                else           entry       = m_heap.read(r_cas_ptr.read());
+
                 cas_to_cc_send_fifo_srcid = entry.owner.srcid;
                 cas_to_cc_send_fifo_inst  = entry.owner.inst;
                 cas_to_cc_send_fifo_put = true;
 
                 if (m_cas_to_cc_send_inst_fifo.wok())   // request accepted by CC_SEND FSM
                 {
-                    r_cas_ptr = entry.next;
-                    if (entry.next == r_cas_ptr.read())    // last copy
+                    bool last;
+                    if (m_sharers)
+                    {
+                        m_sharers->pop(m_cas_sharers);
+                        last = m_sharers->empty(m_cas_sharers);
+                    }
+                    else
+                    {
+                        r_cas_ptr = entry.next;
+                        last = (entry.next == r_cas_ptr.read());
+                    }
+
+                    if (last)    // last copy
                     {
                         r_cas_to_cc_send_multi_req = true;
                         r_cas_fsm = CAS_IDLE;   // Response will be sent after receiving
@@ -6316,25 +6996,24 @@ std::cout << "  <MEMC " << name()
                         "MEMC ERROR in CAS_BC_DIR_INVAL state: Bad IVT allocation");
 
                 // set TRT
-                std::vector<data_t> data_vector;
-                data_vector.clear();
+                data_t data_line[TRT_MAX_LINE_WORDS];
                 size_t word = m_x[(addr_t)(m_cmd_cas_addr_fifo.read())];
                 for (size_t i = 0; i < m_words; i++)
                 {
                     if (i == word)
                     {
                         // first modified word
-                        data_vector.push_back(r_cas_wdata.read());
+                        data_line[i] = r_cas_wdata.read();
                     }
                     else if ((i == word + 1) and (r_cas_cpt.read() == 4))
                     {
                         // second modified word
-                        data_vector.push_back(m_cmd_cas_wdata_fifo.read());
+                        data_line[i] = m_cmd_cas_wdata_fifo.read();
                     }
                     else
                     {
                         // unmodified words
-                        data_vector.push_back(r_cas_data[i].read());
+                        data_line[i] = r_cas_data[i].read();
                     }
                 }
                 m_trt.set(r_cas_trt_index.read(),
@@ -6346,8 +7025,8 @@ std::cout << "  <MEMC " << name()
                         false,    // not a processor read
                         0,
                         0,
-                        std::vector<be_t> (m_words,0),
-                        data_vector);
+                        ConstantLine<be_t>(0),
+                        data_line);
 
                 // invalidate directory entry
                 DirectoryEntry entry;
@@ -6511,16 +7190,6 @@ std::cout << "  <MEMC " << name()
                 assert((r_alloc_trt_fsm.read() == ALLOC_TRT_CAS) and
                         "MEMC ERROR in CAS_MISS_TRT_SET state: Bad TRT allocation");
 
-                std::vector<be_t> be_vector;
-                std::vector<data_t> data_vector;
-                be_vector.clear();
-                data_vector.clear();
-                for (size_t i = 0; i < m_words; i++)
-                {
-                    be_vector.push_back(0);
-                    data_vector.push_back(0);
-                }
-
                 m_trt.set(r_cas_trt_index.read(),
                         true,     // GET
                         m_nline[(addr_t) m_cmd_cas_addr_fifo.read()],
@@ -6530,8 +7199,8 @@ std::cout << "  <MEMC " << name()
                         false,    // write request from processor
                         0,
                         0,
-                        std::vector<be_t>(m_words, 0),
-                        std::vector<data_t>(m_words, 0));
+                        ConstantLine<be_t>(0),
+                        ConstantLine<data_t>(0));
 
                 r_cas_fsm = CAS_MISS_XRAM_REQ;
 
@@ -6813,21 +7482,21 @@ std::cout << "  <MEMC " << name()
                     // <Activity Counters>
                     if (is_local_req(m_config_to_cc_send_srcid_fifo.read()))
                     {
-                        m_cpt_minval_local++;
+                        m_stats->cpt_minval_local++;
                     }
                     else
                     {
-                        m_cpt_minval_remote++;
+                        m_stats->cpt_minval_remote++;
                     }
                     // 2 flits for multi inval
-                    m_cpt_minval_cost += 2 * req_distance(m_config_to_cc_send_srcid_fifo.read());
+                    m_stats->cpt_minval_cost += 2 * req_distance(m_config_to_cc_send_srcid_fifo.read());
                     // </Activity Counters>
                     r_cc_send_fsm = CC_SEND_CONFIG_INVAL_NLINE;
                     break;
                 }
                 if (r_config_to_cc_send_multi_req.read()) r_config_to_cc_send_multi_req = false;
                 // <Activity Counters>
-                m_cpt_minval++;
+                m_stats->cpt_minval++;
                 // </Activity Counters>
                 r_cc_send_fsm = CC_SEND_CONFIG_IDLE;
                 break;
@@ -6861,7 +7530,7 @@ std::cout << "  <MEMC " << name()
             {
                 if (not p_dspin_m2p.read) break;
                 // <Activity Counters>
-                m_cpt_binval++;
+                m_stats->cpt_binval++;
                 // </Activity Counters>
                 r_config_to_cc_send_brdcast_req = false;
                 r_cc_send_fsm = CC_SEND_CONFIG_IDLE;
@@ -6883,21 +7552,21 @@ std::cout << "  <MEMC " << name()
                     // <Activity Counters>
                     if (is_local_req(m_xram_rsp_to_cc_send_srcid_fifo.read()))
                     {
-                        m_cpt_minval_local++;
+                        m_stats->cpt_minval_local++;
                     }
                     else
                     {
-                        m_cpt_minval_remote++;
+                        m_stats->cpt_minval_remote++;
                     }
                     // 2 flits for multi inval
-                    m_cpt_minval_cost += 2 * req_distance(m_xram_rsp_to_cc_send_srcid_fifo.read());
+                    m_stats->cpt_minval_cost += 2 * req_distance(m_xram_rsp_to_cc_send_srcid_fifo.read());
                     // </Activity Counters>
                     r_cc_send_fsm = CC_SEND_XRAM_RSP_INVAL_NLINE;
                     break;
                 }
                 if (r_xram_rsp_to_cc_send_multi_req.read()) r_xram_rsp_to_cc_send_multi_req = false;
                 // <Activity Counters>
-                m_cpt_minval++;
+                m_stats->cpt_minval++;
                 // </Activity Counters>
                 r_cc_send_fsm = CC_SEND_XRAM_RSP_IDLE;
                 break;
@@ -6931,7 +7600,7 @@ std::cout << "  <MEMC " << name()
             {
                 if (not p_dspin_m2p.read) break;
                 // <Activity Counters>
-                m_cpt_binval++;
+                m_stats->cpt_binval++;
                 // </Activity Counters>
                 r_xram_rsp_to_cc_send_brdcast_req = false;
                 r_cc_send_fsm = CC_SEND_XRAM_RSP_IDLE;
@@ -6959,8 +7628,8 @@ std::cout << "  <MEMC " << name()
                 if (not p_dspin_m2p.read) break;
 
                 // <Activity Counters>
-                m_cpt_binval++;
-                m_cpt_write_broadcast++;
+                m_stats->cpt_binval++;
+                m_stats->cpt_write_broadcast++;
                 // </Activity Counters>
 
                 r_write_to_cc_send_brdcast_req = false;
@@ -6985,14 +7654,14 @@ std::cout << "  <MEMC " << name()
                     // <Activity Counters>
                     if (is_local_req(m_write_to_cc_send_srcid_fifo.read()))
                     {
-                        m_cpt_update_local++;
+                        m_stats->cpt_update_local++;
                     }
                     else
                     {
-                        m_cpt_update_remote++;
+                        m_stats->cpt_update_remote++;
                     }
                     // 2 flits for multi update
-                    m_cpt_update_cost += 2 * req_distance(m_write_to_cc_send_srcid_fifo.read());
+                    m_stats->cpt_update_cost += 2 * req_distance(m_write_to_cc_send_srcid_fifo.read());
                     // </Activity Counters>
 
                     r_cc_send_fsm = CC_SEND_WRITE_UPDT_NLINE;
@@ -7005,7 +7674,7 @@ std::cout << "  <MEMC " << name()
                 }
 
                 // <Activity Counters>
-                m_cpt_update++;
+                m_stats->cpt_update++;
                 // </Activity Counters>
                 r_cc_send_fsm = CC_SEND_WRITE_IDLE;
                 break;
@@ -7054,7 +7723,7 @@ std::cout << "  <MEMC " << name()
             {
                 if (not p_dspin_m2p.read) break;
                 // <Activity Counters>
-                m_cpt_binval++;
+                m_stats->cpt_binval++;
                 // </Activity Counters>
 
                 r_cas_to_cc_send_brdcast_req = false;
@@ -7079,14 +7748,14 @@ std::cout << "  <MEMC " << name()
                     // <Activity Counters>
                     if (is_local_req(m_cas_to_cc_send_srcid_fifo.read()))
                     {
-                        m_cpt_update_local++;
+                        m_stats->cpt_update_local++;
                     }
                     else
                     {
-                        m_cpt_update_remote++;
+                        m_stats->cpt_update_remote++;
                     }
                     // 2 flits for multi update
-                    m_cpt_update_cost += 2 * req_distance(m_cas_to_cc_send_srcid_fifo.read());
+                    m_stats->cpt_update_cost += 2 * req_distance(m_cas_to_cc_send_srcid_fifo.read());
                     // </Activity Counters>
                     r_cc_send_fsm = CC_SEND_CAS_UPDT_NLINE;
                     break;
@@ -7099,7 +7768,7 @@ std::cout << "  <MEMC " << name()
                 }
 
                 // <Activity Counters>
-                m_cpt_update++;
+                m_stats->cpt_update++;
                 // </Activity Counters>
                 r_cc_send_fsm = CC_SEND_CAS_IDLE;
                 break;
@@ -7163,7 +7832,7 @@ std::cout << "  <MEMC " << name()
 
                 uint8_t type =
                     DspinDhccpParam::dspin_get(
-                            p_dspin_p2m.data.read(),
+                            p2m_flit,
                             DspinDhccpParam::P2M_TYPE);
 
                 if ((type == DspinDhccpParam::TYPE_CLEANUP_DATA) or
@@ -7202,19 +7871,19 @@ std::cout << "  <MEMC " << name()
 
                 // <Activity Counters>
                 uint32_t srcid = DspinDhccpParam::dspin_get(
-                        p_dspin_p2m.data.read(),
+                        p2m_flit,
                         DspinDhccpParam::CLEANUP_SRCID);
 
                 if (is_local_req(srcid))
                 {
-                    m_cpt_cleanup_local++;
+                    m_stats->cpt_cleanup_local++;
                 }
                 else
                 {
-                    m_cpt_cleanup_remote++;
+                    m_stats->cpt_cleanup_remote++;
                 }
                 // 2 flits for cleanup without data
-                m_cpt_cleanup_cost += 2 * req_distance(srcid);
+                m_stats->cpt_cleanup_cost += 2 * req_distance(srcid);
                 // </Activity Counters>
 
                 break;
@@ -8501,7 +9170,7 @@ std::cout << "  <MEMC " << name()
 
         m_cc_receive_to_cleanup_fifo.update(cc_receive_to_cleanup_fifo_get,
                 cc_receive_to_cleanup_fifo_put,
-                p_dspin_p2m.data.read());
+                p2m_flit);
 
         ////////////////////////////////////////////////////////////////////////////////////
         //    CC_RECEIVE to MULTI_ACK FIFO
@@ -8509,7 +9178,7 @@ std::cout << "  <MEMC " << name()
 
         m_cc_receive_to_multi_ack_fifo.update(cc_receive_to_multi_ack_fifo_get,
                 cc_receive_to_multi_ack_fifo_put,
-                p_dspin_p2m.data.read());
+                p2m_flit);
 
         ////////////////////////////////////////////////////////////////////////////////////
         //    WRITE to CC_SEND FIFO
@@ -8554,7 +9223,7 @@ std::cout << "  <MEMC " << name()
         m_cas_to_cc_send_srcid_fifo.update(cas_to_cc_send_fifo_get,
                 cas_to_cc_send_fifo_put,
                 cas_to_cc_send_fifo_srcid);
-        m_cpt_cycles++;
+        m_stats->cpt_cycles++;
 
         ////////////////////////////////////////////////////////////////////////////////////
         //            Update r_config_rsp_lines counter.
@@ -8571,6 +9240,24 @@ std::cout << "  <MEMC " << name()
             r_config_rsp_lines = r_config_rsp_lines.read() - 1;
         }
 
+        ////////////////////////////////////////////////////////////////////////////////////
+        //            Commit all internal registers written in this cycle.
+        // The memory cache is quiescent if no register and no FIFO has been modified.
+        ////////////////////////////////////////////////////////////////////////////////////
+        bool fifo_update = cmd_read_fifo_put                or cmd_read_fifo_get                or
+                           cmd_write_fifo_put               or cmd_write_fifo_get               or
+                           cmd_cas_fifo_put                 or cmd_cas_fifo_get                 or
+                           cc_receive_to_cleanup_fifo_put   or cc_receive_to_cleanup_fifo_get   or
+                           cc_receive_to_multi_ack_fifo_put or cc_receive_to_multi_ack_fifo_get or
+                           write_to_cc_send_fifo_put        or write_to_cc_send_fifo_get        or
+                           config_to_cc_send_fifo_put       or config_to_cc_send_fifo_get       or
+                           xram_rsp_to_cc_send_fifo_put     or xram_rsp_to_cc_send_fifo_get     or
+                           cas_to_cc_send_fifo_put          or cas_to_cc_send_fifo_get;
+
+        bool registers_update = m_registers.commit();
+
+        m_quiescent = not fifo_update and not registers_update and m_xram_rsp_queue.empty();
+
     } // end transition()
 
     /////////////////////////////
@@ -8624,7 +9311,11 @@ std::cout << "  <MEMC " << name()
         p_vci_ixr.clen    = 0;
         p_vci_ixr.cfixed  = false;
 
-        if ((r_ixr_cmd_fsm.read() == IXR_CMD_READ_SEND) or
+        if (m_xram_store != NULL)   // direct XRAM access
+        {
+            p_vci_ixr.cmdval = false;
+        }
+        else if ((r_ixr_cmd_fsm.read() == IXR_CMD_READ_SEND) or
                 (r_ixr_cmd_fsm.read() == IXR_CMD_WRITE_SEND) or
                 (r_ixr_cmd_fsm.read() == IXR_CMD_CAS_SEND) or
                 (r_ixr_cmd_fsm.read() == IXR_CMD_XRAM_SEND) or
@@ -8656,7 +9347,11 @@ std::cout << "  <MEMC " << name()
         // Response signals on the p_vci_ixr port
         ////////////////////////////////////////////////////
 
-        if ((r_ixr_rsp_fsm.read() == IXR_RSP_TRT_READ) or
+        if (m_xram_store != NULL)   // direct XRAM access
+        {
+            p_vci_ixr.rspack = false;
+        }
+        else if ((r_ixr_rsp_fsm.read() == IXR_RSP_TRT_READ) or
                 (r_ixr_rsp_fsm.read() == IXR_RSP_TRT_ERASE))
         {
             p_vci_ixr.rspack = (r_alloc_trt_fsm.read() == ALLOC_TRT_IXR_RSP);
@@ -0,0 +1,298 @@
+/* -*- c++ -*-
+ *
+ * SOCLIB_LGPL_HEADER_BEGIN
+ *
+ * This file is part of SoCLib, GNU LGPLv2.1.
+ *
+ * SoCLib is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; version 2.1 of the License.
+ *
+ * SoCLib is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with SoCLib; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301 USA
+ *
+ * SOCLIB_LGPL_HEADER_END
+ */
+
+#ifndef DSPIN_TRAFFIC_CHECKER_H_
+#define DSPIN_TRAFFIC_CHECKER_H_
+
+#include <systemc>
+#include <deque>
+#include <iostream>
+#include <stdint.h>
+#include "caba_base_module.h"
+#include "dspin_interface.h"
+#include "alloc_elems.h"
+
+namespace soclib { namespace caba {
+
+using namespace sc_core;
+
+////////////////////////////////////////////////////////////////////////////////
+// This component drives the LOCAL ports of two networks with the same
+// random traffic, and compares their LOCAL ports cycle by cycle:
+// - the reference network (a mesh of router components),
+// - the network under test (a DspinMeshTsar component).
+// For each router, it contains a traffic source (packets of 1 to
+// max_length flits, with a random destination in the mesh) and a traffic
+// sink (accepting the flits with a given probability).
+// The comparison and the stimulus generation are done on the rising
+// clock edge, as the routers transition: the compared signals are the
+// values computed by the genMoore() functions on the previous falling
+// edge, and the new stimulus is seen by the routers on the next edge.
+// A mismatch is reported when the READ signal of an input port, or the
+// WRITE/DATA/EOP signals of an output port, differ between the two
+// networks. After a mismatch, the traffic sources follow the reference
+// network handshake.
+////////////////////////////////////////////////////////////////////////////////
+
+template<int flit_width>
+class DspinTrafficChecker
+: public soclib::caba::BaseModule
+{
+    struct flit_t
+    {
+        uint64_t    data;
+        bool        eop;
+    };
+
+    protected:
+    SC_HAS_PROCESS(DspinTrafficChecker);
+
+    public:
+
+    // ports
+    sc_in<bool>                 p_clk;
+    sc_in<bool>                 p_resetn;
+    DspinOutput<flit_width>     *p_ref_in;       // [router] to the reference LOCAL input
+    DspinInput<flit_width>      *p_ref_out;      // [router] from the reference LOCAL output
+    DspinOutput<flit_width>     *p_mesh_in;      // [router] to the mesh LOCAL input
+    DspinInput<flit_width>      *p_mesh_out;     // [router] from the mesh LOCAL output
+
+    private:
+
+    const size_t                m_x_size;
+    const size_t                m_y_size;
+    const size_t                m_x_width;
+    const size_t                m_y_width;
+    const size_t                m_routers;
+    const size_t                m_injection;     // packet injection rate (percent)
+    const size_t                m_acceptance;    // flit acceptance rate (percent)
+    const size_t                m_max_length;    // flits per packet
+    uint64_t                    m_seed;
+    bool                        m_inject;        // sources enabled
+
+    std::deque<flit_t>          *m_source;       // [router] flits to be sent
+
+    public:
+
+    // statistics
+    uint64_t                    m_cycles;
+    uint64_t                    m_sent;          // flits accepted by the reference
+    uint64_t                    m_received;      // flits delivered by the reference
+    uint64_t                    m_mismatches;
+
+    ////////////////////////
+    // constructor
+    ////////////////////////
+    DspinTrafficChecker( sc_module_name name,
+                         const size_t   x_size,
+                         const size_t   y_size,
+                         const size_t   x_width,
+                         const size_t   y_width,
+                         const size_t   injection,
+                         const size_t   acceptance,
+                         const size_t   max_length,
+                         const uint64_t seed )
+        : soclib::caba::BaseModule(name),
+          p_clk( "p_clk" ),
+          p_resetn( "p_resetn" ),
+          m_x_size( x_size ),
+          m_y_size( y_size ),
+          m_x_width( x_width ),
+          m_y_width( y_width ),
+          m_routers( x_size * y_size ),
+          m_injection( injection ),
+          m_acceptance( acceptance ),
+          m_max_length( max_length ),
+          m_seed( seed ? seed : 1 ),
+          m_inject( true ),
+          m_cycles( 0 ),
+          m_sent( 0 ),
+          m_received( 0 ),
+          m_mismatches( 0 )
+    {
+        p_ref_in   = alloc_elems<DspinOutput<flit_width> >("p_ref_in", m_routers);
+        p_ref_out  = alloc_elems<DspinInput<flit_width> >("p_ref_out", m_routers);
+        p_mesh_in  = alloc_elems<DspinOutput<flit_width> >("p_mesh_in", m_routers);
+        p_mesh_out = alloc_elems<DspinInput<flit_width> >("p_mesh_out", m_routers);
+
+        m_source   = new std::deque<flit_t>[m_routers];
+
+        SC_METHOD (transition);
+        dont_initialize();
+        sensitive << p_clk.pos();
+    }
+
+    ~DspinTrafficChecker()
+    {
+        dealloc_elems<DspinOutput<flit_width> >(p_ref_in, m_routers);
+        dealloc_elems<DspinInput<flit_width> >(p_ref_out, m_routers);
+        dealloc_elems<DspinOutput<flit_width> >(p_mesh_in, m_routers);
+        dealloc_elems<DspinInput<flit_width> >(p_mesh_out, m_routers);
+        delete [] m_source;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The set_injection() function enables or disables the sources
+    // (the packets already generated are still sent).
+    /////////////////////////////////////////////////////////////////////
+    void set_injection( bool inject )
+    {
+        m_inject = inject;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // The pending() function returns the number of flits not yet
+    // accepted by the reference network.
+    /////////////////////////////////////////////////////////////////////
+    size_t pending() const
+    {
+        size_t flits = 0;
+        for ( size_t r = 0 ; r < m_routers ; r++ ) flits += m_source[r].size();
+        return flits;
+    }
+
+    private:
+
+    // xorshift generator (the same sequence on all hosts)
+    uint64_t next_random()
+    {
+        m_seed ^= m_seed << 13;
+        m_seed ^= m_seed >> 7;
+        m_seed ^= m_seed << 17;
+        return m_seed;
+    }
+
+    uint64_t flit_mask() const
+    {
+        return (flit_width == 64) ? ~0ULL : ((1ULL << flit_width) - 1);
+    }
+
+    void mismatch( size_t r, const char * what )
+    {
+        if ( m_mismatches < 10 )
+        {
+            std::cout << "MISMATCH cycle " << std::dec << m_cycles
+                      << " router [" << (r / m_y_size) << "][" << (r % m_y_size)
+                      << "] : " << what << std::endl;
+        }
+        m_mismatches++;
+    }
+
+    /////////////////////////
+    void transition()
+    {
+        if ( p_resetn.read() == false )
+        {
+            for ( size_t r = 0 ; r < m_routers ; r++ )
+            {
+                m_source[r].clear();
+                p_ref_in[r].write  = false;
+                p_mesh_in[r].write = false;
+                p_ref_out[r].read  = false;
+                p_mesh_out[r].read = false;
+            }
+            return;
+        }
+
+        m_cycles++;
+
+        for ( size_t r = 0 ; r < m_routers ; r++ )
+        {
+            // compare the two networks
+            bool ref_get  = p_ref_in[r].read.read();
+            bool ref_put  = p_ref_out[r].write.read();
+
+            if ( ref_get != (bool)p_mesh_in[r].read.read() )
+                mismatch(r, "LOCAL input READ");
+
+            if ( ref_put != (bool)p_mesh_out[r].write.read() )
+                mismatch(r, "LOCAL output WRITE");
+            else if ( ref_put and
+                      (((uint64_t)p_ref_out[r].data.read() !=
+                        (uint64_t)p_mesh_out[r].data.read()) or
+                       (p_ref_out[r].eop.read() != p_mesh_out[r].eop.read())) )
+                mismatch(r, "LOCAL output DATA/EOP");
+
+            // handshakes (reference network)
+            if ( p_ref_in[r].write.read() and ref_get )
+            {
+                m_source[r].pop_front();
+                m_sent++;
+            }
+            if ( ref_put and p_ref_out[r].read.read() ) m_received++;
+
+            // new packet
+            if ( m_inject and m_source[r].empty() and
+                 ((next_random() % 100) < m_injection) )
+            {
+                size_t   length = 1 + (next_random() % m_max_length);
+                uint64_t xdest  = next_random() % m_x_size;
+                uint64_t ydest  = next_random() % m_y_size;
+
+                for ( size_t k = 0 ; k < length ; k++ )
+                {
+                    flit_t flit;
+                    flit.data = next_random() & flit_mask();
+                    if ( k == 0 )
+                    {
+                        size_t x_shift = flit_width - m_x_width;
+                        size_t y_shift = flit_width - m_x_width - m_y_width;
+                        flit.data &= ~(((1ULL << (m_x_width + m_y_width)) - 1) << y_shift);
+                        flit.data |= (xdest << x_shift) | (ydest << y_shift);
+                    }
+                    flit.eop = (k == length - 1);
+                    m_source[r].push_back(flit);
+                }
+            }
+
+            // next stimulus (the same for both networks)
+            bool write = not m_source[r].empty();
+            p_ref_in[r].write  = write;
+            p_mesh_in[r].write = write;
+            if ( write )
+            {
+                p_ref_in[r].data  = (sc_dt::sc_uint<flit_width>)m_source[r].front().data;
+                p_mesh_in[r].data = (sc_dt::sc_uint<flit_width>)m_source[r].front().data;
+                p_ref_in[r].eop   = m_source[r].front().eop;
+                p_mesh_in[r].eop  = m_source[r].front().eop;
+            }
+
+            bool read = (next_random() % 100) < m_acceptance;
+            p_ref_out[r].read  = read;
+            p_mesh_out[r].read = read;
+        }
+    }
+};
+
+}} // end namespace
+
+#endif // DSPIN_TRAFFIC_CHECKER_H_
+
+// Local Variables:
+// tab-width: 4
+// c-basic-offset: 4
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=4:softtabstop=4
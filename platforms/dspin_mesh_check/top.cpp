@@ -0,0 +1,390 @@
+/////////////////////////////////////////////////////////////////////////
+// File: top.cpp
+// Author: TSAR team
+// Copyright: UPMC/LIP6
+// Date : 2026
+// This program is released under the GNU public license
+/////////////////////////////////////////////////////////////////////////
+// This platform checks, in lock-step, that the DspinMeshTsar component
+// (selected in tsar_generic_xbar by -MESH_NOC 1, when the platform is
+// built with USE_MESH_NOC=1) is cycle-accurate
+// with respect to the mesh of router components that it replaces.
+//
+// Two networks of XSIZE * YSIZE routers receive the same random traffic
+// on their LOCAL ports (DspinTrafficChecker component), and their LOCAL
+// ports are compared at each cycle:
+// - the reference network is a mesh of router components, connected as
+//   in the tsar_generic_xbar platform (the NORTH/SOUTH/EAST/WEST ports
+//   on the mesh boundaries are connected to signals with WRITE = false
+//   and READ = true),
+// - the network under test is a DspinMeshTsar component.
+//
+// The reference router is defined by the REFERENCE_ROUTER_TSAR macro:
+// - 0 : the soclib DspinRouter component (caba:dspin_router), that is
+//       the router of the CMD, RSP, P2M and CLACK networks replaced by
+//       -MESH_NOC in TsarXbarCluster (used without broadcast),
+// - 1 : the DspinRouterTsar component (caba:dspin_router_tsar) of this
+//       repository, used without the IOB special cases of its routing
+//       function.
+//
+// The known behavioural differences between the two networks, not
+// visible on the LOCAL ports, are:
+// - the links between routers are not SystemC signals in the
+//   DspinMeshTsar component, and the per-router traces are different,
+// - the DspinMeshTsar component has no boundary ports: the flits routed
+//   out of the mesh are consumed, as by the boundary signals above,
+// - the broadcast packets (supported by the soclib DspinRouter when it
+//   is built with broadcast, as on the M2P network) are not modelled:
+//   -MESH_NOC does not replace the M2P routers.
+//
+// The exit status is 0 if no mismatch has been detected, 1 otherwise.
+//
+// Status: this check has only been run with REFERENCE_ROUTER_TSAR=1
+// (no mismatch). It has not been run against the soclib DspinRouter,
+// and -MESH_NOC stays disabled in tsar_generic_xbar until it passes
+// with REFERENCE_ROUTER_TSAR=0. The DspinMeshTsar fifos ignore a put
+// on a full fifo, even when a get is done in the same cycle: this is
+// the behaviour of the GenericFifo component to be confirmed by this
+// check (high INJECTION and low ACCEPTANCE values fill the fifos).
+//
+// Parameters :
+// - FLIT_WIDTH : DSPIN flit width (39 for CMD/CLACK, 32 for RSP/P2M)
+// - X_WIDTH / Y_WIDTH : x & y fields width in the first flit
+/////////////////////////////////////////////////////////////////////////
+
+#include <systemc>
+#include <sys/time.h>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+
+#include "alloc_elems.h"
+#include "dspin_mesh_tsar.h"
+#include "dspin_traffic_checker.h"
+
+#ifndef REFERENCE_ROUTER_TSAR
+#define REFERENCE_ROUTER_TSAR  0
+#endif
+
+#if REFERENCE_ROUTER_TSAR
+#include "dspin_router_tsar.h"
+#else
+#include "dspin_router.h"
+#endif
+
+#define FLIT_WIDTH             39
+#define X_WIDTH                4
+#define Y_WIDTH                4
+
+#define NORTH                  0
+#define SOUTH                  1
+#define EAST                   2
+#define WEST                   3
+#define LOCAL                  4
+
+///////////////////////////////////////////////////////////
+//     Default values for the command line parameters
+///////////////////////////////////////////////////////////
+
+#define XSIZE                  4
+#define YSIZE                  4
+#define NCYCLES                100000
+#define IN_FIFO_DEPTH          4
+#define OUT_FIFO_DEPTH         4
+#define INJECTION_RATE         30       // percent
+#define ACCEPTANCE_RATE        70       // percent
+#define MAX_PACKET_LENGTH      8        // flits
+#define DRAIN_CYCLES           10000    // end of simulation without injection
+
+int _main(int argc, char *argv[])
+{
+   using namespace sc_core;
+   using namespace soclib::caba;
+   using namespace soclib::common;
+
+#if REFERENCE_ROUTER_TSAR
+   typedef DspinRouterTsar<FLIT_WIDTH> router_t;
+#else
+   typedef DspinRouter<FLIT_WIDTH>     router_t;
+#endif
+
+   size_t   x_size      = XSIZE;              // number of columns
+   size_t   y_size      = YSIZE;              // number of rows
+   size_t   ncycles     = NCYCLES;            // cycles with traffic injection
+   size_t   in_depth    = IN_FIFO_DEPTH;      // input fifos depth
+   size_t   out_depth   = OUT_FIFO_DEPTH;     // output fifos depth
+   size_t   injection   = INJECTION_RATE;     // packets injection rate
+   size_t   acceptance  = ACCEPTANCE_RATE;    // flits acceptance rate
+   size_t   max_length  = MAX_PACKET_LENGTH;  // flits per packet
+   uint64_t seed        = 1;                  // random generator seed
+
+   ////////////// command line arguments //////////////////////
+   for (int n = 1; n < argc; n = n + 2)
+   {
+      if ((strcmp(argv[n], "-XSIZE") == 0) && (n + 1 < argc))
+      {
+         x_size = strtol(argv[n + 1], NULL, 0);
+      }
+      else if ((strcmp(argv[n], "-YSIZE") == 0) && (n + 1 < argc))
+      {
+         y_size = strtol(argv[n + 1], NULL, 0);
+      }
+      else if ((strcmp(argv[n], "-NCYCLES") == 0) && (n + 1 < argc))
+      {
+         ncycles = strtol(argv[n + 1], NULL, 0);
+      }
+      else if ((strcmp(argv[n], "-IN_DEPTH") == 0) && (n + 1 < argc))
+      {
+         in_depth = strtol(argv[n + 1], NULL, 0);
+      }
+      else if ((strcmp(argv[n], "-OUT_DEPTH") == 0) && (n + 1 < argc))
+      {
+         out_depth = strtol(argv[n + 1], NULL, 0);
+      }
+      else if ((strcmp(argv[n], "-INJECTION") == 0) && (n + 1 < argc))
+      {
+         injection = strtol(argv[n + 1], NULL, 0);
+      }
+      else if ((strcmp(argv[n], "-ACCEPTANCE") == 0) && (n + 1 < argc))
+      {
+         acceptance = strtol(argv[n + 1], NULL, 0);
+      }
+      else if ((strcmp(argv[n], "-LENGTH") == 0) && (n + 1 < argc))
+      {
+         max_length = strtol(argv[n + 1], NULL, 0);
+      }
+      else if ((strcmp(argv[n], "-SEED") == 0) && (n + 1 < argc))
+      {
+         seed = strtoull(argv[n + 1], NULL, 0);
+      }
+      else
+      {
+         std::cout << "   Arguments are (key,value) couples." << std::endl;
+         std::cout << "   The order is not important." << std::endl;
+         std::cout << "   Accepted arguments are :" << std::endl << std::endl;
+         std::cout << "     -XSIZE number_of_columns" << std::endl;
+         std::cout << "     -YSIZE number_of_rows" << std::endl;
+         std::cout << "     -NCYCLES number_of_cycles_with_traffic" << std::endl;
+         std::cout << "     -IN_DEPTH input_fifos_depth" << std::endl;
+         std::cout << "     -OUT_DEPTH output_fifos_depth" << std::endl;
+         std::cout << "     -INJECTION packets_injection_rate (percent)" << std::endl;
+         std::cout << "     -ACCEPTANCE flits_acceptance_rate (percent)" << std::endl;
+         std::cout << "     -LENGTH max_flits_per_packet" << std::endl;
+         std::cout << "     -SEED random_seed" << std::endl;
+         exit(0);
+      }
+   }
+
+   assert( (x_size >= 1) and (x_size <= (1 << X_WIDTH)) and
+           (y_size >= 1) and (y_size <= (1 << Y_WIDTH)) and
+           "Error in dspin_mesh_check : illegal mesh size" );
+
+   assert( (max_length >= 1) and
+           "Error in dspin_mesh_check : illegal packet length" );
+
+   std::cout << std::endl
+             << " - REFERENCE        = "
+             << (REFERENCE_ROUTER_TSAR ? "DspinRouterTsar" : "DspinRouter") << std::endl
+             << " - FLIT_WIDTH       = " << FLIT_WIDTH << std::endl
+             << " - XSIZE            = " << x_size << std::endl
+             << " - YSIZE            = " << y_size << std::endl
+             << " - IN_DEPTH         = " << in_depth << std::endl
+             << " - OUT_DEPTH        = " << out_depth << std::endl
+             << " - INJECTION        = " << injection << std::endl
+             << " - ACCEPTANCE       = " << acceptance << std::endl
+             << " - LENGTH           = " << max_length << std::endl
+             << " - SEED             = " << seed << std::endl
+             << " - NCYCLES          = " << ncycles << std::endl
+             << std::endl;
+
+   ///////////////////////////////////////////////////////////////
+   //    Signals
+   ///////////////////////////////////////////////////////////////
+
+   sc_clock          signal_clk("clk");
+   sc_signal<bool>   signal_resetn("resetn");
+
+   const size_t      routers = x_size * y_size;
+
+   // LOCAL ports of both networks
+   DspinSignals<FLIT_WIDTH>* signal_ref_in =
+      alloc_elems<DspinSignals<FLIT_WIDTH> >("signal_ref_in", routers);
+   DspinSignals<FLIT_WIDTH>* signal_ref_out =
+      alloc_elems<DspinSignals<FLIT_WIDTH> >("signal_ref_out", routers);
+   DspinSignals<FLIT_WIDTH>* signal_mesh_in =
+      alloc_elems<DspinSignals<FLIT_WIDTH> >("signal_mesh_in", routers);
+   DspinSignals<FLIT_WIDTH>* signal_mesh_out =
+      alloc_elems<DspinSignals<FLIT_WIDTH> >("signal_mesh_out", routers);
+
+   // links of the reference network : [router][port] output of the router
+   DspinSignals<FLIT_WIDTH>** signal_link =
+      alloc_elems<DspinSignals<FLIT_WIDTH> >("signal_link", routers, 4);
+
+   // boundary inputs of the reference network : [router][port]
+   DspinSignals<FLIT_WIDTH>** signal_bound_in =
+      alloc_elems<DspinSignals<FLIT_WIDTH> >("signal_bound_in", routers, 4);
+
+   ///////////////////////////////////////////////////////////////
+   //    Components
+   ///////////////////////////////////////////////////////////////
+
+   router_t** router = new router_t*[routers];
+
+   for (size_t x = 0; x < x_size; x++)
+   {
+      for (size_t y = 0; y < y_size; y++)
+      {
+         std::ostringstream name;
+         name << "router_" << x << "_" << y;
+#if REFERENCE_ROUTER_TSAR
+         router[x * y_size + y] = new router_t( name.str().c_str(),
+                                                x, y,
+                                                X_WIDTH, Y_WIDTH,
+                                                in_depth, out_depth,
+                                                false,     // not cluster_iob0
+                                                false,     // not cluster_iob1
+                                                false,     // not response router
+                                                0 );       // local field width
+#else
+         router[x * y_size + y] = new router_t( name.str().c_str(),
+                                                x, y,
+                                                X_WIDTH, Y_WIDTH,
+                                                in_depth, out_depth );
+#endif
+      }
+   }
+
+   DspinMeshTsar<FLIT_WIDTH>* mesh;
+   mesh = new DspinMeshTsar<FLIT_WIDTH>( "mesh",
+                                         x_size, y_size,
+                                         X_WIDTH, Y_WIDTH,
+                                         in_depth, out_depth );
+
+   DspinTrafficChecker<FLIT_WIDTH>* checker;
+   checker = new DspinTrafficChecker<FLIT_WIDTH>( "checker",
+                                                  x_size, y_size,
+                                                  X_WIDTH, Y_WIDTH,
+                                                  injection,
+                                                  acceptance,
+                                                  max_length,
+                                                  seed );
+
+   ///////////////////////////////////////////////////////////////
+   //    Net-list
+   ///////////////////////////////////////////////////////////////
+
+   checker->p_clk       (signal_clk);
+   checker->p_resetn    (signal_resetn);
+   mesh->p_clk          (signal_clk);
+   mesh->p_resetn       (signal_resetn);
+
+   for (size_t x = 0; x < x_size; x++)
+   {
+      for (size_t y = 0; y < y_size; y++)
+      {
+         size_t r = x * y_size + y;
+
+         router[r]->p_clk            (signal_clk);
+         router[r]->p_resetn         (signal_resetn);
+
+         // LOCAL ports
+         router[r]->p_in[LOCAL]      (signal_ref_in[r]);
+         router[r]->p_out[LOCAL]     (signal_ref_out[r]);
+         checker->p_ref_in[r]        (signal_ref_in[r]);
+         checker->p_ref_out[r]       (signal_ref_out[r]);
+
+         mesh->p_local_in[x][y]      (signal_mesh_in[r]);
+         mesh->p_local_out[x][y]     (signal_mesh_out[r]);
+         checker->p_mesh_in[r]       (signal_mesh_in[r]);
+         checker->p_mesh_out[r]      (signal_mesh_out[r]);
+
+         // NORTH/SOUTH/EAST/WEST output ports
+         for (size_t p = 0; p < 4; p++)
+         {
+            router[r]->p_out[p]      (signal_link[r][p]);
+         }
+
+         // NORTH/SOUTH/EAST/WEST input ports : neighbour output, or boundary
+         if (y + 1 < y_size) router[r]->p_in[NORTH] (signal_link[r + 1][SOUTH]);
+         else                router[r]->p_in[NORTH] (signal_bound_in[r][NORTH]);
+
+         if (y > 0)          router[r]->p_in[SOUTH] (signal_link[r - 1][NORTH]);
+         else                router[r]->p_in[SOUTH] (signal_bound_in[r][SOUTH]);
+
+         if (x + 1 < x_size) router[r]->p_in[EAST]  (signal_link[r + y_size][WEST]);
+         else                router[r]->p_in[EAST]  (signal_bound_in[r][EAST]);
+
+         if (x > 0)          router[r]->p_in[WEST]  (signal_link[r - y_size][EAST]);
+         else                router[r]->p_in[WEST]  (signal_bound_in[r][WEST]);
+      }
+   }
+
+   ////////////////////////////////////////////////////////
+   //   Simulation
+   ///////////////////////////////////////////////////////
+
+   sc_start(sc_core::sc_time(0, SC_NS));
+   signal_resetn = false;
+
+   // boundary signals : no incoming flit, outgoing flits consumed
+   for (size_t r = 0; r < routers; r++)
+   {
+      for (size_t p = 0; p < 4; p++) signal_bound_in[r][p].write = false;
+      if ((r % y_size) == (y_size - 1)) signal_link[r][NORTH].read = true;
+      if ((r % y_size) == 0)            signal_link[r][SOUTH].read = true;
+      if ((r / y_size) == (x_size - 1)) signal_link[r][EAST].read  = true;
+      if ((r / y_size) == 0)            signal_link[r][WEST].read  = true;
+   }
+
+   sc_start(sc_core::sc_time(1, SC_NS));
+   signal_resetn = true;
+
+   struct timeval t1, t2;
+   gettimeofday(&t1, NULL);
+
+   for (size_t n = 1; n < ncycles + DRAIN_CYCLES; n++)
+   {
+      if (n == ncycles) checker->set_injection(false);
+      sc_start(sc_core::sc_time(1, SC_NS));
+   }
+
+   gettimeofday(&t2, NULL);
+
+   uint64_t ms1 = (uint64_t) t1.tv_sec * 1000ULL + (uint64_t) t1.tv_usec / 1000;
+   uint64_t ms2 = (uint64_t) t2.tv_sec * 1000ULL + (uint64_t) t2.tv_usec / 1000;
+
+   std::cout << std::dec
+             << " - cycles           = " << checker->m_cycles << std::endl
+             << " - flits sent       = " << checker->m_sent << std::endl
+             << " - flits received   = " << checker->m_received << std::endl
+             << " - flits pending    = " << checker->pending() << std::endl
+             << " - mismatches       = " << checker->m_mismatches << std::endl
+             << " - simulation time  = " << (ms2 - ms1) << " ms" << std::endl;
+
+   return (checker->m_mismatches == 0) ? 0 : 1;
+}
+
+int sc_main (int argc, char *argv[])
+{
+   try {
+      return _main(argc, argv);
+   } catch (std::exception &e) {
+      std::cout << e.what() << std::endl;
+   } catch (...) {
+      std::cout << "Unknown exception occured" << std::endl;
+      throw;
+   }
+   return 1;
+}
+
+// Local Variables:
+// tab-width: 3
+// c-basic-offset: 3
+// c-file-offsets:((innamespace . 0)(inline-open . 0))
+// indent-tabs-mode: nil
+// End:
+
+// vim: filetype=cpp:expandtab:shiftwidth=3:tabstop=3:softtabstop=3
@@ -122,10 +122,19 @@
 
 #include <systemc>
 #include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
 #include <cstdarg>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <csignal>
 #include <stdint.h>
 
 #include "gdbserver.h"
@@ -171,6 +180,10 @@
 //        Parallelisation
 //////////////////////////////////////////////////////////////////
 
+#ifndef USE_OPENMP
+#define USE_OPENMP _OPENMP
+#endif
+
 #if USE_OPENMP
 #include <omp.h>
 #endif
@@ -324,6 +337,217 @@
 #define IOX_IOB0_INI_ID              3
 #define IOX_IOB1_INI_ID              4
 
+////////////////////////////////////////////////////////////////////////
+//     Checkpoint / Restore
+// The simulated state cannot be serialized, as most components
+// (processors, XICU, IOB, peripherals) do not export their internal
+// state. The checkpoint is therefore the simulator process itself:
+// - With -CHECKPOINT cycle file, when the checkpoint cycle is reached,
+//   the simulator stops and waits for restore requests on a UNIX socket
+//   bound to the file pathname.
+// - With -RESTORE file, the simulator does not build the platform, and
+//   sends its stdin/stdout/stderr and the NCYCLES value to the
+//   checkpoint. The checkpoint forks a copy of itself (copy on write,
+//   so the restore time does not depend on the platform size), that
+//   simulates NCYCLES more cycles with the client stdin/stdout/stderr,
+//   and returns the exit status to the client.
+// The restored simulations run concurrently, and each one must own the
+// host resources used by the peripherals:
+// - The disk image is switched to the copy-on-write backend at the
+//   checkpoint cycle: each restored simulation starts from the disk
+//   content at the checkpoint, and its writes are private.
+//   The other disk controllers (HBA, SDC) cannot be switched, and
+//   cannot be used with a checkpoint.
+// - The TTY terminals must use the simulator stdin/stdout
+//   (SOCLIB_TTY=TERM), which are the client ones in a restored
+//   simulation: an xterm or a log file would be shared.
+// - The frame buffer must not have a display window (SOCLIB_FB=HEADLESS).
+// - The NIC is used in synthesis mode (no host network interface).
+// The checkpoint only exists as long as the checkpoint process: it must
+// be killed when no longer needed.
+////////////////////////////////////////////////////////////////////////
+
+// maximal length of the socket pathname (terminating null included)
+#define CHECKPOINT_PATH_MAX  sizeof(((struct sockaddr_un *)0)->sun_path)
+
+////////////////////////////////////////////////////////////////////////
+static int checkpoint_send(int sock, uint64_t ncycles)
+////////////////////////////////////////////////////////////////////////
+{
+   int            fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+   char           ctrl[CMSG_SPACE(sizeof(fds))];
+   struct msghdr  msg;
+   struct iovec   iov;
+
+   memset(&msg, 0, sizeof(msg));
+   memset(ctrl, 0, sizeof(ctrl));
+   iov.iov_base       = &ncycles;
+   iov.iov_len        = sizeof(ncycles);
+   msg.msg_iov        = &iov;
+   msg.msg_iovlen     = 1;
+   msg.msg_control    = ctrl;
+   msg.msg_controllen = sizeof(ctrl);
+
+   struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg);
+   cmsg->cmsg_level = SOL_SOCKET;
+   cmsg->cmsg_type  = SCM_RIGHTS;
+   cmsg->cmsg_len   = CMSG_LEN(sizeof(fds));
+   memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+   return (sendmsg(sock, &msg, 0) == (ssize_t)sizeof(ncycles)) ? 0 : -1;
+}
+
+////////////////////////////////////////////////////////////////////////
+static int checkpoint_receive(int sock, uint64_t * ncycles, int fds[3])
+////////////////////////////////////////////////////////////////////////
+{
+   char           ctrl[CMSG_SPACE(3 * sizeof(int))];
+   struct msghdr  msg;
+   struct iovec   iov;
+
+   memset(&msg, 0, sizeof(msg));
+   iov.iov_base       = ncycles;
+   iov.iov_len        = sizeof(*ncycles);
+   msg.msg_iov        = &iov;
+   msg.msg_iovlen     = 1;
+   msg.msg_control    = ctrl;
+   msg.msg_controllen = sizeof(ctrl);
+
+   if (recvmsg(sock, &msg, 0) != (ssize_t)sizeof(*ncycles)) return -1;
+
+   struct cmsghdr * cmsg = CMSG_FIRSTHDR(&msg);
+   if ((cmsg == NULL) or
+       (cmsg->cmsg_level != SOL_SOCKET) or
+       (cmsg->cmsg_type  != SCM_RIGHTS) or
+       (cmsg->cmsg_len   != CMSG_LEN(3 * sizeof(int)))) return -1;
+
+   memcpy(fds, CMSG_DATA(cmsg), 3 * sizeof(int));
+   return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+// This function is executed by the -RESTORE simulator.
+// It returns the exit status of the restored simulation.
+////////////////////////////////////////////////////////////////////////
+static int restore_client(const char * path, uint64_t ncycles)
+////////////////////////////////////////////////////////////////////////
+{
+   struct sockaddr_un addr;
+   int                status = EXIT_FAILURE;
+   int                sock   = socket(AF_UNIX, SOCK_STREAM, 0);
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+   if ((sock < 0) or
+       (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) or
+       (checkpoint_send(sock, ncycles) < 0))
+   {
+      perror("ERROR in tsar_generic_iob : cannot connect to checkpoint");
+      return EXIT_FAILURE;
+   }
+
+   // wait the end of the restored simulation
+   if (read(sock, &status, sizeof(status)) != (ssize_t)sizeof(status))
+   {
+      std::cerr << "ERROR in tsar_generic_iob : restored simulation aborted"
+                << std::endl;
+      status = EXIT_FAILURE;
+   }
+   close(sock);
+   return status;
+}
+
+////////////////////////////////////////////////////////////////////////
+// This function is executed by the -CHECKPOINT simulator.
+// It only returns in the forked simulators, and returns the socket
+// connected to the -RESTORE client, and the number of cycles to simulate.
+////////////////////////////////////////////////////////////////////////
+static int checkpoint_server(const char * path, size_t cycle, uint64_t * ncycles)
+////////////////////////////////////////////////////////////////////////
+{
+   struct sockaddr_un addr;
+   struct stat        st;
+   int                sock = socket(AF_UNIX, SOCK_STREAM, 0);
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+   // only a previous checkpoint socket can be replaced
+   if (lstat(path, &st) == 0)
+   {
+      if (not S_ISSOCK(st.st_mode))
+      {
+         std::cerr << "ERROR in tsar_generic_iob : " << path
+                   << " exists and is not a socket" << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      unlink(path);
+   }
+
+   if ((sock < 0) or
+       (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) or
+       (listen(sock, 16) < 0))
+   {
+      perror("ERROR in tsar_generic_iob : cannot create checkpoint");
+      exit(EXIT_FAILURE);
+   }
+
+   std::cout << "### checkpoint at cycle " << std::dec << cycle
+             << " : waiting restore requests on " << path << std::endl;
+
+   while (true)
+   {
+      uint64_t  restore_ncycles;
+      int       fds[3];
+      int       conn = accept(sock, NULL, NULL);
+
+      // reap the terminated restored simulations
+      while (waitpid(-1, NULL, WNOHANG) > 0) { }
+
+      if (conn < 0)
+      {
+         if (errno == EINTR) continue;
+         perror("ERROR in tsar_generic_iob : checkpoint accept");
+         exit(EXIT_FAILURE);
+      }
+      if (checkpoint_receive(conn, &restore_ncycles, fds) < 0)
+      {
+         close(conn);
+         continue;
+      }
+
+      // no buffered output must be duplicated in the child
+      std::cout.flush();
+      std::cerr.flush();
+      fflush(NULL);
+
+      pid_t pid = fork();
+      if (pid == 0)     // restored simulation
+      {
+         close(sock);
+         dup2(fds[0], STDIN_FILENO);
+         dup2(fds[1], STDOUT_FILENO);
+         dup2(fds[2], STDERR_FILENO);
+         close(fds[0]);
+         close(fds[1]);
+         close(fds[2]);
+         *ncycles = restore_ncycles;
+         return conn;
+      }
+      if (pid < 0) perror("ERROR in tsar_generic_iob : checkpoint fork");
+
+      std::cout << "### checkpoint : restore request ("
+                << std::dec << restore_ncycles << " cycles)" << std::endl;
+      close(fds[0]);
+      close(fds[1]);
+      close(fds[2]);
+      close(conn);
+   }
+}
+
 ////////////////////////////////////////////////////////////////////////
 int _main(int argc, char *argv[])
 ////////////////////////////////////////////////////////////////////////
@@ -343,6 +567,12 @@ int _main(int argc, char *argv[])
    bool     debug_iob        = false;                   // trace iob0 & iob1 when true
    uint32_t debug_from       = 0;                       // trace start cycle
    uint32_t frozen_cycles    = MAX_FROZEN_CYCLES;       // monitoring frozen processor
+   bool     checkpoint_ok    = false;                   // checkpoint requested
+   size_t   checkpoint_cycle = 0;                       // checkpoint cycle
+   char     checkpoint_name[256];                       // pathname: checkpoint socket
+   bool     restore_ok       = false;                   // restore requested
+   char     restore_name[256];                          // pathname: checkpoint socket
+   int      restore_sock     = -1;                      // socket to restore client
    size_t   cluster_iob0     = cluster(0,0);            // cluster containing IOB0
    size_t   cluster_iob1     = cluster(XMAX-1,YMAX-1);  // cluster containing IOB1
    size_t   x_width          = X_WIDTH;                 // # of bits for x
@@ -379,6 +609,11 @@ int _main(int argc, char *argv[])
          {
             strcpy(disk_name, argv[n+1]);
          }
+         else if ((strcmp(argv[n],"-SOFT") == 0) && (n+1<argc) )
+         {
+            strncpy(soft_name, argv[n+1], sizeof(soft_name) - 1);
+            soft_name[sizeof(soft_name) - 1] = 0;
+         }
          else if ((strcmp(argv[n],"-MEMCID") == 0) && (n+1<argc) )
          {
             debug_memc_id = atoi(argv[n+1]);
@@ -427,28 +662,88 @@ int _main(int argc, char *argv[])
          {
             threads = atoi(argv[n+1]);
             threads = (threads < 1) ? 1 : threads;
+            // no more threads than clusters, as the cluster is the unit of work
+            threads = (threads > (ssize_t)(XMAX * YMAX)) ? (XMAX * YMAX) : threads;
          }
          else if ((strcmp(argv[n], "-FROZEN") == 0) && (n+1 < argc))
          {
             frozen_cycles = atoi(argv[n+1]);
          }
+         else if ((strcmp(argv[n], "-CHECKPOINT") == 0) && (n+2 < argc))
+         {
+            checkpoint_ok    = true;
+            checkpoint_cycle = atoi(argv[n+1]);
+            if ( strlen(argv[n+2]) >= CHECKPOINT_PATH_MAX )
+            {
+                std::cout << "CHECKPOINT socket pathname too long" << std::endl;
+                exit(0);
+            }
+            strcpy(checkpoint_name, argv[n+2]);
+            n++;    // three arguments
+         }
+         else if ((strcmp(argv[n], "-RESTORE") == 0) && (n+1 < argc))
+         {
+            restore_ok = true;
+            if ( strlen(argv[n+1]) >= CHECKPOINT_PATH_MAX )
+            {
+                std::cout << "RESTORE socket pathname too long" << std::endl;
+                exit(0);
+            }
+            strcpy(restore_name, argv[n+1]);
+         }
          else
          {
             std::cout << "   Arguments are (key,value) couples." << std::endl;
             std::cout << "   The order is not important." << std::endl;
             std::cout << "   Accepted arguments are :" << std::endl << std::endl;
             std::cout << "     - NCYCLES number_of_simulated_cycles" << std::endl;
+            std::cout << "     - SOFT pathname_for_rom_soft" << std::endl;
             std::cout << "     - DEBUG debug_start_cycle" << std::endl;
             std::cout << "     - THREADS simulator's threads number" << std::endl;
             std::cout << "     - FROZEN max_number_of_lines" << std::endl;
             std::cout << "     - MEMCID index_memc_to_be_traced" << std::endl;
             std::cout << "     - PROCID index_proc_to_be_traced" << std::endl;
             std::cout << "     - IOB    non_zero_value" << std::endl;
+            std::cout << "     - CHECKPOINT checkpoint_cycle socket_pathname" << std::endl;
+            std::cout << "     - RESTORE socket_pathname" << std::endl;
             exit(0);
          }
       }
    }
 
+   // restored simulation : executed by the checkpoint process
+   if (restore_ok)
+   {
+      return restore_client(restore_name, ncycles);
+   }
+
+   if ( checkpoint_ok )
+   {
+      const char * tty_mode = getenv("SOCLIB_TTY");
+      const char * fb_mode  = getenv("SOCLIB_FB");
+
+      if ( threads != 1 )
+      {
+         std::cout << "CHECKPOINT cannot be used with several THREADS" << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      if ( not USE_IOC_BDV )
+      {
+         std::cout << "CHECKPOINT can only be used with the BDV disk controller" << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      if ( (tty_mode == NULL) or (strcmp(tty_mode, "TERM") != 0) )
+      {
+         std::cout << "CHECKPOINT requires SOCLIB_TTY=TERM" << std::endl;
+         exit(EXIT_FAILURE);
+      }
+      if ( (fb_mode == NULL) or (strcmp(fb_mode, "HEADLESS") != 0) )
+      {
+         std::cout << "CHECKPOINT requires SOCLIB_FB=HEADLESS" << std::endl;
+         exit(EXIT_FAILURE);
+      }
+   }
+
    // checking hardware parameters
    assert( (XMAX <= 16) and
    "Error in tsar_generic_iob : XMAX parameter cannot be larger than 16" );
@@ -1137,10 +1432,13 @@ int _main(int argc, char *argv[])
     if ( USE_MWR_DCT ) coproc_type = MWR_COPROC_DCT;
     if ( USE_MWR_GCD ) coproc_type = MWR_COPROC_GCD;
 
+    // With OpenMP, each thread builds (and then evaluates) a fixed block
+    // of neighbour clusters, and the ordered section builds the clusters
+    // in index order, so that results do not depend on the threads number.
 #if USE_OPENMP
 #pragma omp parallel
     {
-#pragma omp for
+#pragma omp for ordered schedule(static)
 #endif
         for(size_t i = 0; i  < (XMAX * YMAX); i++)
         {
@@ -1148,7 +1446,7 @@ int _main(int argc, char *argv[])
             size_t y = i % YMAX;
 
 #if USE_OPENMP
-#pragma omp critical
+#pragma omp ordered
             {
 #endif
             std::cout << std::endl;
@@ -1234,7 +1532,7 @@ int _main(int argc, char *argv[])
             );
 
 #if USE_OPENMP
-            } // end critical
+            } // end ordered
 #endif
         } // end for
 #if USE_OPENMP
@@ -1668,6 +1966,20 @@ int _main(int argc, char *argv[])
 
     for ( size_t n = 0; n < ncycles ; n += simul_period )
     {
+        // checkpoint : the restored simulations continue from here
+        if ( checkpoint_ok and (n >= checkpoint_cycle) )
+        {
+            uint64_t restore_ncycles;
+#if ( USE_IOC_BDV )
+            // each restored simulation writes in a private copy of the disk
+            disk->set_backend(BlockDeviceBackend::BACKEND_COW);
+#endif
+            restore_sock  = checkpoint_server(checkpoint_name, n, &restore_ncycles);
+            ncycles       = n + restore_ncycles;
+            checkpoint_ok = false;
+            gettimeofday(&t1, NULL);
+        }
+
         // stats display
         if( (n % 1000000) == 0)
         {
@@ -1839,6 +2151,15 @@ int _main(int argc, char *argv[])
 
         sc_start(sc_core::sc_time(simul_period, SC_NS));
     }
+
+    // returns the exit status to the restore client
+    if ( restore_sock >= 0 )
+    {
+        int status = EXIT_SUCCESS;
+        if ( write(restore_sock, &status, sizeof(status)) != (ssize_t)sizeof(status) )
+            perror("ERROR in tsar_generic_iob : restore status");
+        close(restore_sock);
+    }
     return EXIT_SUCCESS;
 }
 
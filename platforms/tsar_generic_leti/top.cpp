@@ -111,6 +111,7 @@
 
 #include <systemc>
 #include <sys/time.h>
+#include <unistd.h>
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
@@ -254,6 +255,10 @@ int _main(int argc, char *argv[])
    char     soft_name[256]    = ROM_SOFT_NAME;      // pathname for ROM binary code
    char     disk_name[256]    = DISK_IMAGE_NAME;    // pathname for DISK image
    uint32_t frozen_cycles     = MAX_FROZEN_CYCLES;  // for debug
+   bool     xram_direct       = false;              // direct XRAM access by memc
+   size_t   xram_latency      = XRAM_LATENCY;       // direct XRAM access latency
+   char     xram_image[256]   = "";                 // pathname to physical memory image
+   char     xram_save[256]    = "";                 // pathname to saved memory image
    struct   timeval t1,t2;
    uint64_t ms1,ms2;
 
@@ -305,11 +310,28 @@ int _main(int argc, char *argv[])
          {
             threads = (size_t) strtol(argv[n + 1], NULL, 0);
             threads = (threads < 1) ? 1 : threads;
+            // no more threads than clusters, as the cluster is the unit of work
+            threads = (threads > (XMAX * YMAX)) ? (XMAX * YMAX) : threads;
          }
          else if ((strcmp(argv[n], "-FROZEN") == 0) && (n + 1 < argc))
          {
             frozen_cycles = (uint32_t) strtol(argv[n + 1], NULL, 0);
          }
+         else if ((strcmp(argv[n], "-XRAM_DIRECT") == 0) && (n + 1 < argc))
+         {
+            xram_direct  = true;
+            xram_latency = (size_t) strtol(argv[n + 1], NULL, 0);
+         }
+         else if ((strcmp(argv[n], "-XRAM_IMAGE") == 0) && (n + 1 < argc))
+         {
+            strncpy(xram_image, argv[n + 1], sizeof(xram_image) - 1);
+            xram_image[sizeof(xram_image) - 1] = 0;
+         }
+         else if ((strcmp(argv[n], "-XRAM_SAVE") == 0) && (n + 1 < argc))
+         {
+            strncpy(xram_save, argv[n + 1], sizeof(xram_save) - 1);
+            xram_save[sizeof(xram_save) - 1] = 0;
+         }
          else
          {
             std::cout << "   Arguments are (key,value) couples." << std::endl;
@@ -321,11 +343,22 @@ int _main(int argc, char *argv[])
             std::cout << "     - FROZEN max_number_of_lines" << std::endl;
             std::cout << "     - MEMCID index_memc_to_be_traced" << std::endl;
             std::cout << "     - PROCID index_proc_to_be_traced" << std::endl;
+            std::cout << "     - XRAM_DIRECT direct_xram_access_latency" << std::endl;
+            std::cout << "     - XRAM_IMAGE pathname_for_physical_memory_image (with XRAM_DIRECT)" << std::endl;
+            std::cout << "     - XRAM_SAVE pathname_for_saved_memory_image (and exit)" << std::endl;
             exit(0);
          }
       }
    }
 
+   // a memory image is only mapped by the memory caches in direct XRAM
+   // access mode, that changes the memory model: it must be explicit
+   if (xram_image[0] and not xram_direct)
+   {
+      std::cout << "XRAM_IMAGE requires the direct XRAM access mode (XRAM_DIRECT)" << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
     // checking hardware parameters
     assert( ((X_SIZE <= 16) and (X_SIZE > 0)) and
             "Illegal X_SIZE parameter" );
@@ -377,6 +410,7 @@ int _main(int argc, char *argv[])
               << " - MEMC_WAYS        = " << MEMC_WAYS << std::endl
               << " - MEMC_SETS        = " << MEMC_SETS << std::endl
               << " - RAM_LATENCY      = " << XRAM_LATENCY << std::endl
+              << " - XRAM_DIRECT      = " << xram_direct << std::endl
               << " - MAX_FROZEN       = " << frozen_cycles << std::endl
               << " - MAX_CYCLES       = " << ncycles << std::endl
               << " - RESET_ADDRESS    = " << RESET_ADDRESS << std::endl
@@ -627,9 +661,16 @@ int _main(int argc, char *argv[])
    ////////////////////////////
 
 #if USE_IOC_RDK
+   // with a physical memory image (-XRAM_IMAGE), the RAMDISK is already
+   // in the mapped image, and is not loaded in a private copy
    std::ostringstream ramdisk_name;
    ramdisk_name << disk_name << "@" << std::hex << SEG_RDK_BASE << ":";
-   soclib::common::Loader loader( soft_name, ramdisk_name.str().c_str() );
+   soclib::common::Loader * rdk_loader;
+   if ( xram_image[0] )
+      rdk_loader = new soclib::common::Loader( soft_name );
+   else
+      rdk_loader = new soclib::common::Loader( soft_name, ramdisk_name.str().c_str() );
+   soclib::common::Loader & loader = *rdk_loader;
 #else
    soclib::common::Loader loader( soft_name );
 #endif
@@ -648,10 +689,13 @@ int _main(int argc, char *argv[])
                    vci_param_int,
                    vci_param_ext>*          clusters[XMAX][YMAX];
 
+    // With OpenMP, each thread builds (and then evaluates) a fixed block
+    // of neighbour clusters, and the ordered section builds the clusters
+    // in index order, so that results do not depend on the threads number.
 #if USE_OPENMP
 #pragma omp parallel
     {
-#pragma omp for
+#pragma omp for ordered schedule(static)
 #endif
         for (size_t i = 0; i  < (XMAX * YMAX); i++)
         {
@@ -659,7 +703,7 @@ int _main(int argc, char *argv[])
             size_t y = i % (YMAX);
 
 #if USE_OPENMP
-#pragma omp critical
+#pragma omp ordered
             {
 #endif
             std::cout << std::endl;
@@ -705,17 +749,79 @@ int _main(int argc, char *argv[])
                 trace_proc_ok,
                 trace_proc_id,
                 trace_memc_ok,
-                trace_memc_id
+                trace_memc_id,
+                xram_direct
             );
 
 #if USE_OPENMP
-            } // end critical
+            } // end ordered
 #endif
         } // end for
 #if USE_OPENMP
     }
 #endif
 
+   //////////////////////////////////////////////////////////////////
+   //     Direct XRAM access
+   // In this mode, the external RAM of each cluster is not simulated
+   // (no VciSimpleRam is instantiated): the memory cache accesses
+   // a backing store containing its XRAM segment, with a fixed latency.
+   // The backing store is either loaded with the binary code (and the
+   // RAMDISK image), or is a lazy copy-on-write mapping of a physical
+   // memory image, shared by all the simulations using this image.
+   // With -XRAM_SAVE (in both memory access modes), the loaded backing
+   // stores are saved in a physical memory image, and the simulation
+   // exits. Saving an empty image (no section loaded in the XRAM
+   // segments) is an error. The image is used with -XRAM_IMAGE, that
+   // requires -XRAM_DIRECT.
+   //////////////////////////////////////////////////////////////////
+
+   if (xram_save[0] or xram_direct)
+   {
+      size_t saved = 0;     // pages written in the saved image
+
+      if (xram_save[0]) unlink(xram_save);
+
+      for (size_t x = 0; x < XMAX; x++)
+      {
+         for (size_t y = 0; y < YMAX; y++)
+         {
+            uint64_t offset = (uint64_t)cluster(x,y)
+                              << (vci_address_width - X_WIDTH - Y_WIDTH);
+
+            XramBackingStore * store =
+               new XramBackingStore(SEG_RAM_BASE + offset, SEG_RAM_SIZE,
+                                    xram_image[0] ? xram_image : NULL);
+
+            if (not xram_image[0])
+            {
+               loader.load(store->buffer(), store->base(), store->size());
+            }
+            if (xram_save[0])
+            {
+               saved += store->save(xram_save);
+               delete store;
+               continue;
+            }
+
+            clusters[x][y]->memc->set_xram_store(store, xram_latency);
+         }
+      }
+
+      if (xram_save[0])
+      {
+         if (saved == 0)
+         {
+            unlink(xram_save);
+            std::cout << "ERROR : no loaded section in the XRAM segments,"
+                      << " no memory image to save" << std::endl;
+            exit(EXIT_FAILURE);
+         }
+         std::cout << "XRAM image saved in " << xram_save << std::endl;
+         exit(0);
+      }
+   }
+
 #if USE_PIC
 
     //////////////////////////////////////////////////////////////////
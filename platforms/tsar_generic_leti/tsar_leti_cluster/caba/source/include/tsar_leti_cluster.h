@@ -128,7 +128,7 @@ template<size_t dspin_cmd_width,
 
     VciXicu<vci_param_int>*                       xicu;
 
-    VciSimpleRam<vci_param_ext>*                  xram;
+    VciSimpleRam<vci_param_ext>*                  xram;         // NULL if direct XRAM access
 
     VciMultiTty<vci_param_int>*                   mtty;
 
@@ -184,7 +184,8 @@ template<size_t dspin_cmd_width,
                      bool                               trace_proc_ok,
                      uint32_t                           trace_proc_id,
                      bool                               trace_memc_ok,
-                     uint32_t                           trace_memc_id );
+                     uint32_t                           trace_memc_id,
+                     bool                               xram_direct );  // no XRAM component
 
     ~TsarLetiCluster();
 
@@ -50,7 +50,8 @@ template<size_t dspin_cmd_width,
          bool                               trace_proc_ok,
          uint32_t                           trace_proc_id,
          bool                               trace_memc_ok,
-         uint32_t                           trace_memc_id )
+         uint32_t                           trace_memc_id,
+         bool                               xram_direct )
             : soclib::caba::BaseModule(insname),
             m_nprocs(nb_procs),
             p_clk("clk"),
@@ -142,14 +143,20 @@ template<size_t dspin_cmd_width,
                      trace_ok );
 
     /////////////////////////////////////////////////////////////////////////////
-    std::ostringstream sxram;
-    sxram << "xram_" << x_id << "_" << y_id;
-    xram = new VciSimpleRam<vci_param_ext>(
+    // With the direct XRAM access, the memory cache uses a backing store
+    // defined by the top cell, and the XRAM component is not instanciated.
+    xram = NULL;
+    if (not xram_direct)
+    {
+        std::ostringstream sxram;
+        sxram << "xram_" << x_id << "_" << y_id;
+        xram = new VciSimpleRam<vci_param_ext>(
                      sxram.str().c_str(),
                      IntTab(cluster_xy),
                      mtx,
                      loader,
                      xram_latency);
+    }
 
     /////////////////////////////////////////////////////////////////////////////
     std::ostringstream sxicu;
@@ -488,11 +495,14 @@ template<size_t dspin_cmd_width,
     std::cout << "  - MEMC connected" << std::endl;
 
     /////////////////////////////////////////////// XRAM
-    xram->p_clk                        (this->p_clk);
-    xram->p_resetn                     (this->p_resetn);
-    xram->p_vci                        (signal_vci_xram);
+    if (xram != NULL)
+    {
+        xram->p_clk                    (this->p_clk);
+        xram->p_resetn                 (this->p_resetn);
+        xram->p_vci                    (signal_vci_xram);
 
-    std::cout << "  - XRAM connected" << std::endl;
+        std::cout << "  - XRAM connected" << std::endl;
+    }
 
     /////////////////////////////// Extra Components in cluster(0,0)
 
@@ -0,0 +1,81 @@
+#!/usr/bin/python
+
+# Monitor for the activity counters exported in shared memory by the
+# simulator (--counters-shm option, see lib/counter_block/include/counter_block.h).
+# It samples the counters of all components while the simulation is
+# running, and prints the counters increments at each period.
+#
+# Usage : counters_monitor.py prefix [period_in_seconds [counter_name ...]]
+
+import glob
+import mmap
+import os
+import struct
+import sys
+import time
+
+HEADER_SIZE = 8 + 4 + 4 + 64
+PATH_SIZE   = 64
+NAME_SIZE   = 32
+UNIT_SIZE   = 16
+
+
+def cstring(data):
+    return data.split(b'\0', 1)[0].decode('latin-1')
+
+
+class Block(object):
+    def __init__(self, filename):
+        f = open(filename, 'rb')
+        self.map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        f.close()
+
+        if self.map[0:8] != b'SOCCNTRS':
+            raise ValueError('%s : not a counter block' % filename)
+        version, count = struct.unpack('=II', self.map[8:16])
+        if version != 1:
+            raise ValueError('%s : unsupported version %d' % (filename, version))
+
+        self.path  = cstring(self.map[16:16 + PATH_SIZE])
+        self.count = count
+        self.names = []
+        offset = HEADER_SIZE
+        for i in range(count):
+            self.names.append(cstring(self.map[offset:offset + NAME_SIZE]))
+            offset += NAME_SIZE + UNIT_SIZE
+        self.values_offset = offset
+
+    def values(self):
+        return struct.unpack('=%dQ' % self.count,
+                             self.map[self.values_offset:self.values_offset + 8 * self.count])
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit('usage : %s prefix [period [counter_name ...]]' % sys.argv[0])
+
+    prefix   = sys.argv[1]
+    period   = float(sys.argv[2]) if len(sys.argv) > 2 else 1.0
+    selected = set(sys.argv[3:])
+
+    files = sorted(glob.glob('/dev/shm/%s.*' % prefix))
+    if not files:
+        sys.exit('no counter block for prefix %s' % prefix)
+    blocks = [ Block(f) for f in files ]
+
+    previous = [ b.values() for b in blocks ]
+    while True:
+        time.sleep(period)
+        current = [ b.values() for b in blocks ]
+        for b, values, prev in zip(blocks, current, previous):
+            for name, value, last in zip(b.names, values, prev):
+                if not name or (selected and name not in selected):
+                    continue
+                print('%s.%s = %d (+%d)' % (b.path, name, value, value - last))
+        previous = current
+        print('')
+        sys.stdout.flush()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,120 @@
+#!/usr/bin/python
+
+# Decoder for the binary trace files written by the simulator
+# (-DEBUG option with --trace-file, see lib/trace_sink/include/trace_sink.h).
+# It prints the same text as the processors and memory caches print_trace()
+# functions. The binary trace does not contain the signal traces, the ISS
+# request / response lines, or the components detailed FSM debug traces,
+# that are only available in the text trace (-DEBUG without --trace-file).
+#
+# Usage : trace_decode.py trace_file [output_file]
+
+import struct
+import sys
+import heapq
+
+RECORD_SOURCE = 1
+RECORD_SAMPLE = 2
+
+
+class Source(object):
+    def __init__(self, header, fields):
+        self.header = header
+        self.fields = fields    # list of (prefix, table)
+
+    def format(self, values):
+        text = [ self.header, '\n' ]
+        for (prefix, table), value in zip(self.fields, values):
+            text.append(prefix)
+            if table:
+                text.append(table[value] if value < len(table) else str(value))
+            else:
+                text.append(str(value))
+        text.append('\n')
+        return ''.join(text)
+
+
+class TraceReader(object):
+    def __init__(self, f):
+        self.f = f
+
+    def read(self, size):
+        data = self.f.read(size)
+        if len(data) != size:
+            raise EOFError
+        return data
+
+    def u32(self):
+        return struct.unpack('=I', self.read(4))[0]
+
+    def string(self):
+        chars = []
+        while True:
+            c = self.read(1)
+            if c == b'\0':
+                break
+            chars.append(c)
+        return b''.join(chars).decode('latin-1')
+
+
+def decode(f, out):
+    reader = TraceReader(f)
+
+    if reader.read(8) != b'SOCTRACE':
+        sys.exit('not a trace file')
+    version = reader.u32()
+    if version != 1:
+        sys.exit('unsupported trace version %d' % version)
+
+    sources = {}
+    pending = []        # heap of (seq, cycle, source id, values)
+    next_seq = 0
+    last_cycle = None
+
+    while True:
+        try:
+            record = reader.u32()
+        except EOFError:
+            break
+
+        if record == RECORD_SOURCE:
+            sid = reader.u32()
+            header = reader.string()
+            fields = []
+            for i in range(reader.u32()):
+                prefix = reader.string()
+                table = [ reader.string() for j in range(reader.u32()) ]
+                fields.append((prefix, table))
+            sources[sid] = Source(header, fields)
+
+        elif record == RECORD_SAMPLE:
+            sid = reader.u32()
+            seq, cycle = struct.unpack('=QQ', reader.read(16))
+            n = len(sources[sid].fields)
+            values = struct.unpack('=%dI' % n, reader.read(4 * n))
+            heapq.heappush(pending, (seq, cycle, sid, values))
+
+        else:
+            sys.exit('corrupted trace file (record type %d)' % record)
+
+        # the samples are printed in sequence order
+        while pending and pending[0][0] == next_seq:
+            seq, cycle, sid, values = heapq.heappop(pending)
+            if cycle != last_cycle:
+                out.write('****************** cycle %d' % cycle)
+                out.write('*' * 48 + '\n')
+                last_cycle = cycle
+            out.write(sources[sid].format(values))
+            next_seq += 1
+
+    if pending:
+        sys.stderr.write('warning : %d samples not printed (truncated trace)\n' % len(pending))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.exit('usage : %s trace_file [output_file]' % sys.argv[0])
+
+    out = open(sys.argv[2], 'w') if len(sys.argv) > 2 else sys.stdout
+    with open(sys.argv[1], 'rb') as f:
+        decode(f, out)
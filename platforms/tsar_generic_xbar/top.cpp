@@ -82,6 +82,7 @@
 
 #include <systemc>
 #include <sys/time.h>
+#include <unistd.h>
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
@@ -92,6 +93,10 @@
 #include "mapping_table.h"
 #include "alloc_elems.h"
 #include "tsar_xbar_cluster.h"
+#include "dspin_mesh_tsar.h"
+#include "statistics_registry.h"
+#include "trace_sink.h"
+#include "counter_block.h"
 
 #define USE_ALMOS 1
 //#define USE_GIET 
@@ -119,12 +124,37 @@
 ///////////////////////////////////////////////////
 //               Parallelisation
 ///////////////////////////////////////////////////
+// When compiled with OpenMP (SystemCASS parallel
+// scheduler), each module is evaluated by the thread
+// that constructed it: the transition and genMoore
+// phases of all clusters run concurrently, with a
+// barrier between phases, and all inter-cluster
+// DSPIN signals are double-buffered by the kernel.
+// Clusters are therefore constructed in a parallel
+// loop, so that each thread owns a contiguous block
+// of clusters (see "Clusters construction" below).
+///////////////////////////////////////////////////
 
+#ifndef USE_OPENMP
+#define USE_OPENMP _OPENMP
+#endif
 
 #if USE_OPENMP
 #include <omp.h>
 #endif
 
+///////////////////////////////////////////////////
+// The -MESH_NOC option (DspinMeshTsar engine for
+// the CMD/RSP/P2M/CLACK networks) is only available
+// when USE_MESH_NOC is set: the engine has not yet
+// been checked against the soclib DspinRouter
+// (see platforms/dspin_mesh_check).
+///////////////////////////////////////////////////
+
+#ifndef USE_MESH_NOC
+#define USE_MESH_NOC 0
+#endif
+
 //  cluster index (computed from x,y coordinates)
 #ifdef USE_ALMOS
    #define cluster(x,y)   (y + x * Y_SIZE)
@@ -358,6 +388,22 @@ int _main(int argc, char *argv[])
    int64_t  dump_counters     = -1;
    bool     do_reset_counters = false;
    bool     do_dump_counters  = false;
+   char     dump_file[256]    = "";                 // pathname to the statistics file
+   char     trace_file[256]   = "";                 // pathname to the binary trace file
+   char     counters_shm[64]  = "";                 // prefix of the counters shared memory
+   int64_t  dump_period       = 0;                  // cycles between two statistics snapshots
+   soclib::StatisticsRegistry::format_t dump_format = soclib::StatisticsRegistry::FORMAT_CSV;
+   soclib::StatisticsRegistry::mode_t   dump_mode   = soclib::StatisticsRegistry::MODE_CUMULATIVE;
+   bool     xram_direct       = false;              // direct XRAM access by memc
+   size_t   xram_latency      = XRAM_LATENCY;       // direct XRAM access latency
+   char     xram_image[256]   = "";                 // pathname to physical memory image
+   char     xram_save[256]    = "";                 // pathname to saved memory image
+   bool     mesh_noc          = false;              // mesh NoC engine for CMD/RSP/P2M/CLACK
+   bool     dir_bitset        = false;              // bitset directory mode for memc copies
+   size_t   config_skip       = 0;                  // absent lines skipped per cycle by memc
+   bool     disk_backend_set  = false;              // disk image backend selected
+   size_t   disk_prefetch     = 8;                  // blocks read ahead (prefetch backend)
+   soclib::caba::BlockDeviceBackend::backend_t disk_backend = soclib::caba::BlockDeviceBackend::BACKEND_FILE;
    struct   timeval t1, t2;
    uint64_t ms1, ms2;
 
@@ -383,6 +429,15 @@ int _main(int argc, char *argv[])
          {
             strcpy(disk_name, argv[n + 1]);
          }
+         else if ((strcmp(argv[n],"-DISK_BACKEND") == 0) && (n + 1 < argc) &&
+                  soclib::caba::BlockDeviceBackend::parse(argv[n + 1], disk_backend))
+         {
+            disk_backend_set = true;
+         }
+         else if ((strcmp(argv[n],"-DISK_PREFETCH") == 0) && (n + 1 < argc))
+         {
+            disk_prefetch = (size_t) strtol(argv[n + 1], NULL, 0);
+         }
          else if ((strcmp(argv[n],"-DEBUG") == 0) && (n + 1 < argc))
          {
             debug_ok = true;
@@ -421,6 +476,8 @@ int _main(int argc, char *argv[])
          {
             threads_nr = (ssize_t) strtol(argv[n + 1], NULL, 0);
             threads_nr = (threads_nr < 1) ? 1 : threads_nr;
+            // no more threads than clusters, as the cluster is the unit of work
+            threads_nr = (threads_nr > (ssize_t)(X_SIZE * Y_SIZE)) ? (X_SIZE * Y_SIZE) : threads_nr;
          }
          else if ((strcmp(argv[n], "-FROZEN") == 0) && (n + 1 < argc))
          {
@@ -440,6 +497,62 @@ int _main(int argc, char *argv[])
             dump_counters = (int64_t) strtol(argv[n + 1], NULL, 0);
             do_dump_counters = true;
          }
+         else if ((strcmp(argv[n], "--dump-file") == 0) && (n + 1 < argc))
+         {
+            strncpy(dump_file, argv[n + 1], sizeof(dump_file) - 1);
+            dump_file[sizeof(dump_file) - 1] = 0;
+         }
+         else if ((strcmp(argv[n], "--dump-format") == 0) && (n + 1 < argc) &&
+                  soclib::StatisticsRegistry::parse_format(argv[n + 1], dump_format))
+         {
+         }
+         else if ((strcmp(argv[n], "--dump-mode") == 0) && (n + 1 < argc) &&
+                  soclib::StatisticsRegistry::parse_mode(argv[n + 1], dump_mode))
+         {
+         }
+         else if ((strcmp(argv[n], "--dump-period") == 0) && (n + 1 < argc))
+         {
+            dump_period = (int64_t) strtol(argv[n + 1], NULL, 0);
+         }
+         else if ((strcmp(argv[n], "--trace-file") == 0) && (n + 1 < argc))
+         {
+            strncpy(trace_file, argv[n + 1], sizeof(trace_file) - 1);
+            trace_file[sizeof(trace_file) - 1] = 0;
+         }
+         else if ((strcmp(argv[n], "--counters-shm") == 0) && (n + 1 < argc))
+         {
+            strncpy(counters_shm, argv[n + 1], sizeof(counters_shm) - 1);
+            counters_shm[sizeof(counters_shm) - 1] = 0;
+         }
+         else if ((strcmp(argv[n], "-XRAM_DIRECT") == 0) && (n + 1 < argc))
+         {
+            xram_direct  = true;
+            xram_latency = (size_t) strtol(argv[n + 1], NULL, 0);
+         }
+         else if ((strcmp(argv[n], "-XRAM_IMAGE") == 0) && (n + 1 < argc))
+         {
+            strncpy(xram_image, argv[n + 1], sizeof(xram_image) - 1);
+            xram_image[sizeof(xram_image) - 1] = 0;
+         }
+         else if ((strcmp(argv[n], "-XRAM_SAVE") == 0) && (n + 1 < argc))
+         {
+            strncpy(xram_save, argv[n + 1], sizeof(xram_save) - 1);
+            xram_save[sizeof(xram_save) - 1] = 0;
+         }
+#if USE_MESH_NOC
+         else if ((strcmp(argv[n], "-MESH_NOC") == 0) && (n + 1 < argc))
+         {
+            mesh_noc = (strtol(argv[n + 1], NULL, 0) != 0);
+         }
+#endif
+         else if ((strcmp(argv[n], "-DIR_BITSET") == 0) && (n + 1 < argc))
+         {
+            dir_bitset = (strtol(argv[n + 1], NULL, 0) != 0);
+         }
+         else if ((strcmp(argv[n], "-CONFIG_SKIP") == 0) && (n + 1 < argc))
+         {
+            config_skip = (size_t) strtol(argv[n + 1], NULL, 0);
+         }
          else
          {
             std::cout << "   Arguments are (key,value) couples." << std::endl;
@@ -447,6 +560,8 @@ int _main(int argc, char *argv[])
             std::cout << "   Accepted arguments are :" << std::endl << std::endl;
             std::cout << "     -SOFT pathname_for_embedded_soft" << std::endl;
             std::cout << "     -DISK pathname_for_disk_image" << std::endl;
+            std::cout << "     -DISK_BACKEND file | mmap | prefetch | cow" << std::endl;
+            std::cout << "     -DISK_PREFETCH number_of_blocks read ahead (prefetch backend)" << std::endl;
             std::cout << "     -NCYCLES number_of_simulated_cycles" << std::endl;
             std::cout << "     -DEBUG debug_start_cycle" << std::endl;
             std::cout << "     -THREADS simulator's threads number" << std::endl;
@@ -454,11 +569,35 @@ int _main(int argc, char *argv[])
             std::cout << "     -PERIOD number_of_cycles between trace" << std::endl;
             std::cout << "     -MEMCID index_memc_to_be_traced" << std::endl;
             std::cout << "     -PROCID index_proc_to_be_traced" << std::endl;
+            std::cout << "     -XRAM_DIRECT direct_xram_access_latency" << std::endl;
+            std::cout << "     -XRAM_IMAGE pathname_for_physical_memory_image (with XRAM_DIRECT)" << std::endl;
+            std::cout << "     -XRAM_SAVE pathname_for_saved_memory_image (and exit)" << std::endl;
+#if USE_MESH_NOC
+            std::cout << "     -MESH_NOC 0 | 1 (mesh NoC engine)" << std::endl;
+#endif
+            std::cout << "     -DIR_BITSET 0 | 1 (bitset directory for memc copies)" << std::endl;
+            std::cout << "     -CONFIG_SKIP absent_lines_skipped_per_cycle (0 : no skip)" << std::endl;
+            std::cout << "     --reset-counters cycle" << std::endl;
+            std::cout << "     --dump-counters cycle" << std::endl;
+            std::cout << "     --dump-file pathname_for_statistics (- for stdout)" << std::endl;
+            std::cout << "     --dump-format csv | json | bin" << std::endl;
+            std::cout << "     --dump-mode cumulative | delta" << std::endl;
+            std::cout << "     --trace-file pathname_for_binary_trace (with -DEBUG, PROC and MEMC states only)" << std::endl;
+            std::cout << "     --dump-period number_of_cycles between statistics" << std::endl;
+            std::cout << "     --counters-shm prefix_of_counters_shared_memory" << std::endl;
             exit(0);
          }
       }
    }
 
+   // a memory image is only mapped by the memory caches in direct XRAM
+   // access mode, that changes the memory model: it must be explicit
+   if (xram_image[0] and not xram_direct)
+   {
+      std::cout << "XRAM_IMAGE requires the direct XRAM access mode (XRAM_DIRECT)" << std::endl;
+      exit(EXIT_FAILURE);
+   }
+
     // checking hardware parameters
     assert( ( (X_SIZE == 1) or (X_SIZE == 2) or (X_SIZE == 4) or
               (X_SIZE == 8) or (X_SIZE == 16) ) and
@@ -502,8 +641,53 @@ int _main(int argc, char *argv[])
     std::cout << " - MEMC_WAYS        = " << MEMC_WAYS << std::endl;
     std::cout << " - MEMC_SETS        = " << MEMC_SETS << std::endl;
     std::cout << " - RAM_LATENCY      = " << XRAM_LATENCY << std::endl;
+    std::cout << " - XRAM_DIRECT      = " << xram_direct << std::endl;
+    std::cout << " - MESH_NOC         = " << mesh_noc << std::endl;
+    std::cout << " - DIR_BITSET       = " << dir_bitset << std::endl;
+    std::cout << " - CONFIG_SKIP      = " << config_skip << std::endl;
     std::cout << " - MAX_FROZEN       = " << frozen_cycles << std::endl;
 
+    // statistics snapshots (the counters are published by the components)
+    soclib::StatisticsRegistry & stats = soclib::StatisticsRegistry::instance();
+    int64_t dump_next = -1;
+    if (dump_file[0] != 0)
+    {
+        if (not stats.open(dump_file, dump_format, dump_mode))
+        {
+            perror("cannot open statistics file");
+            return EXIT_FAILURE;
+        }
+        if (dump_period > 0) dump_next = dump_period;
+        std::cout << " - STATISTICS FILE  = " << dump_file << std::endl;
+    }
+
+    // binary traces (decoded by the scripts/trace_decode.py script) :
+    // only the processors and memory caches FSM states are recorded,
+    // and the components detailed text traces are disabled
+    bool debug_text = debug_ok;
+    if (debug_ok and (trace_file[0] != 0))
+    {
+        if (not soclib::TraceSink::instance().open(trace_file))
+        {
+            perror("cannot open trace file");
+            return EXIT_FAILURE;
+        }
+        debug_text = false;
+        std::cout << " - TRACE FILE       = " << trace_file << std::endl;
+        std::cout << "   WARNING : the binary trace only records the PROC and MEMC"
+                  << " print_trace() states. It does not contain the [SIG] signal"
+                  << " traces, the ISS request / response lines, and the"
+                  << " components detailed FSM debug traces" << std::endl;
+    }
+
+    // activity counters exported in shared memory objects
+    // (/dev/shm/<prefix>.<component>, see scripts/counters_monitor.py)
+    if (counters_shm[0] != 0)
+    {
+        soclib::CounterBlockBase::set_shm_prefix(counters_shm);
+        std::cout << " - COUNTERS SHM     = " << counters_shm << std::endl;
+    }
+
     std::cout << std::endl;
     // Internal and External VCI parameters definition
     typedef soclib::caba::VciParams<vci_cell_width_int,
@@ -532,6 +716,7 @@ int _main(int argc, char *argv[])
    omp_set_dynamic(false);
    omp_set_num_threads(threads_nr);
    std::cerr << "Built with openmp version " << _OPENMP << std::endl;
+   std::cout << " - OPENMP THREADS   = " << threads_nr << std::endl;
 #endif
 
    // Define parameters depending on mesh size
@@ -735,6 +920,14 @@ int _main(int argc, char *argv[])
    //      Loader    
    ////////////////////////////
 
+   // With ALMOS, the bootloader, the kernel and the arch-info are all
+   // loaded in the BROM segment: they are the boot ROM content, and
+   // no section is loaded in the XRAM segments, so that there is no
+   // memory image to save (-XRAM_SAVE) or share (-XRAM_IMAGE).
+   // With GIET, the ELF file contains both the boot ROM and the RAM
+   // sections: with -XRAM_IMAGE, -SOFT can designate an ELF file
+   // containing only the boot ROM sections, the RAM sections being
+   // already in the image built (-XRAM_SAVE) with the complete file.
    soclib::common::Loader loader(soft_name);
 
    typedef soclib::common::GdbServer<soclib::common::Mips32ElIss> proc_iss;
@@ -749,10 +942,16 @@ int _main(int argc, char *argv[])
                    vci_param_int,
                    vci_param_ext> * clusters[X_SIZE][Y_SIZE];
 
+   // With OpenMP, the static schedule gives each thread a fixed block
+   // of neighbour clusters (all the components of a cluster - memc,
+   // L1 caches, local crossbars and routers - are evaluated by the
+   // same thread), and the ordered section builds the clusters one
+   // at a time in index order, so that the elaborated netlist (and
+   // the simulation results) does not depend on the number of threads.
 #if USE_OPENMP
 #pragma omp parallel
     {
-#pragma omp for
+#pragma omp for ordered schedule(static)
 #endif
         for (size_t i = 0; i  < (X_SIZE * Y_SIZE); i++)
         {
@@ -760,7 +959,7 @@ int _main(int argc, char *argv[])
             size_t y = i % Y_SIZE;
 
 #if USE_OPENMP
-#pragma omp critical
+#pragma omp ordered
             {
 #endif
             std::cout << std::endl;
@@ -817,18 +1016,142 @@ int _main(int argc, char *argv[])
                 loader,
                 frozen_cycles,
                 debug_from,
-                debug_ok,
-                debug_ok
+                debug_text,
+                debug_text,
+                mesh_noc,
+                xram_direct
             );
 
 #if USE_OPENMP
-            } // end critical
+            } // end ordered
 #endif
         } // end for
 #if USE_OPENMP
     }
 #endif
 
+   ///////////////////////////////////////////////////////////////
+   //     Mesh NoC engine
+   ///////////////////////////////////////////////////////////////
+   // The CMD, RSP, P2M and CLACK networks are simulated by one
+   // DspinMeshTsar component per network (instead of one router
+   // per cluster), directly connected to the local ports of the
+   // clusters. The M2P network always uses the cluster routers,
+   // as it supports broadcast.
+
+   DspinMeshTsar<dspin_cmd_width> * mesh_cmd = NULL;
+   DspinMeshTsar<dspin_rsp_width> * mesh_rsp = NULL;
+   DspinMeshTsar<dspin_rsp_width> * mesh_p2m = NULL;
+   DspinMeshTsar<dspin_cmd_width> * mesh_cla = NULL;
+
+   if (mesh_noc)
+   {
+      mesh_cmd = new DspinMeshTsar<dspin_cmd_width>("mesh_cmd", X_SIZE, Y_SIZE,
+                                                    x_width, y_width, 4, 4);
+      mesh_rsp = new DspinMeshTsar<dspin_rsp_width>("mesh_rsp", X_SIZE, Y_SIZE,
+                                                    x_width, y_width, 4, 4);
+      mesh_p2m = new DspinMeshTsar<dspin_rsp_width>("mesh_p2m", X_SIZE, Y_SIZE,
+                                                    x_width, y_width, 4, 4);
+      mesh_cla = new DspinMeshTsar<dspin_cmd_width>("mesh_cla", X_SIZE, Y_SIZE,
+                                                    x_width, y_width, 4, 4);
+   }
+
+   ///////////////////////////////////////////////////////////////
+   //     Direct XRAM access
+   ///////////////////////////////////////////////////////////////
+   // Each memory cache reads and writes the cache lines directly in
+   // a backing store containing its XRAM segment, with a fixed latency,
+   // and no VCI transaction is simulated on the external network.
+   // The backing store is either loaded with the binary code, or is
+   // a lazy copy-on-write mapping of a physical memory image.
+   // With -XRAM_SAVE (in both memory access modes), the loaded backing
+   // stores are saved in a physical memory image, and the simulation
+   // exits: this image can then be shared (-XRAM_IMAGE -XRAM_DIRECT) by
+   // all the simulations of a parameter sweep. Saving an empty image
+   // (no section loaded in the XRAM segments, as with ALMOS) is an error.
+
+   if (xram_save[0] or xram_direct)
+   {
+      size_t saved = 0;     // pages written in the saved image
+
+      if (xram_save[0]) unlink(xram_save);
+
+      for (size_t x = 0; x < X_SIZE; x++)
+      {
+         for (size_t y = 0; y < Y_SIZE; y++)
+         {
+            uint64_t offset = (uint64_t)cluster(x,y)
+                              << (vci_address_width - x_width - y_width);
+
+            XramBackingStore * store =
+               new XramBackingStore(MEMC_BASE + offset, MEMC_SIZE,
+                                    xram_image[0] ? xram_image : NULL);
+
+            if (not xram_image[0])
+            {
+               loader.load(store->buffer(), store->base(), store->size());
+            }
+            if (xram_save[0])
+            {
+               saved += store->save(xram_save);
+               delete store;
+               continue;
+            }
+
+            clusters[x][y]->memc->set_xram_store(store, xram_latency);
+         }
+      }
+
+      if (xram_save[0])
+      {
+         if (saved == 0)
+         {
+            unlink(xram_save);
+            std::cout << "ERROR : no loaded section in the XRAM segments,"
+                      << " no memory image to save" << std::endl;
+            exit(EXIT_FAILURE);
+         }
+         std::cout << "XRAM image saved in " << xram_save << std::endl;
+         exit(0);
+      }
+   }
+
+   // one slot per L1 cache (instruction and data) in the bitset directory mode
+   if (dir_bitset)
+   {
+      for (size_t x = 0; x < X_SIZE; x++)
+      {
+         for (size_t y = 0; y < Y_SIZE; y++)
+         {
+            clusters[x][y]->memc->set_sharer_directory(2 * X_SIZE * Y_SIZE * NB_PROCS_MAX);
+         }
+      }
+   }
+
+   // disk image backend (the default backend is selected by the block device)
+   if (disk_backend_set)
+   {
+      for (size_t x = 0; x < X_SIZE; x++)
+      {
+         for (size_t y = 0; y < Y_SIZE; y++)
+         {
+            if (cluster(x,y) == cluster_io_id)
+            {
+               clusters[x][y]->bdev->set_backend(disk_backend, disk_prefetch);
+            }
+         }
+      }
+   }
+
+   // bulk skip of the absent lines for the memc INVAL / SYNC commands
+   for (size_t x = 0; x < X_SIZE; x++)
+   {
+      for (size_t y = 0; y < Y_SIZE; y++)
+      {
+         clusters[x][y]->memc->set_config_skip(config_skip);
+      }
+   }
+
    ///////////////////////////////////////////////////////////////
    //     Net-list 
    ///////////////////////////////////////////////////////////////
@@ -841,34 +1164,61 @@ int _main(int argc, char *argv[])
       }
    }
 
+   // Mesh NoC engine
+   if (mesh_noc) {
+      mesh_cmd->p_clk                                  (signal_clk);
+      mesh_cmd->p_resetn                               (signal_resetn);
+      mesh_rsp->p_clk                                  (signal_clk);
+      mesh_rsp->p_resetn                               (signal_resetn);
+      mesh_p2m->p_clk                                  (signal_clk);
+      mesh_p2m->p_resetn                               (signal_resetn);
+      mesh_cla->p_clk                                  (signal_clk);
+      mesh_cla->p_resetn                               (signal_resetn);
+
+      for (size_t x = 0; x < X_SIZE; x++) {
+         for (size_t y = 0; y < Y_SIZE; y++) {
+            mesh_cmd->p_local_in[x][y]    (clusters[x][y]->signal_dspin_cmd_l2g_d);
+            mesh_cmd->p_local_out[x][y]   (clusters[x][y]->signal_dspin_cmd_g2l_d);
+            mesh_rsp->p_local_in[x][y]    (clusters[x][y]->signal_dspin_rsp_l2g_d);
+            mesh_rsp->p_local_out[x][y]   (clusters[x][y]->signal_dspin_rsp_g2l_d);
+            mesh_p2m->p_local_in[x][y]    (clusters[x][y]->signal_dspin_p2m_l2g_c);
+            mesh_p2m->p_local_out[x][y]   (clusters[x][y]->signal_dspin_p2m_g2l_c);
+            mesh_cla->p_local_in[x][y]    (clusters[x][y]->signal_dspin_clack_l2g_c);
+            mesh_cla->p_local_out[x][y]   (clusters[x][y]->signal_dspin_clack_g2l_c);
+         }
+      }
+   }
+
    // Inter Clusters horizontal connections
    if (X_SIZE > 1) {
        for (size_t x = 0; x < (X_SIZE-1); x++) {
            for (size_t y = 0; y < (Y_SIZE); y++) {
-               clusters[x][y]->p_cmd_out[EAST]      (signal_dspin_h_cmd_inc[x][y]);
-               clusters[x+1][y]->p_cmd_in[WEST]     (signal_dspin_h_cmd_inc[x][y]);
-               clusters[x][y]->p_cmd_in[EAST]       (signal_dspin_h_cmd_dec[x][y]);
-               clusters[x+1][y]->p_cmd_out[WEST]    (signal_dspin_h_cmd_dec[x][y]);
-
-               clusters[x][y]->p_rsp_out[EAST]      (signal_dspin_h_rsp_inc[x][y]);
-               clusters[x+1][y]->p_rsp_in[WEST]     (signal_dspin_h_rsp_inc[x][y]);
-               clusters[x][y]->p_rsp_in[EAST]       (signal_dspin_h_rsp_dec[x][y]);
-               clusters[x+1][y]->p_rsp_out[WEST]    (signal_dspin_h_rsp_dec[x][y]);
-
                clusters[x][y]->p_m2p_out[EAST]      (signal_dspin_h_m2p_inc[x][y]);
                clusters[x+1][y]->p_m2p_in[WEST]     (signal_dspin_h_m2p_inc[x][y]);
                clusters[x][y]->p_m2p_in[EAST]       (signal_dspin_h_m2p_dec[x][y]);
                clusters[x+1][y]->p_m2p_out[WEST]    (signal_dspin_h_m2p_dec[x][y]);
 
-               clusters[x][y]->p_p2m_out[EAST]      (signal_dspin_h_p2m_inc[x][y]);
-               clusters[x+1][y]->p_p2m_in[WEST]     (signal_dspin_h_p2m_inc[x][y]);
-               clusters[x][y]->p_p2m_in[EAST]       (signal_dspin_h_p2m_dec[x][y]);
-               clusters[x+1][y]->p_p2m_out[WEST]    (signal_dspin_h_p2m_dec[x][y]);
-
-               clusters[x][y]->p_cla_out[EAST]      (signal_dspin_h_cla_inc[x][y]);
-               clusters[x+1][y]->p_cla_in[WEST]     (signal_dspin_h_cla_inc[x][y]);
-               clusters[x][y]->p_cla_in[EAST]       (signal_dspin_h_cla_dec[x][y]);
-               clusters[x+1][y]->p_cla_out[WEST]    (signal_dspin_h_cla_dec[x][y]);
+               if (not mesh_noc) {
+                  clusters[x][y]->p_cmd_out[EAST]      (signal_dspin_h_cmd_inc[x][y]);
+                  clusters[x+1][y]->p_cmd_in[WEST]     (signal_dspin_h_cmd_inc[x][y]);
+                  clusters[x][y]->p_cmd_in[EAST]       (signal_dspin_h_cmd_dec[x][y]);
+                  clusters[x+1][y]->p_cmd_out[WEST]    (signal_dspin_h_cmd_dec[x][y]);
+
+                  clusters[x][y]->p_rsp_out[EAST]      (signal_dspin_h_rsp_inc[x][y]);
+                  clusters[x+1][y]->p_rsp_in[WEST]     (signal_dspin_h_rsp_inc[x][y]);
+                  clusters[x][y]->p_rsp_in[EAST]       (signal_dspin_h_rsp_dec[x][y]);
+                  clusters[x+1][y]->p_rsp_out[WEST]    (signal_dspin_h_rsp_dec[x][y]);
+
+                  clusters[x][y]->p_p2m_out[EAST]      (signal_dspin_h_p2m_inc[x][y]);
+                  clusters[x+1][y]->p_p2m_in[WEST]     (signal_dspin_h_p2m_inc[x][y]);
+                  clusters[x][y]->p_p2m_in[EAST]       (signal_dspin_h_p2m_dec[x][y]);
+                  clusters[x+1][y]->p_p2m_out[WEST]    (signal_dspin_h_p2m_dec[x][y]);
+
+                  clusters[x][y]->p_cla_out[EAST]      (signal_dspin_h_cla_inc[x][y]);
+                  clusters[x+1][y]->p_cla_in[WEST]     (signal_dspin_h_cla_inc[x][y]);
+                  clusters[x][y]->p_cla_in[EAST]       (signal_dspin_h_cla_dec[x][y]);
+                  clusters[x+1][y]->p_cla_out[WEST]    (signal_dspin_h_cla_dec[x][y]);
+               }
            }
        }
    }
@@ -878,30 +1228,32 @@ int _main(int argc, char *argv[])
    if (Y_SIZE > 1) {
        for (size_t y = 0; y < (Y_SIZE-1); y++) {
            for (size_t x = 0; x < X_SIZE; x++) {
-               clusters[x][y]->p_cmd_out[NORTH]     (signal_dspin_v_cmd_inc[x][y]);
-               clusters[x][y+1]->p_cmd_in[SOUTH]    (signal_dspin_v_cmd_inc[x][y]);
-               clusters[x][y]->p_cmd_in[NORTH]      (signal_dspin_v_cmd_dec[x][y]);
-               clusters[x][y+1]->p_cmd_out[SOUTH]   (signal_dspin_v_cmd_dec[x][y]);
-
-               clusters[x][y]->p_rsp_out[NORTH]     (signal_dspin_v_rsp_inc[x][y]);
-               clusters[x][y+1]->p_rsp_in[SOUTH]    (signal_dspin_v_rsp_inc[x][y]);
-               clusters[x][y]->p_rsp_in[NORTH]      (signal_dspin_v_rsp_dec[x][y]);
-               clusters[x][y+1]->p_rsp_out[SOUTH]   (signal_dspin_v_rsp_dec[x][y]);
-
                clusters[x][y]->p_m2p_out[NORTH]     (signal_dspin_v_m2p_inc[x][y]);
                clusters[x][y+1]->p_m2p_in[SOUTH]    (signal_dspin_v_m2p_inc[x][y]);
                clusters[x][y]->p_m2p_in[NORTH]      (signal_dspin_v_m2p_dec[x][y]);
                clusters[x][y+1]->p_m2p_out[SOUTH]   (signal_dspin_v_m2p_dec[x][y]);
 
-               clusters[x][y]->p_p2m_out[NORTH]     (signal_dspin_v_p2m_inc[x][y]);
-               clusters[x][y+1]->p_p2m_in[SOUTH]    (signal_dspin_v_p2m_inc[x][y]);
-               clusters[x][y]->p_p2m_in[NORTH]      (signal_dspin_v_p2m_dec[x][y]);
-               clusters[x][y+1]->p_p2m_out[SOUTH]   (signal_dspin_v_p2m_dec[x][y]);
-
-               clusters[x][y]->p_cla_out[NORTH]     (signal_dspin_v_cla_inc[x][y]);
-               clusters[x][y+1]->p_cla_in[SOUTH]    (signal_dspin_v_cla_inc[x][y]);
-               clusters[x][y]->p_cla_in[NORTH]      (signal_dspin_v_cla_dec[x][y]);
-               clusters[x][y+1]->p_cla_out[SOUTH]   (signal_dspin_v_cla_dec[x][y]);
+               if (not mesh_noc) {
+                  clusters[x][y]->p_cmd_out[NORTH]     (signal_dspin_v_cmd_inc[x][y]);
+                  clusters[x][y+1]->p_cmd_in[SOUTH]    (signal_dspin_v_cmd_inc[x][y]);
+                  clusters[x][y]->p_cmd_in[NORTH]      (signal_dspin_v_cmd_dec[x][y]);
+                  clusters[x][y+1]->p_cmd_out[SOUTH]   (signal_dspin_v_cmd_dec[x][y]);
+
+                  clusters[x][y]->p_rsp_out[NORTH]     (signal_dspin_v_rsp_inc[x][y]);
+                  clusters[x][y+1]->p_rsp_in[SOUTH]    (signal_dspin_v_rsp_inc[x][y]);
+                  clusters[x][y]->p_rsp_in[NORTH]      (signal_dspin_v_rsp_dec[x][y]);
+                  clusters[x][y+1]->p_rsp_out[SOUTH]   (signal_dspin_v_rsp_dec[x][y]);
+
+                  clusters[x][y]->p_p2m_out[NORTH]     (signal_dspin_v_p2m_inc[x][y]);
+                  clusters[x][y+1]->p_p2m_in[SOUTH]    (signal_dspin_v_p2m_inc[x][y]);
+                  clusters[x][y]->p_p2m_in[NORTH]      (signal_dspin_v_p2m_dec[x][y]);
+                  clusters[x][y+1]->p_p2m_out[SOUTH]   (signal_dspin_v_p2m_dec[x][y]);
+
+                  clusters[x][y]->p_cla_out[NORTH]     (signal_dspin_v_cla_inc[x][y]);
+                  clusters[x][y+1]->p_cla_in[SOUTH]    (signal_dspin_v_cla_inc[x][y]);
+                  clusters[x][y]->p_cla_in[NORTH]      (signal_dspin_v_cla_dec[x][y]);
+                  clusters[x][y+1]->p_cla_out[SOUTH]   (signal_dspin_v_cla_dec[x][y]);
+               }
            }
        }
    }
@@ -909,60 +1261,64 @@ int _main(int argc, char *argv[])
 
    // East & West boundary cluster connections
    for (size_t y = 0; y < (Y_SIZE); y++) {
-       clusters[0][y]->p_cmd_in[WEST]           (signal_dspin_bound_cmd_in[0][y][WEST]);
-       clusters[0][y]->p_cmd_out[WEST]          (signal_dspin_bound_cmd_out[0][y][WEST]);
-       clusters[X_SIZE-1][y]->p_cmd_in[EAST]    (signal_dspin_bound_cmd_in[X_SIZE-1][y][EAST]);
-       clusters[X_SIZE-1][y]->p_cmd_out[EAST]   (signal_dspin_bound_cmd_out[X_SIZE-1][y][EAST]);
-
-       clusters[0][y]->p_rsp_in[WEST]           (signal_dspin_bound_rsp_in[0][y][WEST]);
-       clusters[0][y]->p_rsp_out[WEST]          (signal_dspin_bound_rsp_out[0][y][WEST]);
-       clusters[X_SIZE-1][y]->p_rsp_in[EAST]    (signal_dspin_bound_rsp_in[X_SIZE-1][y][EAST]);
-       clusters[X_SIZE-1][y]->p_rsp_out[EAST]   (signal_dspin_bound_rsp_out[X_SIZE-1][y][EAST]);
-
        clusters[0][y]->p_m2p_in[WEST]           (signal_dspin_bound_m2p_in[0][y][WEST]);
        clusters[0][y]->p_m2p_out[WEST]          (signal_dspin_bound_m2p_out[0][y][WEST]);
        clusters[X_SIZE-1][y]->p_m2p_in[EAST]    (signal_dspin_bound_m2p_in[X_SIZE-1][y][EAST]);
        clusters[X_SIZE-1][y]->p_m2p_out[EAST]   (signal_dspin_bound_m2p_out[X_SIZE-1][y][EAST]);
 
-       clusters[0][y]->p_p2m_in[WEST]           (signal_dspin_bound_p2m_in[0][y][WEST]);
-       clusters[0][y]->p_p2m_out[WEST]          (signal_dspin_bound_p2m_out[0][y][WEST]);
-       clusters[X_SIZE-1][y]->p_p2m_in[EAST]    (signal_dspin_bound_p2m_in[X_SIZE-1][y][EAST]);
-       clusters[X_SIZE-1][y]->p_p2m_out[EAST]   (signal_dspin_bound_p2m_out[X_SIZE-1][y][EAST]);
-
-       clusters[0][y]->p_cla_in[WEST]           (signal_dspin_bound_cla_in[0][y][WEST]);
-       clusters[0][y]->p_cla_out[WEST]          (signal_dspin_bound_cla_out[0][y][WEST]);
-       clusters[X_SIZE-1][y]->p_cla_in[EAST]    (signal_dspin_bound_cla_in[X_SIZE-1][y][EAST]);
-       clusters[X_SIZE-1][y]->p_cla_out[EAST]   (signal_dspin_bound_cla_out[X_SIZE-1][y][EAST]);
+       if (not mesh_noc) {
+          clusters[0][y]->p_cmd_in[WEST]           (signal_dspin_bound_cmd_in[0][y][WEST]);
+          clusters[0][y]->p_cmd_out[WEST]          (signal_dspin_bound_cmd_out[0][y][WEST]);
+          clusters[X_SIZE-1][y]->p_cmd_in[EAST]    (signal_dspin_bound_cmd_in[X_SIZE-1][y][EAST]);
+          clusters[X_SIZE-1][y]->p_cmd_out[EAST]   (signal_dspin_bound_cmd_out[X_SIZE-1][y][EAST]);
+
+          clusters[0][y]->p_rsp_in[WEST]           (signal_dspin_bound_rsp_in[0][y][WEST]);
+          clusters[0][y]->p_rsp_out[WEST]          (signal_dspin_bound_rsp_out[0][y][WEST]);
+          clusters[X_SIZE-1][y]->p_rsp_in[EAST]    (signal_dspin_bound_rsp_in[X_SIZE-1][y][EAST]);
+          clusters[X_SIZE-1][y]->p_rsp_out[EAST]   (signal_dspin_bound_rsp_out[X_SIZE-1][y][EAST]);
+
+          clusters[0][y]->p_p2m_in[WEST]           (signal_dspin_bound_p2m_in[0][y][WEST]);
+          clusters[0][y]->p_p2m_out[WEST]          (signal_dspin_bound_p2m_out[0][y][WEST]);
+          clusters[X_SIZE-1][y]->p_p2m_in[EAST]    (signal_dspin_bound_p2m_in[X_SIZE-1][y][EAST]);
+          clusters[X_SIZE-1][y]->p_p2m_out[EAST]   (signal_dspin_bound_p2m_out[X_SIZE-1][y][EAST]);
+
+          clusters[0][y]->p_cla_in[WEST]           (signal_dspin_bound_cla_in[0][y][WEST]);
+          clusters[0][y]->p_cla_out[WEST]          (signal_dspin_bound_cla_out[0][y][WEST]);
+          clusters[X_SIZE-1][y]->p_cla_in[EAST]    (signal_dspin_bound_cla_in[X_SIZE-1][y][EAST]);
+          clusters[X_SIZE-1][y]->p_cla_out[EAST]   (signal_dspin_bound_cla_out[X_SIZE-1][y][EAST]);
+       }
    }
 
    std::cout << std::endl << "West & East boundaries connections done" << std::endl;
 
    // North & South boundary clusters connections
    for (size_t x = 0; x < X_SIZE; x++) {
-       clusters[x][0]->p_cmd_in[SOUTH]          (signal_dspin_bound_cmd_in[x][0][SOUTH]);
-       clusters[x][0]->p_cmd_out[SOUTH]         (signal_dspin_bound_cmd_out[x][0][SOUTH]);
-       clusters[x][Y_SIZE-1]->p_cmd_in[NORTH]   (signal_dspin_bound_cmd_in[x][Y_SIZE-1][NORTH]);
-       clusters[x][Y_SIZE-1]->p_cmd_out[NORTH]  (signal_dspin_bound_cmd_out[x][Y_SIZE-1][NORTH]);
-
-       clusters[x][0]->p_rsp_in[SOUTH]          (signal_dspin_bound_rsp_in[x][0][SOUTH]);
-       clusters[x][0]->p_rsp_out[SOUTH]         (signal_dspin_bound_rsp_out[x][0][SOUTH]);
-       clusters[x][Y_SIZE-1]->p_rsp_in[NORTH]   (signal_dspin_bound_rsp_in[x][Y_SIZE-1][NORTH]);
-       clusters[x][Y_SIZE-1]->p_rsp_out[NORTH]  (signal_dspin_bound_rsp_out[x][Y_SIZE-1][NORTH]);
-
        clusters[x][0]->p_m2p_in[SOUTH]          (signal_dspin_bound_m2p_in[x][0][SOUTH]);
        clusters[x][0]->p_m2p_out[SOUTH]         (signal_dspin_bound_m2p_out[x][0][SOUTH]);
        clusters[x][Y_SIZE-1]->p_m2p_in[NORTH]   (signal_dspin_bound_m2p_in[x][Y_SIZE-1][NORTH]);
        clusters[x][Y_SIZE-1]->p_m2p_out[NORTH]  (signal_dspin_bound_m2p_out[x][Y_SIZE-1][NORTH]);
 
-       clusters[x][0]->p_p2m_in[SOUTH]          (signal_dspin_bound_p2m_in[x][0][SOUTH]);
-       clusters[x][0]->p_p2m_out[SOUTH]         (signal_dspin_bound_p2m_out[x][0][SOUTH]);
-       clusters[x][Y_SIZE-1]->p_p2m_in[NORTH]   (signal_dspin_bound_p2m_in[x][Y_SIZE-1][NORTH]);
-       clusters[x][Y_SIZE-1]->p_p2m_out[NORTH]  (signal_dspin_bound_p2m_out[x][Y_SIZE-1][NORTH]);
-
-       clusters[x][0]->p_cla_in[SOUTH]          (signal_dspin_bound_cla_in[x][0][SOUTH]);
-       clusters[x][0]->p_cla_out[SOUTH]         (signal_dspin_bound_cla_out[x][0][SOUTH]);
-       clusters[x][Y_SIZE-1]->p_cla_in[NORTH]   (signal_dspin_bound_cla_in[x][Y_SIZE-1][NORTH]);
-       clusters[x][Y_SIZE-1]->p_cla_out[NORTH]  (signal_dspin_bound_cla_out[x][Y_SIZE-1][NORTH]);
+       if (not mesh_noc) {
+          clusters[x][0]->p_cmd_in[SOUTH]          (signal_dspin_bound_cmd_in[x][0][SOUTH]);
+          clusters[x][0]->p_cmd_out[SOUTH]         (signal_dspin_bound_cmd_out[x][0][SOUTH]);
+          clusters[x][Y_SIZE-1]->p_cmd_in[NORTH]   (signal_dspin_bound_cmd_in[x][Y_SIZE-1][NORTH]);
+          clusters[x][Y_SIZE-1]->p_cmd_out[NORTH]  (signal_dspin_bound_cmd_out[x][Y_SIZE-1][NORTH]);
+
+          clusters[x][0]->p_rsp_in[SOUTH]          (signal_dspin_bound_rsp_in[x][0][SOUTH]);
+          clusters[x][0]->p_rsp_out[SOUTH]         (signal_dspin_bound_rsp_out[x][0][SOUTH]);
+          clusters[x][Y_SIZE-1]->p_rsp_in[NORTH]   (signal_dspin_bound_rsp_in[x][Y_SIZE-1][NORTH]);
+          clusters[x][Y_SIZE-1]->p_rsp_out[NORTH]  (signal_dspin_bound_rsp_out[x][Y_SIZE-1][NORTH]);
+
+          clusters[x][0]->p_p2m_in[SOUTH]          (signal_dspin_bound_p2m_in[x][0][SOUTH]);
+          clusters[x][0]->p_p2m_out[SOUTH]         (signal_dspin_bound_p2m_out[x][0][SOUTH]);
+          clusters[x][Y_SIZE-1]->p_p2m_in[NORTH]   (signal_dspin_bound_p2m_in[x][Y_SIZE-1][NORTH]);
+          clusters[x][Y_SIZE-1]->p_p2m_out[NORTH]  (signal_dspin_bound_p2m_out[x][Y_SIZE-1][NORTH]);
+
+          clusters[x][0]->p_cla_in[SOUTH]          (signal_dspin_bound_cla_in[x][0][SOUTH]);
+          clusters[x][0]->p_cla_out[SOUTH]         (signal_dspin_bound_cla_out[x][0][SOUTH]);
+          clusters[x][Y_SIZE-1]->p_cla_in[NORTH]   (signal_dspin_bound_cla_in[x][Y_SIZE-1][NORTH]);
+          clusters[x][Y_SIZE-1]->p_cla_out[NORTH]  (signal_dspin_bound_cla_out[x][Y_SIZE-1][NORTH]);
+       }
    }
 
    std::cout << std::endl << "North & South boundaries connections done" << std::endl;
@@ -970,6 +1326,14 @@ int _main(int argc, char *argv[])
 
 
 #ifdef WT_IDL
+#if USE_OPENMP
+   // the ideal write-through memc directly reads the L1 caches
+   // of all clusters, which is not compatible with a parallel
+   // evaluation of the clusters
+   assert((threads_nr == 1) &&
+          "WT_IDL can only be used with a single simulation thread");
+#endif
+
     std::list<VciCcVCacheWrapper<vci_param_int,
         dspin_cmd_width,
         dspin_rsp_width,
@@ -1082,7 +1446,7 @@ int _main(int argc, char *argv[])
 
    if (debug_ok) {
       #if USE_OPENMP
-         assert(false && "OPEN MP should not be used with debug because of its traces");
+         assert(not debug_text && "OPEN MP should not be used with debug because of its traces");
       #endif
 
       if (gettimeofday(&t1, NULL) != 0) {
@@ -1119,17 +1483,39 @@ int _main(int argc, char *argv[])
                   clusters[x][y]->memc->reset_counters();
                }
             }
+            stats.rebase();
          }
 
          if (n == dump_counters) {
-            for (size_t x = 0; x < (X_SIZE); x++) {
-               for (size_t y = 0; y < Y_SIZE; y++) {
-                  clusters[x][y]->memc->print_stats(true, false);
+            if (stats.is_open()) {
+               stats.dump(n);
+            }
+            else {
+               for (size_t x = 0; x < (X_SIZE); x++) {
+                  for (size_t y = 0; y < Y_SIZE; y++) {
+                     clusters[x][y]->memc->print_stats(true, false);
+                  }
                }
             }
          }
 
-         if ((n > debug_from) and (n % debug_period == 0))
+         if (n == dump_next) {
+            stats.dump(n);
+            dump_next += dump_period;
+         }
+
+         if ((n > debug_from) and (n % debug_period == 0) and not debug_text)
+         {
+            for (size_t x = 0; x < X_SIZE ; x++){
+               for (size_t y = 0; y < Y_SIZE ; y++){
+                  for (int proc = 0; proc < NB_PROCS_MAX; proc++) {
+                     clusters[x][y]->proc[proc]->binary_trace(n);
+                  }
+                  clusters[x][y]->memc->binary_trace(n);
+               }
+            }
+         }
+         else if ((n > debug_from) and (n % debug_period == 0))
          {
             std::cout << "****************** cycle " << std::dec << n ;
             std::cout << "************************************************" << std::endl;
@@ -1187,6 +1573,9 @@ int _main(int argc, char *argv[])
          if (do_dump_counters) {
             nb_cycles = min(nb_cycles, dump_counters - n);
          }
+         if (dump_next > 0) {
+            nb_cycles = min(nb_cycles, dump_next - n);
+         }
 
          sc_start(sc_core::sc_time(nb_cycles, SC_NS));
          n += nb_cycles;
@@ -1198,19 +1587,31 @@ int _main(int argc, char *argv[])
                   clusters[x][y]->memc->reset_counters();
                }
             }
+            stats.rebase();
             do_reset_counters = false;
          }
 
          if (do_dump_counters && n == dump_counters) {
             // Dumping counters
-            for (size_t x = 0; x < (X_SIZE); x++) {
-               for (size_t y = 0; y < Y_SIZE; y++) {
-                  clusters[x][y]->memc->print_stats(true, false);
+            if (stats.is_open()) {
+               stats.dump(n);
+            }
+            else {
+               for (size_t x = 0; x < (X_SIZE); x++) {
+                  for (size_t y = 0; y < Y_SIZE; y++) {
+                     clusters[x][y]->memc->print_stats(true, false);
+                  }
                }
             }
             do_dump_counters = false;
          }
 
+         if (n == dump_next) {
+            // Periodic statistics snapshot
+            stats.dump(n);
+            dump_next += dump_period;
+         }
+
 
          if (gettimeofday(&t2, NULL) != 0) {
             perror("gettimeofday");
@@ -1222,6 +1623,8 @@ int _main(int argc, char *argv[])
       }
    }
 
+   stats.close();
+   soclib::TraceSink::instance().close();
 
    // Free memory
    for (size_t i = 0; i  < (X_SIZE * Y_SIZE); i++)
@@ -1231,6 +1634,11 @@ int _main(int argc, char *argv[])
       delete clusters[x][y];
    }
 
+   delete mesh_cmd;
+   delete mesh_rsp;
+   delete mesh_p2m;
+   delete mesh_cla;
+
    dealloc_elems<DspinSignals<dspin_cmd_width> >(signal_dspin_h_cmd_inc, X_SIZE-1, Y_SIZE);
    dealloc_elems<DspinSignals<dspin_cmd_width> >(signal_dspin_h_cmd_dec, X_SIZE-1, Y_SIZE);
 
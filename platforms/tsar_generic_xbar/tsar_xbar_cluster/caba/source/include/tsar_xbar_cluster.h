@@ -52,6 +52,9 @@ template<size_t dspin_cmd_width,
     // Used in destructor
     size_t n_procs;
 
+    // CMD, RSP, P2M & CLACK routers replaced by DspinMeshTsar instances
+    bool   m_mesh_noc;
+
     // Ports
     sc_in<bool>                                     p_clk;
     sc_in<bool>                                     p_resetn;
@@ -143,7 +146,7 @@ template<size_t dspin_cmd_width,
 
     VciMultiDma<vci_param_int>*                   mdma;
 
-    VciSimpleRam<vci_param_ext>*                  xram;
+    VciSimpleRam<vci_param_ext>*                  xram;         // NULL if direct XRAM access
 
     VciSimpleRom<vci_param_int>*                  brom;
 
@@ -221,7 +224,9 @@ template<size_t dspin_cmd_width,
                      uint32_t                           frozen_cycles,
                      uint32_t                           start_debug_cycle,
                      bool                               memc_debug_ok,
-                     bool                               proc_debug_ok);
+                     bool                               proc_debug_ok,
+                     bool                               mesh_noc,      // mesh NoC engine
+                     bool                               xram_direct);  // no XRAM component
 
     ~TsarXbarCluster();
     void trace(sc_trace_file * tf, const std::string & name);
@@ -81,33 +81,53 @@ template<size_t dspin_cmd_width,
          uint32_t                           frozen_cycles,
          uint32_t                           debug_start_cycle,
          bool                               memc_debug_ok,
-         bool                               proc_debug_ok)
+         bool                               proc_debug_ok,
+         bool                               mesh_noc,
+         bool                               xram_direct)
             : soclib::caba::BaseModule(insname),
             p_clk("clk"),
             p_resetn("resetn")
 
 {
 
-    n_procs = nb_procs;
+    n_procs    = nb_procs;
+    m_mesh_noc = mesh_noc;
 
     /////////////////////////////////////////////////////////////////////////////
     // Vectors of ports definition and allocation
+    // With the mesh NoC engine, the CMD, RSP, P2M & CLACK routers are not
+    // instanciated: the mesh engine is directly connected to the
+    // signal_dspin_*_l2g_* / signal_dspin_*_g2l_* local signals, and the
+    // corresponding N/S/E/W ports do not exist (NULL pointers).
+    // The M2P network (supporting broadcast) always uses local routers.
     /////////////////////////////////////////////////////////////////////////////
 
-    p_cmd_in  = alloc_elems<DspinInput<dspin_cmd_width> >  ("p_cmd_in",  4);
-    p_cmd_out = alloc_elems<DspinOutput<dspin_cmd_width> > ("p_cmd_out", 4);
+    p_cmd_in  = NULL;
+    p_cmd_out = NULL;
+    p_rsp_in  = NULL;
+    p_rsp_out = NULL;
+    p_p2m_in  = NULL;
+    p_p2m_out = NULL;
+    p_cla_in  = NULL;
+    p_cla_out = NULL;
 
-    p_rsp_in  = alloc_elems<DspinInput<dspin_rsp_width> >  ("p_rsp_in",  4);
-    p_rsp_out = alloc_elems<DspinOutput<dspin_rsp_width> > ("p_rsp_out", 4);
+    if (not mesh_noc)
+    {
+        p_cmd_in  = alloc_elems<DspinInput<dspin_cmd_width> >  ("p_cmd_in",  4);
+        p_cmd_out = alloc_elems<DspinOutput<dspin_cmd_width> > ("p_cmd_out", 4);
 
-    p_m2p_in  = alloc_elems<DspinInput<dspin_cmd_width> >  ("p_m2p_in",  4);
-    p_m2p_out = alloc_elems<DspinOutput<dspin_cmd_width> > ("p_m2p_out", 4);
+        p_rsp_in  = alloc_elems<DspinInput<dspin_rsp_width> >  ("p_rsp_in",  4);
+        p_rsp_out = alloc_elems<DspinOutput<dspin_rsp_width> > ("p_rsp_out", 4);
 
-    p_p2m_in  = alloc_elems<DspinInput<dspin_rsp_width> >  ("p_p2m_in",  4);
-    p_p2m_out = alloc_elems<DspinOutput<dspin_rsp_width> > ("p_p2m_out", 4);
+        p_p2m_in  = alloc_elems<DspinInput<dspin_rsp_width> >  ("p_p2m_in",  4);
+        p_p2m_out = alloc_elems<DspinOutput<dspin_rsp_width> > ("p_p2m_out", 4);
 
-    p_cla_in  = alloc_elems<DspinInput<dspin_cmd_width> >  ("p_cla_in",  4);
-    p_cla_out = alloc_elems<DspinOutput<dspin_cmd_width> > ("p_cla_out", 4);
+        p_cla_in  = alloc_elems<DspinInput<dspin_cmd_width> >  ("p_cla_in",  4);
+        p_cla_out = alloc_elems<DspinOutput<dspin_cmd_width> > ("p_cla_out", 4);
+    }
+
+    p_m2p_in  = alloc_elems<DspinInput<dspin_cmd_width> >  ("p_m2p_in",  4);
+    p_m2p_out = alloc_elems<DspinOutput<dspin_cmd_width> > ("p_m2p_out", 4);
 
     /////////////////////////////////////////////////////////////////////////////
     // Components definition
@@ -167,14 +187,21 @@ template<size_t dspin_cmd_width,
 
 
     /////////////////////////////////////////////////////////////////////////////
-    std::ostringstream sxram;
-    sxram << "xram_" << x_id << "_" << y_id;
-    xram = new VciSimpleRam<vci_param_ext>(
+    // With the direct XRAM access, the memory cache uses a backing store
+    // defined by the top cell, and the XRAM component is not instanciated
+    // (it would hold a private copy of the memory segment).
+    xram = NULL;
+    if (not xram_direct)
+    {
+        std::ostringstream sxram;
+        sxram << "xram_" << x_id << "_" << y_id;
+        xram = new VciSimpleRam<vci_param_ext>(
                      sxram.str().c_str(),
                      IntTab(cluster_id),
                      mtx,
                      loader,
                      xram_latency);
+    }
 
     /////////////////////////////////////////////////////////////////////////////
     std::ostringstream sxicu;
@@ -273,24 +300,6 @@ template<size_t dspin_cmd_width,
                      false,                        // don't use local routing table
                      false);                       // broadcast
 
-    /////////////////////////////////////////////////////////////////////////////
-    std::ostringstream s_router_cmd;
-    s_router_cmd << "router_cmd_" << x_id << "_" << y_id;
-    router_cmd = new DspinRouter<dspin_cmd_width>(
-                     s_router_cmd.str().c_str(),
-                     x_id,y_id,                    // coordinate in the mesh
-                     x_width, y_width,             // x & y fields width
-                     4,4);                         // input & output fifo depths
-
-    /////////////////////////////////////////////////////////////////////////////
-    std::ostringstream s_router_rsp;
-    s_router_rsp << "router_rsp_" << x_id << "_" << y_id;
-    router_rsp = new DspinRouter<dspin_rsp_width>(
-                     s_router_rsp.str().c_str(),
-                     x_id,y_id,                    // coordinates in mesh
-                     x_width, y_width,             // x & y fields width
-                     4,4);                         // input & output fifo depths
-
     /////////////////////////////////////////////////////////////////////////////
     std::ostringstream s_router_m2p;
     s_router_m2p << "router_m2p_" << x_id << "_" << y_id;
@@ -301,23 +310,49 @@ template<size_t dspin_cmd_width,
                      4,4,                          // input & output fifo depths
                      true);                        // broadcast supported
 
-    /////////////////////////////////////////////////////////////////////////////
-    std::ostringstream s_router_p2m;
-    s_router_p2m << "router_p2m_" << x_id << "_" << y_id;
-    router_p2m = new DspinRouter<dspin_rsp_width>(
-                     s_router_p2m.str().c_str(),
-                     x_id,y_id,                    // coordinates in mesh
-                     x_width, y_width,             // x & y fields width
-                     4,4);                         // input & output fifo depths
+    router_cmd = NULL;
+    router_rsp = NULL;
+    router_p2m = NULL;
+    router_cla = NULL;
 
-    /////////////////////////////////////////////////////////////////////////////
-    std::ostringstream s_router_cla;
-    s_router_cla << "router_cla_" << x_id << "_" << y_id;
-    router_cla = new DspinRouter<dspin_cmd_width>(
-                     s_router_cla.str().c_str(),
-                     x_id,y_id,                    // coordinate in the mesh
-                     x_width, y_width,             // x & y fields width
-                     4,4);                         // input & output fifo depths
+    if (not mesh_noc)
+    {
+        /////////////////////////////////////////////////////////////////////////
+        std::ostringstream s_router_cmd;
+        s_router_cmd << "router_cmd_" << x_id << "_" << y_id;
+        router_cmd = new DspinRouter<dspin_cmd_width>(
+                         s_router_cmd.str().c_str(),
+                         x_id,y_id,                    // coordinate in the mesh
+                         x_width, y_width,             // x & y fields width
+                         4,4);                         // input & output fifo depths
+
+        /////////////////////////////////////////////////////////////////////////
+        std::ostringstream s_router_rsp;
+        s_router_rsp << "router_rsp_" << x_id << "_" << y_id;
+        router_rsp = new DspinRouter<dspin_rsp_width>(
+                         s_router_rsp.str().c_str(),
+                         x_id,y_id,                    // coordinates in mesh
+                         x_width, y_width,             // x & y fields width
+                         4,4);                         // input & output fifo depths
+
+        /////////////////////////////////////////////////////////////////////////
+        std::ostringstream s_router_p2m;
+        s_router_p2m << "router_p2m_" << x_id << "_" << y_id;
+        router_p2m = new DspinRouter<dspin_rsp_width>(
+                         s_router_p2m.str().c_str(),
+                         x_id,y_id,                    // coordinates in mesh
+                         x_width, y_width,             // x & y fields width
+                         4,4);                         // input & output fifo depths
+
+        /////////////////////////////////////////////////////////////////////////
+        std::ostringstream s_router_cla;
+        s_router_cla << "router_cla_" << x_id << "_" << y_id;
+        router_cla = new DspinRouter<dspin_cmd_width>(
+                         s_router_cla.str().c_str(),
+                         x_id,y_id,                    // coordinate in the mesh
+                         x_width, y_width,             // x & y fields width
+                         4,4);                         // input & output fifo depths
+    }
 
     // IO cluster components
     if (io)
@@ -393,50 +428,58 @@ template<size_t dspin_cmd_width,
     ////////////////////////////////////
 
     //////////////////////// ROUTERS
-    router_cmd->p_clk                      (this->p_clk);
-    router_cmd->p_resetn                   (this->p_resetn);
-    router_rsp->p_clk                      (this->p_clk);
-    router_rsp->p_resetn                   (this->p_resetn);
     router_m2p->p_clk                      (this->p_clk);
     router_m2p->p_resetn                   (this->p_resetn);
-    router_p2m->p_clk                      (this->p_clk);
-    router_p2m->p_resetn                   (this->p_resetn);
-    router_cla->p_clk                      (this->p_clk);
-    router_cla->p_resetn                   (this->p_resetn);
 
     // loop on N/S/E/W ports
     for (size_t i = 0; i < 4; i++)
     {
-        router_cmd->p_out[i]               (this->p_cmd_out[i]);
-        router_cmd->p_in[i]                (this->p_cmd_in[i]);
-
-        router_rsp->p_out[i]               (this->p_rsp_out[i]);
-        router_rsp->p_in[i]                (this->p_rsp_in[i]);
-
         router_m2p->p_out[i]               (this->p_m2p_out[i]);
         router_m2p->p_in[i]                (this->p_m2p_in[i]);
+    }
 
-        router_p2m->p_out[i]               (this->p_p2m_out[i]);
-        router_p2m->p_in[i]                (this->p_p2m_in[i]);
+    router_m2p->p_out[4]                   (signal_dspin_m2p_g2l_c);
+    router_m2p->p_in[4]                    (signal_dspin_m2p_l2g_c);
 
-        router_cla->p_out[i]               (this->p_cla_out[i]);
-        router_cla->p_in[i]                (this->p_cla_in[i]);
-    }
+    if (not mesh_noc)
+    {
+        router_cmd->p_clk                      (this->p_clk);
+        router_cmd->p_resetn                   (this->p_resetn);
+        router_rsp->p_clk                      (this->p_clk);
+        router_rsp->p_resetn                   (this->p_resetn);
+        router_p2m->p_clk                      (this->p_clk);
+        router_p2m->p_resetn                   (this->p_resetn);
+        router_cla->p_clk                      (this->p_clk);
+        router_cla->p_resetn                   (this->p_resetn);
+
+        // loop on N/S/E/W ports
+        for (size_t i = 0; i < 4; i++)
+        {
+            router_cmd->p_out[i]               (this->p_cmd_out[i]);
+            router_cmd->p_in[i]                (this->p_cmd_in[i]);
 
-    router_cmd->p_out[4]                   (signal_dspin_cmd_g2l_d);
-    router_cmd->p_in[4]                    (signal_dspin_cmd_l2g_d);
+            router_rsp->p_out[i]               (this->p_rsp_out[i]);
+            router_rsp->p_in[i]                (this->p_rsp_in[i]);
 
-    router_rsp->p_out[4]                   (signal_dspin_rsp_g2l_d);
-    router_rsp->p_in[4]                    (signal_dspin_rsp_l2g_d);
+            router_p2m->p_out[i]               (this->p_p2m_out[i]);
+            router_p2m->p_in[i]                (this->p_p2m_in[i]);
 
-    router_m2p->p_out[4]                   (signal_dspin_m2p_g2l_c);
-    router_m2p->p_in[4]                    (signal_dspin_m2p_l2g_c);
+            router_cla->p_out[i]               (this->p_cla_out[i]);
+            router_cla->p_in[i]                (this->p_cla_in[i]);
+        }
 
-    router_p2m->p_out[4]                   (signal_dspin_p2m_g2l_c);
-    router_p2m->p_in[4]                    (signal_dspin_p2m_l2g_c);
+        router_cmd->p_out[4]                   (signal_dspin_cmd_g2l_d);
+        router_cmd->p_in[4]                    (signal_dspin_cmd_l2g_d);
 
-    router_cla->p_out[4]                   (signal_dspin_clack_g2l_c);
-    router_cla->p_in[4]                    (signal_dspin_clack_l2g_c);
+        router_rsp->p_out[4]                   (signal_dspin_rsp_g2l_d);
+        router_rsp->p_in[4]                    (signal_dspin_rsp_l2g_d);
+
+        router_p2m->p_out[4]                   (signal_dspin_p2m_g2l_c);
+        router_p2m->p_in[4]                    (signal_dspin_p2m_l2g_c);
+
+        router_cla->p_out[4]                   (signal_dspin_clack_g2l_c);
+        router_cla->p_in[4]                    (signal_dspin_clack_l2g_c);
+    }
 
     std::cout << "  - routers connected" << std::endl;
 
@@ -589,11 +632,14 @@ template<size_t dspin_cmd_width,
     std::cout << "  - MEMC connected" << std::endl;
 
     /////////////////////////////////////////////// XRAM
-    xram->p_clk                        (this->p_clk);
-    xram->p_resetn                     (this->p_resetn);
-    xram->p_vci                        (signal_vci_xram);
+    if (xram != NULL)
+    {
+        xram->p_clk                    (this->p_clk);
+        xram->p_resetn                 (this->p_resetn);
+        xram->p_vci                    (signal_vci_xram);
 
-    std::cout << "  - XRAM connected" << std::endl;
+        std::cout << "  - XRAM connected" << std::endl;
+    }
 
     ////////////////////////////////////////////// MDMA
     mdma->p_clk                        (this->p_clk);
@@ -687,20 +733,23 @@ template<size_t dspin_cmd_width,
                                                  vci_param_int,
                                                  vci_param_ext>::~TsarXbarCluster() {
 
-    dealloc_elems<DspinInput<dspin_cmd_width> > (p_cmd_in, 4);
-    dealloc_elems<DspinOutput<dspin_cmd_width> >(p_cmd_out, 4);
+    if (not m_mesh_noc)
+    {
+        dealloc_elems<DspinInput<dspin_cmd_width> > (p_cmd_in, 4);
+        dealloc_elems<DspinOutput<dspin_cmd_width> >(p_cmd_out, 4);
 
-    dealloc_elems<DspinInput<dspin_rsp_width> > (p_rsp_in, 4);
-    dealloc_elems<DspinOutput<dspin_rsp_width> >(p_rsp_out, 4);
+        dealloc_elems<DspinInput<dspin_rsp_width> > (p_rsp_in, 4);
+        dealloc_elems<DspinOutput<dspin_rsp_width> >(p_rsp_out, 4);
 
-    dealloc_elems<DspinInput<dspin_cmd_width> > (p_m2p_in, 4);
-    dealloc_elems<DspinOutput<dspin_cmd_width> >(p_m2p_out, 4);
+        dealloc_elems<DspinInput<dspin_rsp_width> > (p_p2m_in, 4);
+        dealloc_elems<DspinOutput<dspin_rsp_width> >(p_p2m_out, 4);
 
-    dealloc_elems<DspinInput<dspin_rsp_width> > (p_p2m_in, 4);
-    dealloc_elems<DspinOutput<dspin_rsp_width> >(p_p2m_out, 4);
+        dealloc_elems<DspinInput<dspin_cmd_width> > (p_cla_in, 4);
+        dealloc_elems<DspinOutput<dspin_cmd_width> >(p_cla_out, 4);
+    }
 
-    dealloc_elems<DspinInput<dspin_cmd_width> > (p_cla_in, 4);
-    dealloc_elems<DspinOutput<dspin_cmd_width> >(p_cla_out, 4);
+    dealloc_elems<DspinInput<dspin_cmd_width> > (p_m2p_in, 4);
+    dealloc_elems<DspinOutput<dspin_cmd_width> >(p_m2p_out, 4);
 
     for (size_t p = 0; p < n_procs; p++)
     {